@@ -1459,6 +1459,94 @@ void CScriptArray::SortDesc(asUINT startAt, asUINT count)
 
 
 // internal
+// Sorts a range of integers of type T, which is the unsigned type of the same size.
+// Small ranges use std::sort, and larger ranges an LSD radix sort one byte at a time.
+// The sign bit is flipped for signed types so they are ordered as unsigned values.
+template <class T>
+static void SortIntegers(void *data, asUINT count, bool isSigned, bool asc)
+{
+	T *values = reinterpret_cast<T*>(data);
+	const T signBit = isSigned ? T(T(1) << (sizeof(T)*8 - 1)) : T(0);
+
+	T *tmp = 0;
+	if( count >= 64 )
+		tmp = reinterpret_cast<T*>(userAlloc(sizeof(T)*count));
+
+	if( tmp == 0 )
+	{
+		// Flip the sign bit so the unsigned compare gives the signed order
+		for( asUINT n = 0; n < count; n++ )
+			values[n] ^= signBit;
+		std::sort(values, values + count);
+		for( asUINT n = 0; n < count; n++ )
+			values[n] ^= signBit;
+	}
+	else
+	{
+		T *src = values;
+		T *dst = tmp;
+		for( asUINT shift = 0; shift < sizeof(T)*8; shift += 8 )
+		{
+			asUINT offsets[256] = {0};
+			for( asUINT n = 0; n < count; n++ )
+				offsets[((src[n] ^ signBit) >> shift) & 0xFF]++;
+
+			// Skip the pass if all the values have the same digit
+			if( offsets[((src[0] ^ signBit) >> shift) & 0xFF] == count )
+				continue;
+
+			asUINT sum = 0;
+			for( asUINT d = 0; d < 256; d++ )
+			{
+				asUINT c = offsets[d];
+				offsets[d] = sum;
+				sum += c;
+			}
+
+			for( asUINT n = 0; n < count; n++ )
+				dst[offsets[((src[n] ^ signBit) >> shift) & 0xFF]++] = src[n];
+
+			T *swap = src; src = dst; dst = swap;
+		}
+
+		if( src != values )
+			memcpy(values, src, sizeof(T)*count);
+		userFree(tmp);
+	}
+
+	// Equal integers can't be told apart, so reversing gives the descending order
+	if( !asc )
+		std::reverse(values, values + count);
+}
+
+template <class T>
+static bool FloatGreater(T a, T b)
+{
+	return b < a;
+}
+
+// Sorts a range of floats or doubles with std::sort. NaN doesn't
+// have an order so these are moved to the end of the range first.
+template <class T>
+static void SortFloats(void *data, asUINT count, bool asc)
+{
+	T *values = reinterpret_cast<T*>(data);
+
+	asUINT numbers = count;
+	for( asUINT n = 0; n < numbers; )
+	{
+		if( values[n] != values[n] )
+			std::swap(values[n], values[--numbers]);
+		else
+			n++;
+	}
+
+	if( asc )
+		std::sort(values, values + numbers);
+	else
+		std::sort(values, values + numbers, FloatGreater<T>);
+}
+
 void CScriptArray::Sort(asUINT startAt, asUINT count, bool asc)
 {
 	// Subtype isn't primitive and doesn't have opCmp
@@ -1592,23 +1680,32 @@ void CScriptArray::Sort(asUINT startAt, asUINT count, bool asc)
 	}
 	else
 	{
-		// TODO: Use std::sort for primitive types too
+		void *data = GetArrayItemPointer(start);
+		asUINT num = asUINT(end - start);
 
-		// Insertion sort
-		asBYTE tmp[16];
-		for( int i = start + 1; i < end; i++ )
+		// Enums are sorted by their underlying type
+		int typeId = subTypeId;
+		if( typeId > asTYPEID_DOUBLE )
 		{
-			Copy(tmp, GetArrayItemPointer(i));
-
-			int j = i - 1;
-
-			while( j >= start && Less(GetDataPointer(tmp), At(j), asc) )
-			{
-				Copy(GetArrayItemPointer(j + 1), GetArrayItemPointer(j));
-				j--;
-			}
+			asITypeInfo *enumType = objType->GetEngine()->GetTypeInfoById(typeId);
+			if( enumType )
+				typeId = enumType->GetTypedefTypeId();
+		}
 
-			Copy(GetArrayItemPointer(j + 1), tmp);
+		switch( typeId )
+		{
+		case asTYPEID_BOOL:
+		case asTYPEID_UINT8:  SortIntegers<asBYTE>(data, num, false, asc); break;
+		case asTYPEID_INT8:   SortIntegers<asBYTE>(data, num, true, asc); break;
+		case asTYPEID_UINT16: SortIntegers<asWORD>(data, num, false, asc); break;
+		case asTYPEID_INT16:  SortIntegers<asWORD>(data, num, true, asc); break;
+		case asTYPEID_UINT32: SortIntegers<asDWORD>(data, num, false, asc); break;
+		case asTYPEID_INT32:  SortIntegers<asDWORD>(data, num, true, asc); break;
+		case asTYPEID_UINT64: SortIntegers<asQWORD>(data, num, false, asc); break;
+		case asTYPEID_INT64:  SortIntegers<asQWORD>(data, num, true, asc); break;
+		case asTYPEID_FLOAT:  SortFloats<float>(data, num, asc); break;
+		case asTYPEID_DOUBLE: SortFloats<double>(data, num, asc); break;
+		default:              SortIntegers<asDWORD>(data, num, true, asc); break;
 		}
 	}
 }
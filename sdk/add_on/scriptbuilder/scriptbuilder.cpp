@@ -54,7 +54,8 @@ int CScriptBuilder::StartNewModule(asIScriptEngine *inEngine, const char *module
 	if(inEngine == 0 ) return -1;
 
 	engine = inEngine;
-	module = inEngine->GetModule(moduleName, asGM_ALWAYS_CREATE);
+	// With incremental builds the existing module is kept so the unchanged functions don't have to be compiled again
+	module = inEngine->GetModule(moduleName, inEngine->GetEngineProperty(asEP_INCREMENTAL_BUILD) ? asGM_CREATE_IF_NOT_EXISTS : asGM_ALWAYS_CREATE);
 	if( module == 0 )
 		return -1;
 
@@ -0,0 +1,1148 @@
+#include <assert.h>
+#include <stddef.h> // offsetof
+#include <string.h>
+#include <vector>
+#include "scriptjit.h"
+
+#ifdef SCRIPTJIT_X64
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+// Script calls are made directly on the context, without
+// going back to the interpreter, so the JIT needs to see
+// the internals of the library
+#include "../../angelscript/source/as_context.h"
+#include "../../angelscript/source/as_scriptengine.h"
+#include "../../angelscript/source/as_scriptfunction.h"
+#include "../../angelscript/source/as_callfunc.h"
+#endif
+
+using namespace std;
+
+BEGIN_AS_NAMESPACE
+
+#ifdef SCRIPTJIT_X64
+
+namespace
+{
+
+enum EReg  { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum EXmm  { XMM0 = 0, XMM1, XMM2 };
+enum ECond { CC_B = 0x2, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+// The virtual machine registers are kept in these
+// native registers while executing the native code
+const int REG_VM = RBX; // asSVMRegisters*
+const int REG_SP = R14; // stack pointer
+const int REG_FP = R15; // stack frame pointer
+
+const int OFS_PP   = offsetof(asSVMRegisters, programPointer);
+const int OFS_FP   = offsetof(asSVMRegisters, stackFramePointer);
+const int OFS_SP   = offsetof(asSVMRegisters, stackPointer);
+const int OFS_VAL  = offsetof(asSVMRegisters, valueRegister);
+const int OFS_SUSP = offsetof(asSVMRegisters, doProcessSuspend);
+
+// The executable memory starts with a small header holding the size of the
+// allocation and a tag to recognize the functions compiled by this JIT
+const size_t  CODE_HEADER_SIZE = 16;
+const asQWORD CODE_TAG         = 0x54494A7470726373ULL;
+
+// Minimal x86-64 machine code emitter. Only the instruction forms used by the JIT are supported.
+class CAssembler
+{
+public:
+	vector<asBYTE> code;
+
+	void Byte(asBYTE b)   { code.push_back(b); }
+	void Dword(asDWORD d) { for( int n = 0; n < 4; n++ ) Byte(asBYTE(d >> (n*8))); }
+	void Qword(asQWORD q) { Dword(asDWORD(q)); Dword(asDWORD(q >> 32)); }
+
+	void Rex(bool w, int reg, int rm)
+	{
+		asBYTE rex = asBYTE(0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0));
+		if( rex != 0x40 )
+			Byte(rex);
+	}
+
+	// [prefix] [REX] op0 [op1] modrm with the memory operand [base+disp]
+	void OpMem(int prefix, int op0, int op1, bool w, int reg, int base, int disp)
+	{
+		if( prefix ) Byte(asBYTE(prefix));
+		Rex(w, reg, base);
+		Byte(asBYTE(op0));
+		if( op1 >= 0 ) Byte(asBYTE(op1));
+		bool disp8 = disp >= -128 && disp <= 127;
+		Byte(asBYTE((disp8 ? 0x40 : 0x80) | ((reg & 7) << 3) | (base & 7)));
+		if( (base & 7) == RSP ) Byte(0x24);
+		if( disp8 ) Byte(asBYTE(disp)); else Dword(asDWORD(disp));
+	}
+
+	// [prefix] [REX] op0 [op1] modrm with a register operand
+	void OpReg(int prefix, int op0, int op1, bool w, int reg, int rm)
+	{
+		if( prefix ) Byte(asBYTE(prefix));
+		Rex(w, reg, rm);
+		Byte(asBYTE(op0));
+		if( op1 >= 0 ) Byte(asBYTE(op1));
+		Byte(asBYTE(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+	}
+
+	void Load(bool w, int reg, int base, int disp)  { OpMem(0, 0x8B, -1, w, reg, base, disp); }
+	void Store(bool w, int base, int disp, int reg) { OpMem(0, 0x89, -1, w, reg, base, disp); }
+	void Lea(int reg, int base, int disp)           { OpMem(0, 0x8D, -1, true, reg, base, disp); }
+	void StoreImm(bool w, int base, int disp, asDWORD imm) { OpMem(0, 0xC7, -1, w, 0, base, disp); Dword(imm); }
+	void MovImm64(int reg, asQWORD imm)             { Rex(true, 0, reg); Byte(asBYTE(0xB8 | (reg & 7))); Qword(imm); }
+	void MovImm32(int reg, asDWORD imm)             { Rex(false, 0, reg); Byte(asBYTE(0xB8 | (reg & 7))); Dword(imm); }
+
+	// op reg, [base+disp] where op is one of the classic ALU opcodes (add = 0x03, sub = 0x2B, etc)
+	void AluMem(int op, bool w, int reg, int base, int disp) { OpMem(0, op, -1, w, reg, base, disp); }
+	// op r/m, imm32 using the 0x81 group (add = 0, or = 1, and = 4, sub = 5, xor = 6, cmp = 7)
+	void AluImm(int ext, bool w, int rm, asDWORD imm)        { OpReg(0, 0x81, -1, w, ext, rm); Dword(imm); }
+	void AluMemImm8(int ext, bool w, int base, int disp, asBYTE imm) { OpMem(0, 0x83, -1, w, ext, base, disp); Byte(imm); }
+	void AdjustStack(int bytes)
+	{
+		// add/sub r14, imm8
+		OpReg(0, 0x83, -1, true, bytes < 0 ? 5 : 0, REG_SP);
+		Byte(asBYTE(bytes < 0 ? -bytes : bytes));
+	}
+
+	void Setcc(int cc, int reg8) { Byte(0x0F); Byte(asBYTE(0x90 | cc)); Byte(asBYTE(0xC0 | reg8)); }
+
+	// Labels are resolved when the code is complete
+	int  NewLabel()       { labels.push_back(-1); return int(labels.size()) - 1; }
+	void Bind(int label)  { labels[label] = int(code.size()); }
+	int  Offset(int label) const { return labels[label]; }
+	void Jmp(int label)          { Byte(0xE9); Fixup(label); }
+	void Jcc(int cc, int label)  { Byte(0x0F); Byte(asBYTE(0x80 | cc)); Fixup(label); }
+
+	bool Resolve()
+	{
+		for( size_t n = 0; n < fixups.size(); n++ )
+		{
+			int target = labels[fixups[n].label];
+			if( target < 0 )
+				return false;
+			asDWORD rel = asDWORD(target - (fixups[n].pos + 4));
+			memcpy(&code[fixups[n].pos], &rel, 4);
+		}
+		return true;
+	}
+
+protected:
+	struct SFixup { int pos; int label; };
+	void Fixup(int label) { SFixup f = {int(code.size()), label}; fixups.push_back(f); Dword(0); }
+
+	vector<int>    labels;
+	vector<SFixup> fixups;
+};
+
+// Returns the native address where the current function of the context
+// continues, or 0 if the interpreter must take over
+asPWORD ResumeAddress(asCContext *ctx)
+{
+	asJITFunction jitFunc = ctx->m_currentFunction->scriptData->jitFunction;
+	if( jitFunc == 0 || *reinterpret_cast<asQWORD*>(reinterpret_cast<asBYTE*>(jitFunc) - 8) != CODE_TAG )
+		return 0;
+
+	asDWORD *pp = ctx->m_regs.programPointer;
+	if( *(asBYTE*)pp != asBC_JitEntry )
+		return 0;
+	return asBC_PTRARG(pp);
+}
+
+// The helpers below are called from the native code with the virtual machine
+// registers already stored. They return 0 when the interpreter must continue.
+
+// asBC_CALL
+asPWORD CallScript(asSVMRegisters *regs, asUINT funcId)
+{
+	asCContext *ctx = static_cast<asCContext*>(regs->ctx);
+	asCScriptFunction *func = ctx->m_engine->scriptFunctions[funcId];
+
+	// Let the interpreter raise the exception if a method is called on a null pointer
+	if( func->objectType && *(asPWORD*)regs->stackPointer == 0 )
+	{
+		regs->programPointer -= 2;
+		return 0;
+	}
+
+	ctx->CallScriptFunction(func);
+	if( ctx->m_status != asEXECUTION_ACTIVE )
+		return 0;
+	return ResumeAddress(ctx);
+}
+
+// asBC_RET
+asPWORD ReturnScript(asSVMRegisters *regs, asUINT popSize)
+{
+	asCContext *ctx = static_cast<asCContext*>(regs->ctx);
+
+	// The interpreter takes care of the function callback, and
+	// of returning from the first function or a nested call
+	asUINT length = ctx->m_callStack.GetLength();
+	if( ctx->m_functionCallback || length == 0 || ctx->m_callStack[length - CALLSTACK_FRAME_SIZE] == 0 )
+		return 0;
+
+	ctx->PopCallState();
+	regs->stackPointer += popSize;
+	return ResumeAddress(ctx);
+}
+
+// asBC_CALLSYS
+asPWORD CallSystem(asSVMRegisters *regs, asUINT funcId)
+{
+	asCContext *ctx = static_cast<asCContext*>(regs->ctx);
+	regs->stackPointer += CallSystemFunction(int(funcId), ctx);
+	regs->programPointer += 2;
+
+	if( regs->doProcessSuspend )
+	{
+		if( ctx->m_doSuspend )
+		{
+			ctx->m_status = asEXECUTION_SUSPENDED;
+			return 0;
+		}
+		// An exception might have been raised
+		if( ctx->m_status != asEXECUTION_ACTIVE )
+			return 0;
+	}
+	return 1;
+}
+
+// Translates the bytecode of one script function
+class CTranslator
+{
+public:
+	CTranslator(asDWORD *byteCode, asUINT length) : bc(byteCode), length(length) {}
+
+	bool Translate();
+
+	CAssembler      a;
+	vector<asUINT>  jitEntries;   // bytecode positions of the JitEntry instructions
+	vector<int>     labelAt;      // label for each bytecode position, or -1
+
+protected:
+	struct SExitStub { int label; asDWORD *bc; };
+
+	static int Var(short offset) { return -4*int(offset); }
+
+	void EmitPrologue();
+	void EmitExit(asDWORD *instr);
+	void CallHelper(asPWORD helper, asDWORD arg, asDWORD *pp);
+	void JumpToResume();
+	int  ExitLabel(asDWORD *instr);
+	bool EmitInstruction(asDWORD *instr, asUINT pos);
+	int  JumpTarget(asUINT pos, int offset);
+
+	void CmpResult(bool isSigned);
+	void CmpResultFloat();
+	void TestResult(int cc);
+	void Push(int reg, bool w);
+	void BinOp(bool w, int op, asDWORD *instr);
+	void Shift(bool w, int ext, asDWORD *instr);
+	void Div(bool w, bool isSigned, bool mod, asDWORD *instr);
+	void FloatOp(bool dbl, int op, asDWORD *instr);
+
+	asDWORD          *bc;
+	asUINT            length;
+	int               exitLabel;
+	int               leaveLabel;
+	vector<SExitStub> exitStubs;
+	asDWORD          *exitStubFor;
+	int               exitStubLabel;
+};
+
+bool CTranslator::Translate()
+{
+	// Give each instruction a label so it can be the target of jumps and JitEntries
+	labelAt.resize(length + 1, -1);
+	for( asUINT pos = 0; pos < length; )
+	{
+		labelAt[pos] = a.NewLabel();
+		pos += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[pos]].type];
+	}
+	exitLabel = a.NewLabel();
+	leaveLabel = a.NewLabel();
+	exitStubFor = 0;
+	exitStubLabel = -1;
+
+	EmitPrologue();
+
+	for( asUINT pos = 0; pos < length; )
+	{
+		asDWORD *instr = &bc[pos];
+		asEBCInstr op = asEBCInstr(*(asBYTE*)instr);
+
+		a.Bind(labelAt[pos]);
+		if( op == asBC_JitEntry )
+			jitEntries.push_back(pos);
+		else if( !EmitInstruction(instr, pos) )
+			EmitExit(instr);
+
+		pos += asBCTypeSize[asBCInfo[op].type];
+	}
+
+	// The bytecode always ends with RET, so the code never falls through to here
+	for( size_t n = 0; n < exitStubs.size(); n++ )
+	{
+		a.Bind(exitStubs[n].label);
+		EmitExit(exitStubs[n].bc);
+	}
+
+	// Common exit that stores the virtual machine registers and returns to the interpreter
+	a.Bind(exitLabel);
+	a.Store(true, REG_VM, OFS_PP, RAX);
+	a.Store(true, REG_VM, OFS_FP, REG_FP);
+	a.Store(true, REG_VM, OFS_SP, REG_SP);
+	a.Bind(leaveLabel);
+	a.Byte(0x41); a.Byte(0x5F);  // pop r15
+	a.Byte(0x41); a.Byte(0x5E);  // pop r14
+	a.Byte(0x5B);                // pop rbx
+	a.Byte(0xC3);                // ret
+
+	return a.Resolve();
+}
+
+void CTranslator::EmitPrologue()
+{
+	// void jitFunction(asSVMRegisters *regs, asPWORD entry)
+	a.Byte(0x53);                // push rbx
+	a.Byte(0x41); a.Byte(0x56);  // push r14
+	a.Byte(0x41); a.Byte(0x57);  // push r15
+#if defined(_WIN64)
+	a.OpReg(0, 0x89, -1, true, RCX, REG_VM);  // mov rbx, rcx
+#else
+	a.OpReg(0, 0x89, -1, true, RDI, REG_VM);  // mov rbx, rdi
+#endif
+	a.Load(true, REG_FP, REG_VM, OFS_FP);
+	a.Load(true, REG_SP, REG_VM, OFS_SP);
+	// The entry argument is the native address of the JitEntry instruction
+#if defined(_WIN64)
+	a.Byte(0xFF); a.Byte(0xE2);  // jmp rdx
+#else
+	a.Byte(0xFF); a.Byte(0xE6);  // jmp rsi
+#endif
+}
+
+void CTranslator::EmitExit(asDWORD *instr)
+{
+	// Let the interpreter continue from this instruction
+	a.MovImm64(RAX, (asQWORD)(asPWORD)instr);
+	a.Jmp(exitLabel);
+}
+
+void CTranslator::CallHelper(asPWORD helper, asDWORD arg, asDWORD *pp)
+{
+	a.MovImm64(RAX, (asQWORD)pp);
+	a.Store(true, REG_VM, OFS_PP, RAX);
+	a.Store(true, REG_VM, OFS_FP, REG_FP);
+	a.Store(true, REG_VM, OFS_SP, REG_SP);
+
+	// The native stack is 16 byte aligned here, as the prologue pushed three registers
+#if defined(_WIN64)
+	a.OpReg(0, 0x89, -1, true, REG_VM, RCX);  // mov rcx, rbx
+	a.MovImm32(RDX, arg);
+	a.AluImm(5, true, RSP, 32);               // sub rsp, 32 (shadow space)
+#else
+	a.OpReg(0, 0x89, -1, true, REG_VM, RDI);  // mov rdi, rbx
+	a.MovImm32(RSI, arg);
+#endif
+	a.MovImm64(RAX, helper);
+	a.Byte(0xFF); a.Byte(0xD0);               // call rax
+#if defined(_WIN64)
+	a.AluImm(0, true, RSP, 32);               // add rsp, 32
+#endif
+
+	// The helper has already updated the registers if the interpreter must continue
+	a.OpReg(0, 0x85, -1, true, RAX, RAX);     // test rax, rax
+	a.Jcc(CC_E, leaveLabel);
+}
+
+void CTranslator::JumpToResume()
+{
+	// Continue in the native code of the function that is now current
+	a.Load(true, REG_FP, REG_VM, OFS_FP);
+	a.Load(true, REG_SP, REG_VM, OFS_SP);
+	a.Byte(0xFF); a.Byte(0xE0);               // jmp rax
+}
+
+int CTranslator::ExitLabel(asDWORD *instr)
+{
+	// Exits for unusual conditions, e.g. division by zero, are placed after
+	// the main code. The interpreter will then raise the script exception.
+	if( exitStubFor != instr )
+	{
+		SExitStub stub = {a.NewLabel(), instr};
+		exitStubs.push_back(stub);
+		exitStubFor = instr;
+		exitStubLabel = stub.label;
+	}
+	return exitStubLabel;
+}
+
+int CTranslator::JumpTarget(asUINT pos, int offset)
+{
+	asINT64 target = asINT64(pos) + offset;
+	if( target < 0 || target >= asINT64(length) || labelAt[asUINT(target)] < 0 )
+		return -1;
+	return labelAt[asUINT(target)];
+}
+
+void CTranslator::CmpResult(bool isSigned)
+{
+	// value = (a > b) - (a < b)
+	a.Setcc(isSigned ? CC_G : CC_A, RCX);
+	a.Setcc(isSigned ? CC_L : CC_B, RAX);
+	a.Byte(0x28); a.Byte(0xC1);                  // sub cl, al
+	a.OpReg(0, 0x0F, 0xBE, false, RCX, RCX);     // movsx ecx, cl
+	a.Store(false, REG_VM, OFS_VAL, RCX);
+}
+
+void CTranslator::CmpResultFloat()
+{
+	// Unordered values compare as greater, just like in the interpreter
+	// value = 1 - 2*less - equal
+	a.Setcc(CC_B, RAX);
+	a.Setcc(CC_NP, RDX);
+	a.Byte(0x20); a.Byte(0xD0);                  // and al, dl
+	a.Setcc(CC_E, RCX);
+	a.Byte(0x20); a.Byte(0xD1);                  // and cl, dl
+	a.OpReg(0, 0x0F, 0xB6, false, RAX, RAX);     // movzx eax, al
+	a.OpReg(0, 0x0F, 0xB6, false, RCX, RCX);     // movzx ecx, cl
+	a.OpReg(0, 0x01, -1, false, RAX, RAX);       // add eax, eax
+	a.OpReg(0, 0x01, -1, false, RCX, RAX);       // add eax, ecx
+	a.OpReg(0, 0xF7, -1, false, 3, RAX);         // neg eax
+	a.AluImm(0, false, RAX, 1);                  // add eax, 1
+	a.Store(false, REG_VM, OFS_VAL, RAX);
+}
+
+void CTranslator::TestResult(int cc)
+{
+	// Set the value register to true or false depending on the test of the integer value
+	a.AluMemImm8(7, false, REG_VM, OFS_VAL, 0);  // cmp dword [value], 0
+	a.Setcc(cc, RAX);
+	a.OpReg(0, 0x0F, 0xB6, false, RAX, RAX);     // movzx eax, al
+	a.Store(true, REG_VM, OFS_VAL, RAX);
+}
+
+void CTranslator::Push(int reg, bool w)
+{
+	a.AdjustStack(w ? -8 : -4);
+	a.Store(w, REG_SP, 0, reg);
+}
+
+void CTranslator::BinOp(bool w, int op, asDWORD *instr)
+{
+	a.Load(w, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+	if( op == 0xAF )
+		a.OpMem(0, 0x0F, 0xAF, w, RAX, REG_FP, Var(asBC_SWORDARG2(instr)));  // imul
+	else
+		a.AluMem(op, w, RAX, REG_FP, Var(asBC_SWORDARG2(instr)));
+	a.Store(w, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+}
+
+void CTranslator::Shift(bool w, int ext, asDWORD *instr)
+{
+	a.Load(w, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+	a.Load(false, RCX, REG_FP, Var(asBC_SWORDARG2(instr)));
+	a.OpReg(0, 0xD3, -1, w, ext, RAX);           // shl/shr/sar rax, cl
+	a.Store(w, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+}
+
+void CTranslator::Div(bool w, bool isSigned, bool mod, asDWORD *instr)
+{
+	int exit = ExitLabel(instr);
+
+	a.Load(w, RCX, REG_FP, Var(asBC_SWORDARG2(instr)));
+	a.OpReg(0, 0x85, -1, w, RCX, RCX);           // test rcx, rcx
+	a.Jcc(CC_E, exit);
+	a.Load(w, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+	if( isSigned )
+	{
+		// Dividing the smallest value with -1 overflows
+		int ok = a.NewLabel();
+		a.AluImm(7, w, RCX, asDWORD(-1));        // cmp rcx, -1
+		a.Jcc(CC_NE, ok);
+		if( w )
+		{
+			a.MovImm64(RDX, asQWORD(1) << 63);
+			a.OpReg(0, 0x39, -1, true, RDX, RAX);  // cmp rax, rdx
+		}
+		else
+			a.AluImm(7, false, RAX, 0x80000000); // cmp eax, 0x80000000
+		a.Jcc(CC_E, exit);
+		a.Bind(ok);
+		if( w ) a.Byte(0x48);
+		a.Byte(0x99);                            // cdq / cqo
+		a.OpReg(0, 0xF7, -1, w, 7, RCX);         // idiv rcx
+	}
+	else
+	{
+		a.OpReg(0, 0x31, -1, false, RDX, RDX);   // xor edx, edx
+		a.OpReg(0, 0xF7, -1, w, 6, RCX);         // div rcx
+	}
+	a.Store(w, REG_FP, Var(asBC_SWORDARG0(instr)), mod ? RDX : RAX);
+}
+
+void CTranslator::FloatOp(bool dbl, int op, asDWORD *instr)
+{
+	int prefix = dbl ? 0xF2 : 0xF3;
+	if( op == 0x5E )
+	{
+		// Division by zero raises a script exception
+		int exit = ExitLabel(instr);
+		int ok = a.NewLabel();
+		a.OpMem(prefix, 0x0F, 0x10, false, XMM1, REG_FP, Var(asBC_SWORDARG2(instr)));
+		a.OpReg(0, 0x0F, 0x57, false, XMM2, XMM2);              // xorps xmm2, xmm2
+		a.OpReg(dbl ? 0x66 : 0, 0x0F, 0x2E, false, XMM1, XMM2); // ucomis xmm1, xmm2
+		a.Jcc(CC_P, ok);
+		a.Jcc(CC_E, exit);
+		a.Bind(ok);
+		a.OpMem(prefix, 0x0F, 0x10, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.OpReg(prefix, 0x0F, op, false, XMM0, XMM1);
+	}
+	else
+	{
+		a.OpMem(prefix, 0x0F, 0x10, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.OpMem(prefix, 0x0F, op, false, XMM0, REG_FP, Var(asBC_SWORDARG2(instr)));
+	}
+	a.OpMem(prefix, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+}
+
+// Returns false if the instruction is not supported, in which case an exit to the interpreter is emitted
+bool CTranslator::EmitInstruction(asDWORD *instr, asUINT pos)
+{
+	asEBCInstr op = asEBCInstr(*(asBYTE*)instr);
+	asUINT     size = asBCTypeSize[asBCInfo[op].type];
+
+	switch( op )
+	{
+	//--------------
+	// Stack
+	case asBC_PopPtr:
+		a.AdjustStack(8);
+		return true;
+	case asBC_PshC4:
+		a.AdjustStack(-4);
+		a.StoreImm(false, REG_SP, 0, asBC_DWORDARG(instr));
+		return true;
+	case asBC_PshC8:
+		a.MovImm64(RAX, asBC_QWORDARG(instr));
+		Push(RAX, true);
+		return true;
+	case asBC_PshV4:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		Push(RAX, false);
+		return true;
+	case asBC_PshV8:
+	case asBC_PshVPtr:
+		a.Load(true, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		Push(RAX, true);
+		return true;
+	case asBC_PshVPtrOfs:
+		// A null pointer raises a script exception in the interpreter
+		a.Load(true, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.OpReg(0, 0x85, -1, true, RAX, RAX);     // test rax, rax
+		a.Jcc(CC_E, ExitLabel(instr));
+		a.AluImm(0, true, RAX, asDWORD(int(asBC_SWORDARG1(instr))));  // add rax, offset
+		Push(RAX, true);
+		return true;
+	case asBC_PSF:
+		a.Lea(RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		Push(RAX, true);
+		return true;
+	case asBC_PshNull:
+		a.AdjustStack(-8);
+		a.StoreImm(true, REG_SP, 0, 0);
+		return true;
+	case asBC_PshG4:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Load(false, RAX, RAX, 0);
+		Push(RAX, false);
+		return true;
+	case asBC_PshGPtr:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Load(true, RAX, RAX, 0);
+		Push(RAX, true);
+		return true;
+	case asBC_PGA:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		Push(RAX, true);
+		return true;
+	case asBC_PshRPtr:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		Push(RAX, true);
+		return true;
+	case asBC_PopRPtr:
+		a.Load(true, RAX, REG_SP, 0);
+		a.AdjustStack(8);
+		a.Store(true, REG_VM, OFS_VAL, RAX);
+		return true;
+
+	//--------------
+	// Path control
+	case asBC_JMP:
+	case asBC_JZ:
+	case asBC_JNZ:
+	case asBC_JS:
+	case asBC_JNS:
+	case asBC_JP:
+	case asBC_JNP:
+	case asBC_JLowZ:
+	case asBC_JLowNZ:
+		{
+			int target = JumpTarget(pos, int(size) + asBC_INTARG(instr));
+			if( target < 0 )
+				return false;
+			if( op == asBC_JMP )
+			{
+				a.Jmp(target);
+				return true;
+			}
+			if( op == asBC_JLowZ || op == asBC_JLowNZ )
+			{
+				a.OpMem(0, 0x80, -1, false, 7, REG_VM, OFS_VAL); a.Byte(0); // cmp byte [value], 0
+				a.Jcc(op == asBC_JLowZ ? CC_E : CC_NE, target);
+				return true;
+			}
+			a.AluMemImm8(7, false, REG_VM, OFS_VAL, 0);  // cmp dword [value], 0
+			int cc = 0;
+			switch( op )
+			{
+			case asBC_JZ:  cc = CC_E;  break;
+			case asBC_JNZ: cc = CC_NE; break;
+			case asBC_JS:  cc = CC_L;  break;
+			case asBC_JNS: cc = CC_GE; break;
+			case asBC_JP:  cc = CC_G;  break;
+			default:       cc = CC_LE; break;
+			}
+			a.Jcc(cc, target);
+		}
+		return true;
+	case asBC_JEqIi:
+	case asBC_JNeIi:
+	case asBC_JLtIi:
+	case asBC_JGeIi:
+	case asBC_JGtIi:
+	case asBC_JLeIi:
+		{
+			// The offset follows the constant that is compared against
+			int target = JumpTarget(pos, int(size) + asBC_INTARG(instr+1));
+			if( target < 0 )
+				return false;
+			a.OpMem(0, 0x81, -1, false, 7, REG_FP, Var(asBC_SWORDARG0(instr)));
+			a.Dword(asBC_DWORDARG(instr));
+			int cc = 0;
+			switch( op )
+			{
+			case asBC_JEqIi: cc = CC_E;  break;
+			case asBC_JNeIi: cc = CC_NE; break;
+			case asBC_JLtIi: cc = CC_L;  break;
+			case asBC_JGeIi: cc = CC_GE; break;
+			case asBC_JGtIi: cc = CC_G;  break;
+			default:         cc = CC_LE; break;
+			}
+			a.Jcc(cc, target);
+		}
+		return true;
+
+	case asBC_CALL:
+		CallHelper(asPWORD(CallScript), asBC_INTARG(instr), instr + size);
+		JumpToResume();
+		return true;
+	case asBC_RET:
+		CallHelper(asPWORD(ReturnScript), asBC_WORDARG0(instr), instr);
+		JumpToResume();
+		return true;
+	case asBC_CALLSYS:
+		CallHelper(asPWORD(CallSystem), asBC_DWORDARG(instr), instr);
+		a.Load(true, REG_SP, REG_VM, OFS_SP);
+		return true;
+
+	case asBC_SUSPEND:
+		// Let the interpreter handle the suspend if the application requested it
+		a.OpMem(0, 0x80, -1, false, 7, REG_VM, OFS_SUSP); a.Byte(0);  // cmp byte [doProcessSuspend], 0
+		a.Jcc(CC_NE, ExitLabel(instr));
+		return true;
+
+	//--------------
+	// Tests
+	case asBC_TZ:  TestResult(CC_E);  return true;
+	case asBC_TNZ: TestResult(CC_NE); return true;
+	case asBC_TS:  TestResult(CC_L);  return true;
+	case asBC_TNS: TestResult(CC_GE); return true;
+	case asBC_TP:  TestResult(CC_G);  return true;
+	case asBC_TNP: TestResult(CC_LE); return true;
+
+	case asBC_NOT:
+		a.OpMem(0, 0x80, -1, false, 7, REG_FP, Var(asBC_SWORDARG0(instr))); a.Byte(0);
+		a.Setcc(CC_E, RAX);
+		a.OpReg(0, 0x0F, 0xB6, false, RAX, RAX);
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_ClrHi:
+		a.OpMem(0, 0x0F, 0xB6, false, RAX, REG_VM, OFS_VAL);  // movzx eax, byte [value]
+		a.Store(false, REG_VM, OFS_VAL, RAX);
+		return true;
+
+	//--------------
+	// Comparisons
+	case asBC_CMPi:
+	case asBC_CMPu:
+	case asBC_CMPi64:
+	case asBC_CMPu64:
+	case asBC_CmpPtr:
+		{
+			bool w = op == asBC_CMPi64 || op == asBC_CMPu64 || op == asBC_CmpPtr;
+			a.Load(w, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+			a.AluMem(0x3B, w, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+			CmpResult(op == asBC_CMPi || op == asBC_CMPi64);
+		}
+		return true;
+	case asBC_CMPIi:
+	case asBC_CMPIu:
+		a.OpMem(0, 0x81, -1, false, 7, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.Dword(asBC_DWORDARG(instr));
+		CmpResult(op == asBC_CMPIi);
+		return true;
+	case asBC_CMPf:
+	case asBC_CMPd:
+		{
+			bool dbl = op == asBC_CMPd;
+			a.OpMem(dbl ? 0xF2 : 0xF3, 0x0F, 0x10, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+			a.OpMem(dbl ? 0x66 : 0, 0x0F, 0x2E, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));
+			CmpResultFloat();
+		}
+		return true;
+	case asBC_CMPIf:
+		a.OpMem(0xF3, 0x0F, 0x10, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.MovImm32(RAX, asBC_DWORDARG(instr));
+		a.OpReg(0x66, 0x0F, 0x6E, false, XMM1, RAX);  // movd xmm1, eax
+		a.OpReg(0, 0x0F, 0x2E, false, XMM0, XMM1);    // ucomiss xmm0, xmm1
+		CmpResultFloat();
+		return true;
+
+	//--------------
+	// Variables and registers
+	case asBC_SetV1:
+	case asBC_SetV2:
+	case asBC_SetV4:
+		a.StoreImm(false, REG_FP, Var(asBC_SWORDARG0(instr)), asBC_DWORDARG(instr));
+		return true;
+	case asBC_SetV8:
+		a.MovImm64(RAX, asBC_QWORDARG(instr));
+		a.Store(true, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_CpyVtoV4:
+	case asBC_CpyVtoV8:
+		a.Load(op == asBC_CpyVtoV8, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.Store(op == asBC_CpyVtoV8, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_CpyVtoR4:
+	case asBC_CpyVtoR8:
+		a.Load(op == asBC_CpyVtoR8, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.Store(op == asBC_CpyVtoR8, REG_VM, OFS_VAL, RAX);
+		return true;
+	case asBC_CpyRtoV4:
+	case asBC_CpyRtoV8:
+		a.Load(op == asBC_CpyRtoV8, RAX, REG_VM, OFS_VAL);
+		a.Store(op == asBC_CpyRtoV8, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_CpyVtoG4:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Load(false, RCX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.Store(false, RAX, 0, RCX);
+		return true;
+	case asBC_CpyGtoV4:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Load(false, RCX, RAX, 0);
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RCX);
+		return true;
+	case asBC_LdGRdR4:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Store(true, REG_VM, OFS_VAL, RAX);
+		a.Load(false, RCX, RAX, 0);
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RCX);
+		return true;
+	case asBC_SetG4:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.StoreImm(false, RAX, 0, asBC_DWORDARG(instr + AS_PTR_SIZE));
+		return true;
+	case asBC_LDG:
+		a.MovImm64(RAX, asBC_PTRARG(instr));
+		a.Store(true, REG_VM, OFS_VAL, RAX);
+		return true;
+	case asBC_LDV:
+		a.Lea(RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.Store(true, REG_VM, OFS_VAL, RAX);
+		return true;
+	case asBC_RDR1:
+	case asBC_RDR2:
+	case asBC_RDR4:
+	case asBC_RDR8:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		if( op == asBC_RDR1 )      a.OpMem(0, 0x0F, 0xB6, false, RCX, RAX, 0);  // movzx ecx, byte [rax]
+		else if( op == asBC_RDR2 ) a.OpMem(0, 0x0F, 0xB7, false, RCX, RAX, 0);  // movzx ecx, word [rax]
+		else                       a.Load(op == asBC_RDR8, RCX, RAX, 0);
+		a.Store(op == asBC_RDR8, REG_FP, Var(asBC_SWORDARG0(instr)), RCX);
+		return true;
+	case asBC_WRTV1:
+	case asBC_WRTV2:
+	case asBC_WRTV4:
+	case asBC_WRTV8:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		a.Load(op == asBC_WRTV8, RCX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		if( op == asBC_WRTV1 )      a.OpMem(0, 0x88, -1, false, RCX, RAX, 0);     // mov [rax], cl
+		else if( op == asBC_WRTV2 ) a.OpMem(0x66, 0x89, -1, false, RCX, RAX, 0);  // mov [rax], cx
+		else                        a.Store(op == asBC_WRTV8, RAX, 0, RCX);
+		return true;
+
+	//--------------
+	// Increment and decrement
+	case asBC_IncVi:
+	case asBC_DecVi:
+		a.OpMem(0, 0xFF, -1, false, op == asBC_IncVi ? 0 : 1, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_INCi8:
+	case asBC_DECi8:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		a.OpMem(0, 0xFE, -1, false, op == asBC_INCi8 ? 0 : 1, RAX, 0);
+		return true;
+	case asBC_INCi16:
+	case asBC_DECi16:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		a.OpMem(0x66, 0xFF, -1, false, op == asBC_INCi16 ? 0 : 1, RAX, 0);
+		return true;
+	case asBC_INCi:
+	case asBC_DECi:
+	case asBC_INCi64:
+	case asBC_DECi64:
+		a.Load(true, RAX, REG_VM, OFS_VAL);
+		a.OpMem(0, 0xFF, -1, op == asBC_INCi64 || op == asBC_DECi64, (op == asBC_INCi || op == asBC_INCi64) ? 0 : 1, RAX, 0);
+		return true;
+	case asBC_INCf:
+	case asBC_DECf:
+	case asBC_INCd:
+	case asBC_DECd:
+		{
+			bool dbl = op == asBC_INCd || op == asBC_DECd;
+			int prefix = dbl ? 0xF2 : 0xF3;
+			a.Load(true, RAX, REG_VM, OFS_VAL);
+			if( dbl )
+			{
+				a.MovImm64(RCX, 0x3FF0000000000000ull);             // 1.0
+				a.OpReg(0x66, 0x0F, 0x6E, true, XMM1, RCX);         // movq xmm1, rcx
+			}
+			else
+			{
+				a.MovImm32(RCX, 0x3F800000);                        // 1.0f
+				a.OpReg(0x66, 0x0F, 0x6E, false, XMM1, RCX);        // movd xmm1, ecx
+			}
+			a.OpMem(prefix, 0x0F, 0x10, false, XMM0, RAX, 0);
+			a.OpReg(prefix, 0x0F, (op == asBC_INCf || op == asBC_INCd) ? 0x58 : 0x5C, false, XMM0, XMM1);
+			a.OpMem(prefix, 0x0F, 0x11, false, XMM0, RAX, 0);
+		}
+		return true;
+
+	//--------------
+	// Negation and bits
+	case asBC_NEGi:
+	case asBC_NEGi64:
+		a.OpMem(0, 0xF7, -1, op == asBC_NEGi64, 3, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_NEGf:
+		a.OpMem(0, 0x81, -1, false, 6, REG_FP, Var(asBC_SWORDARG0(instr)));  // xor dword [var], 0x80000000
+		a.Dword(0x80000000);
+		return true;
+	case asBC_NEGd:
+		a.OpMem(0, 0x80, -1, false, 6, REG_FP, Var(asBC_SWORDARG0(instr)) + 7);  // xor byte [var+7], 0x80
+		a.Byte(0x80);
+		return true;
+	case asBC_BNOT:
+	case asBC_BNOT64:
+		a.OpMem(0, 0xF7, -1, op == asBC_BNOT64, 2, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_BAND:   BinOp(false, 0x23, instr); return true;
+	case asBC_BOR:    BinOp(false, 0x0B, instr); return true;
+	case asBC_BXOR:   BinOp(false, 0x33, instr); return true;
+	case asBC_BAND64: BinOp(true,  0x23, instr); return true;
+	case asBC_BOR64:  BinOp(true,  0x0B, instr); return true;
+	case asBC_BXOR64: BinOp(true,  0x33, instr); return true;
+	case asBC_BSLL:   Shift(false, 4, instr); return true;
+	case asBC_BSRL:   Shift(false, 5, instr); return true;
+	case asBC_BSRA:   Shift(false, 7, instr); return true;
+	case asBC_BSLL64: Shift(true,  4, instr); return true;
+	case asBC_BSRL64: Shift(true,  5, instr); return true;
+	case asBC_BSRA64: Shift(true,  7, instr); return true;
+
+	//--------------
+	// Conversions
+	case asBC_iTOf:
+		a.OpMem(0xF3, 0x0F, 0x2A, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));  // cvtsi2ss xmm0, dword [var]
+		a.OpMem(0xF3, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_uTOf:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+		a.OpReg(0xF3, 0x0F, 0x2A, true, XMM0, RAX);                                // cvtsi2ss xmm0, rax
+		a.OpMem(0xF3, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_fTOi:
+	case asBC_fTOu:
+		a.OpMem(0xF3, 0x0F, 0x2C, false, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));  // cvttss2si eax, dword [var]
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_sbTOi:
+	case asBC_swTOi:
+	case asBC_ubTOi:
+	case asBC_uwTOi:
+	case asBC_iTOb:
+	case asBC_iTOw:
+		{
+			int ext = 0xB6;
+			if( op == asBC_sbTOi ) ext = 0xBE;
+			else if( op == asBC_swTOi ) ext = 0xBF;
+			else if( op == asBC_uwTOi || op == asBC_iTOw ) ext = 0xB7;
+			a.OpMem(0, 0x0F, ext, false, RAX, REG_FP, Var(asBC_SWORDARG0(instr)));
+			a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		}
+		return true;
+	case asBC_dTOi:
+	case asBC_dTOu:
+		a.OpMem(0xF2, 0x0F, 0x2C, false, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));  // cvttsd2si eax, qword [var]
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_dTOf:
+		a.OpMem(0xF2, 0x0F, 0x5A, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));  // cvtsd2ss
+		a.OpMem(0xF3, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_fTOd:
+		a.OpMem(0xF3, 0x0F, 0x5A, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));  // cvtss2sd
+		a.OpMem(0xF2, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_iTOd:
+		a.OpMem(0xF2, 0x0F, 0x2A, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));  // cvtsi2sd xmm0, dword [var]
+		a.OpMem(0xF2, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_uTOd:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.OpReg(0xF2, 0x0F, 0x2A, true, XMM0, RAX);                                // cvtsi2sd xmm0, rax
+		a.OpMem(0xF2, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+	case asBC_i64TOi:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_iTOi64:
+		a.OpMem(0, 0x63, -1, true, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));  // movsxd rax, dword [var]
+		a.Store(true, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_uTOi64:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.Store(true, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+
+	//--------------
+	// Math
+	case asBC_ADDi:   BinOp(false, 0x03, instr); return true;
+	case asBC_SUBi:   BinOp(false, 0x2B, instr); return true;
+	case asBC_MULi:   BinOp(false, 0xAF, instr); return true;
+	case asBC_ADDi64: BinOp(true,  0x03, instr); return true;
+	case asBC_SUBi64: BinOp(true,  0x2B, instr); return true;
+	case asBC_MULi64: BinOp(true,  0xAF, instr); return true;
+	case asBC_DIVi:   Div(false, true,  false, instr); return true;
+	case asBC_MODi:   Div(false, true,  true,  instr); return true;
+	case asBC_DIVu:   Div(false, false, false, instr); return true;
+	case asBC_MODu:   Div(false, false, true,  instr); return true;
+	case asBC_DIVi64: Div(true,  true,  false, instr); return true;
+	case asBC_MODi64: Div(true,  true,  true,  instr); return true;
+	case asBC_DIVu64: Div(true,  false, false, instr); return true;
+	case asBC_MODu64: Div(true,  false, true,  instr); return true;
+	case asBC_ADDf:   FloatOp(false, 0x58, instr); return true;
+	case asBC_SUBf:   FloatOp(false, 0x5C, instr); return true;
+	case asBC_MULf:   FloatOp(false, 0x59, instr); return true;
+	case asBC_DIVf:   FloatOp(false, 0x5E, instr); return true;
+	case asBC_ADDd:   FloatOp(true,  0x58, instr); return true;
+	case asBC_SUBd:   FloatOp(true,  0x5C, instr); return true;
+	case asBC_MULd:   FloatOp(true,  0x59, instr); return true;
+	case asBC_DIVd:   FloatOp(true,  0x5E, instr); return true;
+
+	case asBC_ADDIi:
+	case asBC_SUBIi:
+	case asBC_MULIi:
+		a.Load(false, RAX, REG_FP, Var(asBC_SWORDARG1(instr)));
+		if( op == asBC_MULIi )
+		{
+			a.OpReg(0, 0x69, -1, false, RAX, RAX);  // imul eax, eax, imm32
+			a.Dword(asBC_DWORDARG(instr+1));
+		}
+		else
+			a.AluImm(op == asBC_ADDIi ? 0 : 5, false, RAX, asBC_DWORDARG(instr+1));
+		a.Store(false, REG_FP, Var(asBC_SWORDARG0(instr)), RAX);
+		return true;
+	case asBC_ADDIf:
+	case asBC_SUBIf:
+	case asBC_MULIf:
+		a.OpMem(0xF3, 0x0F, 0x10, false, XMM0, REG_FP, Var(asBC_SWORDARG1(instr)));
+		a.MovImm32(RAX, asBC_DWORDARG(instr+1));
+		a.OpReg(0x66, 0x0F, 0x6E, false, XMM1, RAX);  // movd xmm1, eax
+		a.OpReg(0xF3, 0x0F, op == asBC_ADDIf ? 0x58 : op == asBC_SUBIf ? 0x5C : 0x59, false, XMM0, XMM1);
+		a.OpMem(0xF3, 0x0F, 0x11, false, XMM0, REG_FP, Var(asBC_SWORDARG0(instr)));
+		return true;
+
+	default:
+		// Everything else, e.g. object handling, is left for the interpreter
+		return false;
+	}
+}
+
+void *AllocExecutableMemory(size_t size)
+{
+#if defined(_WIN32)
+	return VirtualAlloc(0, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+	void *mem = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return mem == MAP_FAILED ? 0 : mem;
+#endif
+}
+
+bool ProtectExecutableMemory(void *mem, size_t size)
+{
+#if defined(_WIN32)
+	DWORD old;
+	return VirtualProtect(mem, size, PAGE_EXECUTE_READ, &old) != 0;
+#else
+	return mprotect(mem, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+void FreeExecutableMemory(void *mem, size_t size)
+{
+#if defined(_WIN32)
+	(void)size;
+	VirtualFree(mem, 0, MEM_RELEASE);
+#else
+	munmap(mem, size);
+#endif
+}
+
+} // namespace
+
+#endif // SCRIPTJIT_X64
+
+CScriptJIT::CScriptJIT()
+{
+	m_enabledByDefault = true;
+}
+
+CScriptJIT::~CScriptJIT()
+{
+}
+
+void CScriptJIT::SetEnabledByDefault(bool enable)
+{
+	m_enabledByDefault = enable;
+}
+
+bool CScriptJIT::GetEnabledByDefault() const
+{
+	return m_enabledByDefault;
+}
+
+bool CScriptJIT::IsSupported()
+{
+#ifdef SCRIPTJIT_X64
+	return true;
+#else
+	return false;
+#endif
+}
+
+int CScriptJIT::EnableFunction(asIScriptFunction *func, bool enable)
+{
+	if( func == 0 || func->GetFuncType() != asFUNC_SCRIPT )
+		return asINVALID_ARG;
+
+	if( !enable )
+		return func->SetJITFunction(0);
+
+	if( func->GetJITFunction() )
+		return asSUCCESS;
+
+	asJITFunction jitFunc = 0;
+	int r = Compile(func, &jitFunc);
+	if( r < 0 )
+		return r;
+
+	return func->SetJITFunction(jitFunc);
+}
+
+void CScriptJIT::NewFunction(asIScriptFunction *func)
+{
+	if( m_enabledByDefault )
+		EnableFunction(func, true);
+}
+
+void CScriptJIT::CleanFunction(asIScriptFunction *func, asJITFunction jitFunc)
+{
+	(void)func;
+#ifdef SCRIPTJIT_X64
+	if( jitFunc )
+	{
+		asBYTE *mem = reinterpret_cast<asBYTE*>(jitFunc) - CODE_HEADER_SIZE;
+		FreeExecutableMemory(mem, *reinterpret_cast<size_t*>(mem));
+	}
+#else
+	(void)jitFunc;
+#endif
+}
+
+int CScriptJIT::Compile(asIScriptFunction *func, asJITFunction *output)
+{
+#ifdef SCRIPTJIT_X64
+	asUINT length = 0;
+	asDWORD *byteCode = func->GetByteCode(&length);
+	if( byteCode == 0 || length == 0 )
+		return asNOT_SUPPORTED;
+
+	CTranslator t(byteCode, length);
+	if( !t.Translate() )
+		return asERROR;
+
+	// Without JitEntry instructions the interpreter will never invoke the native code
+	if( t.jitEntries.size() == 0 )
+		return asNOT_SUPPORTED;
+
+	size_t size = CODE_HEADER_SIZE + t.a.code.size();
+	asBYTE *mem = reinterpret_cast<asBYTE*>(AllocExecutableMemory(size));
+	if( mem == 0 )
+		return asOUT_OF_MEMORY;
+
+	*reinterpret_cast<size_t*>(mem) = size;
+	*reinterpret_cast<asQWORD*>(mem + 8) = CODE_TAG;
+	asBYTE *code = mem + CODE_HEADER_SIZE;
+	memcpy(code, &t.a.code[0], t.a.code.size());
+	if( !ProtectExecutableMemory(mem, size) )
+	{
+		FreeExecutableMemory(mem, size);
+		return asERROR;
+	}
+
+	// Tell the interpreter where in the native code each JitEntry resumes
+	for( size_t n = 0; n < t.jitEntries.size(); n++ )
+	{
+		asUINT pos = t.jitEntries[n];
+		asBC_PTRARG(&byteCode[pos]) = asPWORD(code + t.a.Offset(t.labelAt[pos]));
+	}
+
+	*output = reinterpret_cast<asJITFunction>(code);
+	return asSUCCESS;
+#else
+	(void)func;
+	(void)output;
+	return asNOT_SUPPORTED;
+#endif
+}
+
+END_AS_NAMESPACE
@@ -0,0 +1,72 @@
+#ifndef SCRIPTJIT_H
+#define SCRIPTJIT_H
+
+// The script JIT translates the most common bytecode instructions to native
+// x86-64 machine code. Any instruction it doesn't handle is left for the
+// interpreter, so the compiled functions always behave exactly like the
+// bytecode. Control returns to the JIT at the next JitEntry instruction,
+// i.e. at the start of functions, after calls, and in loops.
+//
+// Calls between compiled script functions, and calls to registered
+// functions, are made directly from the native code. For this the JIT
+// accesses the internals of the library, so it must be compiled with
+// the same configuration as the library itself.
+//
+// Usage:
+//
+//  CScriptJIT jit;
+//  engine->SetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS, true);
+//  engine->SetEngineProperty(asEP_JIT_INTERFACE_VERSION, 2);
+//  engine->SetJITCompiler(&jit);
+//
+// The engine properties must be set before the scripts are built or loaded.
+// The JIT object must outlive the engine, as the engine will call it to
+// release the native code when the functions are destroyed.
+//
+// On platforms other than x86-64 the JIT is a no-op and all functions are
+// executed by the interpreter.
+
+#ifndef ANGELSCRIPT_H
+// Avoid having to inform include path if header is already include before
+#include <angelscript.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define SCRIPTJIT_X64
+#endif
+
+BEGIN_AS_NAMESPACE
+
+class CScriptJIT : public asIJITCompilerV2
+{
+public:
+	CScriptJIT();
+	virtual ~CScriptJIT();
+
+	// Determines if new functions are compiled automatically as they are
+	// built or loaded. Default is true. When false, the application must
+	// enable each function it wants compiled with EnableFunction.
+	void SetEnabledByDefault(bool enable);
+	bool GetEnabledByDefault() const;
+
+	// Compile, or release the native code of, a single script function.
+	// Returns asNOT_SUPPORTED if there is no native code generator for the
+	// platform, or if the function has no JitEntry instructions.
+	int  EnableFunction(asIScriptFunction *func, bool enable);
+
+	// Returns true if the platform has a native code generator
+	static bool IsSupported();
+
+	// asIJITCompilerV2
+	virtual void NewFunction(asIScriptFunction *func);
+	virtual void CleanFunction(asIScriptFunction *func, asJITFunction jitFunc);
+
+protected:
+	int Compile(asIScriptFunction *func, asJITFunction *output);
+
+	bool m_enabledByDefault;
+};
+
+END_AS_NAMESPACE
+
+#endif
@@ -0,0 +1,319 @@
+#include "scriptprofiler.h"
+#include <stdio.h>   // snprintf
+#include <algorithm> // sort
+#include <chrono>
+
+using namespace std;
+
+BEGIN_AS_NAMESPACE
+
+CScriptProfiler::CScriptProfiler()
+{
+	m_interval    = 1000;
+	m_sampleCount = 0;
+	m_root        = new SNode(0);
+	m_running     = false;
+}
+
+CScriptProfiler::~CScriptProfiler()
+{
+	Stop();
+
+	while( m_contexts.size() )
+		DetachContext(m_contexts.back());
+
+	Reset();
+	delete m_root;
+}
+
+void CScriptProfiler::SetInterval(asUINT microseconds)
+{
+	lock_guard<mutex> guard(m_lock);
+	m_interval = microseconds > 0 ? microseconds : 1;
+}
+
+asUINT CScriptProfiler::GetInterval() const
+{
+	return m_interval;
+}
+
+int CScriptProfiler::AttachContext(asIScriptContext *ctx)
+{
+	if( ctx == 0 )
+		return asINVALID_ARG;
+
+	int r = ctx->SetSampleCallback(asMETHOD(CScriptProfiler, SampleCallback), this, asCALL_THISCALL);
+	if( r < 0 )
+		return r;
+
+	// Hold a reference so the timer thread never sees a destroyed context
+	lock_guard<mutex> guard(m_lock);
+	ctx->AddRef();
+	m_contexts.push_back(ctx);
+
+	return 0;
+}
+
+void CScriptProfiler::DetachContext(asIScriptContext *ctx)
+{
+	lock_guard<mutex> guard(m_lock);
+	for( size_t n = 0; n < m_contexts.size(); n++ )
+	{
+		if( m_contexts[n] == ctx )
+		{
+			ctx->ClearSampleCallback();
+			ctx->Release();
+			m_contexts.erase(m_contexts.begin() + n);
+			break;
+		}
+	}
+}
+
+int CScriptProfiler::Start()
+{
+	lock_guard<mutex> guard(m_lock);
+	if( m_running )
+		return asERROR;
+
+	m_running = true;
+	m_thread = thread(&CScriptProfiler::TimerThread, this);
+
+	return 0;
+}
+
+void CScriptProfiler::Stop()
+{
+	{
+		lock_guard<mutex> guard(m_lock);
+		if( !m_running )
+			return;
+		m_running = false;
+	}
+
+	m_wakeUp.notify_all();
+	m_thread.join();
+}
+
+void CScriptProfiler::TimerThread()
+{
+	unique_lock<mutex> guard(m_lock);
+	while( m_running )
+	{
+		m_wakeUp.wait_for(guard, chrono::microseconds(m_interval));
+		if( !m_running )
+			break;
+
+		// Contexts that are not executing would take the sample
+		// when resumed, and attribute the idle time to the script
+		for( size_t n = 0; n < m_contexts.size(); n++ )
+			if( m_contexts[n]->GetState() == asEXECUTION_ACTIVE )
+				m_contexts[n]->RequestSample();
+	}
+}
+
+void CScriptProfiler::Reset()
+{
+	lock_guard<mutex> guard(m_lock);
+	for( size_t n = 0; n < m_root->children.size(); n++ )
+		DeleteNode(m_root->children[n]);
+	m_root->children.clear();
+	m_root->inclusive = 0;
+	m_functions.clear();
+	m_sampleCount = 0;
+}
+
+void CScriptProfiler::DeleteNode(SNode *node)
+{
+	for( size_t n = 0; n < node->children.size(); n++ )
+		DeleteNode(node->children[n]);
+	node->func->Release();
+	delete node;
+}
+
+asUINT CScriptProfiler::GetSampleCount() const
+{
+	lock_guard<mutex> guard(m_lock);
+	return m_sampleCount;
+}
+
+CScriptProfiler::SNode *CScriptProfiler::GetChild(SNode *node, asIScriptFunction *func)
+{
+	for( size_t n = 0; n < node->children.size(); n++ )
+		if( node->children[n]->func == func )
+			return node->children[n];
+
+	func->AddRef();
+	SNode *child = new SNode(func);
+	node->children.push_back(child);
+	return child;
+}
+
+void CScriptProfiler::SampleCallback(asIScriptContext *ctx)
+{
+	lock_guard<mutex> guard(m_lock);
+
+	m_sampleCount++;
+	m_root->inclusive++;
+
+	// Walk the call stack from the outermost function to the current one
+	SNode *node = m_root;
+	m_stack.clear();
+	for( asUINT n = ctx->GetCallstackSize(); n-- > 0; )
+	{
+		// Nested calls have a marker without a function in the call stack
+		asIScriptFunction *func = ctx->GetFunction(n);
+		if( func == 0 )
+			continue;
+
+		node = GetChild(node, func);
+		node->inclusive++;
+		node->lines[ctx->GetLineNumber(n)]++;
+
+		// Recursive functions must only be counted once per sample
+		if( find(m_stack.begin(), m_stack.end(), func) == m_stack.end() )
+		{
+			m_stack.push_back(func);
+			m_functions[func].inclusive++;
+		}
+	}
+
+	node->exclusive++;
+	if( node->func )
+		m_functions[node->func].exclusive++;
+}
+
+void CScriptProfiler::WriteCollapsed(string &out, const SNode *node, const string &stack) const
+{
+	string frames = stack;
+	if( node->func )
+	{
+		if( frames.size() )
+			frames += ";";
+		frames += node->func->GetDeclaration(true, true);
+	}
+
+	if( node->exclusive )
+	{
+		char buf[20];
+		snprintf(buf, sizeof(buf), " %u\n", node->exclusive);
+		out += frames;
+		out += buf;
+	}
+
+	for( size_t n = 0; n < node->children.size(); n++ )
+		WriteCollapsed(out, node->children[n], frames);
+}
+
+string CScriptProfiler::GetCollapsedStacks() const
+{
+	lock_guard<mutex> guard(m_lock);
+
+	string out;
+	WriteCollapsed(out, m_root, "");
+	return out;
+}
+
+static void WriteJSONString(string &out, const char *str)
+{
+	out += "\"";
+	for( ; str && *str; str++ )
+	{
+		unsigned char c = (unsigned char)*str;
+		if( c == '"' || c == '\\' )
+		{
+			out += '\\';
+			out += (char)c;
+		}
+		else if( c < 0x20 )
+		{
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			out += buf;
+		}
+		else
+			out += (char)c;
+	}
+	out += "\"";
+}
+
+void CScriptProfiler::WriteJSON(string &out, const SNode *node) const
+{
+	char buf[100];
+
+	out += "{\"name\":";
+	if( node->func )
+	{
+		const char *section = 0;
+		node->func->GetDeclaredAt(&section, 0, 0);
+
+		WriteJSONString(out, node->func->GetDeclaration(true, true));
+		out += ",\"section\":";
+		WriteJSONString(out, section);
+	}
+	else
+		out += "\"<root>\"";
+
+	snprintf(buf, sizeof(buf), ",\"inclusive\":%u,\"exclusive\":%u,\"lines\":[", node->inclusive, node->exclusive);
+	out += buf;
+	for( map<int, asUINT>::const_iterator it = node->lines.begin(); it != node->lines.end(); ++it )
+	{
+		snprintf(buf, sizeof(buf), "%s[%d,%u]", it == node->lines.begin() ? "" : ",", it->first, it->second);
+		out += buf;
+	}
+
+	out += "],\"children\":[";
+	for( size_t n = 0; n < node->children.size(); n++ )
+	{
+		if( n )
+			out += ",";
+		WriteJSON(out, node->children[n]);
+	}
+	out += "]}";
+}
+
+string CScriptProfiler::GetJSON() const
+{
+	lock_guard<mutex> guard(m_lock);
+
+	char buf[100];
+	snprintf(buf, sizeof(buf), "{\"interval\":%u,\"samples\":%u,\"root\":", m_interval, m_sampleCount);
+
+	string out = buf;
+	WriteJSON(out, m_root);
+	out += "}\n";
+	return out;
+}
+
+static bool CompareExclusive(const pair<asIScriptFunction*, asUINT> &a, const pair<asIScriptFunction*, asUINT> &b)
+{
+	return a.second > b.second;
+}
+
+string CScriptProfiler::GetReport(asUINT maxFunctions) const
+{
+	lock_guard<mutex> guard(m_lock);
+
+	vector<pair<asIScriptFunction*, asUINT> > funcs;
+	for( map<asIScriptFunction*, SFunctionStats>::const_iterator it = m_functions.begin(); it != m_functions.end(); ++it )
+		funcs.push_back(make_pair(it->first, it->second.exclusive));
+	sort(funcs.begin(), funcs.end(), CompareExclusive);
+
+	char buf[100];
+	snprintf(buf, sizeof(buf), "Samples: %u (interval %u us)\n", m_sampleCount, m_interval);
+	string out = buf;
+	out += "   Excl  Excl%    Incl  Incl%  Function\n";
+
+	double total = m_sampleCount ? m_sampleCount : 1;
+	for( size_t n = 0; n < funcs.size() && n < maxFunctions; n++ )
+	{
+		const SFunctionStats &stats = m_functions.find(funcs[n].first)->second;
+		snprintf(buf, sizeof(buf), "%7u %5.1f%% %7u %5.1f%%  ", stats.exclusive, 100 * stats.exclusive / total, stats.inclusive, 100 * stats.inclusive / total);
+		out += buf;
+		out += funcs[n].first->GetDeclaration(true, true);
+		out += "\n";
+	}
+
+	return out;
+}
+
+END_AS_NAMESPACE
@@ -0,0 +1,117 @@
+#ifndef SCRIPTPROFILER_H
+#define SCRIPTPROFILER_H
+
+// The script profiler periodically samples the call stack of the contexts
+// it is attached to, and aggregates the samples in a call tree with the
+// number of samples in each function and on each line.
+//
+// A timer thread requests the samples with asIScriptContext::RequestSample,
+// and the contexts take them at the next line, function entry, or return
+// from a registered function. Unlike the line and function callbacks the
+// script runs at full speed in between the samples.
+//
+// Usage:
+//
+//  CScriptProfiler profiler;
+//  profiler.AttachContext(ctx);
+//  profiler.Start();
+//  ctx->Execute();
+//  profiler.Stop();
+//  profiler.DetachContext(ctx);
+//  std::string flamegraph = profiler.GetCollapsedStacks();
+//
+// The profiler holds references to the functions in the call tree, so it
+// must be reset or destroyed before the engine is shut down.
+
+#ifndef ANGELSCRIPT_H
+// Avoid having to inform include path if header is already include before
+#include <angelscript.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+BEGIN_AS_NAMESPACE
+
+class CScriptProfiler
+{
+public:
+	CScriptProfiler();
+	virtual ~CScriptProfiler();
+
+	// The time between the samples in microseconds. Default is 1000
+	void        SetInterval(asUINT microseconds);
+	asUINT      GetInterval() const;
+
+	// Set or remove the sample callback on the context. A context can
+	// only be attached to one profiler at a time
+	int         AttachContext(asIScriptContext *ctx);
+	void        DetachContext(asIScriptContext *ctx);
+
+	// Start and stop the timer thread that requests the samples
+	int         Start();
+	void        Stop();
+
+	// Discard all samples and release the functions held by the call tree
+	void        Reset();
+
+	asUINT      GetSampleCount() const;
+
+	// Returns one line per call stack with the number of samples taken in it, e.g.
+	// "void main();void update() 42". This is the input expected by flamegraph.pl
+	std::string GetCollapsedStacks() const;
+
+	// Returns the call tree with inclusive and exclusive samples per function,
+	// and the samples per line, in JSON format
+	std::string GetJSON() const;
+
+	// Returns a table of the functions with the most exclusive samples
+	std::string GetReport(asUINT maxFunctions = 20) const;
+
+	// Sample callback invoked by the context
+	void        SampleCallback(asIScriptContext *ctx);
+
+protected:
+	struct SNode
+	{
+		SNode(asIScriptFunction *f) : func(f), inclusive(0), exclusive(0) {}
+		asIScriptFunction           *func;
+		asUINT                       inclusive;
+		asUINT                       exclusive;
+		std::map<int, asUINT>        lines;
+		std::vector<SNode*>          children;
+	};
+
+	struct SFunctionStats
+	{
+		SFunctionStats() : inclusive(0), exclusive(0) {}
+		asUINT inclusive;
+		asUINT exclusive;
+	};
+
+	void        TimerThread();
+	SNode      *GetChild(SNode *node, asIScriptFunction *func);
+	void        DeleteNode(SNode *node);
+	void        WriteCollapsed(std::string &out, const SNode *node, const std::string &stack) const;
+	void        WriteJSON(std::string &out, const SNode *node) const;
+
+	asUINT                                        m_interval;
+	asUINT                                        m_sampleCount;
+	SNode                                        *m_root;
+	std::map<asIScriptFunction*, SFunctionStats>  m_functions;
+	std::vector<asIScriptFunction*>               m_stack;
+
+	std::vector<asIScriptContext*>                m_contexts;
+	std::thread                                   m_thread;
+	bool                                          m_running;
+	mutable std::mutex                            m_lock;
+	std::condition_variable                       m_wakeUp;
+};
+
+END_AS_NAMESPACE
+
+#endif
@@ -8,6 +8,11 @@
 	#include <locale.h> // setlocale()
 #endif
 #include <regex>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
 
 
 using namespace std;
@@ -16,48 +21,78 @@ using namespace std;
 // Usually where the variables are only used in debug mode.
 #define UNUSED_VAR(x) (void)(x)
 
-#ifdef AS_CAN_USE_CPP11
-// The string factory doesn't need to keep a specific order in the
-// cache, so the unordered_map is faster than the ordinary map
-#include <unordered_map>  // std::unordered_map
 BEGIN_AS_NAMESPACE
-typedef unordered_map<string, int> map_t;
-END_AS_NAMESPACE
-#else
-#include <map>      // std::map
-BEGIN_AS_NAMESPACE
-typedef map<string, int> map_t;
-END_AS_NAMESPACE
-#endif
 
-BEGIN_AS_NAMESPACE
+// The string constants are interned in a hash table that is split in shards,
+// each with its own lock, so that modules can be built or loaded in parallel
+// threads without all of them waiting for the same mutex. The lookup is done
+// directly on the raw string data, so no temporary string is created. The
+// locks are created by the engine rather than with std::mutex, so they follow
+// the library's thread configuration and do nothing when built with AS_NO_THREADS.
 class CStdStringFactory : public asIStringFactory
 {
 public:
-	CStdStringFactory() {}
+	CStdStringFactory()
+	{
+		for( asUINT n = 0; n < NUM_SHARDS; n++ )
+		{
+			shards[n].lock = asCreateLockableSharedBool();
+			shards[n].count = 0;
+			shards[n].buckets.resize(16, 0);
+		}
+	}
 	~CStdStringFactory() 
 	{
 		// The script engine must release each string 
 		// constant that it has requested
-		assert(stringCache.size() == 0);
+		assert(IsEmpty());
+
+		for( asUINT n = 0; n < NUM_SHARDS; n++ )
+		{
+			for( size_t b = 0; b < shards[n].buckets.size(); b++ )
+			{
+				SEntry *entry = shards[n].buckets[b];
+				while( entry )
+				{
+					SEntry *next = entry->next;
+					delete entry;
+					entry = next;
+				}
+			}
+			shards[n].lock->Release();
+		}
 	}
 
 	const void *GetStringConstant(const char *data, asUINT length)
 	{
-		// The string factory might be modified from multiple 
-		// threads, so it is necessary to use a mutex.
-		asAcquireExclusiveLock();
-		
-		string str(data, length);
-		map_t::iterator it = stringCache.find(str);
-		if (it != stringCache.end())
-			it->second++;
+		asUINT hash = Hash(data, length);
+		SShard &shard = shards[hash % NUM_SHARDS];
+
+		shard.lock->Lock();
+
+		SEntry **bucket = &shard.buckets[(hash / NUM_SHARDS) & (shard.buckets.size() - 1)];
+		SEntry *entry = *bucket;
+		while( entry )
+		{
+			if( entry->hash == hash && entry->str.length() == length && memcmp(entry->str.c_str(), data, length) == 0 )
+				break;
+			entry = entry->next;
+		}
+
+		if( entry )
+			entry->refCount++;
 		else
-			it = stringCache.insert(map_t::value_type(str, 1)).first;
+		{
+			entry = new SEntry(data, length, hash);
+			entry->next = *bucket;
+			*bucket = entry;
+			if( ++shard.count > shard.buckets.size() )
+				Grow(shard);
+		}
 
-		asReleaseExclusiveLock();
-		
-		return reinterpret_cast<const void*>(&it->first);
+		shard.lock->Unlock();
+
+		return reinterpret_cast<const void*>(&entry->str);
 	}
 
 	int  ReleaseStringConstant(const void *str)
@@ -65,24 +100,35 @@ public:
 		if (str == 0)
 			return asERROR;
 
-		int ret = asSUCCESS;
-		
-		// The string factory might be modified from multiple 
-		// threads, so it is necessary to use a mutex.
-		asAcquireExclusiveLock();
-		
-		map_t::iterator it = stringCache.find(*reinterpret_cast<const string*>(str));
-		if (it == stringCache.end())
-			ret = asERROR;
-		else
+		int ret = asERROR;
+
+		const string *s = reinterpret_cast<const string*>(str);
+		asUINT hash = Hash(s->c_str(), asUINT(s->length()));
+		SShard &shard = shards[hash % NUM_SHARDS];
+
+		shard.lock->Lock();
+
+		// The string is identified by its address
+		SEntry **link = &shard.buckets[(hash / NUM_SHARDS) & (shard.buckets.size() - 1)];
+		while( *link )
 		{
-			it->second--;
-			if (it->second == 0)
-				stringCache.erase(it);
+			SEntry *entry = *link;
+			if( &entry->str == s )
+			{
+				ret = asSUCCESS;
+				if( --entry->refCount == 0 )
+				{
+					*link = entry->next;
+					shard.count--;
+					delete entry;
+				}
+				break;
+			}
+			link = &entry->next;
 		}
-		
-		asReleaseExclusiveLock();
-		
+
+		shard.lock->Unlock();
+
 		return ret;
 	}
 
@@ -100,8 +146,65 @@ public:
 		return asSUCCESS;
 	}
 
-	// THe access to the string cache is protected with the common mutex provided by AngelScript
-	map_t stringCache;
+	bool IsEmpty() const
+	{
+		for( asUINT n = 0; n < NUM_SHARDS; n++ )
+			if( shards[n].count )
+				return false;
+		return true;
+	}
+
+protected:
+	enum { NUM_SHARDS = 16 };
+
+	struct SEntry
+	{
+		SEntry(const char *data, asUINT length, asUINT hash) : str(data, length), refCount(1), hash(hash), next(0) {}
+		string  str;
+		int     refCount;
+		asUINT  hash;
+		SEntry *next;
+	};
+
+	struct SShard
+	{
+		asILockableSharedBool *lock;
+		size_t                 count;
+		vector<SEntry*>        buckets; // the size is always a power of 2
+	};
+
+	static asUINT Hash(const char *data, asUINT length)
+	{
+		// FNV-1a
+		asUINT hash = 2166136261u;
+		for( asUINT n = 0; n < length; n++ )
+		{
+			hash ^= asBYTE(data[n]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	// Must be called with the shard locked
+	static void Grow(SShard &shard)
+	{
+		vector<SEntry*> buckets(shard.buckets.size() * 2, 0);
+		for( size_t b = 0; b < shard.buckets.size(); b++ )
+		{
+			SEntry *entry = shard.buckets[b];
+			while( entry )
+			{
+				SEntry *next = entry->next;
+				SEntry **bucket = &buckets[(entry->hash / NUM_SHARDS) & (buckets.size() - 1)];
+				entry->next = *bucket;
+				*bucket = entry;
+				entry = next;
+			}
+		}
+		shard.buckets.swap(buckets);
+	}
+
+	SShard shards[NUM_SHARDS];
 };
 
 static CStdStringFactory *stringFactory = 0;
@@ -139,7 +242,7 @@ public:
 			// the application might crash. Not deleting the cache would
 			// lead to a memory leak, but since this is only happens when the
 			// application is shutting down anyway, it is not important.
-			if (stringFactory->stringCache.empty())
+			if (stringFactory->IsEmpty())
 			{
 				delete stringFactory;
 				stringFactory = 0;
@@ -376,6 +479,78 @@ static int StringFindFirst(const string &sub, asUINT start, const string &str)
 	return (int)str.find(sub, (size_t)(start < 0 ? string::npos : start));
 }
 
+// Compiling a regular expression usually costs much more than the search
+// itself, so the most recently used patterns are kept in a bounded cache.
+// The compiled patterns are shared, so the cache can be used from multiple
+// contexts at the same time.
+class CRegexCache
+{
+public:
+	typedef std::shared_ptr<const std::regex> regex_ptr;
+
+	CRegexCache() : capacity(64) {}
+
+	// Returns null if the pattern is not a valid regular expression
+	regex_ptr Get(const string &pattern, std::regex_constants::syntax_option_type flags)
+	{
+		// The key holds the flags followed by the pattern
+		string key(reinterpret_cast<const char*>(&flags), sizeof(flags));
+		key += pattern;
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			map_t::iterator it = index.find(key);
+			if( it != index.end() )
+			{
+				// Move the entry to the front of the list
+				entries.splice(entries.begin(), entries, it->second);
+				return it->second->second;
+			}
+		}
+
+		// Compile the pattern without holding the lock
+		regex_ptr rex;
+		try
+		{
+			rex = std::make_shared<const std::regex>(pattern, flags);
+		}
+		catch( const std::regex_error & )
+		{
+			return regex_ptr();
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		map_t::iterator it = index.find(key);
+		if( it != index.end() )
+		{
+			// Another thread compiled the same pattern in the meantime
+			entries.splice(entries.begin(), entries, it->second);
+			return it->second->second;
+		}
+
+		entries.push_front(entry_t(key, rex));
+		index[key] = entries.begin();
+		if( entries.size() > capacity )
+		{
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+
+		return rex;
+	}
+
+protected:
+	typedef std::pair<string, regex_ptr> entry_t;
+	typedef std::unordered_map<string, std::list<entry_t>::iterator> map_t;
+
+	size_t                capacity;
+	std::mutex            lock;
+	std::list<entry_t>    entries; // Most recently used first
+	map_t                 index;
+};
+
+static CRegexCache regexCache;
+
 // This function returns the index of the first position that matches the regular expression
 //
 // AngelScript signature:
@@ -407,9 +582,18 @@ static int StringRegexFind(const string& rex, asUINT start, asUINT& outLengthOfM
 	// I've tried setting the manifest to use utf8 code page but it also doesn't work with MSVC
 	// https://learn.microsoft.com/en-us/windows/apps/design/globalizing/use-utf8-code-page
 
-	std::regex pattern(rex, std::regex_constants::ECMAScript | std::regex_constants::collate);
+	CRegexCache::regex_ptr pattern = regexCache.Get(rex, std::regex_constants::ECMAScript | std::regex_constants::collate);
+	if( !pattern )
+	{
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Invalid regular expression");
+		outLengthOfMatch = 0;
+		return -1;
+	}
+
 	std::cmatch match;
-	bool result = std::regex_search(str.c_str() + start, str.c_str()+str.length(), match, pattern);
+	bool result = std::regex_search(str.c_str() + start, str.c_str()+str.length(), match, *pattern);
 
 	if (!result)
 	{
@@ -418,7 +602,7 @@ static int StringRegexFind(const string& rex, asUINT start, asUINT& outLengthOfM
 	}
 
 	outLengthOfMatch = (asUINT)match[0].length();
-	return (int)match.prefix().length();
+	return (int)(start + match.prefix().length());
 }
 
 // This function returns the index of the first position where the one of the bytes in substring
@@ -3,6 +3,8 @@
 #include "../scriptarray/scriptarray.h"
 #include <stdio.h>
 #include <string.h>
+#include <new>
+#include <regex>
 
 using namespace std;
 
@@ -109,6 +111,167 @@ static void StringJoin_Generic(asIScriptGeneric *gen)
 	new(gen->GetAddressOfReturnLocation()) string(StringJoin(*array, *delim));
 }
 
+// The regex type holds a compiled regular expression, so scripts that use the
+// same pattern many times, e.g. in a loop, don't have to compile it each time.
+// Example:
+//
+// regex rex('[0-9]+');
+// array<string>@ parts = rex.split("a1b22c");
+//
+// The regular expressions use the ECMAScript syntax.
+class CScriptRegex
+{
+public:
+	CScriptRegex(const string &pattern) : refCount(1), rex(pattern, std::regex_constants::ECMAScript | std::regex_constants::collate) {}
+
+	void AddRef() const
+	{
+		asAtomicInc(refCount);
+	}
+
+	void Release() const
+	{
+		if( asAtomicDec(refCount) == 0 )
+		{
+			this->~CScriptRegex();
+			asFreeMem(const_cast<CScriptRegex*>(this));
+		}
+	}
+
+	// Returns the position of the first match at or after start, or -1
+	int Find(const string &str, asUINT start, asUINT &outLengthOfMatch) const
+	{
+		std::cmatch match;
+		if( start >= str.length() || !std::regex_search(str.c_str() + start, str.c_str() + str.length(), match, rex) )
+		{
+			outLengthOfMatch = 0;
+			return -1;
+		}
+
+		outLengthOfMatch = (asUINT)match[0].length();
+		return int(start + match.prefix().length());
+	}
+
+	// Returns true if the whole string matches the expression
+	bool Match(const string &str) const
+	{
+		return std::regex_match(str, rex);
+	}
+
+	// Replaces all the matches. The format can refer to the sub matches with $n
+	string Replace(const string &str, const string &fmt) const
+	{
+		return std::regex_replace(str, rex, fmt);
+	}
+
+	// Splits the string where the expression matches, in the same way string::split does
+	CScriptArray *Split(const string &str) const
+	{
+		asIScriptContext *ctx = asGetActiveContext();
+		asITypeInfo *arrayType = ctx->GetEngine()->GetTypeInfoByDecl("array<string>");
+		CScriptArray *array = CScriptArray::Create(arrayType);
+
+		size_t prev = 0;
+		std::cregex_iterator it(str.c_str(), str.c_str() + str.length(), rex), end;
+		for( ; it != end; ++it )
+		{
+			// Empty matches don't split the string
+			if( it->length(0) == 0 )
+				continue;
+
+			size_t pos = size_t(it->position(0));
+			array->Resize(array->GetSize()+1);
+			((string*)array->At(array->GetSize()-1))->assign(str, prev, pos-prev);
+			prev = pos + size_t(it->length(0));
+		}
+
+		array->Resize(array->GetSize()+1);
+		((string*)array->At(array->GetSize()-1))->assign(str, prev, string::npos);
+
+		return array;
+	}
+
+protected:
+	~CScriptRegex() {}
+
+	mutable int refCount;
+	std::regex  rex;
+};
+
+// AngelScript signature:
+// regex@ regex(const string &in pattern)
+static CScriptRegex *ScriptRegexFactory(const string &pattern)
+{
+	void *mem = asAllocMem(sizeof(CScriptRegex));
+	if( mem == 0 )
+	{
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Out of memory");
+		return 0;
+	}
+
+	try
+	{
+		return new(mem) CScriptRegex(pattern);
+	}
+	catch( const std::regex_error & )
+	{
+		asFreeMem(mem);
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Invalid regular expression");
+		return 0;
+	}
+}
+
+static void ScriptRegexFactory_Generic(asIScriptGeneric *gen)
+{
+	string *pattern = *(string**)gen->GetAddressOfArg(0);
+	*(CScriptRegex**)gen->GetAddressOfReturnLocation() = ScriptRegexFactory(*pattern);
+}
+
+static void ScriptRegexAddRef_Generic(asIScriptGeneric *gen)
+{
+	((CScriptRegex*)gen->GetObject())->AddRef();
+}
+
+static void ScriptRegexRelease_Generic(asIScriptGeneric *gen)
+{
+	((CScriptRegex*)gen->GetObject())->Release();
+}
+
+static void ScriptRegexFind_Generic(asIScriptGeneric *gen)
+{
+	CScriptRegex *self = (CScriptRegex*)gen->GetObject();
+	string *str = *(string**)gen->GetAddressOfArg(0);
+	asUINT start = gen->GetArgDWord(1);
+	asUINT *length = *(asUINT**)gen->GetAddressOfArg(2);
+	gen->SetReturnDWord(self->Find(*str, start, *length));
+}
+
+static void ScriptRegexMatch_Generic(asIScriptGeneric *gen)
+{
+	CScriptRegex *self = (CScriptRegex*)gen->GetObject();
+	string *str = *(string**)gen->GetAddressOfArg(0);
+	gen->SetReturnByte(self->Match(*str));
+}
+
+static void ScriptRegexReplace_Generic(asIScriptGeneric *gen)
+{
+	CScriptRegex *self = (CScriptRegex*)gen->GetObject();
+	string *str = *(string**)gen->GetAddressOfArg(0);
+	string *fmt = *(string**)gen->GetAddressOfArg(1);
+	new(gen->GetAddressOfReturnLocation()) string(self->Replace(*str, *fmt));
+}
+
+static void ScriptRegexSplit_Generic(asIScriptGeneric *gen)
+{
+	CScriptRegex *self = (CScriptRegex*)gen->GetObject();
+	string *str = *(string**)gen->GetAddressOfArg(0);
+	*(CScriptArray**)gen->GetAddressOfReturnLocation() = self->Split(*str);
+}
+
 // This is where the utility functions are registered.
 // The string type must have been registered first.
 void RegisterStdStringUtils(asIScriptEngine *engine)
@@ -125,6 +288,29 @@ void RegisterStdStringUtils(asIScriptEngine *engine)
 		r = engine->RegisterObjectMethod("string", "array<string>@ split(const string &in) const", asFUNCTION(StringSplit), asCALL_CDECL_OBJLAST); assert(r >= 0);
 		r = engine->RegisterGlobalFunction("string join(const array<string> &in, const string &in)", asFUNCTION(StringJoin), asCALL_CDECL); assert(r >= 0);
 	}
+
+	// The regex type
+	r = engine->RegisterObjectType("regex", 0, asOBJ_REF); assert(r >= 0);
+	if( strstr(asGetLibraryOptions(), "AS_MAX_PORTABILITY") )
+	{
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_FACTORY, "regex@ f(const string &in)", asFUNCTION(ScriptRegexFactory_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_ADDREF, "void f()", asFUNCTION(ScriptRegexAddRef_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_RELEASE, "void f()", asFUNCTION(ScriptRegexRelease_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "int find(const string &in, uint start = 0, uint &out lengthOfMatch = void) const", asFUNCTION(ScriptRegexFind_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "bool match(const string &in) const", asFUNCTION(ScriptRegexMatch_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "string replace(const string &in, const string &in fmt) const", asFUNCTION(ScriptRegexReplace_Generic), asCALL_GENERIC); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "array<string>@ split(const string &in) const", asFUNCTION(ScriptRegexSplit_Generic), asCALL_GENERIC); assert(r >= 0);
+	}
+	else
+	{
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_FACTORY, "regex@ f(const string &in)", asFUNCTION(ScriptRegexFactory), asCALL_CDECL); assert(r >= 0);
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_ADDREF, "void f()", asMETHOD(CScriptRegex, AddRef), asCALL_THISCALL); assert(r >= 0);
+		r = engine->RegisterObjectBehaviour("regex", asBEHAVE_RELEASE, "void f()", asMETHOD(CScriptRegex, Release), asCALL_THISCALL); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "int find(const string &in, uint start = 0, uint &out lengthOfMatch = void) const", asMETHOD(CScriptRegex, Find), asCALL_THISCALL); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "bool match(const string &in) const", asMETHOD(CScriptRegex, Match), asCALL_THISCALL); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "string replace(const string &in, const string &in fmt) const", asMETHOD(CScriptRegex, Replace), asCALL_THISCALL); assert(r >= 0);
+		r = engine->RegisterObjectMethod("regex", "array<string>@ split(const string &in) const", asMETHOD(CScriptRegex, Split), asCALL_THISCALL); assert(r >= 0);
+	}
 }
 
 END_AS_NAMESPACE
@@ -75,6 +75,7 @@ class asIJITCompilerAbstract;
 class asIThreadManager;
 class asILockableSharedBool;
 class asIStringFactory;
+class asIFunctionSignature;
 
 //
 // asBYTE  =  8 bits
@@ -191,6 +192,13 @@ enum asEEngineProp
 	asEP_MEMBER_INIT_MODE                   = 38,
 	asEP_BOOL_CONVERSION_MODE               = 39,
 	asEP_FOREACH_SUPPORT                    = 40,
+	asEP_STACK_HIGH_WATER_MARK              = 41,
+	asEP_GC_PROMOTION_SWEEPS                = 42,
+	asEP_GC_PARALLEL_MIN_OBJECTS            = 43,
+	asEP_COMPILE_PARALLEL_MIN_FUNCTIONS     = 44,
+	asEP_OPTIMIZE_BYTECODE_LEVEL            = 45,
+	asEP_MAX_INLINE_FUNCTION_SIZE           = 46,
+	asEP_INCREMENTAL_BUILD                  = 47,
 
 	asEP_LAST_PROPERTY
 };
@@ -250,7 +258,8 @@ enum asEObjTypeFlags : asQWORD
 	asOBJ_APP_CLASS_ALIGN8            = (1<<19),
 	asOBJ_IMPLICIT_HANDLE             = (1<<20),
 	asOBJ_APP_CLASS_UNION             = (asQWORD(1)<<32),
-	asOBJ_MASK_VALID_FLAGS            = 0x1801FFFFFul,
+	asOBJ_GC_THREADSAFE               = (asQWORD(1)<<33),
+	asOBJ_MASK_VALID_FLAGS            = 0x3801FFFFFul,
 	// Internal flags
 	asOBJ_SCRIPT_OBJECT               = (1<<21),
 	asOBJ_SHARED                      = (1<<22),
@@ -322,7 +331,8 @@ enum asEGCFlags
 	asGC_FULL_CYCLE      = 1,
 	asGC_ONE_STEP        = 2,
 	asGC_DESTROY_GARBAGE = 4,
-	asGC_DETECT_GARBAGE  = 8
+	asGC_DETECT_GARBAGE  = 8,
+	asGC_TIME_BUDGET     = 16
 };
 
 // Token classes
@@ -419,6 +429,8 @@ typedef void (*asCLEANSCRIPTOBJECTFUNC_t)(asIScriptObject *);
 typedef asIScriptContext *(*asREQUESTCONTEXTFUNC_t)(asIScriptEngine *, void *);
 typedef void (*asRETURNCONTEXTFUNC_t)(asIScriptEngine *, asIScriptContext *, void *);
 typedef void (*asCIRCULARREFFUNC_t)(asITypeInfo *, const void *, void *);
+typedef void (*asWORKFUNC_t)(asUINT, void *);
+typedef void (*asWORKERPOOLFUNC_t)(asWORKFUNC_t, void *, asUINT, void *);
 
 struct asSVMRegisters;
 typedef void (*asJITFunction)(asSVMRegisters* registers, asPWORD jitArg);
@@ -582,6 +594,17 @@ extern "C"
 	AS_API const char      *asGetLibraryVersion();
 	AS_API const char      *asGetLibraryOptions();
 
+	// Build profiler, only available when the library is compiled with AS_PROFILE
+	AS_API int               asResetProfiler();
+	AS_API asUINT            asGetProfilerScopeCount();
+	AS_API int               asGetProfilerScope(asUINT index, const char **scope, asUINT *count = 0, double *totalTime = 0, double *minTime = 0, double *maxTime = 0);
+	AS_API int               asWriteProfilerTrace(const char *filename);
+
+	// Bytecode statistics, only available when the library is compiled with AS_BYTECODE_STATS
+	AS_API int               asResetByteCodeStats();
+	AS_API asUINT            asGetByteCodeStatsCount(asUINT length);
+	AS_API int               asGetByteCodeStats(asUINT length, asUINT index, asBYTE *opcodes, asQWORD *count = 0);
+
 	// Context
 	AS_API asIScriptContext *asGetActiveContext();
 
@@ -705,6 +728,7 @@ public:
 	virtual asUINT             GetGlobalFunctionCount() const = 0;
 	virtual asIScriptFunction *GetGlobalFunctionByIndex(asUINT index) const = 0;
 	virtual asIScriptFunction *GetGlobalFunctionByDecl(const char *declaration) const = 0;
+	virtual asIFunctionSignature *CreateFunctionSignature(const char *declaration) = 0;
 
 	// Global properties
 	virtual int    RegisterGlobalProperty(const char *declaration, void *pointer) = 0;
@@ -793,6 +817,10 @@ public:
 	virtual asIScriptContext      *RequestContext() = 0;
 	virtual void                   ReturnContext(asIScriptContext *ctx) = 0;
 	virtual int                    SetContextCallbacks(asREQUESTCONTEXTFUNC_t requestCtx, asRETURNCONTEXTFUNC_t returnCtx, void *param = 0) = 0;
+	virtual void                   GetStackStatistics(asUINT *bytesInContexts, asUINT *bytesPooled = 0, asUINT *blocksPooled = 0) const = 0;
+
+	// Worker pool
+	virtual int                    SetWorkerPool(asWORKERPOOLFUNC_t callback, void *param = 0, asUINT numWorkers = 0) = 0;
 
 	// String interpretation
 	virtual asETokenClass ParseToken(const char *string, size_t stringLength = 0, asUINT *tokenLength = 0) const = 0;
@@ -800,6 +828,7 @@ public:
 	// Garbage collection
 	virtual int  GarbageCollect(asDWORD flags = asGC_FULL_CYCLE, asUINT numIterations = 1) = 0;
 	virtual void GetGCStatistics(asUINT *currentSize, asUINT *totalDestroyed = 0, asUINT *totalDetected = 0, asUINT *newObjects = 0, asUINT *totalNewDestroyed = 0) const = 0;
+	virtual int  GetGCTypeStatistics(asITypeInfo *type, asUINT *totalAdded, asUINT *totalNewDestroyed = 0, asUINT *totalPromoted = 0, asUINT *totalDetected = 0) const = 0;
 	virtual int  NotifyGarbageCollectorOfNewObject(void *obj, asITypeInfo *type) = 0;
 	virtual int  GetObjectInGC(asUINT idx, asUINT *seqNbr = 0, void **obj = 0, asITypeInfo **type = 0) = 0;
 	virtual void GCEnumCallback(void *reference) = 0;
@@ -866,6 +895,7 @@ public:
 	virtual asIScriptFunction *GetFunctionByIndex(asUINT index) const = 0;
 	virtual asIScriptFunction *GetFunctionByDecl(const char *decl) const = 0;
 	virtual asIScriptFunction *GetFunctionByName(const char *name) const = 0;
+	virtual asIScriptFunction *GetFunctionBySignature(const asIFunctionSignature *signature) const = 0;
 	virtual int                RemoveFunction(asIScriptFunction *func) = 0;
 
 	// Global variables
@@ -905,7 +935,9 @@ public:
 
 	// Byte code saving and loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
+	virtual int SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped = 0) = 0;
+	virtual int LoadByteCode(const void *data, asUINT size, bool *wasDebugInfoStripped = 0) = 0;
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type = 0) = 0;
@@ -936,6 +968,10 @@ public:
 	virtual int             PopState() = 0;
 	virtual bool            IsNested(asUINT *nestCount = 0) const = 0;
 
+	// Stack memory
+	virtual int             TrimStack() = 0;
+	virtual int             GetStackStatistics(asUINT *allocatedBytes, asUINT *blockCount = 0) const = 0;
+
 	// Object pointer for calling class methods
 	virtual int   SetObject(void *obj) = 0;
 
@@ -976,6 +1012,9 @@ public:
 	virtual int                SetFunctionCallback(const asSFuncPtr &callback, void *obj, int callConv) = 0;
 	virtual void               ClearLineCallback() = 0;
 	virtual void               ClearFunctionCallback() = 0;
+	virtual int                SetSampleCallback(const asSFuncPtr &callback, void *obj, int callConv) = 0;
+	virtual void               ClearSampleCallback() = 0;
+	virtual int                RequestSample() = 0;
 	virtual asUINT             GetCallstackSize() const = 0;
 	virtual asIScriptFunction *GetFunction(asUINT stackLevel = 0) = 0;
 	virtual int                GetLineNumber(asUINT stackLevel = 0, int *column = 0, const char **sectionName = 0) = 0;
@@ -1126,6 +1165,7 @@ public:
 	virtual asIScriptFunction *GetMethodByIndex(asUINT index, bool getVirtual = true) const = 0;
 	virtual asIScriptFunction *GetMethodByName(const char *name, bool getVirtual = true) const = 0;
 	virtual asIScriptFunction *GetMethodByDecl(const char *decl, bool getVirtual = true) const = 0;
+	virtual asIScriptFunction *GetMethodBySignature(const asIFunctionSignature *signature, bool getVirtual = true) const = 0;
 
 	// Properties
 	virtual asUINT      GetPropertyCount() const = 0;
@@ -1237,6 +1277,22 @@ protected:
 	virtual ~asIScriptFunction() {};
 };
 
+class asIFunctionSignature
+{
+public:
+	virtual asIScriptEngine *GetEngine() const = 0;
+
+	// Memory management
+	virtual int AddRef() const = 0;
+	virtual int Release() const = 0;
+
+	// Declaration
+	virtual const char *GetDeclaration() const = 0;
+
+protected:
+	virtual ~asIFunctionSignature() {}
+};
+
 class asIBinaryStream
 {
 public:
@@ -1675,7 +1731,14 @@ enum asEBCInstr
 	asBC_POWi64			= 198,
 	asBC_POWu64			= 199,
 	asBC_Thiscall1		= 200,
-	asBC_MAXBYTECODE	= 201,
+	asBC_JEqIi			= 201,
+	asBC_JNeIi			= 202,
+	asBC_JLtIi			= 203,
+	asBC_JGeIi			= 204,
+	asBC_JGtIi			= 205,
+	asBC_JLeIi			= 206,
+	asBC_PshVPtrOfs		= 207,
+	asBC_MAXBYTECODE	= 208,
 
 	// Temporary tokens. Can't be output to the final program
 	asBC_TryBlock		= 250,
@@ -1971,14 +2034,14 @@ const asSBCInfo asBCInfo[256] =
 	asBCINFO(POWi64,	wW_rW_rW_ARG,	0),
 	asBCINFO(POWu64,	wW_rW_rW_ARG,	0),
 	asBCINFO(Thiscall1, DW_ARG,			-AS_PTR_SIZE-1),
+	asBCINFO(JEqIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JNeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLtIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGtIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(PshVPtrOfs, rW_W_DW_ARG,	AS_PTR_SIZE),
 
-	asBCINFO_DUMMY(201),
-	asBCINFO_DUMMY(202),
-	asBCINFO_DUMMY(203),
-	asBCINFO_DUMMY(204),
-	asBCINFO_DUMMY(205),
-	asBCINFO_DUMMY(206),
-	asBCINFO_DUMMY(207),
 	asBCINFO_DUMMY(208),
 	asBCINFO_DUMMY(209),
 	asBCINFO_DUMMY(210),
@@ -27,6 +27,7 @@ HEADERS += ../../include/angelscript.h \
            ../../source/as_context.h \
            ../../source/as_criticalsection.h \   
            ../../source/as_datatype.h \
+           ../../source/as_declcache.h \
            ../../source/as_debug.h \
            ../../source/as_gc.h \ 
            ../../source/as_generic.h \
@@ -70,6 +71,7 @@ SOURCES += ../../source/as_atomic.cpp \
            ../../source/as_configgroup.cpp \
            ../../source/as_context.cpp \
            ../../source/as_datatype.cpp \
+           ../../source/as_declcache.cpp \
            ../../source/as_gc.cpp \
            ../../source/as_generic.cpp \
            ../../source/as_globalproperty.cpp \
@@ -53,11 +53,10 @@ BEGIN_AS_NAMESPACE
 
 // asCSymbolTable template specializations for sGlobalVariableDescription entries
 template<>
-void asCSymbolTable<sGlobalVariableDescription>::GetKey(const sGlobalVariableDescription *entry, asSNameSpaceNamePair &key) const
+void asCSymbolTable<sGlobalVariableDescription>::GetKey(const sGlobalVariableDescription *entry, const asSNameSpace *&ns, const asCString *&name) const
 {
-	asSNameSpace *ns = entry->ns;
-	asCString name = entry->name;
-	key = asSNameSpaceNamePair(ns, name);
+	ns   = entry->ns;
+	name = &entry->name;
 }
 
 // Comparator for exact variable search
@@ -85,6 +84,11 @@ asCBuilder::asCBuilder(asCScriptEngine *_engine, asCModule *_module)
 	this->engine = _engine;
 	this->module = _module;
 	silent = false;
+#ifndef AS_NO_COMPILER
+	deferMessages = false;
+	numRoundCompiled = 0;
+	numRoundDeferred = 0;
+#endif
 }
 
 asCBuilder::~asCBuilder()
@@ -92,6 +96,10 @@ asCBuilder::~asCBuilder()
 #ifndef AS_NO_COMPILER
 	asUINT n;
 
+	// Free the parsed scripts if the build wasn't completed
+	for( n = 0; n < parsers.GetLength(); n++ )
+		asDELETE(parsers[n],asCParser);
+
 	// Free all functions
 	for( n = 0; n < functions.GetLength(); n++ )
 	{
@@ -229,23 +237,36 @@ int asCBuilder::AddCode(const char *name, const char *code, int codeLength, int
 
 asCScriptCode *asCBuilder::FindOrAddCode(const char *name, const char *code, size_t length)
 {
+	// The default arguments are added by the workers when compiling in parallel
+	ENTERCRITICALSECTION(compileCs);
+
 	for (asUINT n = 0; n < scripts.GetLength(); n++)
 		if( scripts[n]->name == name && scripts[n]->codeLength == length && memcmp(scripts[n]->code, code, length) == 0 )
-			return scripts[n];
+		{
+			asCScriptCode *script = scripts[n];
+			LEAVECRITICALSECTION(compileCs);
+			return script;
+		}
 
 	asCScriptCode *script = asNEW(asCScriptCode);
 	if (script == 0)
+	{
+		LEAVECRITICALSECTION(compileCs);
 		return 0;
+	}
 
 	int r = script->SetCode(name, code, length, true);
 	if (r < 0)
 	{
 		asDELETE(script, asCScriptCode);
+		LEAVECRITICALSECTION(compileCs);
 		return 0;
 	}
 
 	script->idx = engine->GetScriptSectionNameIndex(name);
 	scripts.PushLast(script);
+
+	LEAVECRITICALSECTION(compileCs);
 	return script;
 }
 
@@ -297,9 +318,51 @@ void asCBuilder::EvaluateTemplateInstances(asUINT startIdx, bool keepSilent)
 	}
 }
 
+int asCBuilder::ParseScripts()
+{
+	TimeIt("asCBuilder::ParseScripts");
+
+	// This is called without holding the engine's build lock, so it must not
+	// touch the engine's shared state, nor invoke the message callback
+	numErrors = 0;
+	numWarnings = 0;
+	deferMessages = true;
+	deferredMessages.SetLength(0);
+
+	// Discard the result of a previous attempt to build the scripts
+	asUINT n;
+	for( n = 0; n < parsers.GetLength(); n++ )
+		asDELETE(parsers[n],asCParser);
+	parsers.SetLength(0);
+
+	// Parse all the files as if they were one
+	for( n = 0; n < scripts.GetLength(); n++ )
+	{
+		asCParser *parser = asNEW(asCParser)(this);
+		if( parser != 0 )
+		{
+			parsers.PushLast(parser);
+
+			// Parse the script file
+			parser->ParseScript(scripts[n]);
+		}
+	}
+
+	deferMessages = false;
+
+	return numErrors > 0 ? asERROR : asSUCCESS;
+}
+
 int asCBuilder::Build()
 {
+	// The scripts have already been parsed so the number of errors must be kept
+	int parseErrors = numErrors, parseWarnings = numWarnings;
 	Reset();
+	numErrors = parseErrors;
+	numWarnings = parseWarnings;
+
+	// Now that the build lock is held the messages from the parsing can be written
+	WriteDeferredMessages();
 
 	// The template callbacks must only be called after the subtypes have a known structure,
 	// otherwise the callback may think it is not possible to create the template instance,
@@ -310,7 +373,10 @@ int asCBuilder::Build()
 	engine->deferValidationOfTemplateTypes = true;
 	asUINT numTempl = (asUINT)engine->templateInstanceTypes.GetLength();
 
-	ParseScripts();
+	if (numErrors > 0)
+		return asERROR;
+
+	RegisterDeclarations();
 	if (numErrors > 0)
 		return asERROR;
 
@@ -343,6 +409,10 @@ int asCBuilder::Build()
 	if( numErrors > 0 )
 		return asERROR;
 
+	// Replace calls to small functions with a copy of their bytecode
+	if( engine->ep.optimizeByteCode && engine->ep.maxInlineFunctionSize )
+		InlineFunctionCalls();
+
 	// Make sure something was compiled, otherwise return an error
 	if( module->IsEmpty() )
 	{
@@ -350,9 +420,561 @@ int asCBuilder::Build()
 		return asERROR;
 	}
 
+	// The values of the constants and the visible namespaces are kept for
+	// incremental builds, as the functions must see them the same way
+	if( engine->ep.incrementalBuild )
+	{
+		asCSymbolTable<sGlobalVariableDescription>::iterator it = globVariables.List();
+		for( ; it; it++ )
+			if( (*it)->isPureConstant && !(*it)->isEnumValue && (*it)->property )
+				module->m_constantValues.Insert((*it)->property, (*it)->constantValue);
+		module->m_namespaceVisibility = namespaceVisibility;
+	}
+
+	return asSUCCESS;
+}
+
+// Returns the row and column of the position, encoded the same way as in the function's declaredAt
+static int EncodeRowCol(asCScriptCode *script, size_t pos)
+{
+	int row, col;
+	script->ConvertPosToRowCol(pos, &row, &col);
+	return (row & 0xFFFFF)|((col & 0xFFF)<<20);
+}
+
+// Returns a value that orders the encoded positions as they appear in the code
+static asQWORD RowColOrder(int rowCol)
+{
+	return (asQWORD(asDWORD(rowCol) & 0xFFFFF) << 12) | ((asDWORD(rowCol) >> 20) & 0xFFF);
+}
+
+static bool IsLambda(asCScriptFunction *func)
+{
+	// Anonymous functions start with $
+	return func->objectType == 0 && func->name.GetLength() && func->name[0] == '$';
+}
+
+int asCBuilder::BuildIncrementally(asCArray<asCScriptCode *> &sections)
+{
+	TimeIt("asCBuilder::BuildIncrementally");
+
+	Reset();
+
+	// The functions whose statement blocks have changed are compiled again, together with
+	// the functions that have inlined them. Everything else in the module is kept as is,
+	// including the values of the global variables. If anything but the statement blocks
+	// differ from the code the module was built from asNOT_SUPPORTED is returned, and
+	// the module must be built from scratch
+	asCArray<asCScriptCode *> &built = module->m_builtSections;
+	if( sections.GetLength() != built.GetLength() )
+		return asNOT_SUPPORTED;
+
+	asCArray<sIncrementalSection> secs;
+	secs.SetLength(sections.GetLength());
+	if( secs.GetLength() != sections.GetLength() )
+		return asOUT_OF_MEMORY;
+
+	asCMap<int, asUINT> secByIdx;
+	asSMapNode<int, asUINT> *cursor;
+	bool isChanged = false;
+	asUINT n;
+	int r;
+	for( n = 0; n < sections.GetLength(); n++ )
+	{
+		asCScriptCode *script = sections[n];
+		asCScriptCode *oldScript = built[n];
+		if( script->name != oldScript->name ||
+			script->idx != oldScript->idx ||
+			script->lineOffset != oldScript->lineOffset ||
+			secByIdx.MoveTo(&cursor, script->idx) )
+			return asNOT_SUPPORTED;
+		secByIdx.Insert(script->idx, n);
+
+		secs[n].script    = script;
+		secs[n].oldScript = oldScript;
+		secs[n].isChanged = script->codeLength != oldScript->codeLength ||
+		                    memcmp(script->code, oldScript->code, script->codeLength) != 0;
+		if( secs[n].isChanged )
+			isChanged = true;
+	}
+
+	if( !isChanged )
+		return asSUCCESS;
+
+	// The messages from the parser are only written if the module is updated, since
+	// a full build will report them anyway. The build lock is already held though
+	deferMessages = true;
+
+	// All functions with a statement block in the changed sections are compiled again
+	asCArray<sFunctionBody*>     recompile;
+	asCArray<asCScriptFunction*> replaced;
+	for( n = 0; n < secs.GetLength(); n++ )
+	{
+		if( !secs[n].isChanged )
+			continue;
+
+		r = ParseIncrementalSection(&secs[n]);
+		if( r < 0 )
+			return r;
+
+		for( asUINT b = 0; b < secs[n].bodies.GetLength(); b++ )
+		{
+			r = MarkForRecompilation(&secs[n], b, recompile, replaced);
+			if( r < 0 )
+				return r;
+		}
+	}
+
+	// The functions that have inlined a recompiled function must also be compiled again
+	asCArray<asCScriptFunction*> &calls = module->m_inlinedCalls;
+	for( bool isDone = false; !isDone; )
+	{
+		isDone = true;
+		for( n = 0; n + 1 < calls.GetLength(); n += 2 )
+		{
+			asCScriptFunction *caller = calls[n];
+			if( !replaced.Exists(calls[n+1]) || replaced.Exists(caller) )
+				continue;
+
+			if( caller->module != module || caller->scriptData == 0 ||
+				!secByIdx.MoveTo(&cursor, caller->scriptData->scriptSectionIdx) )
+				return asNOT_SUPPORTED;
+
+			sIncrementalSection *section = &secs[secByIdx.GetValue(cursor)];
+			if( !section->isParsed )
+			{
+				r = ParseIncrementalSection(section);
+				if( r < 0 )
+					return r;
+			}
+
+			// Lambdas are compiled with the function they are declared in. Functions 
+			// without a statement block, e.g. the initialization of global variables 
+			// and the default constructors, cannot be compiled separately
+			int b = FindFunctionBody(section, caller->scriptData->declaredAt, section->isChanged);
+			if( b < 0 )
+				return asNOT_SUPPORTED;
+
+			r = MarkForRecompilation(section, b, recompile, replaced);
+			if( r < 0 )
+				return r;
+
+			isDone = false;
+		}
+	}
+
+	// Constructors need the class declaration to compile the initialization of the members
+	for( n = 0; n < recompile.GetLength(); n++ )
+	{
+		asCScriptFunction *func = recompile[n]->func;
+		if( func->objectType == 0 || func->name != func->objectType->name )
+			continue;
+
+		bool found = false;
+		for( asUINT c = 0; c < classDeclarations.GetLength() && !found; c++ )
+			found = classDeclarations[c]->typeInfo == func->objectType;
+		if( !found && CreateClassDeclaration(recompile[n]->classNode, recompile[n]->script, func->objectType) == 0 )
+			return asNOT_SUPPORTED;
+	}
+
+	// From here on the module is updated. If the new code has errors the build fails, 
+	// and the module is discarded just like when a full build fails
+	deferMessages = false;
+	WriteDeferredMessages();
+
+	// Forget the inlined calls made by the code that is replaced
+	asUINT numCalls = 0;
+	for( n = 0; n + 1 < calls.GetLength(); n += 2 )
+	{
+		if( replaced.Exists(calls[n]) )
+			continue;
+		calls[numCalls++] = calls[n];
+		calls[numCalls++] = calls[n+1];
+	}
+	calls.SetLength(numCalls);
+
+	// The rest of the functions in the changed sections are only moved to where their declarations are now
+	for( n = 0; n < secs.GetLength(); n++ )
+	{
+		if( !secs[n].isChanged )
+			continue;
+
+		asCArray<asCScriptFunction*> moved;
+		for( asUINT f = 0; f < module->m_scriptFunctions.GetLength(); f++ )
+			moved.PushLast(module->m_scriptFunctions[f]);
+		asCSymbolTableIterator<asCGlobalProperty> it = module->m_scriptGlobals.List();
+		for( ; it; it++ )
+			if( (*it)->GetInitFunc() )
+				moved.PushLast((*it)->GetInitFunc());
+
+		for( asUINT f = 0; f < moved.GetLength(); f++ )
+		{
+			asCScriptFunction *func = moved[f];
+			if( func->module != module || func->funcType != asFUNC_SCRIPT || func->scriptData == 0 ||
+				func->scriptData->scriptSectionIdx != secs[n].script->idx || replaced.Exists(func) )
+				continue;
+
+			func->scriptData->declaredAt = RemapRowCol(&secs[n], func->scriptData->declaredAt);
+
+			// The inlined code from other sections keeps its line numbers
+			asCArray<int> &lines = func->scriptData->lineNumbers;
+			asCArray<int> &sectionIdxs = func->scriptData->sectionIdxs;
+			for( asUINT l = 0; l + 1 < lines.GetLength(); l += 2 )
+			{
+				int sectionIdx = func->scriptData->scriptSectionIdx;
+				for( asUINT s = 0; s + 1 < sectionIdxs.GetLength() && sectionIdxs[s] <= lines[l]; s += 2 )
+					sectionIdx = sectionIdxs[s+1];
+				if( sectionIdx == secs[n].script->idx )
+					lines[l+1] = RemapRowCol(&secs[n], lines[l+1]);
+			}
+		}
+	}
+
+	// Remove the previous bytecode of the recompiled functions
+	for( n = 0; n < recompile.GetLength(); n++ )
+	{
+		sFunctionBody *body = recompile[n];
+		asCScriptFunction *func = body->func;
+
+		func->ReleaseReferences();
+		for( asUINT v = 0; v < func->scriptData->variables.GetLength(); v++ )
+			asDELETE(func->scriptData->variables[v], asSScriptVariable);
+		func->scriptData->variables.SetLength(0);
+		func->scriptData->byteCode.SetLength(0);
+		func->scriptData->objVariableInfo.SetLength(0);
+		func->scriptData->tryCatchInfo.SetLength(0);
+		func->scriptData->lineNumbers.SetLength(0);
+		func->scriptData->sectionIdxs.SetLength(0);
+		func->scriptData->variableSpace = 0;
+		func->scriptData->stackNeeded = 0;
+		func->scriptData->declaredAt = body->declaredAt;
+
+		// The builder takes over the node from the parser
+		body->node->DisconnectParent();
+		sFunctionDescription *desc = asNEW(sFunctionDescription);
+		if( desc == 0 )
+		{
+			body->node->Destroy(engine);
+			return asOUT_OF_MEMORY;
+		}
+
+		functions.PushLast(desc);
+
+		desc->script           = body->script;
+		desc->node             = body->node;
+		desc->name             = func->name;
+		desc->objType          = func->objectType;
+		desc->paramNames       = func->parameterNames;
+		desc->funcId           = func->id;
+		desc->isExistingShared = false;
+	}
+
+	// The old lambdas are removed, new ones will be added as the functions are compiled
+	for( n = 0; n < replaced.GetLength(); n++ )
+	{
+		asCScriptFunction *func = replaced[n];
+		if( !IsLambda(func) )
+			continue;
+
+		int idx = module->m_globalFunctions.GetIndex(func);
+		if( idx >= 0 )
+			module->m_globalFunctions.Erase(idx);
+		module->m_scriptFunctions.RemoveValue(func);
+		func->ReleaseInternal();
+	}
+
+	// The functions are compiled with the same visible namespaces as in the full build
+	namespaceVisibility = module->m_namespaceVisibility;
+
+	CompileFunctions();
+
+	if( numWarnings > 0 && engine->ep.compilerWarnings == 2 )
+		WriteError(TXT_WARNINGS_TREATED_AS_ERROR, 0, 0);
+
+	if( numErrors > 0 )
+		return asERROR;
+
+	if( engine->ep.optimizeByteCode && engine->ep.maxInlineFunctionSize )
+		InlineFunctionCalls();
+
+	// Only the compiled functions are given to the JIT compiler
+	if( engine->jitCompiler )
+	{
+		for( n = 0; n < functions.GetLength(); n++ )
+			if( functions[n] )
+				engine->scriptFunctions[functions[n]->funcId]->JITCompile();
+	}
+
+	return asSUCCESS;
+}
+
+int asCBuilder::ParseIncrementalSection(sIncrementalSection *section)
+{
+	asCParser *parser = asNEW(asCParser)(this);
+	if( parser == 0 )
+		return asOUT_OF_MEMORY;
+	parsers.PushLast(parser);
+
+	if( parser->ParseScript(section->script) < 0 || numErrors > 0 ||
+		!FindFunctionBodies(parser->GetScriptNode(), section->script, 0, section->bodies) )
+		return asNOT_SUPPORTED;
+	section->isParsed = true;
+
+	if( !section->isChanged )
+		return MatchFunctionBodies(section);
+
+	// The old code is parsed to know where the functions were declared. It was
+	// already reported when the module was built, so the messages are dropped
+	asUINT numMessages = deferredMessages.GetLength();
+	int    oldWarnings = numWarnings;
+
+	parser = asNEW(asCParser)(this);
+	if( parser == 0 )
+		return asOUT_OF_MEMORY;
+	parsers.PushLast(parser);
+
+	bool isParsed = parser->ParseScript(section->oldScript) >= 0 && numErrors == 0 &&
+	                FindFunctionBodies(parser->GetScriptNode(), section->oldScript, 0, section->oldBodies);
+	deferredMessages.SetLength(numMessages);
+	numWarnings = oldWarnings;
+	if( !isParsed || section->bodies.GetLength() != section->oldBodies.GetLength() )
+		return asNOT_SUPPORTED;
+
+	// The functions were registered with the position in the old code
+	int r = MatchFunctionBodies(section);
+	if( r < 0 )
+		return r;
+
+	// Only the statement blocks may differ
+	asCScriptCode *script = section->script, *oldScript = section->oldScript;
+	size_t pos = 0, oldPos = 0;
+	for( asUINT n = 0; n <= section->bodies.GetLength(); n++ )
+	{
+		bool   isLast = n == section->bodies.GetLength();
+		size_t end    = isLast ? script->codeLength : section->bodies[n].blockPos;
+		size_t oldEnd = isLast ? oldScript->codeLength : section->oldBodies[n].blockPos;
+		if( end - pos != oldEnd - oldPos ||
+			memcmp(&script->code[pos], &oldScript->code[oldPos], end - pos) != 0 )
+			return asNOT_SUPPORTED;
+
+		if( !isLast )
+		{
+			pos    = end + section->bodies[n].blockLength;
+			oldPos = oldEnd + section->oldBodies[n].blockLength;
+		}
+	}
+
+	return asSUCCESS;
+}
+
+bool asCBuilder::FindFunctionBodies(asCScriptNode *node, asCScriptCode *script, asCScriptNode *classNode, asCArray<sFunctionBody> &bodies)
+{
+	for( node = node->firstChild; node; node = node->next )
+	{
+		if( node->nodeType == snNamespace )
+		{
+			if( !FindFunctionBodies(node->lastChild, script, 0, bodies) )
+				return false;
+		}
+		else if( node->nodeType == snClass )
+		{
+			if( !FindFunctionBodies(node, script, node, bodies) )
+				return false;
+		}
+		else if( node->nodeType == snMixin )
+		{
+			// The methods of a mixin class are compiled once for each class that includes it
+			return false;
+		}
+		else if( node->nodeType == snFunction || node->nodeType == snVirtualProperty )
+		{
+			asCScriptNode *block = node->lastChild;
+			if( block == 0 || block->nodeType != snStatementBlock )
+			{
+				// The accessors of a virtual property are child nodes
+				if( node->nodeType == snVirtualProperty && !FindFunctionBodies(node, script, classNode, bodies) )
+					return false;
+				continue;
+			}
+
+			// The accessors of virtual properties are registered with the statement block
+			sFunctionBody body;
+			body.script       = script;
+			body.node         = node->nodeType == snFunction ? node : block;
+			body.classNode    = classNode;
+			body.blockPos     = block->tokenPos;
+			body.blockLength  = block->tokenLength;
+			body.declaredAt   = EncodeRowCol(script, body.node->tokenPos);
+			body.endAt        = EncodeRowCol(script, block->tokenPos + block->tokenLength - 1);
+			body.func         = 0;
+			body.isRecompiled = false;
+			bodies.PushLast(body);
+		}
+	}
+
+	return true;
+}
+
+int asCBuilder::FindFunctionBody(sIncrementalSection *section, int rowCol, bool inOldCode)
+{
+	// The bodies are ordered as they appear in the code
+	asCArray<sFunctionBody> &bodies = inOldCode ? section->oldBodies : section->bodies;
+	asQWORD pos = RowColOrder(rowCol);
+	int min = 0, max = int(bodies.GetLength()) - 1, found = -1;
+	while( min <= max )
+	{
+		int mid = (min + max)/2;
+		if( RowColOrder(bodies[mid].declaredAt) <= pos )
+		{
+			found = mid;
+			min = mid + 1;
+		}
+		else
+			max = mid - 1;
+	}
+
+	if( found >= 0 && pos <= RowColOrder(bodies[found].endAt) )
+		return found;
+
+	return -1;
+}
+
+int asCBuilder::MatchFunctionBodies(sIncrementalSection *section)
+{
+	asCArray<sFunctionBody> &bodies = section->isChanged ? section->oldBodies : section->bodies;
+	for( asUINT n = 0; n < module->m_scriptFunctions.GetLength(); n++ )
+	{
+		// The factories are declared at the same position as the constructors
+		asCScriptFunction *func = module->m_scriptFunctions[n];
+		if( func->module != module || func->funcType != asFUNC_SCRIPT || func->scriptData == 0 ||
+			func->scriptData->scriptSectionIdx != section->script->idx || func->IsFactory() )
+			continue;
+
+		int b = FindFunctionBody(section, func->scriptData->declaredAt, section->isChanged);
+		if( b < 0 || bodies[b].declaredAt != func->scriptData->declaredAt )
+			continue;
+
+		// Shared functions may be used by other modules
+		if( func->IsShared() || (section->bodies[b].func && section->bodies[b].func != func) )
+			return asNOT_SUPPORTED;
+		section->bodies[b].func = func;
+	}
+
 	return asSUCCESS;
 }
 
+int asCBuilder::MarkForRecompilation(sIncrementalSection *section, asUINT bodyIdx, asCArray<sFunctionBody*> &recompile, asCArray<asCScriptFunction*> &replaced)
+{
+	sFunctionBody *body = &section->bodies[bodyIdx];
+	if( body->isRecompiled )
+		return asSUCCESS;
+	if( body->func == 0 )
+		return asNOT_SUPPORTED;
+
+	body->isRecompiled = true;
+	recompile.PushLast(body);
+	replaced.PushLast(body->func);
+
+	// The lambdas declared in the statement block are replaced too
+	sFunctionBody *old = section->isChanged ? &section->oldBodies[bodyIdx] : body;
+	for( asUINT n = 0; n < module->m_scriptFunctions.GetLength(); n++ )
+	{
+		asCScriptFunction *func = module->m_scriptFunctions[n];
+		if( !IsLambda(func) || func->module != module || func->scriptData == 0 ||
+			func->scriptData->scriptSectionIdx != section->script->idx )
+			continue;
+
+		asQWORD pos = RowColOrder(func->scriptData->declaredAt);
+		if( pos >= RowColOrder(old->declaredAt) && pos <= RowColOrder(old->endAt) )
+			replaced.PushLast(func);
+	}
+
+	return asSUCCESS;
+}
+
+sClassDeclaration *asCBuilder::CreateClassDeclaration(asCScriptNode *node, asCScriptCode *script, asCObjectType *objType)
+{
+	if( node == 0 )
+		return 0;
+
+	sClassDeclaration *decl = asNEW(sClassDeclaration);
+	if( decl == 0 )
+		return 0;
+	classDeclarations.PushLast(decl);
+
+	// The node stays with the parser, as only the initializations of the members are needed
+	decl->name     = objType->name;
+	decl->script   = script;
+	decl->typeInfo = objType;
+
+	for( node = node->firstChild; node; node = node->next )
+	{
+		if( node->nodeType != snDeclaration )
+			continue;
+
+		// Skip the type. Multiple properties can be declared separated by ,
+		asCScriptNode *nd = node->firstChild;
+		if( nd && (nd->tokenType == ttPrivate || nd->tokenType == ttProtected) )
+			nd = nd->next;
+		for( nd = nd ? nd->next : 0; nd; nd = nd->next )
+		{
+			asCScriptNode *initNode = 0;
+			if( nd->next && nd->next->nodeType != snIdentifier )
+				initNode = nd->next;
+
+			sPropertyInitializer p(asCString(&script->code[nd->tokenPos], nd->tokenLength), nd, initNode, script);
+			decl->propInits.PushLast(p);
+
+			if( initNode )
+				nd = initNode;
+		}
+	}
+
+	// The members that are not inherited must be declared in the class itself, and not be included from a mixin
+	asUINT first = objType->derivedFrom ? objType->derivedFrom->properties.GetLength() : 0;
+	for( asUINT p = first; p < objType->properties.GetLength(); p++ )
+	{
+		bool found = false;
+		for( asUINT i = 0; i < decl->propInits.GetLength() && !found; i++ )
+			found = decl->propInits[i].name == objType->properties[p]->name;
+		if( !found )
+			return 0;
+	}
+
+	return decl;
+}
+
+int asCBuilder::RemapRowCol(sIncrementalSection *section, int rowCol)
+{
+	// The code between the statement blocks is the same, so the position
+	// moves as much as the end of the last statement block before it
+	asQWORD pos = RowColOrder(rowCol);
+	int min = 0, max = int(section->oldBodies.GetLength()) - 1, found = -1;
+	while( min <= max )
+	{
+		int mid = (min + max)/2;
+		if( RowColOrder(section->oldBodies[mid].endAt) < pos )
+		{
+			found = mid;
+			min = mid + 1;
+		}
+		else
+			max = mid - 1;
+	}
+
+	if( found < 0 )
+		return rowCol;
+
+	int oldEnd = section->oldBodies[found].endAt;
+	int newEnd = section->bodies[found].endAt;
+	int row = (rowCol & 0xFFFFF) + (newEnd & 0xFFFFF) - (oldEnd & 0xFFFFF);
+	int col = (rowCol >> 20) & 0xFFF;
+	if( (rowCol & 0xFFFFF) == (oldEnd & 0xFFFFF) )
+		col += ((newEnd >> 20) & 0xFFF) - ((oldEnd >> 20) & 0xFFF);
+
+	return (row & 0xFFFFF)|((col & 0xFFF)<<20);
+}
+
 int asCBuilder::CompileGlobalVar(const char *sectionName, const char *code, int lineOffset)
 {
 	Reset();
@@ -645,172 +1267,155 @@ int asCBuilder::CompileFunction(const char *sectionName, const char *code, int l
 	return asSUCCESS;
 }
 
-void asCBuilder::ParseScripts()
+void asCBuilder::RegisterDeclarations()
 {
-	TimeIt("asCBuilder::ParseScripts");
+	TimeIt("asCBuilder::RegisterDeclarations");
 
-	asCArray<asCParser*> parsers((int)scripts.GetLength());
+	asUINT n = 0;
 
-	// Parse all the files as if they were one
-	asUINT n = 0;
-	for( n = 0; n < scripts.GetLength(); n++ )
+	// Register namespace visibility
+	for (n = 0; n < scripts.GetLength(); n++)
 	{
-		asCParser *parser = asNEW(asCParser)(this);
-		if( parser != 0 )
-		{
-			parsers.PushLast(parser);
-
-			// Parse the script file
-			parser->ParseScript(scripts[n]);
-		}
+		asCScriptNode* node = parsers[n]->GetScriptNode();
+		RegisterNamespaceVisibility(node, scripts[n], engine->nameSpaces[0]);
 	}
-
-	if (numErrors == 0)
+	
+	// Find all type declarations
+	for (n = 0; n < scripts.GetLength(); n++)
 	{
-		// Register namespace visibility
-		for (n = 0; n < scripts.GetLength(); n++)
-		{
-			asCScriptNode* node = parsers[n]->GetScriptNode();
-			RegisterNamespaceVisibility(node, scripts[n], engine->nameSpaces[0]);
-		}
-		
-		// Find all type declarations
-		for (n = 0; n < scripts.GetLength(); n++)
-		{
-			asCScriptNode *node = parsers[n]->GetScriptNode();
-			RegisterTypesFromScript(node, scripts[n], engine->nameSpaces[0]);
-		}
+		asCScriptNode *node = parsers[n]->GetScriptNode();
+		RegisterTypesFromScript(node, scripts[n], engine->nameSpaces[0]);
+	}
 
-		// Before moving forward the builder must establish the relationship between types
-		// so that a derived type can see the child types of the parent type.
-		DetermineTypeRelations();
+	// Before moving forward the builder must establish the relationship between types
+	// so that a derived type can see the child types of the parent type.
+	DetermineTypeRelations();
 
-		// Complete function definitions (defining returntype and parameters)
-		for( n = 0; n < funcDefs.GetLength(); n++ )
-			CompleteFuncDef(funcDefs[n]);
+	// Complete function definitions (defining returntype and parameters)
+	for( n = 0; n < funcDefs.GetLength(); n++ )
+		CompleteFuncDef(funcDefs[n]);
 
+	// Find other global nodes
+	for (n = 0; n < scripts.GetLength(); n++)
+	{
 		// Find other global nodes
-		for (n = 0; n < scripts.GetLength(); n++)
-		{
-			// Find other global nodes
-			asCScriptNode *node = parsers[n]->GetScriptNode();
-			RegisterNonTypesFromScript(node, scripts[n], engine->nameSpaces[0]);
-		}
+		asCScriptNode *node = parsers[n]->GetScriptNode();
+		RegisterNonTypesFromScript(node, scripts[n], engine->nameSpaces[0]);
+	}
 
-		// Register script methods found in the interfaces
-		for( n = 0; n < interfaceDeclarations.GetLength(); n++ )
-		{
-			sClassDeclaration *decl = interfaceDeclarations[n];
-			asCScriptNode *node = decl->node->firstChild->next;
+	// Register script methods found in the interfaces
+	for( n = 0; n < interfaceDeclarations.GetLength(); n++ )
+	{
+		sClassDeclaration *decl = interfaceDeclarations[n];
+		asCScriptNode *node = decl->node->firstChild->next;
 
-			// Skip list of inherited interfaces
-			while( node && node->nodeType == snIdentifier )
-				node = node->next;
+		// Skip list of inherited interfaces
+		while( node && node->nodeType == snIdentifier )
+			node = node->next;
 
-			while( node )
+		while( node )
+		{
+			asCScriptNode *next = node->next;
+			if( node->nodeType == snFunction )
 			{
-				asCScriptNode *next = node->next;
-				if( node->nodeType == snFunction )
-				{
-					node->DisconnectParent();
-					RegisterScriptFunctionFromNode(node, decl->script, CastToObjectType(decl->typeInfo), true, false, 0, decl->isExistingShared);
-				}
-				else if( node->nodeType == snVirtualProperty )
-				{
-					node->DisconnectParent();
-					RegisterVirtualProperty(node, decl->script, CastToObjectType(decl->typeInfo), true, false, 0, decl->isExistingShared);
-				}
-
-				node = next;
+				node->DisconnectParent();
+				RegisterScriptFunctionFromNode(node, decl->script, CastToObjectType(decl->typeInfo), true, false, 0, decl->isExistingShared);
 			}
+			else if( node->nodeType == snVirtualProperty )
+			{
+				node->DisconnectParent();
+				RegisterVirtualProperty(node, decl->script, CastToObjectType(decl->typeInfo), true, false, 0, decl->isExistingShared);
+			}
+
+			node = next;
 		}
+	}
 
-		// Register script methods found in the classes
-		for( n = 0; n < classDeclarations.GetLength(); n++ )
-		{
-			sClassDeclaration *decl = classDeclarations[n];
+	// Register script methods found in the classes
+	for( n = 0; n < classDeclarations.GetLength(); n++ )
+	{
+		sClassDeclaration *decl = classDeclarations[n];
 
-			asCScriptNode *node = decl->node->firstChild->next;
+		asCScriptNode *node = decl->node->firstChild->next;
 
-			// Skip list of classes and interfaces
-			while( node && node->nodeType == snIdentifier )
-				node = node->next;
+		// Skip list of classes and interfaces
+		while( node && node->nodeType == snIdentifier )
+			node = node->next;
 
-			while( node )
+		while( node )
+		{
+			asCScriptNode *next = node->next;
+			if( node->nodeType == snFunction )
 			{
-				asCScriptNode *next = node->next;
-				if( node->nodeType == snFunction )
-				{
-					node->DisconnectParent();
-					RegisterScriptFunctionFromNode(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, decl->isExistingShared, false, decl);
-				}
-				else if( node->nodeType == snVirtualProperty )
-				{
-					node->DisconnectParent();
-					RegisterVirtualProperty(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, decl->isExistingShared);
-				}
-
-				node = next;
+				node->DisconnectParent();
+				RegisterScriptFunctionFromNode(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, decl->isExistingShared, false, decl);
+			}
+			else if( node->nodeType == snVirtualProperty )
+			{
+				node->DisconnectParent();
+				RegisterVirtualProperty(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, decl->isExistingShared);
 			}
 
-			if (!decl->isExistingShared)
+			node = next;
+		}
+
+		if (!decl->isExistingShared)
+		{
+			// Add the default copy operator if needed (only if no other opAssign with single parameter is defined)
+			bool copyOperatorExists = false;
+			asCObjectType* ot = CastToObjectType(decl->typeInfo);
+			for (asUINT i = 0; i < ot->methods.GetLength(); i++)
 			{
-				// Add the default copy operator if needed (only if no other opAssign with single parameter is defined)
-				bool copyOperatorExists = false;
-				asCObjectType* ot = CastToObjectType(decl->typeInfo);
-				for (asUINT i = 0; i < ot->methods.GetLength(); i++)
+				asCScriptFunction* f = engine->scriptFunctions[ot->methods[i]];
+				if (f->name == "opAssign" && f->parameterTypes.GetLength() == 1)
 				{
-					asCScriptFunction* f = engine->scriptFunctions[ot->methods[i]];
-					if (f->name == "opAssign" && f->parameterTypes.GetLength() == 1)
-					{
-						copyOperatorExists = true;
-						break;
-					}
-				}
-				if (engine->ep.alwaysImplDefaultCopy == 2 || decl->isDefaultCopyDeleted ||
-					(copyOperatorExists && ot->beh.copy == engine->scriptTypeBehaviours.beh.copy && engine->ep.alwaysImplDefaultCopy == 0))
-				{
-					// Script class has a declared constructor, so remove the default opAssign
-					// unless the engine is configured to always provide a default opAssign
-					engine->scriptFunctions[ot->beh.copy]->ReleaseInternal();
-					ot->beh.copy = 0;
+					copyOperatorExists = true;
+					break;
 				}
+			}
+			if (engine->ep.alwaysImplDefaultCopy == 2 || decl->isDefaultCopyDeleted ||
+				(copyOperatorExists && ot->beh.copy == engine->scriptTypeBehaviours.beh.copy && engine->ep.alwaysImplDefaultCopy == 0))
+			{
+				// Script class has a declared constructor, so remove the default opAssign
+				// unless the engine is configured to always provide a default opAssign
+				engine->scriptFunctions[ot->beh.copy]->ReleaseInternal();
+				ot->beh.copy = 0;
+			}
 
-				// Add the default constructors if needed (only if no other constructor is explicitly defined)
-				if ( !decl->isDefaultConstructorDeleted && 
-					 ((engine->ep.alwaysImplDefaultConstruct == 0 && ot->beh.construct == engine->scriptTypeBehaviours.beh.construct && ot->beh.constructors.GetLength() == 1) ||
-					 engine->ep.alwaysImplDefaultConstruct == 1) )
-				{
-					AddDefaultConstructor(ot, decl->script);
-				}
+			// Add the default constructors if needed (only if no other constructor is explicitly defined)
+			if ( !decl->isDefaultConstructorDeleted && 
+				 ((engine->ep.alwaysImplDefaultConstruct == 0 && ot->beh.construct == engine->scriptTypeBehaviours.beh.construct && ot->beh.constructors.GetLength() == 1) ||
+				 engine->ep.alwaysImplDefaultConstruct == 1) )
+			{
+				AddDefaultConstructor(ot, decl->script);
+			}
 
-				// Add the default copy constructor if needed (only if no other constructor with single parameter is explicitly defined)
-				bool copyConstructExists = false;
-				for (asUINT i = 0; i < ot->beh.constructors.GetLength(); i++)
+			// Add the default copy constructor if needed (only if no other constructor with single parameter is explicitly defined)
+			bool copyConstructExists = false;
+			for (asUINT i = 0; i < ot->beh.constructors.GetLength(); i++)
+			{
+				if (engine->scriptFunctions[ot->beh.constructors[i]]->parameterTypes.GetLength() == 1)
 				{
-					if (engine->scriptFunctions[ot->beh.constructors[i]]->parameterTypes.GetLength() == 1)
-					{
-						copyConstructExists = true;
-						break;
-					}
+					copyConstructExists = true;
+					break;
 				}
-				if ( !decl->isDefaultCopyConstructorDeleted &&
-					 ((engine->ep.alwaysImplDefaultCopyConstruct == 0 && !copyConstructExists) || engine->ep.alwaysImplDefaultCopyConstruct == 1) )
-					AddDefaultCopyConstructor(ot, decl->script);
+			}
+			if ( !decl->isDefaultCopyConstructorDeleted &&
+				 ((engine->ep.alwaysImplDefaultCopyConstruct == 0 && !copyConstructExists) || engine->ep.alwaysImplDefaultCopyConstruct == 1) )
+				AddDefaultCopyConstructor(ot, decl->script);
 
-				// If the default constructor has not been generated now, then release the dummy 
-				if (ot->beh.construct == engine->scriptTypeBehaviours.beh.construct)
-				{
-					engine->scriptFunctions[ot->beh.construct]->ReleaseInternal();
-					ot->beh.construct = 0;
-					ot->beh.constructors.RemoveIndex(0);
+			// If the default constructor has not been generated now, then release the dummy 
+			if (ot->beh.construct == engine->scriptTypeBehaviours.beh.construct)
+			{
+				engine->scriptFunctions[ot->beh.construct]->ReleaseInternal();
+				ot->beh.construct = 0;
+				ot->beh.constructors.RemoveIndex(0);
 
-					if (ot->beh.factory)
-					{
-						engine->scriptFunctions[ot->beh.factory]->ReleaseInternal();
-						ot->beh.factory = 0;
-						ot->beh.factories.RemoveIndex(0);
-					}
+				if (ot->beh.factory)
+				{
+					engine->scriptFunctions[ot->beh.factory]->ReleaseInternal();
+					ot->beh.factory = 0;
+					ot->beh.factories.RemoveIndex(0);
 				}
 			}
 		}
@@ -820,6 +1425,17 @@ void asCBuilder::ParseScripts()
 	{
 		asDELETE(parsers[n],asCParser);
 	}
+	parsers.SetLength(0);
+}
+
+void asCBuilder::WriteDeferredMessages()
+{
+	for( asUINT n = 0; n < deferredMessages.GetLength(); n++ )
+	{
+		sDeferredMessage &m = deferredMessages[n];
+		engine->WriteMessage(m.scriptname.AddressOf(), m.r, m.c, m.type, m.msg.AddressOf());
+	}
+	deferredMessages.SetLength(0);
 }
 
 void asCBuilder::RegisterTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns)
@@ -842,256 +1458,1093 @@ void asCBuilder::RegisterTypesFromScript(asCScriptNode *node, asCScriptCode *scr
 			asSNameSpace *nsChild = engine->AddNameSpace(nsName.AddressOf());
 			RegisterTypesFromScript(node->lastChild, script, nsChild);
 		}
-		else
+		else
+		{
+			if( node->nodeType == snClass )
+			{
+				node->DisconnectParent();
+				RegisterClass(node, script, ns);
+			}
+			else if( node->nodeType == snInterface )
+			{
+				node->DisconnectParent();
+				RegisterInterface(node, script, ns);
+			}
+			else if( node->nodeType == snEnum )
+			{
+				node->DisconnectParent();
+				RegisterEnum(node, script, ns);
+			}
+			else if( node->nodeType == snTypedef )
+			{
+				node->DisconnectParent();
+				RegisterTypedef(node, script, ns);
+			}
+			else if( node->nodeType == snFuncDef )
+			{
+				node->DisconnectParent();
+				RegisterFuncDef(node, script, ns, 0);
+			}
+			else if( node->nodeType == snMixin )
+			{
+				node->DisconnectParent();
+				RegisterMixinClass(node, script, ns);
+			}
+		}
+
+		node = next;
+	}
+}
+
+void asCBuilder::RegisterNamespaceVisibility(asCScriptNode* node, asCScriptCode* script, asSNameSpace* ns)
+{
+	asASSERT(node->nodeType == snScript);
+
+	node = node->firstChild;
+	// First, register all namespaces
+	while ( node )
+	{
+		asCScriptNode* next = node->next;
+		if ( node->nodeType == snNamespace )
+		{
+			asCString nsName;
+			nsName.Assign(&script->code[node->firstChild->tokenPos], node->firstChild->tokenLength);
+			if ( ns->name != "" )
+				nsName = ns->name + "::" + nsName;
+
+			asSNameSpace* nsChild = engine->AddNameSpace(nsName.AddressOf());
+			RegisterNamespaceVisibility(node->lastChild, script, nsChild);
+		}
+		else if ( node->nodeType == snUsing )
+		{
+			node->DisconnectParent();
+			RegisterUsingNamespace(node, script, ns);
+		}
+		node = next;
+	}
+}
+
+// TODO: using: review
+void asCBuilder::AddVisibleNamespaces(asSNameSpace *ns, const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending)
+{
+	asSMapNode<asSNameSpace*, asCArray<asSNameSpace*>>* cursor = 0;
+
+	if (namespaceVisibility.MoveTo(&cursor, ns))
+	{
+		asCArray<asSNameSpace*>& visibilityBuffer = namespaceVisibility.GetValue(cursor);
+		asUINT count = visibilityBuffer.GetLength();
+
+		for (asUINT i = 0; i < count; ++i)
+		{
+			asSNameSpace* visibleNameSpace = visibilityBuffer[i];
+			if (!visited.Exists(visibleNameSpace) && !pending.Exists(visibleNameSpace))
+			{
+				pending.PushLast(visibleNameSpace);
+			}
+		}
+	}
+}
+
+// TODO: using: review
+asSNameSpace *asCBuilder::FindNextVisibleNamespace(const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending, asSNameSpace *parentNs, bool* checkAmbiguous)
+{
+	// First iterate through all pending namespaces that have been included with 'using namespace'
+	asSNameSpace* nextNs = 0;
+	while ( pending.GetLength() != 0 )
+	{
+		asSNameSpace *candidate = pending.PopLast();
+		if (!visited.Exists(candidate))
+		{
+			nextNs = candidate;
+			break;
+		}
+	}
+
+	// Even if the parent namespace has already been visited, it still needs to be traversed
+	if (nextNs == 0)
+		nextNs = parentNs;
+
+	if (checkAmbiguous && !(*checkAmbiguous))
+		*checkAmbiguous = nextNs == engine->nameSpaces[0];
+
+	return nextNs;
+}
+
+void asCBuilder::RegisterNonTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns)
+{
+	node = node->firstChild;
+	while( node )
+	{
+		asCScriptNode *next = node->next;
+		if( node->nodeType == snNamespace )
+		{
+			// Determine the name of the namespace
+			asCString nsName;
+			nsName.Assign(&script->code[node->firstChild->tokenPos], node->firstChild->tokenLength);
+			if( ns->name != "" )
+				nsName = ns->name + "::" + nsName;
+
+			// Declare the namespace, then add the entities
+			asSNameSpace *nsChild = engine->AddNameSpace(nsName.AddressOf());
+			RegisterNonTypesFromScript(node->lastChild, script, nsChild);
+		}
+		else
+		{
+			node->DisconnectParent();
+			if( node->nodeType == snFunction )
+				RegisterScriptFunctionFromNode(node, script, 0, false, true, ns);
+			else if( node->nodeType == snDeclaration )
+				RegisterGlobalVar(node, script, ns);
+			else if( node->nodeType == snVirtualProperty )
+				RegisterVirtualProperty(node, script, 0, false, true, ns);
+			else if( node->nodeType == snImport )
+				RegisterImportedFunction(module->GetNextImportedFunctionId(), node, script, ns);
+			else
+			{
+				// Unused script node
+				int r, c;
+				script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+
+				WriteWarning(script->name, TXT_UNUSED_SCRIPT_NODE, r, c);
+
+				node->Destroy(engine);
+			}
+		}
+
+		node = next;
+	}
+}
+
+void asCBuilder::CompileFunctions()
+{
+	TimeIt("asCBuilder::CompileFunctions");
+
+	asUINT n = 0;
+
+#ifndef AS_NO_THREADS
+	// Large modules can have the function bodies compiled by the application's worker pool
+	if( engine->ep.compileParallelMinFunctions && functions.GetLength() >= engine->ep.compileParallelMinFunctions &&
+		engine->workerPoolFunc )
+		n = CompileFunctionsInParallel();
+#endif
+
+	// Compile each function. The lambdas are added to the list as they are found
+	for( ; n < functions.GetLength(); n++ )
+		CompileFunction(functions[n]);
+}
+
+void asCBuilder::CompileFunction(sFunctionDescription *current)
+{
+	if( current == 0 ) return;
+
+	// Don't compile the function again if it was an existing shared function
+	if( current->isExistingShared ) return;
+
+	// Don't compile if there is no statement block
+	if (current->node && !(current->node->nodeType == snStatementBlock || current->node->lastChild->nodeType == snStatementBlock))
+		return;
+
+	asCCompiler compiler(engine);
+	asCScriptFunction *func = engine->scriptFunctions[current->funcId];
+
+	// Find the class declaration for constructors
+	sClassDeclaration *classDecl = 0;
+	if( current->objType && current->name == current->objType->name )
+	{
+		for( asUINT c = 0; c < classDeclarations.GetLength(); c++ )
+		{
+			if( classDeclarations[c]->typeInfo == current->objType )
+			{
+				classDecl = classDeclarations[c];
+				break;
+			}
+		}
+
+		asASSERT( classDecl );
+	}
+
+	if( current->node )
+	{
+		int r, c;
+		current->script->ConvertPosToRowCol(current->node->tokenPos, &r, &c);
+
+		asCString str = func->GetDeclarationStr();
+		str.Format(TXT_COMPILING_s, str.AddressOf());
+		WriteInfo(current->script->name, str, r, c, true);
+
+		// When compiling a constructor need to pass the class declaration for member initializations
+		compiler.CompileFunction(this, current->script, current->paramNames, current->node, func, classDecl);
+
+		// The pre message of a function compiled by a worker is kept until the function is committed
+		if( GetCompileTask() == 0 )
+			engine->preMessage.isSet = false;
+	}
+	else if( current->objType && current->name == current->objType->name )
+	{
+		asCScriptNode *node = classDecl ? classDecl->node : 0;
+
+		if (func->parameterTypes.GetLength() == 0)
+		{
+			int r = 0, c = 0;
+			if (node)
+				current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+
+			asCString str = func->GetDeclarationStr();
+			str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
+			WriteInfo(current->script->name, str, r, c, true);
+
+			// This is the default constructor that is generated
+			// automatically if not implemented by the user.
+			r = compiler.CompileDefaultConstructor(this, current->script, node, func, classDecl);
+		}
+		else
+		{
+			asASSERT(func->parameterTypes.GetLength() == 1 && func->parameterTypes[0].GetTypeInfo() == current->objType);
+
+			int r = 0, c = 0;
+			if (node)
+				current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+
+			asCString str = func->GetDeclarationStr();
+			str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
+			WriteInfo(current->script->name, str, r, c, true);
+
+			// This is the default copy constructor that is generated
+			// automatically if not implemented by the user.
+			r = compiler.CompileDefaultCopyConstructor(this, current->script, node, func, classDecl);
+		}
+
+		if( GetCompileTask() == 0 )
+			engine->preMessage.isSet = false;
+	}
+	else
+	{
+		asASSERT( false );
+	}
+}
+
+// Returns the index of the dword holding the jump offset, or 0 if the instruction is not a relative jump
+static asUINT GetJumpOffsetIndex(asEBCInstr op)
+{
+	if( (op >= asBC_JMP && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ )
+		return 1;
+	if( op >= asBC_JEqIi && op <= asBC_JLeIi )
+		return 2;
+	return 0;
+}
+
+// Returns the number of variable operands of the instruction
+static asUINT GetVarOperandCount(asEBCInstr op)
+{
+	switch( asBCInfo[op].type )
+	{
+	case asBCTYPE_wW_rW_rW_ARG:
+		return 3;
+	case asBCTYPE_wW_rW_ARG:
+	case asBCTYPE_rW_rW_ARG:
+	case asBCTYPE_wW_rW_DW_ARG:
+		return 2;
+	case asBCTYPE_rW_ARG:
+	case asBCTYPE_wW_ARG:
+	case asBCTYPE_rW_DW_ARG:
+	case asBCTYPE_wW_DW_ARG:
+	case asBCTYPE_wW_QW_ARG:
+	case asBCTYPE_rW_QW_ARG:
+	case asBCTYPE_rW_W_DW_ARG:
+	case asBCTYPE_rW_DW_DW_ARG:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// Returns true if the instruction can be part of a function that is inlined, i.e. it
+// doesn't touch the stack pointer, other functions, global variables, or object references
+static bool IsInlinableInstr(asEBCInstr op)
+{
+	if( GetJumpOffsetIndex(op) )
+		return true;
+
+	switch( op )
+	{
+	case asBC_JMPP:
+	case asBC_SUSPEND:
+	case asBC_JitEntry:
+	case asBC_RET:
+	case asBC_TZ: case asBC_TNZ: case asBC_TS: case asBC_TNS: case asBC_TP: case asBC_TNP:
+	case asBC_NOT: case asBC_ClrHi: case asBC_ChkNullV:
+	case asBC_NEGi: case asBC_NEGf: case asBC_NEGd: case asBC_NEGi64:
+	case asBC_INCi8: case asBC_INCi16: case asBC_INCi: case asBC_INCi64: case asBC_INCf: case asBC_INCd:
+	case asBC_DECi8: case asBC_DECi16: case asBC_DECi: case asBC_DECi64: case asBC_DECf: case asBC_DECd:
+	case asBC_IncVi: case asBC_DecVi:
+	case asBC_BNOT: case asBC_BAND: case asBC_BOR: case asBC_BXOR: case asBC_BSLL: case asBC_BSRL: case asBC_BSRA:
+	case asBC_BNOT64: case asBC_BAND64: case asBC_BOR64: case asBC_BXOR64: case asBC_BSLL64: case asBC_BSRL64: case asBC_BSRA64:
+	case asBC_CMPi: case asBC_CMPu: case asBC_CMPf: case asBC_CMPd: case asBC_CMPi64: case asBC_CMPu64:
+	case asBC_CMPIi: case asBC_CMPIu: case asBC_CMPIf:
+	case asBC_ADDi: case asBC_SUBi: case asBC_MULi: case asBC_DIVi: case asBC_MODi: case asBC_DIVu: case asBC_MODu:
+	case asBC_ADDf: case asBC_SUBf: case asBC_MULf: case asBC_DIVf: case asBC_MODf:
+	case asBC_ADDd: case asBC_SUBd: case asBC_MULd: case asBC_DIVd: case asBC_MODd:
+	case asBC_ADDi64: case asBC_SUBi64: case asBC_MULi64: case asBC_DIVi64: case asBC_MODi64: case asBC_DIVu64: case asBC_MODu64:
+	case asBC_ADDIi: case asBC_SUBIi: case asBC_MULIi: case asBC_ADDIf: case asBC_SUBIf: case asBC_MULIf:
+	case asBC_POWi: case asBC_POWu: case asBC_POWf: case asBC_POWd: case asBC_POWdi: case asBC_POWi64: case asBC_POWu64:
+	case asBC_iTOf: case asBC_fTOi: case asBC_uTOf: case asBC_fTOu: case asBC_sbTOi: case asBC_swTOi: case asBC_ubTOi: case asBC_uwTOi:
+	case asBC_dTOi: case asBC_dTOu: case asBC_dTOf: case asBC_iTOd: case asBC_uTOd: case asBC_fTOd: case asBC_iTOb: case asBC_iTOw:
+	case asBC_i64TOi: case asBC_uTOi64: case asBC_iTOi64: case asBC_fTOi64: case asBC_dTOi64: case asBC_fTOu64: case asBC_dTOu64:
+	case asBC_i64TOf: case asBC_u64TOf: case asBC_i64TOd: case asBC_u64TOd:
+	case asBC_SetV1: case asBC_SetV2: case asBC_SetV4: case asBC_SetV8:
+	case asBC_CpyVtoV4: case asBC_CpyVtoV8: case asBC_CpyVtoR4: case asBC_CpyVtoR8: case asBC_CpyRtoV4: case asBC_CpyRtoV8:
+	case asBC_WRTV1: case asBC_WRTV2: case asBC_WRTV4: case asBC_WRTV8:
+	case asBC_RDR1: case asBC_RDR2: case asBC_RDR4: case asBC_RDR8:
+	case asBC_LDV: case asBC_LoadThisR: case asBC_LoadRObjR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Returns true if the instruction may modify the variable in its first operand
+static bool DoesInstrWriteFirstVar(asEBCInstr op)
+{
+	if( op >= asBC_JEqIi && op <= asBC_JLeIi )
+		return false;
+
+	switch( op )
+	{
+	case asBC_JMPP:
+	case asBC_ChkNullV:
+	case asBC_CMPi: case asBC_CMPu: case asBC_CMPf: case asBC_CMPd: case asBC_CMPi64: case asBC_CMPu64:
+	case asBC_CMPIi: case asBC_CMPIu: case asBC_CMPIf:
+	case asBC_CpyVtoR4: case asBC_CpyVtoR8:
+	case asBC_WRTV1: case asBC_WRTV2: case asBC_WRTV4: case asBC_WRTV8:
+	case asBC_LoadRObjR:
+		return false;
+	default:
+		// Instructions like NEGi and iTOf modify the variable in place
+		return GetVarOperandCount(op) > 0;
+	}
+}
+
+// The location of the inlined function's variables in the caller's stack frame
+struct sInlineFrame
+{
+	int              base;
+	int              thisVar;
+	bool             hasThis;
+	asCArray<int>    paramOffset;
+	asCArray<int>    paramSize;
+	asCArray<int>    paramVar;
+	asCArray<bool>   paramIsWritten;
+	asCArray<bool>   paramIsUsed;
+};
+
+static int MapInlinedVar(const sInlineFrame &frame, int var)
+{
+	// Local variables are moved above the caller's variables
+	if( var > 0 )
+		return frame.base + var;
+
+	if( frame.hasThis && var > -AS_PTR_SIZE )
+		return frame.thisVar + var;
+
+	for( asUINT n = 0; n < frame.paramOffset.GetLength(); n++ )
+	{
+		int delta = frame.paramOffset[n] - var;
+		if( delta >= 0 && delta < frame.paramSize[n] )
+			return frame.paramVar[n] - delta;
+	}
+
+	asASSERT( false );
+	return var;
+}
+
+static void AddInlinedLine(asCArray<int> &lines, asCArray<int> &sections, asUINT pos, int line, int section)
+{
+	// A later entry for the same position replaces the earlier one
+	if( lines.GetLength() && asUINT(lines[lines.GetLength()-2]) == pos )
+	{
+		lines.SetLength(lines.GetLength()-2);
+		sections.PopLast();
+	}
+
+	lines.PushLast(int(pos));
+	lines.PushLast(line);
+	sections.PushLast(section);
+}
+
+// Returns true if the variable holds an object that is known to exist, i.e. it is the
+// object pointer of a method or only ever declared as a local object that isn't a handle
+static bool IsNonNullObjectVar(asCScriptFunction *func, int var)
+{
+	if( var == 0 )
+		return func->objectType != 0;
+
+	bool found = false;
+	for( asUINT n = 0; n < func->scriptData->variables.GetLength(); n++ )
+	{
+		asSScriptVariable *v = func->scriptData->variables[n];
+		if( v->stackOffset != var )
+			continue;
+		if( var < 0 || v->type.IsObjectHandle() || v->type.IsReference() || !v->type.IsObject() )
+			return false;
+		found = true;
+	}
+
+	return found;
+}
+
+bool asCBuilder::CanInlineFunction(asCScriptFunction *func)
+{
+	if( func == 0 || func->funcType != asFUNC_SCRIPT || func->scriptData == 0 )
+		return false;
+
+	asCArray<asDWORD> &bc = func->scriptData->byteCode;
+	if( bc.GetLength() == 0 || bc.GetLength() > engine->ep.maxInlineFunctionSize )
+		return false;
+
+	if( func->objectType && !(func->objectType->flags & asOBJ_SCRIPT_OBJECT) )
+		return false;
+
+	// Only primitives are passed and returned, so there is nothing to clean up
+	if( func->DoesReturnOnStack() || func->IsVariadic() || 
+		!func->returnType.IsPrimitive() || func->returnType.IsReference() )
+		return false;
+
+	asUINT n;
+	for( n = 0; n < func->parameterTypes.GetLength(); n++ )
+	{
+		const asCDataType &dt = func->parameterTypes[n];
+		if( !dt.IsPrimitive() || dt.IsReference() || dt.GetTokenType() == ttQuestion )
+			return false;
+	}
+
+	if( func->scriptData->objVariableInfo.GetLength() || func->scriptData->tryCatchInfo.GetLength() )
+		return false;
+
+	for( n = 0; n < func->scriptData->variables.GetLength(); n++ )
+	{
+		asSScriptVariable *var = func->scriptData->variables[n];
+		if( var->stackOffset > 0 && (!var->type.IsPrimitive() || var->type.IsReference()) )
+			return false;
+	}
+
+	// Only the last instruction may return, and the object pointer must not be modified
+	for( n = 0; n < bc.GetLength(); )
+	{
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[n]);
+		asUINT size = asBCTypeSize[asBCInfo[op].type];
+		if( !IsInlinableInstr(op) )
+			return false;
+		if( op == asBC_RET && n + size != bc.GetLength() )
+			return false;
+		if( func->objectType && DoesInstrWriteFirstVar(op) && asBC_SWORDARG0(&bc[n]) <= 0 && asBC_SWORDARG0(&bc[n]) > -AS_PTR_SIZE )
+			return false;
+		n += size;
+	}
+
+	asEBCInstr last = asEBCInstr(*(asBYTE*)&bc[bc.GetLength() - asBCTypeSize[asBCInfo[asBC_RET].type]]);
+	return last == asBC_RET;
+}
+
+void asCBuilder::InlineFunctionCalls()
+{
+	TimeIt("asCBuilder::InlineFunctionCalls");
+
+	// This is done after all functions have been compiled, as the 
+	// functions may have been compiled in parallel and in any order
+	for( asUINT n = 0; n < functions.GetLength(); n++ )
+	{
+		if( functions[n] == 0 || functions[n]->isExistingShared )
+			continue;
+
+		asCScriptFunction *func = engine->scriptFunctions[functions[n]->funcId];
+		if( func && func->scriptData && func->scriptData->byteCode.GetLength() &&
+			func->scriptData->tryCatchInfo.GetLength() == 0 )
+			InlineFunctionCalls(func);
+	}
+}
+
+void asCBuilder::InlineFunctionCalls(asCScriptFunction *func)
+{
+	asCArray<asDWORD> &bc = func->scriptData->byteCode;
+	asUINT length = bc.GetLength();
+
+	// Find the start of each instruction and the destinations of the jumps
+	asCArray<asUINT> instrPos;
+	asCArray<asBYTE> isJumpTarget;
+	isJumpTarget.SetLength(length + 1);
+	memset(isJumpTarget.AddressOf(), 0, isJumpTarget.GetLength());
+	asUINT pos;
+	for( pos = 0; pos < length; )
+	{
+		instrPos.PushLast(pos);
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[pos]);
+		asUINT size = asBCTypeSize[asBCInfo[op].type];
+		asUINT ofsIdx = GetJumpOffsetIndex(op);
+		if( ofsIdx )
+		{
+			asUINT target = pos + size + int(bc[pos + ofsIdx]);
+			if( target <= length )
+				isJumpTarget[target] = 1;
+		}
+		pos += size;
+	}
+
+	// Find the calls where the arguments are pushed with simple push instructions right before the call
+	asCArray<asUINT> siteStart;
+	asCArray<asUINT> siteCall;
+	int frameSize = 0;
+	asUINT n;
+	for( n = 0; n < instrPos.GetLength(); n++ )
+	{
+		asDWORD *instr = &bc[instrPos[n]];
+		if( *(asBYTE*)instr != asBC_CALL )
+			continue;
+
+		asCScriptFunction *callee = engine->scriptFunctions[asBC_INTARG(instr)];
+		if( !CanInlineFunction(callee) )
+			continue;
+
+		// Walk backwards over the pushes. The object pointer is pushed last, and the parameters in reverse order
+		asUINT numPushes = callee->parameterTypes.GetLength() + (callee->objectType ? 1 : 0);
+		if( numPushes > n )
+			continue;
+
+		bool ok = true;
+		for( asUINT p = 0; p < numPushes && ok; p++ )
+		{
+			asDWORD *push = &bc[instrPos[n - 1 - p]];
+			asEBCInstr op = asEBCInstr(*(asBYTE*)push);
+			if( callee->objectType && p == 0 )
+				ok = op == asBC_PshVPtr;
+			else
+			{
+				int size = callee->parameterTypes[p - (callee->objectType ? 1 : 0)].GetSizeOnStackDWords();
+				ok = (size == 1 && (op == asBC_PshC4 || op == asBC_PshV4)) ||
+				     (size == 2 && (op == asBC_PshC8 || op == asBC_PshV8));
+			}
+
+			// The code must not jump into the middle of the call
+			if( isJumpTarget[instrPos[n - p]] )
+				ok = false;
+		}
+		if( !ok )
+			continue;
+
+		siteStart.PushLast(instrPos[n - numPushes]);
+		siteCall.PushLast(instrPos[n]);
+
+		// An incremental build must recompile the caller if the callee is changed
+		if( engine->ep.incrementalBuild )
+		{
+			module->m_inlinedCalls.PushLast(func);
+			module->m_inlinedCalls.PushLast(callee);
+		}
+
+		// All inlined functions share the same space after the caller's variables
+		int size = callee->scriptData->variableSpace;
+		for( asUINT p = 0; p < callee->parameterTypes.GetLength(); p++ )
+			size += callee->parameterTypes[p].GetSizeOnStackDWords();
+		if( size > frameSize )
+			frameSize = size;
+	}
+
+	if( siteStart.GetLength() == 0 )
+		return;
+
+	// Build the new bytecode
+	asCArray<asDWORD> out;
+	asCArray<asUINT> posMap;
+	posMap.SetLength(length + 1);
+	asCArray<asUINT> jumps;
+	asCArray<int> lines;
+	asCArray<int> lineSections;
+	asCArray<int> &oldLines = func->scriptData->lineNumbers;
+	asUINT lineIdx = 0;
+	int callerLine = oldLines.GetLength() ? oldLines[1] : 0;
+	int callerSection = func->scriptData->scriptSectionIdx;
+	sInlineFrame frame;
+	frame.base = func->scriptData->variableSpace;
+	asUINT site = 0;
+
+	for( n = 0; n < instrPos.GetLength(); )
+	{
+		pos = instrPos[n];
+		bool isSite = site < siteStart.GetLength() && siteStart[site] == pos;
+		asUINT endPos = isSite ? siteCall[site] : pos;
+
+		// Copy the line numbers of the caller up to this instruction
+		for( ; lineIdx < oldLines.GetLength() && asUINT(oldLines[lineIdx]) <= endPos; lineIdx += 2 )
+		{
+			callerLine = oldLines[lineIdx+1];
+			callerSection = func->scriptData->scriptSectionIdx;
+			for( asUINT s = 0; s < func->scriptData->sectionIdxs.GetLength(); s += 2 )
+				if( func->scriptData->sectionIdxs[s] <= oldLines[lineIdx] )
+					callerSection = func->scriptData->sectionIdxs[s+1];
+			AddInlinedLine(lines, lineSections, out.GetLength(), callerLine, callerSection);
+		}
+
+		if( !isSite )
+		{
+			asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[pos]);
+			asUINT size = asBCTypeSize[asBCInfo[op].type];
+			posMap[pos] = out.GetLength();
+			if( GetJumpOffsetIndex(op) )
+			{
+				// Remember the jump so the offset can be updated when all positions are known
+				jumps.PushLast(out.GetLength());
+				jumps.PushLast(pos + size + int(bc[pos + GetJumpOffsetIndex(op)]));
+			}
+			for( asUINT d = 0; d < size; d++ )
+				out.PushLast(bc[pos + d]);
+			n++;
+			continue;
+		}
+
+		asCScriptFunction *callee = engine->scriptFunctions[asBC_INTARG(&bc[siteCall[site]])];
+		asCArray<asDWORD> &cbc = callee->scriptData->byteCode;
+		asUINT numParams = callee->parameterTypes.GetLength();
+
+		// Determine where the parameters are stored in the callee's stack frame
+		frame.hasThis = callee->objectType != 0;
+		frame.thisVar = 0;
+		frame.paramOffset.SetLength(numParams);
+		frame.paramSize.SetLength(numParams);
+		frame.paramVar.SetLength(numParams);
+		frame.paramIsWritten.SetLength(numParams);
+		frame.paramIsUsed.SetLength(numParams);
+		int offset = frame.hasThis ? -AS_PTR_SIZE : 0;
+		int slot = frame.base + callee->scriptData->variableSpace;
+		asUINT p;
+		for( p = 0; p < numParams; p++ )
+		{
+			frame.paramOffset[p] = offset;
+			frame.paramSize[p] = callee->parameterTypes[p].GetSizeOnStackDWords();
+			frame.paramIsWritten[p] = false;
+			frame.paramIsUsed[p] = false;
+			offset -= frame.paramSize[p];
+			slot += frame.paramSize[p];
+			frame.paramVar[p] = slot;
+		}
+
+		// Parameters that are modified by the callee must be copied, and those that are not used can be ignored
+		asUINT cpos;
+		for( cpos = 0; cpos < cbc.GetLength(); )
+		{
+			asEBCInstr op = asEBCInstr(*(asBYTE*)&cbc[cpos]);
+			for( asUINT v = 0; v < GetVarOperandCount(op); v++ )
+			{
+				int var = *(((short*)&cbc[cpos]) + 1 + v);
+				for( p = 0; p < numParams; p++ )
+				{
+					if( frame.paramOffset[p] - var >= 0 && frame.paramOffset[p] - var < frame.paramSize[p] )
+					{
+						frame.paramIsUsed[p] = true;
+						if( v == 0 && DoesInstrWriteFirstVar(op) )
+							frame.paramIsWritten[p] = true;
+					}
+				}
+			}
+			cpos += asBCTypeSize[asBCInfo[op].type];
+		}
+
+		// Replace the pushes with copies to the parameter slots, or use the caller's variables directly
+		p = numParams;
+		for( ; instrPos[n] < siteCall[site]; n++ )
 		{
-			if( node->nodeType == snClass )
+			pos = instrPos[n];
+			posMap[pos] = out.GetLength();
+			asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[pos]);
+			if( op == asBC_PshVPtr )
 			{
-				node->DisconnectParent();
-				RegisterClass(node, script, ns);
+				// The call would have raised an exception for a null handle, so the inlined code must too
+				frame.thisVar = asBC_SWORDARG0(&bc[pos]);
+				if( !IsNonNullObjectVar(func, frame.thisVar) )
+					out.PushLast(asBC_ChkNullV | (asDWORD(asWORD(frame.thisVar)) << 16));
+				continue;
 			}
-			else if( node->nodeType == snInterface )
+
+			p--;
+			if( !frame.paramIsUsed[p] )
+				continue;
+			if( (op == asBC_PshV4 || op == asBC_PshV8) && !frame.paramIsWritten[p] )
 			{
-				node->DisconnectParent();
-				RegisterInterface(node, script, ns);
+				frame.paramVar[p] = asBC_SWORDARG0(&bc[pos]);
+				continue;
 			}
-			else if( node->nodeType == snEnum )
+
+			asDWORD instr = op == asBC_PshC4 ? asBC_SetV4 : op == asBC_PshC8 ? asBC_SetV8 : op == asBC_PshV4 ? asBC_CpyVtoV4 : asBC_CpyVtoV8;
+			instr |= asDWORD(asWORD(frame.paramVar[p])) << 16;
+			out.PushLast(instr);
+			if( op == asBC_PshC4 )
+				out.PushLast(bc[pos+1]);
+			else if( op == asBC_PshC8 )
 			{
-				node->DisconnectParent();
-				RegisterEnum(node, script, ns);
+				out.PushLast(bc[pos+1]);
+				out.PushLast(bc[pos+2]);
 			}
-			else if( node->nodeType == snTypedef )
+			else
+				out.PushLast(asDWORD(asWORD(asBC_SWORDARG0(&bc[pos]))));
+		}
+
+		// Copy the callee's bytecode without the final RET
+		asUINT retPos = cbc.GetLength() - asBCTypeSize[asBCInfo[asBC_RET].type];
+		asCArray<asUINT> calleeMap;
+		calleeMap.SetLength(cbc.GetLength() + 1);
+		asUINT firstJump = jumps.GetLength();
+		asUINT calleeLineIdx = 0;
+		asCArray<int> &calleeLines = callee->scriptData->lineNumbers;
+		posMap[siteCall[site]] = out.GetLength();
+		for( cpos = 0; cpos < retPos; )
+		{
+			asEBCInstr op = asEBCInstr(*(asBYTE*)&cbc[cpos]);
+			asUINT size = asBCTypeSize[asBCInfo[op].type];
+			calleeMap[cpos] = out.GetLength();
+
+			// The inlined code reports the callee's line numbers
+			for( ; calleeLineIdx < calleeLines.GetLength() && asUINT(calleeLines[calleeLineIdx]) <= cpos; calleeLineIdx += 2 )
 			{
-				node->DisconnectParent();
-				RegisterTypedef(node, script, ns);
+				int section = callee->scriptData->scriptSectionIdx;
+				for( asUINT s = 0; s < callee->scriptData->sectionIdxs.GetLength(); s += 2 )
+					if( callee->scriptData->sectionIdxs[s] <= calleeLines[calleeLineIdx] )
+						section = callee->scriptData->sectionIdxs[s+1];
+				AddInlinedLine(lines, lineSections, out.GetLength(), calleeLines[calleeLineIdx+1], section);
 			}
-			else if( node->nodeType == snFuncDef )
+
+			asUINT start = out.GetLength();
+			if( op == asBC_LoadThisR && frame.thisVar != 0 )
 			{
-				node->DisconnectParent();
-				RegisterFuncDef(node, script, ns, 0);
+				// The object pointer is no longer the first variable in the stack frame
+				out.PushLast(asBC_LoadRObjR | (asDWORD(asWORD(frame.thisVar)) << 16));
+				out.PushLast(asDWORD(asWORD(asBC_SWORDARG0(&cbc[cpos]))));
+				out.PushLast(cbc[cpos+1]);
+				cpos += size;
+				continue;
 			}
-			else if( node->nodeType == snMixin )
+
+			for( asUINT d = 0; d < size; d++ )
+				out.PushLast(cbc[cpos + d]);
+			for( asUINT v = 0; v < GetVarOperandCount(op); v++ )
 			{
-				node->DisconnectParent();
-				RegisterMixinClass(node, script, ns);
+				short *var = ((short*)&out[start]) + 1 + v;
+				*var = short(MapInlinedVar(frame, *var));
+			}
+
+			if( GetJumpOffsetIndex(op) )
+			{
+				jumps.PushLast(start);
+				jumps.PushLast(cpos + size + int(cbc[cpos + GetJumpOffsetIndex(op)]));
 			}
+			cpos += size;
 		}
+		calleeMap[retPos] = out.GetLength();
 
-		node = next;
-	}
-}
+		// Translate the jumps within the inlined code to the caller's positions
+		for( asUINT j = firstJump; j < jumps.GetLength(); j += 2 )
+		{
+			asEBCInstr op = asEBCInstr(*(asBYTE*)&out[jumps[j]]);
+			asUINT end = jumps[j] + asBCTypeSize[asBCInfo[op].type];
+			out[jumps[j] + GetJumpOffsetIndex(op)] = asDWORD(int(calleeMap[jumps[j+1]]) - int(end));
+		}
+		jumps.SetLength(firstJump);
 
-void asCBuilder::RegisterNamespaceVisibility(asCScriptNode* node, asCScriptCode* script, asSNameSpace* ns)
-{
-	asASSERT(node->nodeType == snScript);
+		// Restore the caller's line number after the inlined code
+		AddInlinedLine(lines, lineSections, out.GetLength(), callerLine, callerSection);
 
-	node = node->firstChild;
-	// First, register all namespaces
-	while ( node )
-	{
-		asCScriptNode* next = node->next;
-		if ( node->nodeType == snNamespace )
-		{
-			asCString nsName;
-			nsName.Assign(&script->code[node->firstChild->tokenPos], node->firstChild->tokenLength);
-			if ( ns->name != "" )
-				nsName = ns->name + "::" + nsName;
+		// The call no longer holds a reference to the function
+		callee->ReleaseInternal();
 
-			asSNameSpace* nsChild = engine->AddNameSpace(nsName.AddressOf());
-			RegisterNamespaceVisibility(node->lastChild, script, nsChild);
-		}
-		else if ( node->nodeType == snUsing )
-		{
-			node->DisconnectParent();
-			RegisterUsingNamespace(node, script, ns);
-		}
-		node = next;
+		n++;
+		site++;
 	}
-}
+	posMap[length] = out.GetLength();
 
-// TODO: using: review
-void asCBuilder::AddVisibleNamespaces(asSNameSpace *ns, const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending)
-{
-	asSMapNode<asSNameSpace*, asCArray<asSNameSpace*>>* cursor = 0;
+	// Any remaining line numbers refer to the end of the function
+	for( ; lineIdx < oldLines.GetLength(); lineIdx += 2 )
+		AddInlinedLine(lines, lineSections, out.GetLength(), oldLines[lineIdx+1], callerSection);
 
-	if (namespaceVisibility.MoveTo(&cursor, ns))
+	// Update the jumps in the caller's code
+	for( n = 0; n < jumps.GetLength(); n += 2 )
 	{
-		asCArray<asSNameSpace*>& visibilityBuffer = namespaceVisibility.GetValue(cursor);
-		asUINT count = visibilityBuffer.GetLength();
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&out[jumps[n]]);
+		asUINT end = jumps[n] + asBCTypeSize[asBCInfo[op].type];
+		out[jumps[n] + GetJumpOffsetIndex(op)] = asDWORD(int(posMap[jumps[n+1]]) - int(end));
+	}
 
-		for (asUINT i = 0; i < count; ++i)
-		{
-			asSNameSpace* visibleNameSpace = visibilityBuffer[i];
-			if (!visited.Exists(visibleNameSpace) && !pending.Exists(visibleNameSpace))
-			{
-				pending.PushLast(visibleNameSpace);
-			}
-		}
+	// Update the positions in the debug information
+	for( n = 0; n < func->scriptData->objVariableInfo.GetLength(); n++ )
+	{
+		asSObjectVariableInfo &info = func->scriptData->objVariableInfo[n];
+		info.programPos = posMap[info.programPos];
+	}
+	for( n = 0; n < func->scriptData->variables.GetLength(); n++ )
+	{
+		asSScriptVariable *var = func->scriptData->variables[n];
+		var->declaredAtProgramPos = posMap[var->declaredAtProgramPos];
 	}
-}
 
-// TODO: using: review
-asSNameSpace *asCBuilder::FindNextVisibleNamespace(const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending, asSNameSpace *parentNs, bool* checkAmbiguous)
-{
-	// First iterate through all pending namespaces that have been included with 'using namespace'
-	asSNameSpace* nextNs = 0;
-	while ( pending.GetLength() != 0 )
+	func->scriptData->lineNumbers = lines;
+	func->scriptData->sectionIdxs.SetLength(0);
+	int lastIdx = func->scriptData->scriptSectionIdx;
+	for( n = 0; n < lineSections.GetLength(); n++ )
 	{
-		asSNameSpace *candidate = pending.PopLast();
-		if (!visited.Exists(candidate))
+		if( lineSections[n] != lastIdx )
 		{
-			nextNs = candidate;
-			break;
+			lastIdx = lineSections[n];
+			func->scriptData->sectionIdxs.PushLast(lines[n*2]);
+			func->scriptData->sectionIdxs.PushLast(lastIdx);
 		}
 	}
 
-	// Even if the parent namespace has already been visited, it still needs to be traversed
-	if (nextNs == 0)
-		nextNs = parentNs;
-
-	if (checkAmbiguous && !(*checkAmbiguous))
-		*checkAmbiguous = nextNs == engine->nameSpaces[0];
-
-	return nextNs;
+	bc = out;
+	func->scriptData->variableSpace += frameSize;
+	func->scriptData->stackNeeded += frameSize;
 }
 
-void asCBuilder::RegisterNonTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns)
+#ifndef AS_NO_THREADS
+asUINT asCBuilder::CompileFunctionsInParallel()
 {
-	node = node->firstChild;
-	while( node )
+	TimeIt("asCBuilder::CompileFunctionsInParallel");
+
+	// The workers compile against the engine as it is now, and a function that would
+	// need to modify it, e.g. to create a new template instance or register a lambda,
+	// is deferred and compiled again by this thread. As the functions are committed
+	// in the original order the result is the same as when compiling them one by one.
+	// Lambdas found by this thread are added after these and compiled serially.
+	asUINT count = functions.GetLength();
+	asUINT n;
+	for( n = 0; n < count; n++ )
 	{
-		asCScriptNode *next = node->next;
-		if( node->nodeType == snNamespace )
-		{
-			// Determine the name of the namespace
-			asCString nsName;
-			nsName.Assign(&script->code[node->firstChild->tokenPos], node->firstChild->tokenLength);
-			if( ns->name != "" )
-				nsName = ns->name + "::" + nsName;
+		sCompileTask *task = asNEW(sCompileTask);
+		if( task == 0 )
+			break;
+		task->func = functions[n];
+		compileTasks.PushLast(task);
+	}
 
-			// Declare the namespace, then add the entities
-			asSNameSpace *nsChild = engine->AddNameSpace(nsName.AddressOf());
-			RegisterNonTypesFromScript(node->lastChild, script, nsChild);
+	// Out of memory, fall back to compiling the functions serially
+	if( compileTasks.GetLength() < count )
+	{
+		for( n = 0; n < compileTasks.GetLength(); n++ )
+			asDELETE(compileTasks[n], sCompileTask);
+		compileTasks.SetLength(0);
+		return 0;
+	}
+
+	// Prepare what is otherwise initialized on demand, so the workers don't have to
+	DoesTypeExist("");
+	asSMapNode<asSNameSpaceNamePair, asCTypeInfo*> *cursor;
+	engine->allRegisteredTypes.MoveFirst(&cursor);
+	while( cursor )
+	{
+		if( CastToTypedefType(cursor->value) == 0 )
+			engine->GetTypeIdFromDataType(asCDataType::CreateType(cursor->value, false));
+		engine->allRegisteredTypes.MoveNext(&cursor, cursor);
+	}
+	for( n = 0; n < engine->templateInstanceTypes.GetLength(); n++ )
+		if( engine->templateInstanceTypes[n] )
+			engine->GetTypeIdFromDataType(asCDataType::CreateType(engine->templateInstanceTypes[n], false));
+	for( n = 0; n < engine->listPatternTypes.GetLength(); n++ )
+		engine->GetTypeIdFromDataType(asCDataType::CreateType(engine->listPatternTypes[n], false));
+	for( n = 0; n < engine->funcDefs.GetLength(); n++ )
+		engine->GetTypeIdFromDataType(asCDataType::CreateType(engine->funcDefs[n], false));
+	for( n = 0; n < module->m_classTypes.GetLength(); n++ )
+		engine->GetTypeIdFromDataType(asCDataType::CreateType(module->m_classTypes[n], false));
+	for( n = 0; n < module->m_enumTypes.GetLength(); n++ )
+		engine->GetTypeIdFromDataType(asCDataType::CreateType(module->m_enumTypes[n], false));
+
+	// The deferred functions are given to the workers again after the first of them has been compiled
+	// here, as it may have created what the others needed. The workers stop early when most of what
+	// they compile is deferred, and if a round still wastes more work than it does the remaining
+	// functions are compiled serially. Too few functions for the workers to be worth it are also
+	// compiled serially.
+	asUINT next = 0;
+	asUINT numPoorRounds = 0;
+	while( next < count )
+	{
+		asUINT numPending = 0;
+		for( n = next; n < count; n++ )
+		{
+			if( compileTasks[n]->isDeferred )
+				DiscardCompiledFunction(compileTasks[n]);
+			if( !compileTasks[n]->isCompiled )
+				numPending++;
+		}
+
+		if( numPoorRounds < 2 && numPending >= engine->ep.compileParallelMinFunctions )
+		{
+			nextCompileTask.set(next);
+			numRoundCompiled = 0;
+			numRoundDeferred = 0;
+			engine->workerPoolFunc(CompileFunctionsTask, this, engine->workerPoolSize, engine->workerPoolParam);
+
+			if( numRoundCompiled < numRoundDeferred )
+				numPoorRounds++;
+			else
+				numPoorRounds = 0;
 		}
 		else
+			numPoorRounds = 2;
+
+		// Commit the functions in order up to the first one that must be compiled here
+		for( ; next < count; next++ )
 		{
-			node->DisconnectParent();
-			if( node->nodeType == snFunction )
-				RegisterScriptFunctionFromNode(node, script, 0, false, true, ns);
-			else if( node->nodeType == snDeclaration )
-				RegisterGlobalVar(node, script, ns);
-			else if( node->nodeType == snVirtualProperty )
-				RegisterVirtualProperty(node, script, 0, false, true, ns);
-			else if( node->nodeType == snImport )
-				RegisterImportedFunction(module->GetNextImportedFunctionId(), node, script, ns);
-			else
+			sCompileTask *task = compileTasks[next];
+			if( task->isDeferred )
+				DiscardCompiledFunction(task);
+
+			if( task->isCompiled )
 			{
-				// Unused script node
-				int r, c;
-				script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+				CommitFunction(task);
+				continue;
+			}
 
-				WriteWarning(script->name, TXT_UNUSED_SCRIPT_NODE, r, c);
+			CompileFunction(task->func);
+			task->isCompiled = true;
 
-				node->Destroy(engine);
+			// Let the workers try the remaining functions again
+			if( numPoorRounds < 2 )
+			{
+				next++;
+				break;
 			}
 		}
-
-		node = next;
 	}
+
+	for( n = 0; n < count; n++ )
+		asDELETE(compileTasks[n], sCompileTask);
+	compileTasks.SetLength(0);
+
+	return count;
 }
 
-void asCBuilder::CompileFunctions()
+void asCBuilder::CompileFunctionsTask(asUINT worker, void *param)
 {
-	// Compile each function
-	for( asUINT n = 0; n < functions.GetLength(); n++ )
+	UNUSED_VAR(worker);
+	asCBuilder *builder = reinterpret_cast<asCBuilder*>(param);
+
+	// The tasks are taken in order, so each worker gets a fair share even if the functions differ in size
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	asUINT numCompiled = 0, numDeferred = 0;
+	for( ;; )
 	{
-		sFunctionDescription *current = functions[n];
-		if( current == 0 ) continue;
+		// Leave the rest for the next round when most functions need the builder's thread
+		if( numDeferred > numCompiled )
+			break;
 
-		// Don't compile the function again if it was an existing shared function
-		if( current->isExistingShared ) continue;
+		asUINT n = builder->nextCompileTask.atomicInc() - 1;
+		if( n >= builder->compileTasks.GetLength() )
+			break;
 
-		// Don't compile if there is no statement block
-		if (current->node && !(current->node->nodeType == snStatementBlock || current->node->lastChild->nodeType == snStatementBlock))
+		sCompileTask *task = builder->compileTasks[n];
+		if( task->isCompiled )
 			continue;
 
-		asCCompiler compiler(engine);
-		asCScriptFunction *func = engine->scriptFunctions[current->funcId];
-
-		// Find the class declaration for constructors
-		sClassDeclaration *classDecl = 0;
-		if( current->objType && current->name == current->objType->name )
-		{
-			for( asUINT c = 0; c < classDeclarations.GetLength(); c++ )
-			{
-				if( classDeclarations[c]->typeInfo == current->objType )
-				{
-					classDecl = classDeclarations[c];
-					break;
-				}
-			}
+		tld->compileTask = task;
+		builder->CompileFunction(task->func);
+		tld->compileTask = 0;
 
-			asASSERT( classDecl );
-		}
+		task->isCompiled = true;
+		if( task->isDeferred )
+			numDeferred++;
+		else
+			numCompiled++;
+	}
 
-		if( current->node )
-		{
-			int r, c;
-			current->script->ConvertPosToRowCol(current->node->tokenPos, &r, &c);
+	ENTERCRITICALSECTION(builder->compileCs);
+	builder->numRoundCompiled += numCompiled;
+	builder->numRoundDeferred += numDeferred;
+	LEAVECRITICALSECTION(builder->compileCs);
 
-			asCString str = func->GetDeclarationStr();
-			str.Format(TXT_COMPILING_s, str.AddressOf());
-			WriteInfo(current->script->name, str, r, c, true);
+	// Don't keep the memory in threads that may not build anything else
+	asCMemoryMgr::FreeThreadArenas();
+}
 
-			// When compiling a constructor need to pass the class declaration for member initializations
-			compiler.CompileFunction(this, current->script, current->paramNames, current->node, func, classDecl);
+void asCBuilder::DiscardCompiledFunction(sCompileTask *task)
+{
+	// Forget what the worker did before the function was deferred
+	asCScriptFunction *func = task->func ? engine->scriptFunctions[task->func->funcId] : 0;
+	if( func && func->scriptData )
+	{
+		for( asUINT n = 0; n < func->scriptData->variables.GetLength(); n++ )
+			asDELETE(func->scriptData->variables[n], asSScriptVariable);
+		func->scriptData->variables.SetLength(0);
+		func->scriptData->byteCode.SetLength(0);
+		func->scriptData->objVariableInfo.SetLength(0);
+		func->scriptData->tryCatchInfo.SetLength(0);
+		func->scriptData->lineNumbers.SetLength(0);
+		func->scriptData->sectionIdxs.SetLength(0);
+		func->scriptData->variableSpace = 0;
+		func->scriptData->stackNeeded = 0;
+	}
+
+	task->isCompiled  = false;
+	task->isDeferred  = false;
+	task->numWarnings = 0;
+	task->preMessage.isSet = false;
+	task->messages.SetLength(0);
+	ReleaseStringConstants(task);
+}
 
-			engine->preMessage.isSet = false;
-		}
-		else if( current->objType && current->name == current->objType->name )
+void asCBuilder::CommitFunction(sCompileTask *task)
+{
+	// Write the messages as they would have been written if the function was compiled by this thread
+	if( task->messages.GetLength() )
+	{
+		engine->preMessage = task->preMessage;
+		for( asUINT n = 0; n < task->messages.GetLength(); n++ )
 		{
-			asCScriptNode *node = classDecl ? classDecl->node : 0;
-
-			if (func->parameterTypes.GetLength() == 0)
-			{
-				int r = 0, c = 0;
-				if (node)
-					current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
-
-				asCString str = func->GetDeclarationStr();
-				str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
-				WriteInfo(current->script->name, str, r, c, true);
-
-				// This is the default constructor that is generated
-				// automatically if not implemented by the user.
-				r = compiler.CompileDefaultConstructor(this, current->script, node, func, classDecl);
-			}
-			else
-			{
-				asASSERT(func->parameterTypes.GetLength() == 1 && func->parameterTypes[0].GetTypeInfo() == current->objType);
+			sDeferredMessage &m = task->messages[n];
+			WriteMessage(m.scriptname, m.r, m.c, m.type, m.msg);
+		}
+		engine->preMessage.isSet = false;
+	}
+	numWarnings += task->numWarnings;
 
-				int r = 0, c = 0;
-				if (node)
-					current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+	// The references to what the bytecode uses are added by the builder's thread, as
+	// the string factory, for one, isn't required to be thread safe
+	asCScriptFunction *func = task->func ? engine->scriptFunctions[task->func->funcId] : 0;
+	if( func && func->scriptData && func->scriptData->byteCode.GetLength() )
+		func->AddReferences();
+	ReleaseStringConstants(task);
+}
 
-				asCString str = func->GetDeclarationStr();
-				str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
-				WriteInfo(current->script->name, str, r, c, true);
+void asCBuilder::ReleaseStringConstants(sCompileTask *task)
+{
+	// The compiler's references to the string constants are kept until the function's own have been added
+	asASSERT( GetCompileTask() == 0 );
+	for( asUINT n = 0; n < task->stringConstants.GetLength(); n++ )
+		engine->stringFactory->ReleaseStringConstant(task->stringConstants[n]);
+	task->stringConstants.SetLength(0);
+}
+#endif
+#endif
 
-				// This is the default copy constructor that is generated
-				// automatically if not implemented by the user.
-				r = compiler.CompileDefaultCopyConstructor(this, current->script, node, func, classDecl);
-			}
+sCompileTask *asCBuilder::GetCompileTask()
+{
+#ifndef AS_NO_COMPILER
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	return tld ? tld->compileTask : 0;
+#else
+	return 0;
+#endif
+}
 
-			engine->preMessage.isSet = false;
-		}
-		else
-		{
-			asASSERT( false );
-		}
+bool asCBuilder::CanModifySharedState()
+{
+#ifndef AS_NO_COMPILER
+	// Functions compiled in parallel must leave the engine as it is, so they can't
+	// depend on each other. The function will be compiled again by the builder's thread
+	sCompileTask *task = GetCompileTask();
+	if( task )
+	{
+		task->isDeferred = true;
+		return false;
 	}
-}
 #endif
 
+	return true;
+}
+
 // Called from module and engine
 int asCBuilder::ParseDataType(const char *datatype, asCDataType *result, asSNameSpace *implicitNamespace, bool isReturnType)
 {
@@ -1289,6 +2742,7 @@ asCGlobalProperty *asCBuilder::GetGlobalProperty(const char *prop, asSNameSpace
 	if( DoesGlobalPropertyExist(prop, ns, &globProp, &globDesc, isAppProp) )
 	{
 #ifndef AS_NO_COMPILER
+		asSMapNode<asCGlobalProperty*, asQWORD> *constNode;
 		if( globDesc )
 		{
 			// The property was declared in this build call, check if it has been compiled successfully already
@@ -1296,6 +2750,12 @@ asCGlobalProperty *asCBuilder::GetGlobalProperty(const char *prop, asSNameSpace
 			if( isPureConstant ) *isPureConstant = globDesc->isPureConstant;
 			if( constantValue  ) *constantValue  = globDesc->constantValue;
 		}
+		else if( module && module->m_constantValues.MoveTo(&constNode, globProp) )
+		{
+			// The constant was declared in a previous build of the module
+			if( isPureConstant ) *isPureConstant = true;
+			if( constantValue  ) *constantValue  = module->m_constantValues.GetValue(constNode);
+		}
 		else
 #endif
 		if( isAppProp )
@@ -2710,6 +4170,8 @@ int asCBuilder::RegisterInterface(asCScriptNode *node, asCScriptCode *file, asSN
 
 void asCBuilder::CompileGlobalVariables()
 {
+	TimeIt("asCBuilder::CompileGlobalVariables");
+
 	bool compileSucceeded = true;
 
 	// Store state of compilation (errors, warning, output)
@@ -3665,6 +5127,8 @@ void asCBuilder::CompileClasses(asUINT numTempl)
 						realFunc->AddRefInternal();
 				}
 			}
+
+			ot->SortInterfaces();
 		}
 
 		// Enumerate each of the declared properties
@@ -4227,6 +5691,32 @@ void asCBuilder::CompileClasses(asUINT numTempl)
 			// Reset the counter
 			numReevaluations = 0;
 		}
+
+		// The garbage collector can enumerate the references of script classes from
+		// multiple threads, unless they hold value types that are not registered as
+		// thread safe for this
+		for( n = 0; n < classDeclarations.GetLength(); n++ )
+		{
+			sClassDeclaration *decl = classDeclarations[n];
+			if( decl->isExistingShared ) continue;
+
+			asCObjectType *ot = CastToObjectType(decl->typeInfo);
+			if( ot->IsInterface() || !(ot->flags & asOBJ_GC) ) continue;
+
+			bool threadSafe = true;
+			for( asUINT p = 0; p < ot->properties.GetLength(); p++ )
+			{
+				asCTypeInfo *ti = ot->properties[p]->type.GetTypeInfo();
+				if( ti && (ti->flags & asOBJ_VALUE) && (ti->flags & asOBJ_GC) && !(ti->flags & asOBJ_GC_THREADSAFE) )
+				{
+					threadSafe = false;
+					break;
+				}
+			}
+
+			if( threadSafe )
+				ot->flags |= asOBJ_GC_THREADSAFE;
+		}
 	}
 }
 
@@ -4465,13 +5955,16 @@ int asCBuilder::CreateVirtualFunction(asCScriptFunction *func, int idx)
 	vf->id               = engine->GetNextScriptFunctionId();
 	vf->objectType       = func->objectType;
 	vf->objectType->AddRefInternal();
-	vf->signatureId      = func->signatureId;
 	vf->vfTableIdx       = idx;
 	vf->traits           = func->traits;
 
 	// Clear the shared trait since the virtual function should not have that
 	vf->SetShared(false);
 
+	// The virtual function gets the same signature id as the real function
+	vf->ComputeSignatureId();
+	asASSERT( vf->signatureId == func->signatureId );
+
 	// It is not necessary to copy the default args, as they have no meaning in the virtual function
 
 	module->AddScriptFunction(vf);
@@ -5222,6 +6715,10 @@ int asCBuilder::RegisterScriptFunctionFromNode(asCScriptNode *node, asCScriptCod
 
 asCScriptFunction *asCBuilder::RegisterLambda(asCScriptNode *node, asCScriptCode *file, asCScriptFunction *funcDef, const asCString &name, asSNameSpace *ns, bool isShared)
 {
+	// The lambda is registered when the function is compiled again by the builder's thread
+	if( !CanModifySharedState() )
+		return 0;
+
 	// Get the parameter names from the node
 	asCArray<asCString> parameterNames;
 	asCArray<asCString*> defaultArgs;
@@ -6055,18 +7552,28 @@ void asCBuilder::WriteInfo(const asCString &scriptname, const asCString &message
 	// Need to store the pre message in a structure
 	if( pre )
 	{
-		engine->preMessage.isSet      = true;
-		engine->preMessage.c          = c;
-		engine->preMessage.r          = r;
-		engine->preMessage.message    = message;
-		engine->preMessage.scriptname = scriptname;
+		asCScriptEngine::preMessage_t *preMessage = &engine->preMessage;
+#ifndef AS_NO_COMPILER
+		sCompileTask *task = GetCompileTask();
+		if( task )
+			preMessage = &task->preMessage;
+#endif
+		preMessage->isSet      = true;
+		preMessage->c          = c;
+		preMessage->r          = r;
+		preMessage->message    = message;
+		preMessage->scriptname = scriptname;
 	}
 	else
 	{
-		engine->preMessage.isSet = false;
+#ifndef AS_NO_COMPILER
+		// The pre message is only used by the compilation, which doesn't run in parallel like the parsing
+		if( !deferMessages && GetCompileTask() == 0 )
+#endif
+			engine->preMessage.isSet = false;
 
 		if( !silent )
-			engine->WriteMessage(scriptname.AddressOf(), r, c, asMSGTYPE_INFORMATION, message.AddressOf());
+			WriteMessage(scriptname, r, c, asMSGTYPE_INFORMATION, message);
 	}
 }
 
@@ -6090,21 +7597,60 @@ void asCBuilder::WriteError(const asCString &message, asCScriptCode *file, asCSc
 
 void asCBuilder::WriteError(const asCString &scriptname, const asCString &message, int r, int c)
 {
+#ifndef AS_NO_COMPILER
+	// The errors are reported when the function is compiled again by the builder's thread
+	sCompileTask *task = GetCompileTask();
+	if( task )
+	{
+		task->isDeferred = true;
+		return;
+	}
+#endif
+
 	numErrors++;
 
 	if( !silent )
-		engine->WriteMessage(scriptname.AddressOf(), r, c, asMSGTYPE_ERROR, message.AddressOf());
+		WriteMessage(scriptname, r, c, asMSGTYPE_ERROR, message);
 }
 
 void asCBuilder::WriteWarning(const asCString &scriptname, const asCString &message, int r, int c)
 {
 	if( engine->ep.compilerWarnings )
 	{
-		numWarnings++;
+#ifndef AS_NO_COMPILER
+		sCompileTask *task = GetCompileTask();
+		if( task )
+			task->numWarnings++;
+		else
+#endif
+			numWarnings++;
 
 		if( !silent )
-			engine->WriteMessage(scriptname.AddressOf(), r, c, asMSGTYPE_WARNING, message.AddressOf());
+			WriteMessage(scriptname, r, c, asMSGTYPE_WARNING, message);
+	}
+}
+
+void asCBuilder::WriteMessage(const asCString &scriptname, int r, int c, asEMsgType type, const asCString &message)
+{
+#ifndef AS_NO_COMPILER
+	sCompileTask *task = GetCompileTask();
+	if( deferMessages || task )
+	{
+		sDeferredMessage m;
+		m.scriptname = scriptname;
+		m.r          = r;
+		m.c          = c;
+		m.type       = type;
+		m.msg        = message;
+		if( task )
+			task->messages.PushLast(m);
+		else
+			deferredMessages.PushLast(m);
+		return;
 	}
+#endif
+
+	engine->WriteMessage(scriptname.AddressOf(), r, c, type, message.AddressOf());
 }
 
 void asCBuilder::WriteWarning(const asCString &message, asCScriptCode *file, asCScriptNode *node)
@@ -6787,7 +8333,7 @@ asCObjectType *asCBuilder::GetTemplateInstanceFromNode(asCScriptNode *node, asCS
 		// Need to find the correct object type
 		asCObjectType *otInstance = engine->GetTemplateInstanceType(templateType, subTypes, module);
 
-		if (otInstance && otInstance->scriptSectionIdx < 0)
+		if (otInstance && otInstance->scriptSectionIdx < 0 && CanModifySharedState())
 		{
 			// If this is the first time the template instance is used, store where it was declared from
 			otInstance->scriptSectionIdx = engine->GetScriptSectionNameIndex(file->name.AddressOf());
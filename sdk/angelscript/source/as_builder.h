@@ -48,6 +48,8 @@
 #include "as_scriptnode.h"
 #include "as_datatype.h"
 #include "as_property.h"
+#include "as_atomic.h"
+#include "as_criticalsection.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -132,8 +134,61 @@ struct sMixinClass
 	asSNameSpace  *ns;
 };
 
+struct sDeferredMessage
+{
+	asCString  scriptname;
+	int        r;
+	int        c;
+	asEMsgType type;
+	asCString  msg;
+};
+
+// A function that is compiled by a worker thread. The messages are kept until the
+// function is committed, so they are written in the same order as in a serial build
+struct sCompileTask
+{
+	sCompileTask() { func = 0; isCompiled = false; isDeferred = false; numWarnings = 0; }
+
+	sFunctionDescription          *func;
+	bool                           isCompiled;
+	bool                           isDeferred;
+	int                            numWarnings;
+	asCScriptEngine::preMessage_t  preMessage;
+	asCArray<sDeferredMessage>     messages;
+	asCArray<void*>                stringConstants;
+};
+
+// A function body found in a script section by an incremental build
+struct sFunctionBody
+{
+	asCScriptCode     *script;
+	asCScriptNode     *node;       // The node the function was registered with
+	asCScriptNode     *classNode;
+	size_t             blockPos;
+	size_t             blockLength;
+	int                declaredAt; // Row and column of the node, encoded like in the function
+	int                endAt;      // Row and column of the end of the statement block
+	asCScriptFunction *func;
+	bool               isRecompiled;
+};
+
+// A script section compared against the one the module was built from
+struct sIncrementalSection
+{
+	sIncrementalSection() { script = 0; oldScript = 0; isChanged = false; isParsed = false; }
+
+	asCScriptCode          *script;
+	asCScriptCode          *oldScript;
+	bool                    isChanged;
+	bool                    isParsed;
+	asCArray<sFunctionBody> bodies;
+	asCArray<sFunctionBody> oldBodies; // Only for changed sections
+};
+
 #endif // AS_NO_COMPILER
 
+class asCParser;
+
 class asCBuilder
 {
 public:
@@ -153,7 +208,12 @@ public:
 #ifndef AS_NO_COMPILER
 	int AddCode(const char *name, const char *code, int codeLength, int lineOffset, int sectionIdx, bool makeCopy);
 	asCScriptCode *FindOrAddCode(const char *name, const char *code, size_t length);
+
+	// The parsing only touches the builder, so it is done before the engine's
+	// build lock is taken. Build then registers the entities and compiles them
+	int ParseScripts();
 	int Build();
+	int BuildIncrementally(asCArray<asCScriptCode *> &sections);
 
 	int CompileFunction(const char *sectionName, const char *code, int lineOffset, asDWORD compileFlags, asCScriptFunction **outFunc);
 	int CompileGlobalVar(const char *sectionName, const char *code, int lineOffset);
@@ -163,6 +223,7 @@ protected:
 	friend class asCModule;
 	friend class asCParser;
 	friend class asCScriptFunction;
+	friend class asCFunctionSignature;
 	friend class asCScriptEngine;
 
 	void               Reset();
@@ -173,6 +234,7 @@ protected:
 	void               WriteError(const asCString &msg, asCScriptCode *file, asCScriptNode *node);
 	void               WriteWarning(const asCString &scriptname, const asCString &msg, int r, int c);
 	void               WriteWarning(const asCString &msg, asCScriptCode *file, asCScriptNode *node);
+	void               WriteMessage(const asCString &scriptname, int r, int c, asEMsgType type, const asCString &msg);
 
 	bool               DoesGlobalPropertyExist(const char *prop, asSNameSpace *ns, asCGlobalProperty **outProp = 0, sGlobalVariableDescription **outDesc = 0, bool *isAppProp = 0);
 	asCGlobalProperty *GetGlobalProperty(const char *prop, asSNameSpace *ns, bool *isCompiled, bool *isPureConstant, asQWORD *constantValue, bool *isAppProp);
@@ -192,6 +254,9 @@ protected:
 	asCObjectType     *GetTemplateInstanceFromNode(asCScriptNode *node, asCScriptCode *file, asCObjectType *templateType, asSNameSpace *implicitNamespace, asCObjectType *currentType, asCScriptNode **next = 0);
 	asCDataType        ModifyDataTypeFromNode(const asCDataType &type, asCScriptNode *node, asCScriptCode *file, asETypeModifiers *inOutFlag, bool *autoHandle);
 
+	static sCompileTask *GetCompileTask();
+	static bool        CanModifySharedState();
+
 	int numErrors;
 	int numWarnings;
 	bool silent;
@@ -234,14 +299,31 @@ protected:
 	void               AddDefaultCopyConstructor(asCObjectType *objType, asCScriptCode *file);		
 	asCObjectProperty *AddPropertyToClass(sClassDeclaration *c, const asCString &name, const asCDataType &type, bool isPrivate, bool isProtected, bool isInherited, asCScriptCode *file = 0, asCScriptNode *node = 0);
 	int                CreateVirtualFunction(asCScriptFunction *func, int idx);
-	void               ParseScripts();
+	void               RegisterDeclarations();
+	void               WriteDeferredMessages();
 	void               RegisterTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
 	void               RegisterNamespaceVisibility(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
 	void               AddVisibleNamespaces(asSNameSpace *ns, const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending);
 	asSNameSpace      *FindNextVisibleNamespace(const asCArray<asSNameSpace*>& visited, asCArray<asSNameSpace*>& pending, asSNameSpace *parentNs, bool* checkAmbiguous = 0);
 	void               RegisterNonTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
 	void               CompileFunctions();
+	void               CompileFunction(sFunctionDescription *current);
+	void               InlineFunctionCalls();
+	void               InlineFunctionCalls(asCScriptFunction *func);
+	bool               CanInlineFunction(asCScriptFunction *func);
+	asUINT             CompileFunctionsInParallel();
+	void               DiscardCompiledFunction(sCompileTask *task);
+	void               CommitFunction(sCompileTask *task);
+	void               ReleaseStringConstants(sCompileTask *task);
+	static void        CompileFunctionsTask(asUINT worker, void *param);
 	void               CompileGlobalVariables();
+	int                ParseIncrementalSection(sIncrementalSection *section);
+	bool               FindFunctionBodies(asCScriptNode *node, asCScriptCode *script, asCScriptNode *classNode, asCArray<sFunctionBody> &bodies);
+	int                FindFunctionBody(sIncrementalSection *section, int rowCol, bool inOldCode);
+	int                MatchFunctionBodies(sIncrementalSection *section);
+	int                MarkForRecompilation(sIncrementalSection *section, asUINT bodyIdx, asCArray<sFunctionBody*> &recompile, asCArray<asCScriptFunction*> &replaced);
+	sClassDeclaration *CreateClassDeclaration(asCScriptNode *node, asCScriptCode *script, asCObjectType *objType);
+	int                RemapRowCol(sIncrementalSection *section, int rowCol);
 	int                GetEnumValueFromType(asCEnumType *type, const char *name, asCDataType &outDt, asINT64 &outValue);
 	int                GetEnumValue(const char *name, asCDataType &outDt, asINT64 &outValue, asSNameSpace *ns);
 	bool               DoesTypeExist(const asCString &type);
@@ -261,10 +343,24 @@ protected:
 	asCArray<sClassDeclaration *>                     namedTypeDeclarations;
 	asCArray<sFuncDef *>                              funcDefs;
 	asCArray<sMixinClass *>                           mixinClasses;
+	asCArray<asCParser *>                             parsers;
+
+	// The messages written while parsing are held back until the build lock
+	// is taken, so the message callback is never invoked by two threads at once
+	bool                       deferMessages;
+	asCArray<sDeferredMessage> deferredMessages;
 
 	// For use with the DoesTypeExists() method
 	bool                    hasCachedKnownTypes;
 	asCMap<asCString, bool> knownTypes;
+
+	// The functions compiled by the worker pool. The lock protects
+	// what the workers share with each other besides the engine
+	asCArray<sCompileTask *> compileTasks;
+	asCAtomic                nextCompileTask;
+	asUINT                   numRoundCompiled;
+	asUINT                   numRoundDeferred;
+	DECLARECRITICALSECTION(compileCs)
 #endif
 };
 
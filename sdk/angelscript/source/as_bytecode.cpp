@@ -56,8 +56,12 @@ asCByteCode::asCByteCode(asCScriptEngine *engine)
 	last  = 0;
 	largestStackUsed = -1;
 	temporaryVariables = 0;
+	isLabelIndexValid = false;
 
 	this->engine = engine;
+
+	// The instructions are allocated from the arena of the compiling thread
+	pool = asCMemoryMgr::GetByteInstructionArena();
 }
 
 asCByteCode::~asCByteCode()
@@ -75,6 +79,19 @@ void asCByteCode::Finalize(const asCArray<int> &tempVariableOffsets)
 	// Optimize the code
 	Optimize();
 
+	// The data flow optimizations take more time, so they are only done when asked for
+	if( engine->ep.optimizeByteCode && engine->ep.optimizeByteCodeLevel >= 2 )
+	{
+		OptimizeDataFlow();
+
+		// Clean up what may have been left behind, e.g. jumps to the next instruction
+		Optimize();
+	}
+
+	// The fused instructions are not understood by the optimizations, so this must be done last
+	if( engine->ep.optimizeByteCode )
+		FuseInstructions();
+
 	// Resolve jumps
 	ResolveJumpAddresses();
 
@@ -89,13 +106,16 @@ void asCByteCode::ClearAll()
 	while( del )
 	{
 		first = del->next;
-		engine->memoryMgr.FreeByteInstruction(del);
+		pool->Free(del);
 		del = first;
 	}
 
 	first = 0;
 	last = 0;
 
+	labelIndex.SetLength(0);
+	isLabelIndexValid = false;
+
 	lineNumbers.SetLength(0);
 
 	largestStackUsed = -1;
@@ -233,22 +253,6 @@ void asCByteCode::ExchangeVar(int oldOffset, int newOffset)
 	}
 }
 
-void asCByteCode::AddPath(asCArray<asCByteInstruction *> &paths, asCByteInstruction *instr, int stackSize)
-{
-	if( instr->marked )
-	{
-		// Verify the size of the stack
-		asASSERT(instr->stackSize == stackSize);
-	}
-	else
-	{
-		// Add the destination to the code paths
-		instr->marked = true;
-		instr->stackSize = stackSize;
-		paths.PushLast(instr);
-	}
-}
-
 asCByteInstruction *asCByteCode::ChangeFirstDeleteNext(asCByteInstruction *curr, asEBCInstr bc)
 {
 	curr->op = bc;
@@ -1190,6 +1194,787 @@ void asCByteCode::Optimize()
 	}
 }
 
+// The variables that are analysed by the data flow optimizations
+struct sDataFlowVars
+{
+	// The index of the variable at each offset, counted from firstOffset, or -1 if the variable is not analysed
+	int           firstOffset;
+	asCArray<int> index;
+
+	// The offset of each analysed variable
+	asCArray<short> offsets;
+
+	int Index(int offset) const
+	{
+		offset -= firstOffset;
+		if( offset < 0 || asUINT(offset) >= index.GetLength() )
+			return -1;
+		return index[offset];
+	}
+};
+
+// How an instruction that works on 32bit values accesses the variables
+struct sDataFlowOperands
+{
+	bool   hasDef;    // The instruction writes to the variable in wArg[0]
+	bool   isUpdate;  // The instruction also reads the variable in wArg[0] before writing it
+	asUINT numUses;
+	asUINT useArg[2]; // The wArg that hold the other variables that are read
+};
+
+// Returns false if the instruction is not one of those the data flow optimizations
+// understand. The variables used by any other instruction are not analysed at all
+static bool GetDataFlowOperands(const asCByteInstruction *instr, sDataFlowOperands &ops)
+{
+	ops.hasDef   = false;
+	ops.isUpdate = false;
+	ops.numUses  = 0;
+
+	switch( instr->op )
+	{
+	case asBC_SetV4:
+	case asBC_CpyRtoV4:
+	case asBC_CpyGtoV4:
+	case asBC_RDR4:
+	case asBC_LdGRdR4:
+		ops.hasDef = true;
+		break;
+
+	case asBC_CpyVtoV4:
+	case asBC_ADDIi:
+	case asBC_SUBIi:
+	case asBC_MULIi:
+	case asBC_ADDIf:
+	case asBC_SUBIf:
+	case asBC_MULIf:
+		ops.hasDef = true;
+		ops.useArg[ops.numUses++] = 1;
+		break;
+
+	case asBC_ADDi:
+	case asBC_SUBi:
+	case asBC_MULi:
+	case asBC_DIVi:
+	case asBC_MODi:
+	case asBC_DIVu:
+	case asBC_MODu:
+	case asBC_ADDf:
+	case asBC_SUBf:
+	case asBC_MULf:
+	case asBC_DIVf:
+	case asBC_MODf:
+	case asBC_BAND:
+	case asBC_BOR:
+	case asBC_BXOR:
+	case asBC_BSLL:
+	case asBC_BSRL:
+	case asBC_BSRA:
+		ops.hasDef = true;
+		ops.useArg[ops.numUses++] = 1;
+		ops.useArg[ops.numUses++] = 2;
+		break;
+
+	case asBC_IncVi:
+	case asBC_DecVi:
+	case asBC_NEGi:
+	case asBC_NEGf:
+	case asBC_BNOT:
+	case asBC_iTOf:
+	case asBC_fTOi:
+	case asBC_uTOf:
+	case asBC_fTOu:
+	case asBC_sbTOi:
+	case asBC_swTOi:
+	case asBC_ubTOi:
+	case asBC_uwTOi:
+		ops.hasDef   = true;
+		ops.isUpdate = true;
+		break;
+
+	case asBC_CMPi:
+	case asBC_CMPu:
+	case asBC_CMPf:
+		ops.useArg[ops.numUses++] = 0;
+		ops.useArg[ops.numUses++] = 1;
+		break;
+
+	case asBC_PshV4:
+	case asBC_CpyVtoR4:
+	case asBC_CpyVtoG4:
+	case asBC_WRTV4:
+	case asBC_CMPIi:
+	case asBC_CMPIu:
+	case asBC_CMPIf:
+		ops.useArg[ops.numUses++] = 0;
+		break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+// Returns true if the only effect of the instruction is the value it writes to the variable
+static bool IsDataFlowDefRemovable(asEBCInstr op)
+{
+	switch( op )
+	{
+	// A division may raise an exception
+	case asBC_DIVi:
+	case asBC_MODi:
+	case asBC_DIVu:
+	case asBC_MODu:
+	case asBC_DIVf:
+	case asBC_MODf:
+	// These also set the value register or read from it
+	case asBC_RDR4:
+	case asBC_LdGRdR4:
+		return false;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+// Gives the offsets of the variables that any instruction refers to
+static asUINT GetVarOffsets(const asCByteInstruction *instr, short *offsets)
+{
+	switch( asBCInfo[instr->op].type )
+	{
+	case asBCTYPE_wW_rW_rW_ARG:
+		offsets[0] = instr->wArg[0];
+		offsets[1] = instr->wArg[1];
+		offsets[2] = instr->wArg[2];
+		return 3;
+
+	case asBCTYPE_wW_rW_ARG:
+	case asBCTYPE_rW_rW_ARG:
+	case asBCTYPE_wW_rW_DW_ARG:
+		offsets[0] = instr->wArg[0];
+		offsets[1] = instr->wArg[1];
+		return 2;
+
+	case asBCTYPE_rW_ARG:
+	case asBCTYPE_wW_ARG:
+	case asBCTYPE_wW_W_ARG:
+	case asBCTYPE_rW_W_DW_ARG:
+	case asBCTYPE_rW_DW_ARG:
+	case asBCTYPE_wW_DW_ARG:
+	case asBCTYPE_wW_QW_ARG:
+	case asBCTYPE_rW_QW_ARG:
+	case asBCTYPE_rW_DW_DW_ARG:
+		offsets[0] = instr->wArg[0];
+		return 1;
+
+	default:
+		break;
+	}
+
+	// The object pointer is always in the variable at offset 0
+	if( instr->op == asBC_LoadThisR )
+	{
+		offsets[0] = 0;
+		return 1;
+	}
+
+	if( instr->op == asBC_ObjInfo )
+	{
+		offsets[0] = instr->wArg[0];
+		return 1;
+	}
+
+	return 0;
+}
+
+// Computes the value that the instruction writes when the values it reads are known constants
+static bool EvaluateDataFlowConst(const asCByteInstruction *instr, const sDataFlowVars &vars, const asBYTE *isConst, const asDWORD *values, asDWORD &result)
+{
+	asDWORD a = 0, b = 0;
+	switch( asBCInfo[instr->op].type )
+	{
+	case asBCTYPE_wW_rW_rW_ARG:
+	{
+		int ia = vars.Index(instr->wArg[1]);
+		int ib = vars.Index(instr->wArg[2]);
+		if( ia < 0 || ib < 0 || !isConst[ia] || !isConst[ib] )
+			return false;
+		a = values[ia];
+		b = values[ib];
+		break;
+	}
+	case asBCTYPE_wW_rW_ARG:
+	case asBCTYPE_wW_rW_DW_ARG:
+	{
+		int ia = vars.Index(instr->wArg[1]);
+		if( ia < 0 || !isConst[ia] )
+			return false;
+		a = values[ia];
+		b = *ARG_DW(instr->arg);
+		break;
+	}
+	case asBCTYPE_rW_ARG:
+	{
+		int ia = vars.Index(instr->wArg[0]);
+		if( ia < 0 || !isConst[ia] )
+			return false;
+		a = values[ia];
+		break;
+	}
+	default:
+		return false;
+	}
+
+	// The arithmetic is done on unsigned values, which
+	// gives the same result as the two's complement ints
+	switch( instr->op )
+	{
+	case asBC_CpyVtoV4: result = a;           break;
+	case asBC_ADDi:
+	case asBC_ADDIi:    result = a + b;       break;
+	case asBC_SUBi:
+	case asBC_SUBIi:    result = a - b;       break;
+	case asBC_MULi:
+	case asBC_MULIi:    result = a * b;       break;
+	case asBC_BAND:     result = a & b;       break;
+	case asBC_BOR:      result = a | b;       break;
+	case asBC_BXOR:     result = a ^ b;       break;
+	case asBC_IncVi:    result = a + 1;       break;
+	case asBC_DecVi:    result = a - 1;       break;
+	case asBC_NEGi:     result = asDWORD(0) - a; break;
+	case asBC_BNOT:     result = ~a;          break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+// Updates the known values after the instruction has been executed
+static void TransferDataFlowValues(const asCByteInstruction *instr, const sDataFlowVars &vars, asBYTE *isConst, asDWORD *values, int *copyOf)
+{
+	sDataFlowOperands ops;
+	if( !GetDataFlowOperands(instr, ops) || !ops.hasDef )
+		return;
+
+	int d = vars.Index(instr->wArg[0]);
+	if( d < 0 )
+		return;
+
+	asDWORD result = 0;
+	bool isResultConst = false;
+	int source = -1;
+	if( instr->op == asBC_SetV4 )
+	{
+		result = *ARG_DW(instr->arg);
+		isResultConst = true;
+	}
+	else
+	{
+		isResultConst = EvaluateDataFlowConst(instr, vars, isConst, values, result);
+		if( instr->op == asBC_CpyVtoV4 && instr->wArg[1] != instr->wArg[0] )
+			source = vars.Index(instr->wArg[1]);
+	}
+
+	// The variables that were copies of the old value are no longer so
+	const int numVars = int(vars.offsets.GetLength());
+	for( int n = 0; n < numVars; n++ )
+		if( copyOf[n] == d )
+			copyOf[n] = -1;
+
+	copyOf[d] = source;
+	isConst[d] = isResultConst ? 1 : 0;
+	values[d] = isResultConst ? result : 0;
+}
+
+static void ChangeDataFlowInstr(asCByteInstruction *instr, asEBCInstr op)
+{
+	instr->op       = op;
+	instr->size     = asBCTypeSize[asBCInfo[op].type];
+	instr->stackInc = asBCInfo[op].stackInc;
+}
+
+// Replaces the variables read by the instruction with the known constants or the
+// variables they are copies of. Returns true if the instruction was changed
+static bool RewriteDataFlowUses(asCByteInstruction *instr, const sDataFlowVars &vars, const asBYTE *isConst, const asDWORD *values, const int *copyOf)
+{
+	sDataFlowOperands ops;
+	if( !GetDataFlowOperands(instr, ops) )
+		return false;
+
+	// Store the resulting value directly if all the input is known
+	asDWORD result;
+	if( ops.hasDef && EvaluateDataFlowConst(instr, vars, isConst, values, result) )
+	{
+		ChangeDataFlowInstr(instr, asBC_SetV4);
+		instr->wArg[1] = 0;
+		instr->wArg[2] = 0;
+		instr->arg = 0;
+		*ARG_DW(instr->arg) = result;
+		return true;
+	}
+
+	bool changed = false;
+	for( asUINT u = 0; u < ops.numUses; u++ )
+	{
+		const asUINT w = ops.useArg[u];
+		int v = vars.Index(instr->wArg[w]);
+		if( v < 0 )
+			continue;
+
+		if( isConst[v] )
+		{
+			// Use the variants of the instructions that take the constant as argument
+			asEBCInstr op = asBC_MAXBYTECODE;
+			if( w == 0 && instr->op == asBC_PshV4 )
+				op = asBC_PshC4;
+			else if( w == 1 && (instr->op == asBC_CMPi || instr->op == asBC_CMPu || instr->op == asBC_CMPf) )
+				op = instr->op == asBC_CMPi ? asBC_CMPIi : instr->op == asBC_CMPu ? asBC_CMPIu : asBC_CMPIf;
+			else if( w == 2 || (w == 1 && (instr->op == asBC_ADDi || instr->op == asBC_MULi ||
+			                               instr->op == asBC_ADDf || instr->op == asBC_MULf)) )
+			{
+				switch( instr->op )
+				{
+				case asBC_ADDi: op = asBC_ADDIi; break;
+				case asBC_SUBi: op = asBC_SUBIi; break;
+				case asBC_MULi: op = asBC_MULIi; break;
+				case asBC_ADDf: op = asBC_ADDIf; break;
+				case asBC_SUBf: op = asBC_SUBIf; break;
+				case asBC_MULf: op = asBC_MULIf; break;
+				default: break;
+				}
+
+				// The order of the operands doesn't matter for addition and multiplication
+				if( op != asBC_MAXBYTECODE && w == 1 )
+					instr->wArg[1] = instr->wArg[2];
+			}
+
+			if( op != asBC_MAXBYTECODE )
+			{
+				asDWORD value = values[v];
+				ChangeDataFlowInstr(instr, op);
+				if( op == asBC_PshC4 )
+					instr->wArg[0] = 0;
+				else if( asBCInfo[op].type == asBCTYPE_wW_rW_DW_ARG )
+					instr->wArg[2] = 0;
+				else
+					instr->wArg[1] = 0;
+				instr->arg = 0;
+				*ARG_DW(instr->arg) = value;
+				return true;
+			}
+		}
+
+		if( copyOf[v] >= 0 )
+		{
+			instr->wArg[w] = vars.offsets[copyOf[v]];
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+// Returns true if the instruction jumps depending on the value register
+static bool IsConditionalJump(asEBCInstr op)
+{
+	return op == asBC_JZ || op == asBC_JNZ ||
+	       op == asBC_JS || op == asBC_JNS ||
+	       op == asBC_JP || op == asBC_JNP;
+}
+
+void asCByteCode::OptimizeDataFlow()
+{
+	// This function performs the optimizations that need to know which values the variables
+	// may hold at each point in the function. Only the variables with 32bit values that are
+	// never accessed by reference are analysed
+
+	TimeIt("asCByteCode::OptimizeDataFlow");
+
+	if( first == 0 )
+		return;
+
+	sDataFlowVars vars;
+	if( !FindDataFlowVars(vars) )
+		return;
+
+	// Each pass may give new opportunities for the other, but the most are found in the first round
+	sByteCodeGraph graph;
+	for( int round = 0; round < 4; round++ )
+	{
+		BuildControlFlowGraph(graph);
+
+		// The analysis keeps the state of each variable for each block,
+		// so it is not done for really big functions with many variables
+		if( asQWORD(graph.blocks.GetLength()) * vars.offsets.GetLength() > (1<<20) )
+			return;
+
+		bool foldedJumps = false;
+		bool changed = PropagateValues(graph, vars, foldedJumps);
+
+		// Remove the code that can no longer be reached
+		if( foldedJumps )
+			PostProcess();
+
+		BuildControlFlowGraph(graph);
+		if( RemoveDeadStores(graph, vars) )
+			changed = true;
+
+		if( !changed )
+			break;
+	}
+}
+
+bool asCByteCode::FindDataFlowVars(sDataFlowVars &vars)
+{
+	// Find the range of the variable offsets
+	int minOffset = 0, maxOffset = 0;
+	for( asCByteInstruction *instr = first; instr; instr = instr->next )
+	{
+		// The exception handler may read the variables at any point in
+		// a try block, which the control flow graph doesn't show
+		if( instr->op == asBC_TryBlock )
+			return false;
+
+		short offsets[3];
+		asUINT count = GetVarOffsets(instr, offsets);
+		for( asUINT n = 0; n < count; n++ )
+		{
+			if( offsets[n] < minOffset ) minOffset = offsets[n];
+			if( offsets[n] > maxOffset ) maxOffset = offsets[n];
+		}
+	}
+
+	// Mark the variables that can be analysed. A variable that is also accessed
+	// by any other instruction is left alone, and so are its neighbours in case
+	// the other instruction works on a 64bit value or a pointer
+	enum { UNUSED, CANDIDATE, EXCLUDED };
+	vars.firstOffset = minOffset - 1;
+	asCArray<asBYTE> state;
+	state.SetLength(maxOffset - minOffset + 3);
+	memset(state.AddressOf(), UNUSED, state.GetLength());
+	for( asCByteInstruction *instr = first; instr; instr = instr->next )
+	{
+		short offsets[3];
+		asUINT count = GetVarOffsets(instr, offsets);
+		sDataFlowOperands ops;
+		bool isKnown = GetDataFlowOperands(instr, ops);
+		for( asUINT n = 0; n < count; n++ )
+		{
+			int s = offsets[n] - vars.firstOffset;
+			if( isKnown )
+			{
+				if( state[s] == UNUSED )
+					state[s] = CANDIDATE;
+			}
+			else
+				state[s-1] = state[s] = state[s+1] = EXCLUDED;
+		}
+	}
+
+	vars.index.SetLength(state.GetLength());
+	vars.offsets.SetLength(0);
+	for( asUINT n = 0; n < state.GetLength(); n++ )
+	{
+		if( state[n] == CANDIDATE )
+		{
+			vars.index[n] = int(vars.offsets.GetLength());
+			vars.offsets.PushLast(short(n + vars.firstOffset));
+		}
+		else
+			vars.index[n] = -1;
+	}
+
+	return vars.offsets.GetLength() > 0;
+}
+
+bool asCByteCode::PropagateValues(sByteCodeGraph &graph, const sDataFlowVars &vars, bool &foldedJumps)
+{
+	TimeIt("asCByteCode::PropagateValues");
+
+	const asUINT numBlocks = graph.blocks.GetLength();
+	const asUINT numVars = vars.offsets.GetLength();
+
+	// The known values on entry to each block. A variable is either a known constant, a known copy
+	// of another variable, or unknown. A block is first given the values from the block that reaches
+	// it first, and then the values are merged with those from the other blocks until nothing changes
+	asCArray<asBYTE>  isConst;
+	asCArray<asDWORD> values;
+	asCArray<int>     copyOf;
+	asCArray<bool>    visited;
+	isConst.SetLength(numBlocks * numVars);
+	values.SetLength(numBlocks * numVars);
+	copyOf.SetLength(numBlocks * numVars);
+	visited.SetLength(numBlocks);
+	memset(visited.AddressOf(), 0, numBlocks * sizeof(bool));
+
+	// Nothing is known about the variables when entering the function
+	visited[0] = true;
+	for( asUINT v = 0; v < numVars; v++ )
+	{
+		isConst[v] = 0;
+		values[v]  = 0;
+		copyOf[v]  = -1;
+	}
+
+	asCArray<asBYTE>  currIsConst;
+	asCArray<asDWORD> currValues;
+	asCArray<int>     currCopyOf;
+	currIsConst.SetLength(numVars);
+	currValues.SetLength(numVars);
+	currCopyOf.SetLength(numVars);
+
+	asCArray<asUINT> pending;
+	asCArray<bool>   isPending;
+	isPending.SetLength(numBlocks);
+	memset(isPending.AddressOf(), 0, numBlocks * sizeof(bool));
+	pending.PushLast(0);
+	isPending[0] = true;
+
+	while( pending.GetLength() )
+	{
+		asUINT b = pending.PopLast();
+		isPending[b] = false;
+
+		const sByteCodeBlock &block = graph.blocks[b];
+		memcpy(currIsConst.AddressOf(), &isConst[b*numVars], numVars * sizeof(asBYTE));
+		memcpy(currValues.AddressOf(), &values[b*numVars], numVars * sizeof(asDWORD));
+		memcpy(currCopyOf.AddressOf(), &copyOf[b*numVars], numVars * sizeof(int));
+		for( asUINT n = block.firstInstr; n < block.firstInstr + block.numInstrs; n++ )
+			TransferDataFlowValues(graph.instrs[n], vars, currIsConst.AddressOf(), currValues.AddressOf(), currCopyOf.AddressOf());
+
+		for( asUINT s = block.firstSucc; s < block.firstSucc + block.numSuccs; s++ )
+		{
+			const asUINT succ = graph.succs[s];
+			asBYTE  *succIsConst = &isConst[succ*numVars];
+			asDWORD *succValues  = &values[succ*numVars];
+			int     *succCopyOf  = &copyOf[succ*numVars];
+
+			bool changed = false;
+			if( !visited[succ] )
+			{
+				visited[succ] = true;
+				memcpy(succIsConst, currIsConst.AddressOf(), numVars * sizeof(asBYTE));
+				memcpy(succValues, currValues.AddressOf(), numVars * sizeof(asDWORD));
+				memcpy(succCopyOf, currCopyOf.AddressOf(), numVars * sizeof(int));
+				changed = true;
+			}
+			else
+			{
+				for( asUINT v = 0; v < numVars; v++ )
+				{
+					if( succIsConst[v] && (!currIsConst[v] || succValues[v] != currValues[v]) )
+					{
+						succIsConst[v] = 0;
+						succValues[v] = 0;
+						changed = true;
+					}
+					if( succCopyOf[v] >= 0 && succCopyOf[v] != currCopyOf[v] )
+					{
+						succCopyOf[v] = -1;
+						changed = true;
+					}
+				}
+			}
+
+			if( changed && !isPending[succ] )
+			{
+				isPending[succ] = true;
+				pending.PushLast(succ);
+			}
+		}
+	}
+
+	// Replace the variables with what is known about them
+	bool changed = false;
+	asCArray<asCByteInstruction*> toDelete;
+	asCArray<asCByteInstruction*> foldedCompares;
+	for( asUINT b = 0; b < numBlocks; b++ )
+	{
+		// Blocks that are never reached will be removed by PostProcess
+		if( !visited[b] )
+			continue;
+
+		const sByteCodeBlock &block = graph.blocks[b];
+		memcpy(currIsConst.AddressOf(), &isConst[b*numVars], numVars * sizeof(asBYTE));
+		memcpy(currValues.AddressOf(), &values[b*numVars], numVars * sizeof(asDWORD));
+		memcpy(currCopyOf.AddressOf(), &copyOf[b*numVars], numVars * sizeof(int));
+		for( asUINT n = block.firstInstr; n < block.firstInstr + block.numInstrs; n++ )
+		{
+			asCByteInstruction *instr = graph.instrs[n];
+
+			// Decide the conditional jumps that follow a comparison with a known value
+			if( IsConditionalJump(instr->op) && n > block.firstInstr )
+			{
+				const asCByteInstruction *cmp = graph.instrs[n-1];
+				int v = (cmp->op == asBC_CMPIi || cmp->op == asBC_CMPIu) ? vars.Index(cmp->wArg[0]) : -1;
+				if( v >= 0 && currIsConst[v] )
+				{
+					asDWORD a = currValues[v];
+					asDWORD b = *ARG_DW(cmp->arg);
+					int r;
+					if( a == b ) r = 0;
+					else if( cmp->op == asBC_CMPIi ) r = int(a) < int(b) ? -1 : 1;
+					else r = a < b ? -1 : 1;
+
+					bool taken = false;
+					switch( instr->op )
+					{
+					case asBC_JZ:  taken = r == 0; break;
+					case asBC_JNZ: taken = r != 0; break;
+					case asBC_JS:  taken = r < 0;  break;
+					case asBC_JNS: taken = r >= 0; break;
+					case asBC_JP:  taken = r > 0;  break;
+					case asBC_JNP: taken = r <= 0; break;
+					default: break;
+					}
+
+					if( taken )
+						instr->op = asBC_JMP;
+					else
+						toDelete.PushLast(instr);
+					foldedCompares.PushLast(graph.instrs[n-1]);
+
+					foldedJumps = true;
+					changed = true;
+					continue;
+				}
+			}
+
+			if( RewriteDataFlowUses(instr, vars, currIsConst.AddressOf(), currValues.AddressOf(), currCopyOf.AddressOf()) )
+			{
+				changed = true;
+
+				// A variable that is copied to itself
+				if( instr->op == asBC_CpyVtoV4 && instr->wArg[0] == instr->wArg[1] )
+				{
+					toDelete.PushLast(instr);
+					continue;
+				}
+			}
+
+			TransferDataFlowValues(instr, vars, currIsConst.AddressOf(), currValues.AddressOf(), currCopyOf.AddressOf());
+		}
+	}
+
+	for( asUINT n = 0; n < toDelete.GetLength(); n++ )
+		DeleteInstruction(toDelete[n]);
+
+	// The comparisons are no longer needed if the jump was the only one to use the result
+	for( asUINT n = 0; n < foldedCompares.GetLength(); n++ )
+		if( !IsTempRegUsed(foldedCompares[n]) )
+			DeleteInstruction(foldedCompares[n]);
+
+	return changed;
+}
+
+bool asCByteCode::RemoveDeadStores(sByteCodeGraph &graph, const sDataFlowVars &vars)
+{
+	TimeIt("asCByteCode::RemoveDeadStores");
+
+	const asUINT numBlocks = graph.blocks.GetLength();
+	const asUINT numVars = vars.offsets.GetLength();
+
+	// Find the variables that may be read after each block, i.e. those that are
+	// live on entry to any of the following blocks. The blocks are visited backwards
+	// until nothing changes. No variable is read after the function returns
+	asCArray<asBYTE> liveIn;
+	asCArray<asBYTE> live;
+	liveIn.SetLength(numBlocks * numVars);
+	live.SetLength(numVars);
+	memset(liveIn.AddressOf(), 0, numBlocks * numVars);
+
+	bool changed = true;
+	while( changed )
+	{
+		changed = false;
+		for( asUINT b = numBlocks; b-- > 0; )
+		{
+			const sByteCodeBlock &block = graph.blocks[b];
+			memset(live.AddressOf(), 0, numVars);
+			for( asUINT s = block.firstSucc; s < block.firstSucc + block.numSuccs; s++ )
+			{
+				const asBYTE *succLive = &liveIn[graph.succs[s]*numVars];
+				for( asUINT v = 0; v < numVars; v++ )
+					live[v] |= succLive[v];
+			}
+
+			for( asUINT n = block.firstInstr + block.numInstrs; n-- > block.firstInstr; )
+			{
+				const asCByteInstruction *instr = graph.instrs[n];
+				sDataFlowOperands ops;
+				if( !GetDataFlowOperands(instr, ops) )
+					continue;
+
+				if( ops.hasDef && !ops.isUpdate )
+				{
+					int d = vars.Index(instr->wArg[0]);
+					if( d >= 0 ) live[d] = 0;
+				}
+				if( ops.isUpdate )
+				{
+					int d = vars.Index(instr->wArg[0]);
+					if( d >= 0 ) live[d] = 1;
+				}
+				for( asUINT u = 0; u < ops.numUses; u++ )
+				{
+					int v = vars.Index(instr->wArg[ops.useArg[u]]);
+					if( v >= 0 ) live[v] = 1;
+				}
+			}
+
+			if( memcmp(&liveIn[b*numVars], live.AddressOf(), numVars) != 0 )
+			{
+				memcpy(&liveIn[b*numVars], live.AddressOf(), numVars);
+				changed = true;
+			}
+		}
+	}
+
+	// Remove the instructions that store a value that is never read
+	asCArray<asCByteInstruction*> toDelete;
+	for( asUINT b = 0; b < numBlocks; b++ )
+	{
+		const sByteCodeBlock &block = graph.blocks[b];
+		memset(live.AddressOf(), 0, numVars);
+		for( asUINT s = block.firstSucc; s < block.firstSucc + block.numSuccs; s++ )
+		{
+			const asBYTE *succLive = &liveIn[graph.succs[s]*numVars];
+			for( asUINT v = 0; v < numVars; v++ )
+				live[v] |= succLive[v];
+		}
+
+		for( asUINT n = block.firstInstr + block.numInstrs; n-- > block.firstInstr; )
+		{
+			asCByteInstruction *instr = graph.instrs[n];
+			sDataFlowOperands ops;
+			if( !GetDataFlowOperands(instr, ops) )
+				continue;
+
+			int d = ops.hasDef ? vars.Index(instr->wArg[0]) : -1;
+			if( d >= 0 && !live[d] && IsDataFlowDefRemovable(instr->op) )
+			{
+				toDelete.PushLast(instr);
+				continue;
+			}
+
+			if( d >= 0 )
+				live[d] = ops.isUpdate ? 1 : 0;
+			for( asUINT u = 0; u < ops.numUses; u++ )
+			{
+				int v = vars.Index(instr->wArg[ops.useArg[u]]);
+				if( v >= 0 ) live[v] = 1;
+			}
+		}
+	}
+
+	for( asUINT n = 0; n < toDelete.GetLength(); n++ )
+		DeleteInstruction(toDelete[n]);
+
+	return toDelete.GetLength() > 0;
+}
+
 bool asCByteCode::IsTempVarReadByInstr(asCByteInstruction *curr, int offset)
 {
 	// Which instructions read from variables?
@@ -1258,23 +2043,27 @@ bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
 {
 	TimeIt("asCByteCode::IsTempVarRead");
 
+	// The paths can only join at labels, so the labels that have been reached are 
+	// marked to avoid checking the code that follows them more than once
 	asCArray<asCByteInstruction *> openPaths;
-	asCArray<asCByteInstruction *> closedPaths;
+	asCArray<asCByteInstruction *> visited;
+	bool isRead = false;
 
 	// We're not interested in the first instruction, since it is the one that sets the variable
-	openPaths.PushLast(curr->next);
+	if( curr->next )
+		openPaths.PushLast(curr->next);
 
-	while( openPaths.GetLength() )
+	while( openPaths.GetLength() && !isRead )
 	{
 		curr = openPaths.PopLast();
 
-		// Add the instruction to the closed paths so that we don't verify it again
-		closedPaths.PushLast(curr);
-
 		while( curr )
 		{
 			if( IsTempVarReadByInstr(curr, offset) )
-				return true;
+			{
+				isRead = true;
+				break;
+			}
 
 			if( IsTempVarOverwrittenByInstr(curr, offset) ) break;
 
@@ -1284,12 +2073,14 @@ bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
 				// Find the destination. If it cannot be found it is because we're doing a localized
 				// optimization and the label hasn't been added to the final bytecode yet
 
+				asCByteInstruction *dest = 0;
 				int label = *((int*)ARG_DW(curr->arg));
-				int r = FindLabel(label, curr, &curr, 0);
-				if( r >= 0 &&
-					!closedPaths.Exists(curr) &&
-					!openPaths.Exists(curr) )
-					openPaths.PushLast(curr);
+				if( FindLabel(label, &dest) >= 0 && !dest->marked )
+				{
+					dest->marked = true;
+					visited.PushLast(dest);
+					openPaths.PushLast(dest);
+				}
 
 				break;
 			}
@@ -1303,11 +2094,12 @@ bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
 
 				asCByteInstruction *dest = 0;
 				int label = *((int*)ARG_DW(curr->arg));
-				int r = FindLabel(label, curr, &dest, 0);
-				if( r >= 0 &&
-					!closedPaths.Exists(dest) &&
-					!openPaths.Exists(dest) )
+				if( FindLabel(label, &dest) >= 0 && !dest->marked )
+				{
+					dest->marked = true;
+					visited.PushLast(dest);
 					openPaths.PushLast(dest);
+				}
 			}
 			else if( curr->op == asBC_JMPP )
 			{
@@ -1322,11 +2114,12 @@ bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
 
 					asCByteInstruction *dest = 0;
 					int label = *((int*)ARG_DW(curr->arg));
-					int r = FindLabel(label, curr, &dest, 0);
-					if( r >= 0 &&
-						!closedPaths.Exists(dest) &&
-						!openPaths.Exists(dest) )
+					if( FindLabel(label, &dest) >= 0 && !dest->marked )
+					{
+						dest->marked = true;
+						visited.PushLast(dest);
 						openPaths.PushLast(dest);
+					}
 
 					curr = curr->next;
 				}
@@ -1337,11 +2130,22 @@ bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
 				break;
 			}
 
+			// The rest of the path has already been checked if the label has been reached before
 			curr = curr->next;
+			if( curr && curr->op == asBC_LABEL )
+			{
+				if( curr->marked ) break;
+				curr->marked = true;
+				visited.PushLast(curr);
+			}
 		}
 	}
 
-	return false;
+	// Clear the marks so the instructions can be visited again in the next search
+	for( asUINT n = 0; n < visited.GetLength(); n++ )
+		visited[n]->marked = false;
+
+	return isRead;
 }
 
 bool asCByteCode::IsTempRegUsed(asCByteInstruction *curr)
@@ -1628,12 +2432,17 @@ void asCByteCode::AddCode(asCByteCode *bc)
 			bc->first = 0;
 			bc->last = 0;
 		}
+
+		// The labels will be indexed again when needed
+		isLabelIndexValid = false;
+		bc->labelIndex.SetLength(0);
+		bc->isLabelIndexValid = false;
 	}
 }
 
 int asCByteCode::AddInstruction()
 {
-	void *ptr = engine->memoryMgr.AllocByteInstruction();
+	void *ptr = pool->Alloc();
 	if( ptr == 0 )
 	{
 		// Out of memory
@@ -1656,7 +2465,7 @@ int asCByteCode::AddInstruction()
 
 int asCByteCode::AddInstructionFirst()
 {
-	void *ptr = engine->memoryMgr.AllocByteInstruction();
+	void *ptr = pool->Alloc();
 	if( ptr == 0 )
 	{
 		// Out of memory
@@ -1764,6 +2573,13 @@ void asCByteCode::Label(short label)
 	last->size     = 0;
 	last->stackInc = 0;
 	last->wArg[0]  = label;
+
+	if( isLabelIndexValid )
+	{
+		while( labelIndex.GetLength() <= asUINT(label) )
+			labelIndex.PushLast(0);
+		labelIndex[label] = last;
+	}
 }
 
 void asCByteCode::Line(int line, int column, int scriptIdx)
@@ -1833,93 +2649,267 @@ void asCByteCode::VarDecl(int varDeclIdx)
 	last->wArg[0]  = asWORD(varDeclIdx);
 }
 
-int asCByteCode::FindLabel(int label, asCByteInstruction *from, asCByteInstruction **dest, int *positionDelta)
+void asCByteCode::BuildLabelIndex()
 {
-	TimeIt("asCByteCode::FindLabel");
+	TimeIt("asCByteCode::BuildLabelIndex");
 
-	// Search forward
-	int labelPos = -from->GetSize();
+	labelIndex.SetLength(0);
 
-	asCByteInstruction *labelInstr = from;
-	while( labelInstr )
+	asCByteInstruction *instr = first;
+	while( instr )
 	{
-		labelPos += labelInstr->GetSize();
-		labelInstr = labelInstr->next;
+		if( instr->op == asBC_LABEL )
+		{
+			int label = instr->wArg[0];
+			while( labelIndex.GetLength() <= asUINT(label) )
+				labelIndex.PushLast(0);
+
+			// Each label must only be placed once in the code
+			asASSERT( labelIndex[label] == 0 );
+			labelIndex[label] = instr;
+		}
 
-		if( labelInstr && labelInstr->op == asBC_LABEL )
+		instr = instr->next;
+	}
+
+	isLabelIndexValid = true;
+}
+
+void asCByteCode::RemoveFromLabelIndex(asCByteInstruction *instr)
+{
+	if( isLabelIndexValid && instr->op == asBC_LABEL &&
+		asUINT(instr->wArg[0]) < labelIndex.GetLength() &&
+		labelIndex[instr->wArg[0]] == instr )
+		labelIndex[instr->wArg[0]] = 0;
+}
+
+int asCByteCode::FindLabel(int label, asCByteInstruction **dest)
+{
+	if( !isLabelIndexValid )
+		BuildLabelIndex();
+
+	if( label < 0 || asUINT(label) >= labelIndex.GetLength() || labelIndex[label] == 0 )
+		return -1;
+
+	if( dest ) *dest = labelIndex[label];
+	return 0;
+}
+
+void asCByteCode::BuildControlFlowGraph(sByteCodeGraph &graph)
+{
+	TimeIt("asCByteCode::BuildControlFlowGraph");
+
+	graph.instrs.SetLength(0);
+	graph.blocks.SetLength(0);
+	graph.succs.SetLength(0);
+
+	// Lay out the instructions in an array and find where the basic blocks start.
+	// A block starts at each label, after each jump, and at each destination of a 
+	// JMPP, i.e. each of the JMP instructions that follows it
+	asCArray<bool> isBlockStart;
+	for( asCByteInstruction *instr = first; instr; instr = instr->next )
+	{
+		graph.instrs.PushLast(instr);
+		isBlockStart.PushLast(instr == first || instr->op == asBC_LABEL);
+	}
+
+	const asUINT numInstrs = graph.instrs.GetLength();
+	for( asUINT n = 0; n < numInstrs; n++ )
+	{
+		const asCByteInstruction *instr = graph.instrs[n];
+		if( instr->op == asBC_JMP   ||
+			instr->op == asBC_JZ    || instr->op == asBC_JNZ    ||
+			instr->op == asBC_JLowZ || instr->op == asBC_JLowNZ ||
+			instr->op == asBC_JS    || instr->op == asBC_JNS    ||
+			instr->op == asBC_JP    || instr->op == asBC_JNP    ||
+			instr->op == asBC_TryBlock )
 		{
-			if( labelInstr->wArg[0] == label )
-				break;
+			if( n + 1 < numInstrs )
+				isBlockStart[n+1] = true;
+		}
+		else if( instr->op == asBC_JMPP )
+		{
+			asDWORD max = *ARG_DW(instr->arg);
+			for( asUINT d = n + 1; d <= n + 1 + max && d < numInstrs; d++ )
+				isBlockStart[d] = true;
 		}
 	}
 
-	if( labelInstr == 0 )
+	// Create the blocks and remember which block each label starts
+	asCArray<int> labelBlock;
+	for( asUINT n = 0; n < numInstrs; n++ )
 	{
-		// Search backwards
-		labelPos = -from->GetSize();
+		if( isBlockStart[n] )
+		{
+			sByteCodeBlock block = { n, 0, 0, 0 };
+			graph.blocks.PushLast(block);
+		}
+		graph.blocks[graph.blocks.GetLength()-1].numInstrs++;
 
-		labelInstr = from;
-		while( labelInstr )
+		if( graph.instrs[n]->op == asBC_LABEL )
 		{
-			labelInstr = labelInstr->prev;
-			if( labelInstr )
-			{
-				labelPos -= labelInstr->GetSize();
+			int label = graph.instrs[n]->wArg[0];
+			while( labelBlock.GetLength() <= asUINT(label) )
+				labelBlock.PushLast(-1);
+			labelBlock[label] = int(graph.blocks.GetLength()-1);
+		}
+	}
 
-				if( labelInstr->op == asBC_LABEL )
-				{
-					if( labelInstr->wArg[0] == label )
-						break;
-				}
-			}
+	// Connect each block with the blocks that may be executed after it
+	const asUINT numBlocks = graph.blocks.GetLength();
+	for( asUINT b = 0; b < numBlocks; b++ )
+	{
+		sByteCodeBlock &block = graph.blocks[b];
+		const asCByteInstruction *instr = graph.instrs[block.firstInstr + block.numInstrs - 1];
+		block.firstSucc = graph.succs.GetLength();
+
+		bool fallsThrough = true;
+		if( instr->op == asBC_JMP   ||
+			instr->op == asBC_JZ    || instr->op == asBC_JNZ    ||
+			instr->op == asBC_JLowZ || instr->op == asBC_JLowNZ ||
+			instr->op == asBC_JS    || instr->op == asBC_JNS    ||
+			instr->op == asBC_JP    || instr->op == asBC_JNP    ||
+			instr->op == asBC_TryBlock )
+		{
+			int label = *((int*) ARG_DW(instr->arg));
+			bool found = label >= 0 && asUINT(label) < labelBlock.GetLength() && labelBlock[label] >= 0;
+			asASSERT( found );
+			if( found )
+				graph.succs.PushLast(asUINT(labelBlock[label]));
+
+			// Only the unconditional jump doesn't continue with the next instruction
+			fallsThrough = instr->op != asBC_JMP;
+		}
+		else if( instr->op == asBC_JMPP )
+		{
+			// Each of the following JMP instructions is a destination
+			asDWORD max = *ARG_DW(instr->arg);
+			for( asUINT d = b + 1; d <= b + 1 + max && d < numBlocks; d++ )
+				graph.succs.PushLast(d);
+			fallsThrough = false;
 		}
+
+		if( fallsThrough && b + 1 < numBlocks )
+			graph.succs.PushLast(b + 1);
+
+		block.numSuccs = graph.succs.GetLength() - block.firstSucc;
 	}
+}
 
-	if( labelInstr != 0 )
+// Returns the fused compare and jump instruction that replaces CMPIi followed by the jump
+static asEBCInstr GetFusedCompareJump(asEBCInstr jump)
+{
+	// The comparison leaves -1, 0, or 1 in the register, so testing the
+	// low byte gives the same result as testing the whole register
+	switch( jump )
 	{
-		if( dest ) *dest = labelInstr;
-		if( positionDelta ) *positionDelta = labelPos;
-		return 0;
+	case asBC_JZ:
+	case asBC_JLowZ:  return asBC_JEqIi;
+	case asBC_JNZ:
+	case asBC_JLowNZ: return asBC_JNeIi;
+	case asBC_JS:     return asBC_JLtIi;
+	case asBC_JNS:    return asBC_JGeIi;
+	case asBC_JP:     return asBC_JGtIi;
+	case asBC_JNP:    return asBC_JLeIi;
+	default:          return asBC_MAXBYTECODE;
 	}
+}
+
+void asCByteCode::FuseInstructions()
+{
+	// Replaces frequent pairs of instructions with a single instruction that does the work of 
+	// both, so the context only has to dispatch once. The pairs were picked from the statistics
+	// gathered with AS_BYTECODE_STATS on the performance tests.
 
-	return -1;
+	TimeIt("asCByteCode::FuseInstructions");
+
+	for( asCByteInstruction *instr = first; instr && instr->next; instr = instr->next )
+	{
+		asCByteInstruction *next = instr->next;
+
+		if( instr->op == asBC_CMPIi )
+		{
+			// CMPIi x, c; J** +y -> J**Ii x, c, +y
+			// The fused instruction doesn't set the register, so it must not be read after the jump
+			asEBCInstr fused = GetFusedCompareJump(next->op);
+			if( fused != asBC_MAXBYTECODE && !IsTempRegUsed(next) )
+			{
+				instr->op       = fused;
+				instr->size     = asBCTypeSize[asBCInfo[fused].type];
+				instr->stackInc = asBCInfo[fused].stackInc;
+				*(ARG_DW(instr->arg)+1) = *ARG_DW(next->arg);
+				DeleteInstruction(next);
+			}
+		}
+		else if( instr->op == asBC_PshVPtr && next->op == asBC_ADDSi )
+		{
+			// PshVPtr x; ADDSi y, t -> PshVPtrOfs x, y, t
+			instr->op       = asBC_PshVPtrOfs;
+			instr->size     = asBCTypeSize[asBCInfo[asBC_PshVPtrOfs].type];
+			instr->stackInc = asBCInfo[asBC_PshVPtrOfs].stackInc;
+			instr->wArg[1]  = next->wArg[0];
+			*ARG_DW(instr->arg) = *ARG_DW(next->arg);
+			DeleteInstruction(next);
+		}
+	}
 }
 
 int asCByteCode::ResolveJumpAddresses()
 {
 	TimeIt("asCByteCode::ResolveJumpAddresses");
 
+	// Find the position of each label first, so the jumps can be resolved in a single pass
+	asCArray<int> labelPos;
 	asUINT currPos = 0;
 
 	asCByteInstruction *instr = first;
 	while( instr )
+	{
+		if( instr->op == asBC_LABEL )
+		{
+			int label = instr->wArg[0];
+			while( labelPos.GetLength() <= asUINT(label) )
+				labelPos.PushLast(-1);
+			labelPos[label] = int(currPos);
+		}
+
+		currPos += instr->GetSize();
+		instr = instr->next;
+	}
+
+	currPos = 0;
+	instr = first;
+	while( instr )
 	{
 		if( instr->op == asBC_JMP   ||
 			instr->op == asBC_JZ    || instr->op == asBC_JNZ    ||
 			instr->op == asBC_JLowZ || instr->op == asBC_JLowNZ ||
 			instr->op == asBC_JS    || instr->op == asBC_JNS    ||
-			instr->op == asBC_JP    || instr->op == asBC_JNP    )
+			instr->op == asBC_JP    || instr->op == asBC_JNP    ||
+			instr->op == asBC_TryBlock )
 		{
 			int label = *((int*) ARG_DW(instr->arg));
-			int labelPosOffset;
-			int r = FindLabel(label, instr, 0, &labelPosOffset);
-			if( r == 0 )
-				*((int*) ARG_DW(instr->arg)) = labelPosOffset;
-			else
+			if( label < 0 || asUINT(label) >= labelPos.GetLength() || labelPos[label] < 0 )
 				return -1;
-		}
-		else if (instr->op == asBC_TryBlock)
-		{
-			int label = *((int*)ARG_DW(instr->arg));
-			int labelPosOffset;
-			int r = FindLabel(label, instr, 0, &labelPosOffset);
-			if (r == 0)
+
+			// The jumps are relative to the next instruction
+			int labelPosOffset = labelPos[label] - int(currPos + instr->GetSize());
+			if( instr->op == asBC_TryBlock )
 			{
 				// Should store the absolute address so the exception handler doesn't need to figure it out
 				*((int*)ARG_DW(instr->arg)) = currPos + labelPosOffset;
 			}
 			else
+				*((int*) ARG_DW(instr->arg)) = labelPosOffset;
+		}
+		else if( instr->op >= asBC_JEqIi && instr->op <= asBC_JLeIi )
+		{
+			// The label of the fused compare and jump instructions is in the second argument
+			int label = *((int*) ARG_DW(instr->arg) + 1);
+			if( label < 0 || asUINT(label) >= labelPos.GetLength() || labelPos[label] < 0 )
 				return -1;
+
+			*((int*) ARG_DW(instr->arg) + 1) = labelPos[label] - int(currPos + instr->GetSize());
 		}
 
 		currPos += instr->GetSize();
@@ -1936,9 +2926,10 @@ asCByteInstruction *asCByteCode::DeleteInstruction(asCByteInstruction *instr)
 
 	asCByteInstruction *ret = instr->prev ? instr->prev : instr->next;
 
+	RemoveFromLabelIndex(instr);
 	RemoveInstruction(instr);
 
-	engine->memoryMgr.FreeByteInstruction(instr);
+	pool->Free(instr);
 
 	return ret;
 }
@@ -2032,86 +3023,59 @@ void asCByteCode::PostProcess()
 
 	largestStackUsed = 0;
 
-	asCByteInstruction *instr = first;
-	while( instr )
+	sByteCodeGraph graph;
+	BuildControlFlowGraph(graph);
+
+	for( asUINT n = 0; n < graph.instrs.GetLength(); n++ )
 	{
-		instr->marked = false;
-		instr->stackSize = -1;
-		instr = instr->next;
+		graph.instrs[n]->marked = false;
+		graph.instrs[n]->stackSize = -1;
 	}
 
-	// Add the first instruction to the list of unchecked code paths
-	asCArray<asCByteInstruction *> paths;
-	AddPath(paths, first, 0);
+	// Add the first block to the list of unchecked code paths. A block is 
+	// marked as soon as it is added, with the stack size on entry in its 
+	// first instruction, so it will only be checked once
+	asCArray<asUINT> paths;
+	graph.instrs[0]->marked = true;
+	graph.instrs[0]->stackSize = 0;
+	paths.PushLast(0);
 
 	// Go through each of the code paths
 	for( asUINT p = 0; p < paths.GetLength(); ++p )
 	{
-		instr = paths[p];
-		int stackSize = instr->stackSize;
+		const sByteCodeBlock &block = graph.blocks[paths[p]];
+		int stackSize = graph.instrs[block.firstInstr]->stackSize;
 
-		while( instr )
+		for( asUINT n = block.firstInstr; n < block.firstInstr + block.numInstrs; n++ )
 		{
+			asCByteInstruction *instr = graph.instrs[n];
 			instr->marked = true;
 			instr->stackSize = stackSize;
 			stackSize += instr->stackInc;
 			if( stackSize > largestStackUsed )
 				largestStackUsed = stackSize;
+		}
 
-			if( instr->op == asBC_JMP )
-			{
-				// Find the label that we should jump to
-				int label = *((int*) ARG_DW(instr->arg));
-				asCByteInstruction *dest = 0;
-				int r = FindLabel(label, instr, &dest, 0); asASSERT( r == 0 ); UNUSED_VAR(r);
-
-				AddPath(paths, dest, stackSize);
-				break;
-			}
-			else if( instr->op == asBC_JZ    || instr->op == asBC_JNZ    ||
-					 instr->op == asBC_JLowZ || instr->op == asBC_JLowNZ ||
-					 instr->op == asBC_JS    || instr->op == asBC_JNS    ||
-					 instr->op == asBC_JP    || instr->op == asBC_JNP    ||
-					 instr->op == asBC_TryBlock )
-			{
-				// Find the label that is being jumped to
-				int label = *((int*) ARG_DW(instr->arg));
-				asCByteInstruction *dest = 0;
-				int r = FindLabel(label, instr, &dest, 0); asASSERT( r == 0 ); UNUSED_VAR(r);
-
-				AddPath(paths, dest, stackSize);
-
-				// Add both paths to the code paths
-				AddPath(paths, instr->next, stackSize);
-
-				break;
-			}
-			else if( instr->op == asBC_JMPP )
+		// Add the blocks that follow to the code paths
+		for( asUINT s = block.firstSucc; s < block.firstSucc + block.numSuccs; s++ )
+		{
+			asCByteInstruction *dest = graph.instrs[graph.blocks[graph.succs[s]].firstInstr];
+			if( dest->marked )
 			{
-				// I need to know the largest value possible
-				asDWORD max = *ARG_DW(instr->arg);
-
-				// Add all destinations to the code paths
-				asCByteInstruction *dest = instr->next;
-				for( asDWORD n = 0; n <= max && dest != 0; ++n )
-				{
-					AddPath(paths, dest, stackSize);
-					dest = dest->next;
-				}
-
-				break;
+				// Verify the size of the stack
+				asASSERT(dest->stackSize == stackSize);
 			}
 			else
 			{
-				instr = instr->next;
-				if( instr == 0 || instr->marked )
-					break;
+				dest->marked = true;
+				dest->stackSize = stackSize;
+				paths.PushLast(graph.succs[s]);
 			}
 		}
 	}
 
 	// Are there any instructions that didn't get visited?
-	instr = first;
+	asCByteInstruction *instr = first;
 	while( instr )
 	{
 		// Don't remove asBC_Block instructions as then the start and end of blocks may become mismatched
@@ -2409,7 +3373,10 @@ void asCByteCode::DebugOutput(const char *name, asCScriptFunction *func)
 			break;
 
 		case asBCTYPE_rW_DW_DW_ARG:
-			fprintf(file, "   %-8s v%d, %u, %u\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1));
+			if( instr->op >= asBC_JEqIi && instr->op <= asBC_JLeIi )
+				fprintf(file, "   %-8s v%d, %d, %+d     (d:%d)\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1), pos+*(int*)(ARG_DW(instr->arg)+1));
+			else
+				fprintf(file, "   %-8s v%d, %u, %u\n", asBCInfo[instr->op].name, instr->wArg[0], *(int*)ARG_DW(instr->arg), *(int*)(ARG_DW(instr->arg)+1));
 			break;
 
 		case asBCTYPE_QW_DW_ARG:
@@ -2897,9 +3864,11 @@ int asCByteCode::RemoveLastInstr()
 {
 	if( last == 0 ) return -1;
 
+	RemoveFromLabelIndex(last);
+
 	if( first == last )
 	{
-		engine->memoryMgr.FreeByteInstruction(last);
+		pool->Free(last);
 		first = 0;
 		last = 0;
 	}
@@ -2909,7 +3878,7 @@ int asCByteCode::RemoveLastInstr()
 		last = bc->prev;
 
 		bc->Remove();
-		engine->memoryMgr.FreeByteInstruction(bc);
+		pool->Free(bc);
 	}
 
 	return 0;
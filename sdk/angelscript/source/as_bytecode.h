@@ -55,6 +55,27 @@ BEGIN_AS_NAMESPACE
 class asCScriptEngine;
 class asCScriptFunction;
 class asCByteInstruction;
+class asCObjectArena;
+struct sDataFlowVars;
+
+// A basic block in the control flow graph. The instructions and the 
+// successors are given as ranges in the arrays of the sByteCodeGraph
+struct sByteCodeBlock
+{
+	asUINT firstInstr;
+	asUINT numInstrs;
+	asUINT firstSucc;
+	asUINT numSuccs;
+};
+
+// An array based view of the instructions, split in basic blocks. It is only
+// valid until instructions are added to or removed from the asCByteCode
+struct sByteCodeGraph
+{
+	asCArray<asCByteInstruction *> instrs;
+	asCArray<sByteCodeBlock>       blocks;
+	asCArray<asUINT>               succs;
+};
 
 class asCByteCode
 {
@@ -70,13 +91,14 @@ public:
 
 	void Optimize();
 	void OptimizeLocally(const asCArray<int> &tempVariableOffsets);
+	void OptimizeDataFlow();
+	void FuseInstructions();
 	void ExtractLineNumbers();
 	void ExtractObjectVariableInfo(asCScriptFunction *outFunc);
 	void ExtractTryCatchInfo(asCScriptFunction *outFunc);
 	int  ResolveJumpAddresses();
-	int  FindLabel(int label, asCByteInstruction *from, asCByteInstruction **dest, int *positionDelta);
-
-	void AddPath(asCArray<asCByteInstruction *> &paths, asCByteInstruction *instr, int stackSize);
+	int  FindLabel(int label, asCByteInstruction **dest);
+	void BuildControlFlowGraph(sByteCodeGraph &graph);
 
 	void Output(asDWORD *array);
 	void AddCode(asCByteCode *bc);
@@ -162,15 +184,29 @@ protected:
 	bool IsTempVarOverwrittenByInstr(asCByteInstruction *curr, int var);
 	bool IsInstrJmpOrLabel(asCByteInstruction *curr);
 
+	// Helpers for OptimizeDataFlow
+	bool FindDataFlowVars(sDataFlowVars &vars);
+	bool PropagateValues(sByteCodeGraph &graph, const sDataFlowVars &vars, bool &foldedJumps);
+	bool RemoveDeadStores(sByteCodeGraph &graph, const sDataFlowVars &vars);
+
 	int AddInstruction();
 	int AddInstructionFirst();
 
+	void BuildLabelIndex();
+	void RemoveFromLabelIndex(asCByteInstruction *instr);
+
 	asCByteInstruction *first;
 	asCByteInstruction *last;
 
+	// The LABEL instruction for each label. It is built when first needed
+	// and then kept up to date until the code from another asCByteCode is added
+	asCArray<asCByteInstruction *> labelIndex;
+	bool                           isLabelIndexValid;
+
 	const asCArray<int> *temporaryVariables;
 
-	asCScriptEngine *engine;
+	asCScriptEngine        *engine;
+	asCObjectArena         *pool;
 };
 
 class asCByteInstruction
@@ -82,6 +82,7 @@ asCCompiler::asCCompiler(asCScriptEngine *engine) : byteCode(engine)
 	script = 0;
 
 	variables = 0;
+	compileTask = 0;
 	isProcessingDeferredParams = false;
 	isCompilingDefaultArg = false;
 	noCodeOutput = 0;
@@ -98,10 +99,22 @@ asCCompiler::~asCCompiler()
 	}
 
 	// Clean up all the string constants that were allocated. By now the script
-	// functions that were compiled successfully already holds their own references
-	for (asUINT n = 0; n < usedStringConstants.GetLength(); n++)
-		engine->stringFactory->ReleaseStringConstant(usedStringConstants[n]);
-	usedStringConstants.SetLength(0);
+	// functions that were compiled successfully already holds their own references,
+	// except when compiled by a worker, where the builder adds them afterwards
+	if( compileTask )
+	{
+		for( asUINT n = 0; n < usedStringConstants.GetLength(); n++ )
+			compileTask->stringConstants.PushLast(usedStringConstants[n]);
+		usedStringConstants.SetLength(0);
+	}
+	else if( usedStringConstants.GetLength() )
+	{
+		ENTERCRITICALSECTION(builder->compileCs);
+		for (asUINT n = 0; n < usedStringConstants.GetLength(); n++)
+			engine->stringFactory->ReleaseStringConstant(usedStringConstants[n]);
+		usedStringConstants.SetLength(0);
+		LEAVECRITICALSECTION(builder->compileCs);
+	}
 
 	// Clean up the temporary script nodes that were allocated during compilation
 	for (asUINT n = 0; n < nodesToFreeUponComplete.GetLength(); n++)
@@ -116,6 +129,7 @@ void asCCompiler::Reset(asCBuilder *in_builder, asCScriptCode *in_script, asCScr
 	this->outFunc = in_outFunc;
 
 	hasCompileErrors = false;
+	compileTask = asCBuilder::GetCompileTask();
 
 	m_isConstructor       = false;
 	m_isConstructorCalled = false;
@@ -447,7 +461,9 @@ void asCCompiler::FinalizeFunction()
 	asASSERT( outFunc->scriptData->byteCode.GetLength() == 0 );
 	outFunc->scriptData->byteCode.SetLength(byteCode.GetSize());
 	byteCode.Output(outFunc->scriptData->byteCode.AddressOf());
-	outFunc->AddReferences();
+	// When compiled in parallel the builder adds the references as the function is committed
+	if( compileTask == 0 )
+		outFunc->AddReferences();
 	outFunc->scriptData->stackNeeded = byteCode.largestStackUsed + outFunc->scriptData->variableSpace;
 	outFunc->scriptData->lineNumbers = byteCode.lineNumbers;
 
@@ -1415,6 +1431,10 @@ void asCCompiler::CompileStatementBlock(asCScriptNode *block, bool ownVariableSc
 	asCScriptNode *node = block->firstChild;
 	while( node )
 	{
+		// Don't waste time on a function that will be compiled again by the builder's thread
+		if( compileTask && compileTask->isDeferred )
+			break;
+
 #ifdef AS_DEBUG
 		// Keep the current line in a variable so it will be easier
 		// to determine where in a script an assert is occurring.
@@ -1665,8 +1685,16 @@ void asCCompiler::DetermineSingleFunc(asCExprContext *ctx, asCScriptNode *node)
 	}
 
 	// Push the function pointer on the stack
+	asCFuncdefType *funcDef = engine->FindMatchingFuncdef(builder->GetFunctionDescription(funcs[0]), builder->module);
+	if( funcDef == 0 )
+	{
+		// The function is compiled in parallel and will be compiled again
+		ctx->type.SetDummy();
+		return;
+	}
+
 	ctx->bc.InstrPTR(asBC_FuncPtr, builder->GetFunctionDescription(funcs[0]));
-	ctx->type.Set(asCDataType::CreateType(engine->FindMatchingFuncdef(builder->GetFunctionDescription(funcs[0]), builder->module), false));
+	ctx->type.Set(asCDataType::CreateType(funcDef, false));
 	ctx->type.dataType.MakeHandle(true);
 	ctx->type.isExplicitHandle = true;
 	ctx->methodName = "";
@@ -3915,6 +3943,11 @@ void asCCompiler::CompileInitList(asCExprValue *var, asCScriptNode *node, asCByt
 	// Create a new special object type for the lists. Both asCRestore and the
 	// context exception handler will need this to know how to parse the buffer.
 	asCObjectType *listPatternType = engine->GetListPatternType(funcId);
+	if( listPatternType == 0 )
+	{
+		// The function is compiled in parallel and will be compiled again
+		return;
+	}
 
 	// Allocate a temporary variable to hold the pointer to the buffer
 	int bufferVar = AllocateVariable(asCDataType::CreateType(listPatternType, false), true);
@@ -12027,7 +12060,10 @@ int asCCompiler::CompileExpressionValue(asCScriptNode *node, asCExprContext *ctx
 				}
 				else
 				{
+					// The string factory doesn't have to be thread safe, even if the functions are compiled in parallel
+					ENTERCRITICALSECTION(builder->compileCs);
 					void *strPtr = const_cast<void*>(engine->stringFactory->GetStringConstant(str.AddressOf(), (asUINT)str.GetLength()));
+					LEAVECRITICALSECTION(builder->compileCs);
 					if (strPtr == 0)
 					{
 						// TODO: A better message is needed
@@ -13062,6 +13098,11 @@ int asCCompiler::InstantiateTemplateFunctions(asCArray<int>& funcs, asCScriptNod
 		}
 
 		funcs[i] = engine->GetTemplateFunctionInstance(func, dataTypes);
+		if( funcs[i] < 0 )
+		{
+			// The function is compiled in parallel and will be compiled again
+			return -1;
+		}
 	}
 
 	return 0;
@@ -14137,6 +14178,7 @@ int asCCompiler::FindPropertyAccessor(const asCString &name, asCExprContext *ctx
 			// If the object is a handle then we need to remember that
 			ctx->property_handle = ctx->type.dataType.IsObjectHandle();
 			ctx->property_ref    = ctx->type.dataType.IsReference();
+			ctx->property_var    = ctx->type.isVariable;
 		}
 
 		// The setter's parameter type is used as the property type,
@@ -14217,6 +14259,7 @@ int asCCompiler::ProcessPropertySetAccessor(asCExprContext *ctx, asCExprContext
 		ctx->type.dataType = asCDataType::CreateType(func->objectType, ctx->property_const);
 		if( ctx->property_handle ) ctx->type.dataType.MakeHandle(true);
 		if( ctx->property_ref )	ctx->type.dataType.MakeReference(true);
+		ctx->type.isVariable = ctx->property_var;
 
 		// Don't allow the call if the object is read-only and the property accessor is not const
 		if( ctx->property_const && !func->IsReadOnly() )
@@ -14346,6 +14389,7 @@ int asCCompiler::ProcessPropertyGetSetAccessor(asCExprContext *ctx, asCExprConte
 		lctx->bc.InstrSHORT(asBC_PSF, (short)offset);
 		lctx->type.stackOffset = (short)offset;
 		lctx->property_ref = true;
+		lctx->property_var = false;
 
 		// Don't release the temporary variable too early
 		lctx->type.isTemporary = false;
@@ -14361,6 +14405,7 @@ int asCCompiler::ProcessPropertyGetSetAccessor(asCExprContext *ctx, asCExprConte
 	llctx.property_get    = lctx->property_get;
 	llctx.property_handle = lctx->property_handle;
 	llctx.property_ref    = lctx->property_ref;
+	llctx.property_var    = lctx->property_var;
 	llctx.property_set    = lctx->property_set;
 
 	// Compile the dual operator using the get accessor
@@ -14424,6 +14469,7 @@ int asCCompiler::ProcessPropertyGetAccessor(asCExprContext *ctx, asCScriptNode *
 		ctx->type.dataType = asCDataType::CreateType(func->objectType, ctx->property_const);
 		if( ctx->property_handle ) ctx->type.dataType.MakeHandle(true);
 		if( ctx->property_ref ) ctx->type.dataType.MakeReference(true);
+		ctx->type.isVariable = ctx->property_var;
 
 		// Don't allow the call if the object is read-only and the property accessor is not const
 		if( ctx->property_const && !func->IsReadOnly() )
@@ -17628,6 +17674,47 @@ void asCCompiler::CompileOperatorOnHandles(asCScriptNode *node, asCExprContext *
 }
 
 
+// Returns the type of the object if it is known at compile time, i.e. the expression is a local
+// variable of a script class that is not a handle. Such a variable always holds an object of the
+// declared type, since assignments copy the value rather than replacing the object
+asCObjectType *asCCompiler::GetExactObjectType(asCExprContext *ctx)
+{
+	if( !ctx->type.isVariable || ctx->type.isTemporary || ctx->type.stackOffset <= 0 )
+		return 0;
+
+	sVariable *var = variables->GetVariableByOffset(ctx->type.stackOffset);
+	if( var == 0 || var->type.IsObjectHandle() || var->type.IsReference() )
+		return 0;
+
+	asCObjectType *ot = CastToObjectType(var->type.GetTypeInfo());
+	if( ot == 0 || !(ot->flags & asOBJ_SCRIPT_OBJECT) || ot != ctx->type.dataType.GetTypeInfo() )
+		return 0;
+
+	return ot;
+}
+
+// Returns the implementation of the virtual method if it can be determined at compile time, i.e. when
+// the true type of the object is known, or when the method cannot be overridden in derived classes
+asCScriptFunction *asCCompiler::GetDevirtualizedMethod(asCScriptFunction *descr, asCExprContext *ctx)
+{
+	asCObjectType *ot = GetExactObjectType(ctx);
+	bool isExact = ot != 0;
+	if( ot == 0 )
+		ot = CastToObjectType(ctx->type.dataType.GetTypeInfo());
+	if( ot == 0 || !(ot->flags & asOBJ_SCRIPT_OBJECT) || !ot->DerivesFrom(descr->objectType) ||
+		descr->vfTableIdx < 0 || asUINT(descr->vfTableIdx) >= ot->virtualFunctionTable.GetLength() )
+		return 0;
+
+	asCScriptFunction *realFunc = ot->virtualFunctionTable[descr->vfTableIdx];
+	if( realFunc == 0 || realFunc->funcType != asFUNC_SCRIPT )
+		return 0;
+
+	if( isExact || (ot->flags & asOBJ_NOINHERIT) || realFunc->IsFinal() )
+		return realFunc;
+
+	return 0;
+}
+
 void asCCompiler::PerformFunctionCall(int funcId, asCExprContext *ctx, bool isConstructor, asCArray<asCExprContext*> *args, asCObjectType *objType, bool useVariable, int varOffset, int funcPtrVar)
 {
 	asCScriptFunction *descr = builder->GetFunctionDescription(funcId);
@@ -17795,15 +17882,16 @@ void asCCompiler::PerformFunctionCall(int funcId, asCExprContext *ctx, bool isCo
 		if( descr->DoesReturnOnStack() )
 			argSize += AS_PTR_SIZE;
 
-		// TODO: runtime optimize: If it is known that a class method cannot be overridden the call
-		//                         should be made with asBC_CALL as it is faster. Examples where this
-		//                         is known is for example finalled methods where the class doesn't derive
-		//                         from any other, or even non-finalled methods but where it is known
-		//                         at compile time the true type of the object. The first should be
-		//                         quite easy to determine, but the latter will be quite complex and possibly
-		//                         not worth it.
+		// If it is known which implementation of a virtual method will be called, e.g. because
+		// the method or class is final, the call is made with asBC_CALL as it is faster
+		asCScriptFunction *realFunc = 0;
+		if( descr->funcType == asFUNC_VIRTUAL && engine->ep.optimizeByteCode )
+			realFunc = GetDevirtualizedMethod(descr, ctx);
+
 		if( descr->funcType == asFUNC_IMPORTED )
 			ctx->bc.Call(asBC_CALLBND , descr->id, argSize);
+		else if( realFunc )
+			ctx->bc.Call(asBC_CALL, realFunc->id, argSize);
 		// TODO: Maybe we need two different byte codes
 		else if( descr->funcType == asFUNC_INTERFACE || descr->funcType == asFUNC_VIRTUAL )
 			ctx->bc.Call(asBC_CALLINTF, descr->id, argSize);
@@ -18350,6 +18438,7 @@ void asCExprContext::Clear()
 	property_const = false;
 	property_handle = false;
 	property_ref = false;
+	property_var = false;
 	methodName = "";
 	enumValue = "";
 	symbolNamespace = 0;
@@ -18438,6 +18527,7 @@ void asCExprContext::Copy(asCExprContext *other)
 	property_const      = other->property_const;
 	property_handle     = other->property_handle;
 	property_ref        = other->property_ref;
+	property_var        = other->property_var;
 	property_arg        = other->property_arg;
 	exprNode            = other->exprNode;
 	methodName          = other->methodName;
@@ -160,6 +160,7 @@ struct asCExprContext
 	bool property_const;   // If the object that is being accessed through property accessor is read-only
 	bool property_handle;  // If the property accessor is called on an object stored in a handle
 	bool property_ref;     // If the property accessor is called on a reference
+	bool property_var;     // If the property accessor is called on an object stored in a variable
 	bool isVoidExpression; // Set to true if the expression is an explicit 'void', e.g. used to ignore out parameters in func calls
 	bool isCleanArg;       // Set to true if the expression has only been initialized with default constructor
 	asCExprContext *property_arg;
@@ -353,6 +354,8 @@ protected:
 	asUINT MatchArgument(asCArray<int> &funcs, asCArray<asSOverloadCandidate> &matches, const asCExprContext *argExpr, int paramNum, bool allowObjectConstruct = true);
 	int  MatchArgument(asCScriptFunction *desc, const asCExprContext *argExpr, int paramNum, bool allowObjectConstruct = true);
 	void PerformFunctionCall(int funcId, asCExprContext *out, bool isConstructor = false, asCArray<asCExprContext*> *args = 0, asCObjectType *objTypeForConstruct = 0, bool useVariable = false, int varOffset = 0, int funcPtrVar = 0);
+	asCObjectType *GetExactObjectType(asCExprContext *ctx);
+	asCScriptFunction *GetDevirtualizedMethod(asCScriptFunction *descr, asCExprContext *ctx);
 	void MoveArgsToStack(int funcId, asCByteCode *bc, asCArray<asCExprContext *> &args, bool addOneToOffset);
 	int  MakeFunctionCall(asCExprContext *ctx, int funcId, asCObjectType *objectType, asCArray<asCExprContext*> &args, asCScriptNode *node, bool useVariable = false, int stackOffset = 0, int funcPtrVar = 0);
 	int  PrepareFunctionCall(int funcId, asCByteCode *bc, asCArray<asCExprContext *> &args);
@@ -431,6 +434,9 @@ protected:
 
 	bool hasCompileErrors;
 
+	// Set when the function is compiled in parallel with other functions
+	sCompileTask *compileTask;
+
 	int nextLabel;
 	int numLambdas;
 
@@ -36,6 +36,7 @@
 //
 
 #include <math.h> // fmodf() pow()
+#include <cstdlib> // qsort
 
 #include "as_config.h"
 #include "as_context.h"
@@ -140,6 +141,250 @@ public:
 
 #endif
 
+#ifdef AS_BYTECODE_STATS
+
+// Counts the sequences of one, two and three instructions executed by all
+// contexts. The contexts record the executed instructions in a small buffer
+// of their own, and add it to the shared counters only when it is full or
+// when the execution returns, so the lock is not taken for each instruction.
+class asCByteCodeStats
+{
+public:
+	asCByteCodeStats()
+	{
+		Clear();
+	}
+
+	void Reset()
+	{
+		ENTERCRITICALSECTION(cs);
+		Clear();
+		LEAVECRITICALSECTION(cs);
+	}
+
+	// The instructions before start have already been counted, and are
+	// only in the trace to complete the sequences that follow them
+	void Add(const asBYTE *trace, asUINT length, asUINT start)
+	{
+		ENTERCRITICALSECTION(cs);
+		for( asUINT n = start; n < length; n++ )
+		{
+			counts1[trace[n]]++;
+			if( n >= 1 )
+				counts2[trace[n-1]*256 + trace[n]]++;
+			if( n >= 2 )
+				AddTriple(trace[n-2] | (trace[n-1] << 8) | (trace[n] << 16));
+		}
+		sorted = false;
+		LEAVECRITICALSECTION(cs);
+	}
+
+	asUINT GetCount(asUINT length)
+	{
+		if( length < 1 || length > 3 )
+			return 0;
+
+		ENTERCRITICALSECTION(cs);
+		Sort();
+		asUINT count = ranking[length-1].GetLength();
+		LEAVECRITICALSECTION(cs);
+		return count;
+	}
+
+	int Get(asUINT length, asUINT index, asBYTE *opcodes, asQWORD *count)
+	{
+		if( length < 1 || length > 3 )
+			return asINVALID_ARG;
+
+		int r = asINVALID_ARG;
+		ENTERCRITICALSECTION(cs);
+		Sort();
+		if( index < ranking[length-1].GetLength() )
+		{
+			const sNGram &g = ranking[length-1][index];
+			if( opcodes )
+			{
+				for( asUINT n = 0; n < length; n++ )
+					opcodes[n] = asBYTE(g.key >> (8*n));
+			}
+			if( count )
+				*count = g.count;
+			r = asSUCCESS;
+		}
+		LEAVECRITICALSECTION(cs);
+		return r;
+	}
+
+protected:
+	struct sNGram
+	{
+		asDWORD key;
+		asQWORD count;
+	};
+
+	void Clear()
+	{
+		memset(counts1, 0, sizeof(counts1));
+		memset(counts2, 0, sizeof(counts2));
+		keys3.SetLength(0);
+		counts3.SetLength(0);
+		used3 = 0;
+		for( asUINT n = 0; n < 3; n++ )
+			ranking[n].SetLength(0);
+		sorted = true;
+	}
+
+	// The triples are kept in an open addressed hash table, since only a small
+	// part of the possible sequences are ever executed. A key of 0 is a free slot
+	void AddTriple(asDWORD key)
+	{
+		key |= 0x1000000;
+		if( (used3+1)*2 > keys3.GetLength() )
+		{
+			asCArray<asDWORD> oldKeys;
+			asCArray<asQWORD> oldCounts;
+			oldKeys.Concatenate(keys3);
+			oldCounts.Concatenate(counts3);
+
+			asUINT size = keys3.GetLength() ? keys3.GetLength()*2 : 1024;
+			keys3.SetLength(size);
+			counts3.SetLength(size);
+			memset(keys3.AddressOf(), 0, size*sizeof(asDWORD));
+			for( asUINT n = 0; n < oldKeys.GetLength(); n++ )
+			{
+				if( oldKeys[n] == 0 ) continue;
+				asUINT slot = FindSlot(oldKeys[n]);
+				keys3[slot] = oldKeys[n];
+				counts3[slot] = oldCounts[n];
+			}
+		}
+
+		asUINT slot = FindSlot(key);
+		if( keys3[slot] == 0 )
+		{
+			keys3[slot] = key;
+			counts3[slot] = 0;
+			used3++;
+		}
+		counts3[slot]++;
+	}
+
+	asUINT FindSlot(asDWORD key)
+	{
+		asUINT mask = keys3.GetLength() - 1;
+		asUINT slot = (key * 2654435761u) & mask;
+		while( keys3[slot] && keys3[slot] != key )
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	// Builds the lists of sequences ordered by how often they were executed
+	void Sort()
+	{
+		if( sorted )
+			return;
+
+		sNGram g;
+		for( asUINT n = 0; n < 3; n++ )
+			ranking[n].SetLength(0);
+		for( asUINT n = 0; n < 256; n++ )
+		{
+			if( counts1[n] == 0 ) continue;
+			g.key = n; g.count = counts1[n];
+			ranking[0].PushLast(g);
+		}
+		for( asUINT n = 0; n < 256*256; n++ )
+		{
+			if( counts2[n] == 0 ) continue;
+			g.key = (n >> 8) | ((n & 0xFF) << 8); g.count = counts2[n];
+			ranking[1].PushLast(g);
+		}
+		for( asUINT n = 0; n < keys3.GetLength(); n++ )
+		{
+			if( keys3[n] == 0 ) continue;
+			g.key = keys3[n] & 0xFFFFFF; g.count = counts3[n];
+			ranking[2].PushLast(g);
+		}
+
+		struct C
+		{
+			static int cmp(const void *a, const void *b)
+			{
+				const sNGram *ga = reinterpret_cast<const sNGram*>(a);
+				const sNGram *gb = reinterpret_cast<const sNGram*>(b);
+				if( ga->count != gb->count )
+					return ga->count > gb->count ? -1 : 1;
+				return ga->key < gb->key ? -1 : (ga->key > gb->key ? 1 : 0);
+			}
+		};
+		for( asUINT n = 0; n < 3; n++ )
+			if( ranking[n].GetLength() > 1 )
+				std::qsort(ranking[n].AddressOf(), ranking[n].GetLength(), sizeof(sNGram), C::cmp);
+
+		sorted = true;
+	}
+
+	DECLARECRITICALSECTION(cs);
+	asQWORD           counts1[256];
+	asQWORD           counts2[256*256];
+	asCArray<asDWORD> keys3;
+	asCArray<asQWORD> counts3;
+	asUINT            used3;
+	asCArray<sNGram>  ranking[3];
+	bool              sorted;
+} g_byteCodeStats;
+
+// internal
+void asCContext::FlushByteCodeStats()
+{
+	g_byteCodeStats.Add(m_bcTrace, m_bcTraceLength, m_bcTraceKept);
+
+	// Keep the last two instructions so the sequences
+	// that continue in the next buffer are complete
+	m_bcTraceKept = m_bcTraceLength < 2 ? m_bcTraceLength : 2;
+	for( asUINT n = 0; n < m_bcTraceKept; n++ )
+		m_bcTrace[n] = m_bcTrace[m_bcTraceLength - m_bcTraceKept + n];
+	m_bcTraceLength = m_bcTraceKept;
+}
+
+#endif
+
+// interface
+AS_API int asResetByteCodeStats()
+{
+#ifdef AS_BYTECODE_STATS
+	g_byteCodeStats.Reset();
+	return asSUCCESS;
+#else
+	return asNOT_SUPPORTED;
+#endif
+}
+
+// interface
+AS_API asUINT asGetByteCodeStatsCount(asUINT length)
+{
+#ifdef AS_BYTECODE_STATS
+	return g_byteCodeStats.GetCount(length);
+#else
+	UNUSED_VAR(length);
+	return 0;
+#endif
+}
+
+// interface
+AS_API int asGetByteCodeStats(asUINT length, asUINT index, asBYTE *opcodes, asQWORD *count)
+{
+#ifdef AS_BYTECODE_STATS
+	return g_byteCodeStats.Get(length, index, opcodes, count);
+#else
+	UNUSED_VAR(length);
+	UNUSED_VAR(index);
+	UNUSED_VAR(opcodes);
+	UNUSED_VAR(count);
+	return asNOT_SUPPORTED;
+#endif
+}
+
 // interface
 AS_API asIScriptContext *asGetActiveContext()
 {
@@ -200,12 +445,18 @@ asCContext::asCContext(asCScriptEngine *engine, bool holdRef)
 	m_lineCallback              = false;
 	m_exceptionCallback         = false;
 	m_functionCallback          = false;
+	m_sampleCallback            = false;
+	m_sampleRequested           = false;
 	m_regs.doProcessSuspend     = false;
 	m_doSuspend                 = false;
 	m_exceptionWillBeCaught     = false;
 	m_regs.ctx                  = this;
 	m_regs.objectRegister       = 0;
 	m_regs.objectType           = 0;
+#ifdef AS_BYTECODE_STATS
+	m_bcTraceLength             = 0;
+	m_bcTraceKept               = 0;
+#endif
 }
 
 asCContext::~asCContext()
@@ -280,17 +531,11 @@ void asCContext::DetachEngine()
 	}
 	while( IsNested() );
 
-	// Free the stack blocks
+	// Return the stack blocks to the engine so other contexts can reuse them
 	for( asUINT n = 0; n < m_stackBlocks.GetLength(); n++ )
 	{
 		if( m_stackBlocks[n] )
-		{
-#ifndef WIP_16BYTE_ALIGN
-			asDELETEARRAY(m_stackBlocks[n]);
-#else
-			asDELETEARRAYALIGNED(m_stackBlocks[n]);
-#endif
-		}
+			m_engine->memoryMgr.FreeStackBlock(m_stackBlocks[n], m_stackBlockSize << n);
 	}
 	m_stackBlocks.SetLength(0);
 	m_stackBlockSize = 0;
@@ -307,6 +552,10 @@ void asCContext::DetachEngine()
 	}
 	m_userData.SetLength(0);
 
+	ACQUIREEXCLUSIVE(m_engine->engineRWLock);
+	m_engine->contexts.RemoveValue(this);
+	RELEASEEXCLUSIVE(m_engine->engineRWLock);
+
 	// Clear engine pointer
 	if( m_holdEngineRef )
 		m_engine->Release();
@@ -777,7 +1026,7 @@ int asCContext::Prepare(asIScriptFunction *func)
 		m_exceptionFunction       = 0;
 		m_doAbort                 = false;
 		m_doSuspend               = false;
-		m_regs.doProcessSuspend   = m_lineCallback;
+		m_regs.doProcessSuspend   = m_lineCallback || m_sampleRequested;
 		m_externalSuspendRequest  = false;
 	}
 	m_status = asEXECUTION_PREPARED;
@@ -1529,6 +1778,13 @@ int asCContext::Execute()
 			CleanStack(true);
 	}
 
+#ifdef AS_BYTECODE_STATS
+	// The sequences don't continue into the next execution
+	FlushByteCodeStats();
+	m_bcTraceLength = 0;
+	m_bcTraceKept   = 0;
+#endif
+
 	if( m_lineCallback )
 	{
 		// Call the line callback one last time before leaving
@@ -1537,7 +1793,8 @@ int asCContext::Execute()
 		m_regs.doProcessSuspend = true;
 	}
 	else
-		m_regs.doProcessSuspend = false;
+		// A sample that is still pending will be taken in the next execution
+		m_regs.doProcessSuspend = m_sampleRequested;
 
 	m_doSuspend = false;
 
@@ -1560,6 +1817,15 @@ int asCContext::Execute()
 	// Pop the active context
 	asPopActiveContext(tld, this);
 
+	// Give back the stack memory of a deep call, unless the execution will be resumed
+	if( m_engine->ep.stackHighWaterMark && m_status != asEXECUTION_SUSPENDED )
+	{
+		asUINT allocated = 0;
+		GetStackStatistics(&allocated);
+		if( allocated > m_engine->ep.stackHighWaterMark )
+			TrimStack();
+	}
+
 	if( m_status == asEXECUTION_FINISHED )
 	{
 		m_regs.objectType = m_initialFunction->returnType.GetTypeInfo();
@@ -1955,6 +2221,40 @@ int asCContext::GetLineNumber(asUINT stackLevel, int *column, const char **secti
 	return (line & 0xFFFFF);
 }
 
+// interface
+int asCContext::TrimStack()
+{
+	// The stack pointers cannot be trusted until the deserialization is completed
+	if( m_status == asEXECUTION_DESERIALIZATION )
+		return asCONTEXT_ACTIVE;
+
+	if( m_stackBlocks.GetLength() == 0 )
+		return asSUCCESS;
+
+	// The blocks above the current one are not in use, even if the context is
+	// active, so they can be returned to the engine. When the context is idle
+	// this brings it back to the initial block
+	while( m_stackBlocks.GetLength() > m_stackIndex + 1 )
+	{
+		asUINT n = m_stackBlocks.GetLength() - 1;
+		m_engine->memoryMgr.FreeStackBlock(m_stackBlocks[n], m_stackBlockSize << n);
+		m_stackBlocks.PopLast();
+	}
+
+	return asSUCCESS;
+}
+
+// interface
+int asCContext::GetStackStatistics(asUINT *allocatedBytes, asUINT *blockCount) const
+{
+	// Each block is twice the size of the previous one
+	asUINT numBlocks = m_stackBlocks.GetLength();
+	if( allocatedBytes ) *allocatedBytes = numBlocks ? m_stackBlockSize * ((1 << numBlocks) - 1) * 4 : 0;
+	if( blockCount )     *blockCount     = numBlocks;
+
+	return asSUCCESS;
+}
+
 // internal
 bool asCContext::ReserveStackSpace(asUINT size)
 {
@@ -1973,11 +2273,7 @@ bool asCContext::ReserveStackSpace(asUINT size)
 		m_stackBlockSize = m_engine->ep.initContextStackSize;
 		asASSERT( m_stackBlockSize > 0 );
 
-#ifndef WIP_16BYTE_ALIGN
-		asDWORD *stack = asNEWARRAY(asDWORD,m_stackBlockSize);
-#else
-		asDWORD *stack = asNEWARRAYALIGNED(asDWORD, m_stackBlockSize, MAX_TYPE_ALIGNMENT);
-#endif
+		asDWORD *stack = m_engine->memoryMgr.AllocStackBlock(m_stackBlockSize);
 		if( stack == 0 )
 		{
 			// Out of memory
@@ -2024,11 +2320,7 @@ bool asCContext::ReserveStackSpace(asUINT size)
 		if( m_stackBlocks.GetLength() == m_stackIndex )
 		{
 			// Allocate the new stack block, with twice the size of the previous
-#ifndef WIP_16BYTE_ALIGN
-			asDWORD *stack = asNEWARRAY(asDWORD, (m_stackBlockSize << m_stackIndex));
-#else
-			asDWORD *stack = asNEWARRAYALIGNED(asDWORD, (m_stackBlockSize << m_stackIndex), MAX_TYPE_ALIGNMENT);
-#endif
+			asDWORD *stack = m_engine->memoryMgr.AllocStackBlock(m_stackBlockSize << m_stackIndex);
 			if( stack == 0 )
 			{
 				// Out of memory
@@ -2135,6 +2427,8 @@ void asCContext::PrepareScriptFunction()
 	{
 		if( m_lineCallback )
 			CallLineCallback();
+		if( m_sampleRequested )
+			CallSampleCallback();
 		if( m_doSuspend )
 			m_status = asEXECUTION_SUSPENDED;
 	}
@@ -2166,17 +2460,22 @@ void asCContext::CallInterfaceMethod(asCScriptFunction *func)
 		bool found = false;
 		asCObjectType *findInterface = func->objectType;
 
-		// TODO: runtime optimize: The list of interfaces should be ordered by the address
-		//                         Then a binary search pattern can be used.
-		asUINT intfCount = asUINT(objType->interfaces.GetLength());
-		for( asUINT n = 0; n < intfCount; n++ )
+		// The interfaces are ordered by address so a binary search can be used
+		asUINT lo = 0, hi = asUINT(objType->sortedInterfaces.GetLength());
+		while( lo < hi )
 		{
-			if( objType->interfaces[n] == findInterface )
+			asUINT mid = (lo + hi) / 2;
+			asCObjectType *intf = objType->sortedInterfaces[mid];
+			if( intf == findInterface )
 			{
-				offset = objType->interfaceVFTOffsets[n];
+				offset = objType->sortedInterfaceVFTOffsets[mid];
 				found = true;
 				break;
 			}
+			if( intf < findInterface )
+				lo = mid + 1;
+			else
+				hi = mid;
 		}
 
 		if( !found )
@@ -2205,14 +2504,21 @@ void asCContext::CallInterfaceMethod(asCScriptFunction *func)
 	CallScriptFunction(realFunc);
 }
 
+// Records the instruction that is about to be executed when gathering bytecode statistics
+#ifdef AS_BYTECODE_STATS
+#define RECORD_INSTRUCTION() { if( m_bcTraceLength == sizeof(m_bcTrace) ) FlushByteCodeStats(); m_bcTrace[m_bcTraceLength++] = *(asBYTE*)l_bc; }
+#else
+#define RECORD_INSTRUCTION()
+#endif
+
 #if AS_USE_COMPUTED_GOTOS
 #define INSTRUCTION(x) case_##x
-#define NEXT_INSTRUCTION() goto *(void*) dispatch_table[*(asBYTE*)l_bc]
+#define NEXT_INSTRUCTION() { RECORD_INSTRUCTION(); goto *(void*) dispatch_table[*(asBYTE*)l_bc]; }
 #define BEGIN() NEXT_INSTRUCTION();
 #else
 #define INSTRUCTION(x) case x
 #define NEXT_INSTRUCTION() break
-#define BEGIN() switch( *(asBYTE*)l_bc )
+#define BEGIN() RECORD_INSTRUCTION(); switch( *(asBYTE*)l_bc )
 #endif
 
 void asCContext::ExecuteNext()
@@ -2269,10 +2575,9 @@ static const void *const dispatch_table[256] = {
 &&INSTRUCTION(asBC_JLowNZ),		&&INSTRUCTION(asBC_AllocMem),	&&INSTRUCTION(asBC_SetListSize),&&INSTRUCTION(asBC_PshListElmnt),
 &&INSTRUCTION(asBC_SetListType),&&INSTRUCTION(asBC_POWi),		&&INSTRUCTION(asBC_POWu),		&&INSTRUCTION(asBC_POWf),
 &&INSTRUCTION(asBC_POWd),		&&INSTRUCTION(asBC_POWdi),		&&INSTRUCTION(asBC_POWi64),		&&INSTRUCTION(asBC_POWu64),
-&&INSTRUCTION(asBC_Thiscall1),
+&&INSTRUCTION(asBC_Thiscall1),	&&INSTRUCTION(asBC_JEqIi),		&&INSTRUCTION(asBC_JNeIi),		&&INSTRUCTION(asBC_JLtIi),
+&&INSTRUCTION(asBC_JGeIi),		&&INSTRUCTION(asBC_JGtIi),		&&INSTRUCTION(asBC_JLeIi),		&&INSTRUCTION(asBC_PshVPtrOfs),
 
-								&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
-&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
@@ -2412,7 +2717,17 @@ static const void *const dispatch_table[256] = {
 			m_regs.stackPointer = l_sp;
 			m_regs.stackFramePointer = l_fp;
 
-			CallScriptFunction(m_engine->scriptFunctions[i]);
+			// Methods that are called directly, e.g. final methods, haven't had the object pointer verified
+			asCScriptFunction *func = m_engine->scriptFunctions[i];
+			if( func->objectType && *(asPWORD*)l_sp == 0 )
+			{
+				// Tell the exception handler to clean up the arguments to this method
+				m_needToCleanupArgs = true;
+				SetInternalException(TXT_NULL_POINTER_ACCESS);
+				return;
+			}
+
+			CallScriptFunction(func);
 
 			// Extract the values from the context again
 			l_bc = m_regs.programPointer;
@@ -2996,6 +3311,16 @@ static const void *const dispatch_table[256] = {
 
 			if( m_regs.doProcessSuspend )
 			{
+				// A sample requested during the call is attributed to the calling line
+				if( m_sampleRequested )
+				{
+					m_regs.programPointer    = l_bc - 2;
+					m_regs.stackPointer      = l_sp;
+					m_regs.stackFramePointer = l_fp;
+
+					CallSampleCallback();
+				}
+
 				// Should the execution be suspended?
 				if( m_doSuspend )
 				{
@@ -3091,6 +3416,14 @@ static const void *const dispatch_table[256] = {
 
 				CallLineCallback();
 			}
+			if( m_sampleRequested )
+			{
+				m_regs.programPointer    = l_bc;
+				m_regs.stackPointer      = l_sp;
+				m_regs.stackFramePointer = l_fp;
+
+				CallSampleCallback();
+			}
 			if( m_doSuspend )
 			{
 				l_bc++;
@@ -4893,16 +5226,70 @@ static const void *const dispatch_table[256] = {
 		}
 		NEXT_INSTRUCTION();
 
+	//-----------------------------------
+	// Fused instructions. These do the work of two instructions with a single dispatch
+
+	// CMPIi followed by a conditional jump. The value register is not updated
+	INSTRUCTION(asBC_JEqIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) == asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+	INSTRUCTION(asBC_JNeIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) != asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+	INSTRUCTION(asBC_JLtIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) < asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+	INSTRUCTION(asBC_JGeIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) >= asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+	INSTRUCTION(asBC_JGtIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) > asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+	INSTRUCTION(asBC_JLeIi):
+		if( *(int*)(l_fp - asBC_SWORDARG0(l_bc)) <= asBC_INTARG(l_bc) )
+			l_bc += asBC_INTARG(l_bc+1) + 3;
+		else
+			l_bc += 3;
+		NEXT_INSTRUCTION();
+
+	// PshVPtr followed by ADDSi
+	INSTRUCTION(asBC_PshVPtrOfs):
+		{
+			// The pointer must not be null
+			asPWORD a = *(asPWORD*)(l_fp - asBC_SWORDARG0(l_bc));
+			if( a == 0 )
+			{
+				m_regs.programPointer    = l_bc;
+				m_regs.stackPointer      = l_sp;
+				m_regs.stackFramePointer = l_fp;
+
+				SetInternalException(TXT_NULL_POINTER_ACCESS);
+				return;
+			}
+			l_sp -= AS_PTR_SIZE;
+			*(asPWORD*)l_sp = a + asBC_SWORDARG1(l_bc);
+		}
+		l_bc += 3;
+		NEXT_INSTRUCTION();
+
 	// Don't let the optimizer optimize for size,
 	// since it requires extra conditions and jumps
 #if AS_USE_COMPUTED_GOTOS == 0
-	INSTRUCTION(201): l_bc = (asDWORD*)201; goto case_FAULT;
-	INSTRUCTION(202): l_bc = (asDWORD*)202; goto case_FAULT;
-	INSTRUCTION(203): l_bc = (asDWORD*)203; goto case_FAULT;
-	INSTRUCTION(204): l_bc = (asDWORD*)204; goto case_FAULT;
-	INSTRUCTION(205): l_bc = (asDWORD*)205; goto case_FAULT;
-	INSTRUCTION(206): l_bc = (asDWORD*)206; goto case_FAULT;
-	INSTRUCTION(207): l_bc = (asDWORD*)207; goto case_FAULT;
 	INSTRUCTION(208): l_bc = (asDWORD*)208; goto case_FAULT;
 	INSTRUCTION(209): l_bc = (asDWORD*)209; goto case_FAULT;
 	INSTRUCTION(210): l_bc = (asDWORD*)210; goto case_FAULT;
@@ -4971,6 +5358,7 @@ static const void *const dispatch_table[256] = {
 #ifdef AS_DEBUG
 		asDWORD instr = *(asBYTE*)old;
 		if( instr != asBC_JMP && instr != asBC_JMPP && (instr < asBC_JZ || instr > asBC_JNP) && instr != asBC_JLowZ && instr != asBC_JLowNZ &&
+			(instr < asBC_JEqIi || instr > asBC_JLeIi) &&
 			instr != asBC_CALL && instr != asBC_CALLBND && instr != asBC_CALLINTF && instr != asBC_RET && instr != asBC_ALLOC && instr != asBC_CallPtr &&
 			instr != asBC_JitEntry )
 		{
@@ -5720,7 +6108,7 @@ int asCContext::SetLineCallback(const asSFuncPtr &callback, void *obj, int callC
 	bool isObj = false;
 	if( (unsigned)callConv == asCALL_GENERIC || (unsigned)callConv == asCALL_THISCALL_OBJFIRST || (unsigned)callConv == asCALL_THISCALL_OBJLAST )
 	{
-		m_regs.doProcessSuspend = m_doSuspend;
+		m_regs.doProcessSuspend = m_doSuspend || m_sampleRequested;
 		return asNOT_SUPPORTED;
 	}
 	if( (unsigned)callConv >= asCALL_THISCALL )
@@ -5728,7 +6116,7 @@ int asCContext::SetLineCallback(const asSFuncPtr &callback, void *obj, int callC
 		isObj = true;
 		if( obj == 0 )
 		{
-			m_regs.doProcessSuspend = m_doSuspend;
+			m_regs.doProcessSuspend = m_doSuspend || m_sampleRequested;
 			return asINVALID_ARG;
 		}
 	}
@@ -5740,7 +6128,7 @@ int asCContext::SetLineCallback(const asSFuncPtr &callback, void *obj, int callC
 
 	// The BC_SUSPEND instruction should be processed if either line
 	// callback is set or if the application has requested a suspension
-	m_regs.doProcessSuspend = m_doSuspend || m_lineCallback;
+	m_regs.doProcessSuspend = m_doSuspend || m_sampleRequested || m_lineCallback;
 
 	return r;
 }
@@ -5810,6 +6198,69 @@ void asCContext::ClearFunctionCallback()
 	m_functionCallback = false;
 }
 
+// interface
+int asCContext::SetSampleCallback(const asSFuncPtr &callback, void *obj, int callConv)
+{
+	// Turn off the callback while it is being changed, in case
+	// another thread requests a sample at the same time
+	m_sampleCallback = false;
+
+	m_sampleCallbackObj = obj;
+	bool isObj = false;
+	if( (unsigned)callConv == asCALL_GENERIC || (unsigned)callConv == asCALL_THISCALL_OBJFIRST || (unsigned)callConv == asCALL_THISCALL_OBJLAST )
+		return asNOT_SUPPORTED;
+	if( (unsigned)callConv >= asCALL_THISCALL )
+	{
+		isObj = true;
+		if( obj == 0 )
+			return asINVALID_ARG;
+	}
+	int r = DetectCallingConvention(isObj, callback, callConv, 0, &m_sampleCallbackFunc);
+	if( r >= 0 ) m_sampleCallback = true;
+	return r;
+}
+
+// interface
+void asCContext::ClearSampleCallback()
+{
+	m_sampleCallback = false;
+}
+
+// interface
+int asCContext::RequestSample()
+{
+	// Like Suspend, this just sets some flags and is safe to call from
+	// a secondary thread. The sample callback is invoked by the thread
+	// executing the script at the next line, function entry, or return
+	// from a registered function, where the call stack can be inspected.
+	if( m_engine == 0 ) return asERROR;
+	if( !m_sampleCallback ) return asNO_FUNCTION;
+
+	m_sampleRequested = true;
+	m_regs.doProcessSuspend = true;
+
+	return 0;
+}
+
+void asCContext::CallSampleCallback()
+{
+	// Turn off the processing of the suspend instructions again, unless something else needs it
+	m_sampleRequested = false;
+	m_regs.doProcessSuspend = m_doSuspend || m_lineCallback;
+
+	// Another thread may have set the flags again in the meantime
+	if( m_doSuspend || m_sampleRequested )
+		m_regs.doProcessSuspend = true;
+
+	if( !m_sampleCallback )
+		return;
+
+	if( m_sampleCallbackFunc.callConv < ICC_THISCALL )
+		m_engine->CallGlobalFunction(this, m_sampleCallbackObj, &m_sampleCallbackFunc, 0);
+	else
+		m_engine->CallObjectMethod(m_sampleCallbackObj, this, &m_sampleCallbackFunc, 0);
+}
+
 void asCContext::CallFunctionCallback(asCScriptFunction *func, bool pop)
 {
 	asSFunctionInfo msg;
@@ -5847,7 +6298,7 @@ void asCContext::HandleAppException()
 void asCContext::ClearLineCallback()
 {
 	m_lineCallback = false;
-	m_regs.doProcessSuspend = m_doSuspend;
+	m_regs.doProcessSuspend = m_doSuspend || m_sampleRequested;
 }
 
 // interface
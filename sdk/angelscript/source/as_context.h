@@ -72,6 +72,10 @@ public:
 	int             PopState();
 	bool            IsNested(asUINT *nestCount = 0) const;
 
+	// Stack memory
+	int             TrimStack();
+	int             GetStackStatistics(asUINT *allocatedBytes, asUINT *blockCount = 0) const;
+
 	// Object pointer for calling class methods
 	int SetObject(void *obj);
 
@@ -112,6 +116,9 @@ public:
 	int                SetFunctionCallback(const asSFuncPtr &callback, void *obj, int callConv);
 	void               ClearLineCallback();
     void               ClearFunctionCallback();
+	int                SetSampleCallback(const asSFuncPtr &callback, void *obj, int callConv);
+	void               ClearSampleCallback();
+	int                RequestSample();
 	asUINT             GetCallstackSize() const;
 	asIScriptFunction *GetFunction(asUINT stackLevel);
 	int                GetLineNumber(asUINT stackLevel, int *column, const char **sectionName);
@@ -158,6 +165,7 @@ public:
 	void CallLineCallback();
 	void CallExceptionCallback();
 	void CallFunctionCallback(asCScriptFunction *func, bool pop);
+	void CallSampleCallback();
 
 	int  CallGeneric(asCScriptFunction *func);
 #ifndef AS_NO_EXCEPTIONS
@@ -166,6 +174,9 @@ public:
 	void DetachEngine();
 
 	void ExecuteNext();
+#ifdef AS_BYTECODE_STATS
+	void FlushByteCodeStats();
+#endif
 	void CleanStack(bool catchException = false);
 	bool CleanStackFrame(bool catchException = false);
 	void CleanArgsOnStack();
@@ -247,10 +258,23 @@ public:
 	asSSystemFunctionInterface m_functionCallbackFunc;
 	void *                     m_functionCallbackObj;
 
+	bool                       m_sampleCallback;
+	bool                       m_sampleRequested;
+	asSSystemFunctionInterface m_sampleCallbackFunc;
+	void *                     m_sampleCallbackObj;
+
 	asCArray<asPWORD> m_userData;
 
 	// Registers available to JIT compiler functions
 	asSVMRegisters m_regs;
+
+#ifdef AS_BYTECODE_STATS
+	// Executed instructions that have not yet been added to the bytecode statistics.
+	// Kept last so the other members are at the same place in code compiled without the flag
+	asBYTE m_bcTrace[1024];
+	asUINT m_bcTraceLength;
+	asUINT m_bcTraceKept;
+#endif
 };
 
 // We need at least 2 PTRs on the stack reserved for exception handling
@@ -82,23 +82,57 @@ typedef double float64_t;
 
 
 
-#if defined(_MSC_VER) && defined(AS_PROFILE)
-// Currently only do profiling with MSVC++
+#if defined(AS_PROFILE)
+// Collects the time spent in the scopes marked with TimeIt. The scopes are
+// nested per thread, and the timings can be retrieved by the application
+// with asGetProfilerScope or exported with asWriteProfilerTrace
 
-#include <mmsystem.h>
+#if defined(_WIN32)
 #include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+#include <stdio.h>
+#include <string.h>
 #include "as_string.h"
-#include "as_map.h"
+#include "as_array.h"
 #include "as_string_util.h"
+#include "as_criticalsection.h"
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
+// The trace keeps one entry for each time a scope is executed, so it is limited
+// to not use up all the memory in long sessions. The many short executions of
+// the helper functions are left out, as they are seen in the summary anyway
+#ifndef AS_PROFILE_MAX_EVENTS
+#define AS_PROFILE_MAX_EVENTS 1000000
+#endif
+#ifndef AS_PROFILE_MIN_EVENT_TIME
+#define AS_PROFILE_MIN_EVENT_TIME 0.00001
+#endif
+
 struct TimeCount
 {
-	double time;
-	int    count;
-	double max;
-	double min;
+	TimeCount() : name(0), key(0), nameOffset(0), time(0), count(0), max(0), min(0) {}
+
+	const char       *name;
+	const asCString  *key;
+	asUINT            nameOffset;
+	asCArray<asUINT>  children;
+	double            time;
+	int               count;
+	double            max;
+	double            min;
+};
+
+struct TimeEvent
+{
+	asUINT scope;
+	asUINT threadId;
+	double begin;
+	double elapsed;
 };
 
 class CProfiler
@@ -106,91 +140,235 @@ class CProfiler
 public:
 	CProfiler()
 	{
-		// We need to know how often the clock is updated
-		__int64 tps;
-		if( !QueryPerformanceFrequency((LARGE_INTEGER *)&tps) )
-			usePerformance = false;
-		else
-		{
-			usePerformance = true;
-			ticksPerSecond = double(tps);
-		}
-
+		timeOffset = 0;
 		timeOffset = GetTime();
+		numThreads = 0;
+		numDroppedEvents = 0;
+		generation = 0;
 	}
 
 	~CProfiler()
 	{
 		WriteSummary();
+
+		asSMapNode<asCString, asCString*> *cursor = 0;
+		keys.MoveFirst(&cursor);
+		while( cursor )
+		{
+			asDELETE(cursor->value, asCString);
+			keys.MoveNext(&cursor, cursor);
+		}
 	}
 
+	// Returns the time in seconds since the profiler was created
 	double GetTime()
 	{
-		if( usePerformance )
+		return double(asGetTimeInMicroseconds())/1000000.0 - timeOffset;
+	}
+
+	// Enters the scope in the current thread and returns the index of the scope. The
+	// outer scope and its generation are returned so End can restore them afterwards
+	int Begin(const char *name, int *parentScope, asUINT *parentGeneration, asUINT *scopeGeneration, double *beginTime)
+	{
+		asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+		*parentScope = tld ? tld->profilerScope : -1;
+		*parentGeneration = tld ? tld->profilerGeneration : 0;
+
+		ENTERCRITICALSECTION(cs);
+
+		// If the profiler was reset after the outer scope was entered its index is no
+		// longer valid, so the scope is counted as an outermost scope instead
+		int parent = *parentGeneration == generation ? *parentScope : -1;
+
+		// The names are normally string constants, so the pointer is compared first
+		asCArray<asUINT> *siblings = parent >= 0 ? &scopes[parent].children : &roots;
+		int scope = -1;
+		for( asUINT n = 0; n < siblings->GetLength(); n++ )
+		{
+			const char *other = scopes[(*siblings)[n]].name;
+			if( other == name || strcmp(other, name) == 0 )
+			{
+				scope = (*siblings)[n];
+				break;
+			}
+		}
+
+		if( scope < 0 )
 		{
-			__int64 ticks;
-			QueryPerformanceCounter((LARGE_INTEGER *)&ticks);
+			// The scopes are stored in the order they are first entered, so the
+			// outer scopes always come before the scopes nested in them
+			scope = (int)scopes.GetLength();
+			scopes.PushLast(TimeCount());
+
+			TimeCount &tc = scopes[scope];
+			tc.name = name;
+			asCString key;
+			if( parent >= 0 )
+			{
+				key = *scopes[parent].key;
+				key += "|";
+			}
+			tc.nameOffset = key.GetLength();
+			key += name;
+			tc.key = InternKey(key);
+
+			if( parent >= 0 )
+				scopes[parent].children.PushLast(scope);
+			else
+				roots.PushLast(scope);
+		}
 
-			return double(ticks)/ticksPerSecond - timeOffset;
+		if( tld )
+		{
+			if( tld->profilerThreadId == 0 )
+				tld->profilerThreadId = ++numThreads;
+			tld->profilerScope = scope;
+			tld->profilerGeneration = generation;
 		}
-		
-		return double(timeGetTime())/1000.0 - timeOffset;
+		*scopeGeneration = generation;
+
+		LEAVECRITICALSECTION(cs);
+
+		*beginTime = GetTime();
+		return scope;
 	}
 
-	double Begin(const char *name)
+	void End(int scope, int parentScope, asUINT parentGeneration, asUINT scopeGeneration, double beginTime)
 	{
 		double time = GetTime();
+		double elapsed = time - beginTime;
+
+		asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+
+		ENTERCRITICALSECTION(cs);
+
+		// The scope is not counted if the profiler was reset while it was active
+		if( scopeGeneration != generation )
+		{
+			LEAVECRITICALSECTION(cs);
+			if( tld )
+			{
+				tld->profilerScope = parentScope;
+				tld->profilerGeneration = parentGeneration;
+			}
+			return;
+		}
 
-		// Add the scope to the key
-		if( key.GetLength() )
-			key += "|";
-		key += name;
+		// Update the profile info for this scope
+		TimeCount &tc = scopes[scope];
+		if( tc.count == 0 || tc.max < elapsed ) 
+			tc.max = elapsed;
+		if( tc.count == 0 || tc.min > elapsed ) 
+			tc.min = elapsed;
+		tc.time += elapsed;
+		tc.count++;
+
+		if( elapsed >= AS_PROFILE_MIN_EVENT_TIME )
+		{
+			if( events.GetLength() < AS_PROFILE_MAX_EVENTS )
+			{
+				TimeEvent ev = {asUINT(scope), tld ? tld->profilerThreadId : 0, beginTime, elapsed};
+				events.PushLast(ev);
+			}
+			else
+				numDroppedEvents++;
+		}
 
-		// Compensate for the time spent writing to the file
-		timeOffset += GetTime() - time;
+		LEAVECRITICALSECTION(cs);
 
-		return time;
+		// Return to the outer scope
+		if( tld )
+		{
+			tld->profilerScope = parentScope;
+			tld->profilerGeneration = parentGeneration;
+		}
 	}
 
-	void End(const char * /*name*/, double beginTime)
+	// Forgets the timings collected so far. The scopes that are active in other
+	// threads keep the indices from before, so the generation tells them apart
+	void Reset()
 	{
-		double time = GetTime();
+		ENTERCRITICALSECTION(cs);
+		generation++;
+		scopes.SetLength(0);
+		roots.SetLength(0);
+		events.SetLength(0);
+		numDroppedEvents = 0;
+		LEAVECRITICALSECTION(cs);
+	}
 
-		double elapsed = time - beginTime;
+	asUINT GetScopeCount()
+	{
+		ENTERCRITICALSECTION(cs);
+		asUINT count = scopes.GetLength();
+		LEAVECRITICALSECTION(cs);
+		return count;
+	}
 
-		// Update the profile info for this scope
-		asSMapNode<asCString, TimeCount> *cursor;
-		if( map.MoveTo(&cursor, key) )
+	int GetScope(asUINT index, const char **key, asUINT *count, double *time, double *min, double *max)
+	{
+		ENTERCRITICALSECTION(cs);
+		if( index >= scopes.GetLength() )
 		{
-			cursor->value.time += elapsed;
-			cursor->value.count++;
-			if( cursor->value.max < elapsed ) 
-				cursor->value.max = elapsed;
-			if( cursor->value.min > elapsed ) 
-				cursor->value.min = elapsed;
+			LEAVECRITICALSECTION(cs);
+			return asINVALID_ARG;
 		}
-		else
+
+		const TimeCount &tc = scopes[index];
+		if( key )   *key   = tc.key->AddressOf();
+		if( count ) *count = tc.count;
+		if( time )  *time  = tc.time;
+		if( min )   *min   = tc.min;
+		if( max )   *max   = tc.max;
+		LEAVECRITICALSECTION(cs);
+
+		return asSUCCESS;
+	}
+
+	// Writes the collected scopes in the Trace Event Format, which can be
+	// viewed with chrome://tracing or https://ui.perfetto.dev
+	int WriteTrace(const char *filename)
+	{
+		FILE *fp;
+		#if _MSC_VER >= 1500 && !defined(AS_MARMALADE)
+			fopen_s(&fp, filename, "wt");
+		#else
+			fp = fopen(filename, "wt");
+		#endif
+		if( fp == 0 )
+			return asERROR;
+
+		ENTERCRITICALSECTION(cs);
+
+		fprintf(fp, "{\"traceEvents\":[\n");
+		for( asUINT n = 0; n < events.GetLength(); n++ )
 		{
-			TimeCount tc = {elapsed, 1, elapsed, elapsed};
-			map.Insert(key, tc);
+			const TimeEvent &ev = events[n];
+			const TimeCount &tc = scopes[ev.scope];
+			fprintf(fp, "{\"name\":\"%s\",\"cat\":\"angelscript\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"scope\":\"%s\"}}%s\n", 
+				tc.key->AddressOf() + tc.nameOffset, ev.begin*1000000.0, ev.elapsed*1000000.0, ev.threadId, tc.key->AddressOf(), 
+				n + 1 < events.GetLength() ? "," : "");
 		}
+		fprintf(fp, "],\n\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%u}}\n", numDroppedEvents);
 
-		// Remove the inner most scope from the key
-		int n = key.FindLast("|");
-		if( n > 0 )
-			key.SetLength(n);
-		else
-			key.SetLength(0);
+		LEAVECRITICALSECTION(cs);
 
-		// Compensate for the time spent writing to the file
-		timeOffset += GetTime() - time;
+		fclose(fp);
+		return asSUCCESS;
 	}
 	
 protected:
 	void WriteSummary()
 	{
+		if( scopes.GetLength() == 0 )
+			return;
+
 		// Write the analyzed info into a file for inspection
+#if defined(_WIN32)
 		_mkdir("AS_DEBUG");
+#else
+		mkdir("AS_DEBUG", S_IRWXU);
+#endif
 		FILE *fp;
 		#if _MSC_VER >= 1500 && !defined(AS_MARMALADE)
 			fopen_s(&fp, "AS_DEBUG/profiling_summary.txt", "wt");
@@ -202,32 +380,45 @@ protected:
 
 		fprintf(fp, "%-60s %10s %15s %15s %15s %15s\n\n", "Scope", "Count", "Tot time", "Avg time", "Max time", "Min time");
 
-		asSMapNode<asCString, TimeCount> *cursor;
-		map.MoveLast(&cursor);
-		while( cursor )
+		for( asUINT n = 0; n < scopes.GetLength(); n++ )
 		{
-			asCString key = cursor->key;
-			int count;
-			int n = key.FindLast("|", &count);
-			if( count )
-			{
-				key = asCString("                                               ", count) + key.SubString(n+1);
-			}
+			const TimeCount &tc = scopes[n];
 
-			fprintf(fp, "%-60s %10d %15.6f %15.6f %15.6f %15.6f\n", key.AddressOf(), cursor->value.count, cursor->value.time, cursor->value.time / cursor->value.count, cursor->value.max, cursor->value.min);
+			// Indent the scope by its depth
+			int count;
+			tc.key->FindLast("|", &count);
+			asCString key = asCString("                                               ", count) + (tc.key->AddressOf() + tc.nameOffset);
 
-			map.MovePrev(&cursor, cursor);
+			fprintf(fp, "%-60s %10d %15.6f %15.6f %15.6f %15.6f\n", key.AddressOf(), tc.count, tc.time, tc.count ? tc.time / tc.count : 0, tc.max, tc.min);
 		}
 
 		fclose(fp);
 	}
 
 	double  timeOffset;
-	double  ticksPerSecond;
-	bool    usePerformance;
+	asUINT  numThreads;
+	asUINT  numDroppedEvents;
+	asUINT  generation;
+
+	// Returns a string with the same content whose address stays the same until the
+	// profiler is destroyed, so the application can keep it even if the scopes array
+	// is reallocated or the profiler is reset. Must be called with the lock held
+	const asCString *InternKey(const asCString &key)
+	{
+		asSMapNode<asCString, asCString*> *cursor = 0;
+		if( keys.MoveTo(&cursor, key) )
+			return cursor->value;
+
+		asCString *str = asNEW(asCString)(key);
+		keys.Insert(key, str);
+		return str;
+	}
 
-	asCString                    key;
-	asCMap<asCString, TimeCount> map;
+	asCArray<TimeCount>       scopes;
+	asCMap<asCString, asCString*> keys;
+	asCArray<asUINT>          roots;
+	asCArray<TimeEvent>       events;
+	DECLARECRITICALSECTION(cs)
 };
 
 extern CProfiler g_profiler;
@@ -237,30 +428,32 @@ class CProfilerScope
 public:
 	CProfilerScope(const char *name)
 	{
-		this->name = name;
-		beginTime = g_profiler.Begin(name);
+		scope = g_profiler.Begin(name, &parentScope, &parentGeneration, &generation, &beginTime);
 	}
 
 	~CProfilerScope()
 	{
-		g_profiler.End(name, beginTime);
+		g_profiler.End(scope, parentScope, parentGeneration, generation, beginTime);
 	}
 
 protected:
-	const char *name;
-	double      beginTime;
+	int    scope;
+	int    parentScope;
+	asUINT parentGeneration;
+	asUINT generation;
+	double beginTime;
 };
 
 #define TimeIt(x) CProfilerScope profilescope(x)
 
 END_AS_NAMESPACE
 
-#else // !(_MSC_VER && AS_PROFILE)
+#else // !AS_PROFILE
 
 // Define it so nothing is done
 #define TimeIt(x) 
 
-#endif // !(_MSC_VER && AS_PROFILE)
+#endif // !AS_PROFILE
 
 
 
@@ -0,0 +1,173 @@
+/*
+   AngelCode Scripting Library
+   Copyright (c) 2025 Andreas Jonsson
+
+   This software is provided 'as-is', without any express or implied 
+   warranty. In no event will the authors be held liable for any 
+   damages arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any 
+   purpose, including commercial applications, and to alter it and 
+   redistribute it freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you 
+      must not claim that you wrote the original software. If you use
+      this software in a product, an acknowledgment in the product 
+      documentation would be appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and 
+      must not be misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source 
+      distribution.
+
+   The original version of this library can be located at:
+   http://www.angelcode.com/angelscript/
+
+   Andreas Jonsson
+   andreas@angelcode.com
+*/
+
+
+//
+// as_declcache.cpp
+//
+// Caches the results of looking up functions and types by their declaration
+//
+
+
+#include "as_config.h"
+#include "as_declcache.h"
+#include "as_scriptengine.h"
+
+BEGIN_AS_NAMESPACE
+
+asCDeclCache::asCDeclCache()
+{
+	m_version = 0;
+}
+
+asCDeclCache::~asCDeclCache()
+{
+	Clear();
+}
+
+void asCDeclCache::Clear()
+{
+	asCSymbolTableIterator<asSDeclCacheEntry> it = m_functions.List();
+	while( it )
+	{
+		asDELETE(*it, asSDeclCacheEntry);
+		it++;
+	}
+	m_functions.Clear();
+
+	it = m_dataTypes.List();
+	while( it )
+	{
+		asDELETE(*it, asSDeclCacheEntry);
+		it++;
+	}
+	m_dataTypes.Clear();
+}
+
+// Must be called with the engine's declCacheCs held
+bool asCDeclCache::IsValid(const asCScriptEngine *engine)
+{
+	asDWORD version = engine->declCacheVersion.get();
+	if( m_version == version )
+		return true;
+
+	// Something has changed since the results were stored
+	Clear();
+	m_version = version;
+	return false;
+}
+
+bool asCDeclCache::GetFunction(const asCScriptEngine *engine, const asSNameSpace *ns, const char *decl, asCScriptFunction **func)
+{
+	bool found = false;
+
+	ENTERCRITICALSECTION(engine->declCacheCs);
+	if( IsValid(engine) )
+	{
+		int idx = m_functions.GetFirstIndex(ns, decl, strlen(decl));
+		if( idx >= 0 )
+		{
+			*func = m_functions.Get(idx)->func;
+			found = true;
+		}
+	}
+	LEAVECRITICALSECTION(engine->declCacheCs);
+
+	return found;
+}
+
+void asCDeclCache::PutFunction(const asCScriptEngine *engine, asDWORD version, const asSNameSpace *ns, const char *decl, asCScriptFunction *func)
+{
+	ENTERCRITICALSECTION(engine->declCacheCs);
+	if( version == engine->declCacheVersion.get() )
+	{
+		IsValid(engine);
+
+		// Another thread may have stored the same declaration in the meantime
+		if( m_functions.GetFirstIndex(ns, decl, strlen(decl)) < 0 )
+		{
+			asSDeclCacheEntry *entry = asNEW(asSDeclCacheEntry);
+			if( entry )
+			{
+				entry->nameSpace = ns;
+				entry->name      = decl;
+				entry->func      = func;
+				m_functions.Put(entry);
+			}
+		}
+	}
+	LEAVECRITICALSECTION(engine->declCacheCs);
+}
+
+bool asCDeclCache::GetDataType(const asCScriptEngine *engine, const asSNameSpace *ns, const char *decl, asCDataType *dt)
+{
+	bool found = false;
+
+	ENTERCRITICALSECTION(engine->declCacheCs);
+	if( IsValid(engine) )
+	{
+		int idx = m_dataTypes.GetFirstIndex(ns, decl, strlen(decl));
+		if( idx >= 0 )
+		{
+			*dt = m_dataTypes.Get(idx)->dataType;
+			found = true;
+		}
+	}
+	LEAVECRITICALSECTION(engine->declCacheCs);
+
+	return found;
+}
+
+void asCDeclCache::PutDataType(const asCScriptEngine *engine, asDWORD version, const asSNameSpace *ns, const char *decl, const asCDataType &dt)
+{
+	ENTERCRITICALSECTION(engine->declCacheCs);
+	if( version == engine->declCacheVersion.get() )
+	{
+		IsValid(engine);
+
+		// Another thread may have stored the same declaration in the meantime
+		if( m_dataTypes.GetFirstIndex(ns, decl, strlen(decl)) < 0 )
+		{
+			asSDeclCacheEntry *entry = asNEW(asSDeclCacheEntry);
+			if( entry )
+			{
+				entry->nameSpace = ns;
+				entry->name      = decl;
+				entry->func      = 0;
+				entry->dataType  = dt;
+				m_dataTypes.Put(entry);
+			}
+		}
+	}
+	LEAVECRITICALSECTION(engine->declCacheCs);
+}
+
+END_AS_NAMESPACE
+
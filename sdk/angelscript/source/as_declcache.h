@@ -0,0 +1,92 @@
+/*
+   AngelCode Scripting Library
+   Copyright (c) 2025 Andreas Jonsson
+
+   This software is provided 'as-is', without any express or implied 
+   warranty. In no event will the authors be held liable for any 
+   damages arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any 
+   purpose, including commercial applications, and to alter it and 
+   redistribute it freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you 
+      must not claim that you wrote the original software. If you use
+      this software in a product, an acknowledgment in the product 
+      documentation would be appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and 
+      must not be misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source 
+      distribution.
+
+   The original version of this library can be located at:
+   http://www.angelcode.com/angelscript/
+
+   Andreas Jonsson
+   andreas@angelcode.com
+*/
+
+
+//
+// as_declcache.h
+//
+// Caches the results of looking up functions and types by their declaration
+//
+
+
+
+#ifndef AS_DECLCACHE_H
+#define AS_DECLCACHE_H
+
+#include "as_config.h"
+#include "as_string.h"
+#include "as_datatype.h"
+#include "as_namespace.h"
+#include "as_symboltable.h"
+
+BEGIN_AS_NAMESPACE
+
+class asCScriptEngine;
+class asCScriptFunction;
+
+// Result of looking up a declaration. The declaration is stored as the name
+// so the entries can be kept in a symbol table together with the namespace
+// that was the default namespace when the declaration was parsed
+struct asSDeclCacheEntry
+{
+	const asSNameSpace *nameSpace;
+	asCString           name;
+	asCScriptFunction  *func;
+	asCDataType         dataType;
+};
+
+// Cache of the results of GetFunctionByDecl, GetMethodByDecl, GetTypeIdByDecl and GetTypeInfoByDecl.
+// The cache is emptied whenever the engine's declCacheVersion changes, which happens when anything
+// is registered, removed, built, or destroyed that could change the result of a lookup
+class asCDeclCache
+{
+public:
+	asCDeclCache();
+	~asCDeclCache();
+
+	// The version must be read from the engine before the declaration is parsed
+	// so results found with an outdated configuration are not stored
+	bool GetFunction(const asCScriptEngine *engine, const asSNameSpace *ns, const char *decl, asCScriptFunction **func);
+	void PutFunction(const asCScriptEngine *engine, asDWORD version, const asSNameSpace *ns, const char *decl, asCScriptFunction *func);
+	bool GetDataType(const asCScriptEngine *engine, const asSNameSpace *ns, const char *decl, asCDataType *dt);
+	void PutDataType(const asCScriptEngine *engine, asDWORD version, const asSNameSpace *ns, const char *decl, const asCDataType &dt);
+
+protected:
+	bool IsValid(const asCScriptEngine *engine);
+	void Clear();
+
+	asCSymbolTable<asSDeclCacheEntry> m_functions;
+	asCSymbolTable<asSDeclCacheEntry> m_dataTypes;
+	asDWORD                           m_version;
+};
+
+END_AS_NAMESPACE
+
+#endif
@@ -42,6 +42,7 @@
 #include "as_scriptengine.h"
 #include "as_scriptobject.h"
 #include "as_texts.h"
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -56,10 +57,14 @@ asCGarbageCollector::asCGarbageCollector()
 	numDetected     = 0;
 	numAdded        = 0;
 	isProcessing    = false;
+	isCountingInParallel = false;
+	gcMapCount      = 0;
+	gcMapCursor     = 0;
 
-	seqAtSweepStart[0] = 0;
-	seqAtSweepStart[1] = 0;
-	seqAtSweepStart[2] = 0;
+	// By default the objects are promoted after surviving 3 sweeps
+	seqAtSweepStart.SetLength(3);
+	for( asUINT n = 0; n < seqAtSweepStart.GetLength(); n++ )
+		seqAtSweepStart[n] = 0;
 
 	circularRefDetectCallbackFunc  = 0;
 	circularRefDetectCallbackParam = 0;
@@ -67,12 +72,8 @@ asCGarbageCollector::asCGarbageCollector()
 
 asCGarbageCollector::~asCGarbageCollector()
 {
-	// This local typedef is done to workaround a compiler error on
-	// MSVC6 when using the typedef declared in the class definition
-	typedef asSMapNode_t node_t;
-	for( asUINT n = 0; n < freeNodes.GetLength(); n++ )
-		asDELETE(freeNodes[n], node_t);
-	freeNodes.SetLength(0);
+	for( asUINT n = 0; n < workerRefs.GetLength(); n++ )
+		asDELETE(workerRefs[n], asCArray<asUINT>);
 }
 
 int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
@@ -128,6 +129,7 @@ int asCGarbageCollector::AddScriptObjectToGC(void *obj, asCObjectType *objType)
 	ENTERCRITICALSECTION(gcCritical);
 	ot.seqNbr = numAdded++;
 	gcNewObjects.PushLast(ot);
+	objType->gcStats.numAdded++;
 	LEAVECRITICALSECTION(gcCritical);
 
 	return ot.seqNbr;
@@ -227,6 +229,34 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 			LEAVECRITICALSECTION(gcCollecting);
 			return 0;
 		}
+		else if( flags & asGC_TIME_BUDGET )
+		{
+			// The iterations give the time budget in microseconds. The steps are short, 
+			// so the time is only checked every few steps to keep the overhead low
+			asQWORD deadline = asGetTimeInMicroseconds() + iterations;
+			for( asUINT step = 1; ; step++ )
+			{
+				int moreWork = 0;
+				if( doDestroy )
+				{
+					moreWork |= DestroyNewGarbage();
+					moreWork |= DestroyOldGarbage();
+				}
+				if( doDetect && gcOldObjects.GetLength() > 0 )
+					moreWork |= IdentifyGarbageWithCyclicRefs();
+
+				if( !moreWork )
+				{
+					// There is nothing more to do at the moment
+					isProcessing = false;
+					LEAVECRITICALSECTION(gcCollecting);
+					return 0;
+				}
+
+				if( (step & 7) == 0 && asGetTimeInMicroseconds() >= deadline )
+					break;
+			}
+		}
 		else
 		{
 			while( iterations-- > 0 )
@@ -252,6 +282,16 @@ int asCGarbageCollector::GarbageCollect(asDWORD flags, asUINT iterations)
 	return 1;
 }
 
+void asCGarbageCollector::GetTypeStatistics(asCObjectType *type, asUINT *totalAdded, asUINT *totalNewDestroyed, asUINT *totalPromoted, asUINT *totalDetected) const
+{
+	// The counters are not protected by critical sections, so
+	// they may be slightly out of sync with each other
+	if( totalAdded )        *totalAdded        = type->gcStats.numAdded;
+	if( totalNewDestroyed ) *totalNewDestroyed = type->gcStats.numNewDestroyed;
+	if( totalPromoted )     *totalPromoted     = type->gcStats.numPromoted;
+	if( totalDetected )     *totalDetected     = type->gcStats.numDetected;
+}
+
 // TODO: Additional statistics to gather
 //
 //       - How many objects are added on average between each destroyed object
@@ -374,10 +414,20 @@ int asCGarbageCollector::DestroyNewGarbage()
 				return 0;
 
 			// Update the seqAtSweepStart which is used to determine when 
-			// to move an object from the new set to the old set
-			seqAtSweepStart[0] = seqAtSweepStart[1];
-			seqAtSweepStart[1] = seqAtSweepStart[2];
-			seqAtSweepStart[2] = numAdded;
+			// to move an object from the new set to the old set. There is 
+			// one entry for each sweep an object must survive to be promoted
+			asUINT sweeps = engine->ep.gcPromotionSweeps;
+			if( seqAtSweepStart.GetLength() != sweeps )
+			{
+				// The history is lost when the setting is changed, so the 
+				// objects will not be promoted until the new entries are filled
+				seqAtSweepStart.SetLength(sweeps);
+				for( asUINT n = 0; n < sweeps; n++ )
+					seqAtSweepStart[n] = 0;
+			}
+			for( asUINT n = 1; n < sweeps; n++ )
+				seqAtSweepStart[n-1] = seqAtSweepStart[n];
+			seqAtSweepStart[sweeps-1] = numAdded;
 
 			destroyNewIdx = (asUINT)-1;
 			destroyNewState = destroyGarbage_loop;
@@ -401,6 +451,10 @@ int asCGarbageCollector::DestroyNewGarbage()
 				{
 					// Release the object immediately
 
+					// Count the object before releasing it, as the type
+					// may be destroyed together with its last object
+					gcObj.type->gcStats.numNewDestroyed++;
+
 					// Make sure the refCount is really 0, because the
 					// destructor may have increased the refCount again.
 					bool addRef = false;
@@ -425,18 +479,19 @@ int asCGarbageCollector::DestroyNewGarbage()
 					{
 						// Since the object was resurrected in the
 						// destructor, we must add our reference again
+						gcObj.type->gcStats.numNewDestroyed--;
 						engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
 					}
 
 					destroyNewState = destroyGarbage_haveMore;
 				}
-				// Check if this object has been inspected 3 times already, and if so move it to the 
+				// Check if this object has been inspected enough times already, and if so move it to the 
 				// set of old objects that are less likely to become garbage in a short time
-				// TODO: Is 3 really a good value? Should the number of times be dynamic? 
 				else if( gcObj.seqNbr < seqAtSweepStart[0] )
 				{
 					// We've already verified this object multiple times. It is likely
 					// to live for quite a long time so we'll move it to the list if old objects
+					gcObj.type->gcStats.numPromoted++;
 					MoveObjectToOldList(destroyNewIdx);
 					destroyNewIdx--;
 				}
@@ -633,32 +688,31 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 		switch( detectState )
 		{
 		case clearCounters_init:
+			gcMapCursor = MoveNextInMap(0);
 			detectState = clearCounters_loop;
 		break;
 
 		case clearCounters_loop:
 		{
-			// Decrease reference counter for all objects removed from the map
-			asSMapNode<void*, asSIntTypePair> *cursor = 0;
-			gcMap.MoveFirst(&cursor);
-			if( cursor )
+			// Decrease reference counter for all objects left in the map
+			if( gcMapCursor < gcMap.GetLength() )
 			{
-				void *obj = gcMap.GetKey(cursor);
-				asSIntTypePair it = gcMap.GetValue(cursor);
-
-				engine->CallObjectMethod(obj, it.type->beh.release);
+				asSMapEntry &entry = gcMap[gcMapCursor];
+				gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 
-				ReturnNode(gcMap.Remove(cursor));
+				engine->CallObjectMethod(entry.obj, entry.it.type->beh.release);
 
 				return 1;
 			}
 
+			ClearMap();
 			detectState = buildMap_init;
 		}
 		break;
 
 		case buildMap_init:
 			detectIdx = 0;
+			ReserveMap(gcOldObjects.GetLength());
 			detectState = buildMap_loop;
 		break;
 
@@ -688,14 +742,17 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				{
 					asSIntTypePair it = {refCount-1, gcObj.type};
 
-					gcMap.Insert(GetNode(gcObj.obj, it));
-
-					// Increment the object's reference counter when putting it in the map
-					engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
+					// If the object is already in the map, or the map couldn't 
+					// grow, then the object is not verified again in this cycle
+					if( InsertInMap(gcObj.obj, it) )
+					{
+						// Increment the object's reference counter when putting it in the map
+						engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.addref);
 
-					// Mark the object so that we can
-					// see if it has changed since read
-					engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.gcSetFlag);
+						// Mark the object so that we can
+						// see if it has changed since read
+						engine->CallObjectMethod(gcObj.obj, gcObj.type->beh.gcSetFlag);
+					}
 				}
 
 				detectIdx++; 
@@ -710,7 +767,16 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case countReferences_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			// For large heaps the application can let the objects be shared between
+			// the workers of a pool. The whole phase is then completed in one step
+			if( engine->ep.gcParallelMinObjects && gcMapCount >= engine->ep.gcParallelMinObjects &&
+				engine->workerPoolFunc && CountReferencesInParallel() )
+			{
+				detectState = detectGarbage_init;
+				return 1;
+			}
+
+			gcMapCursor = MoveNextInMap(0);
 			detectState = countReferences_loop;
 		}
 		break;
@@ -728,11 +794,11 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 			// Any new objects created after this step in the GC cycle won't be
 			// in the map, and is thus automatically considered alive.
-			if( gcMapCursor )
+			if( gcMapCursor < gcMap.GetLength() )
 			{
-				void *obj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+				void *obj = gcMap[gcMapCursor].obj;
+				asCObjectType *type = gcMap[gcMapCursor].it.type;
+				gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 
 				if( engine->CallObjectMethodRetBool(obj, type->beh.gcGetFlag) )
 				{
@@ -749,7 +815,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case detectGarbage_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = MoveNextInMap(0);
 			liveObjects.SetLength(0);
 			detectState = detectGarbage_loop1;
 		}
@@ -765,13 +831,11 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// references were not found in the map.
 
 			// Add all alive objects from the map to the liveObjects array
-			if( gcMapCursor )
+			if( gcMapCursor < gcMap.GetLength() )
 			{
-				asSMapNode<void*, asSIntTypePair> *cursor = gcMapCursor;
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
-
-				void *obj = gcMap.GetKey(cursor);
-				asSIntTypePair it = gcMap.GetValue(cursor);
+				void *obj = gcMap[gcMapCursor].obj;
+				asSIntTypePair it = gcMap[gcMapCursor].it;
+				gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 
 				bool gcFlag = engine->CallObjectMethodRetBool(obj, it.type->beh.gcGetFlag);
 				if( !gcFlag || it.i > 0 )
@@ -799,11 +863,11 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				asCObjectType *type = 0;
 
 				// Remove the object from the map to mark it as alive
-				asSMapNode<void*, asSIntTypePair> *cursor = 0;
-				if( gcMap.MoveTo(&cursor, gcObj) )
+				asUINT idx = FindInMap(gcObj);
+				if( idx < gcMap.GetLength() )
 				{
-					type = gcMap.GetValue(cursor).type;
-					ReturnNode(gcMap.Remove(cursor));
+					type = gcMap[idx].it.type;
+					RemoveFromMapAtIdx(idx);
 
 					// We need to decrease the reference count again as we remove the object from the map
 					engine->CallObjectMethod(gcObj, type->beh.release);
@@ -821,7 +885,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 		break;
 
 		case verifyUnmarked_init:
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = MoveNextInMap(0);
 			detectState = verifyUnmarked_loop;
 			break;
 
@@ -830,10 +894,10 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// In this step we must make sure that none of the objects still in the map
 			// has been touched by the application. If they have then we must run the
 			// detectGarbage loop once more.
-			if( gcMapCursor )
+			if( gcMapCursor < gcMap.GetLength() )
 			{
-				void *gcObj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
+				void *gcObj = gcMap[gcMapCursor].obj;
+				asCObjectType *type = gcMap[gcMapCursor].it.type;
 
 				bool gcFlag = engine->CallObjectMethodRetBool(gcObj, type->beh.gcGetFlag);
 				if( !gcFlag )
@@ -842,7 +906,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 					detectState = detectGarbage_init;
 				}
 				else
-					gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+					gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 
 				// Allow the application to work a little
 				return 1;
@@ -858,26 +922,26 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 
 		case breakCircles_init:
 		{
-			gcMap.MoveFirst(&gcMapCursor);
+			gcMapCursor = MoveNextInMap(0);
 			detectState = breakCircles_loop;
 
 			// If the application has requested a callback for detected circular references,
 			// then make that callback now for all the objects in the list. This step is not
 			// done in incremental steps as it is only meant for debugging purposes and thus
 			// doesn't require interactivity
-			if (gcMapCursor && circularRefDetectCallbackFunc)
+			if (gcMapCursor < gcMap.GetLength() && circularRefDetectCallbackFunc)
 			{
-				while (gcMapCursor)
+				while (gcMapCursor < gcMap.GetLength())
 				{
-					void *gcObj = gcMap.GetKey(gcMapCursor);
-					asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
+					void *gcObj = gcMap[gcMapCursor].obj;
+					asCObjectType *type = gcMap[gcMapCursor].it.type;
 					circularRefDetectCallbackFunc(type, gcObj, circularRefDetectCallbackParam);
 
-					gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+					gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 				}
 
 				// Reset iterator
-				gcMap.MoveFirst(&gcMapCursor);
+				gcMapCursor = MoveNextInMap(0);
 			}
 		}
 		break;
@@ -889,11 +953,12 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 			// kept alive through circular references. To be able to free
 			// these objects we need to force the breaking of the circle
 			// by having the objects release their references.
-			if( gcMapCursor )
+			if( gcMapCursor < gcMap.GetLength() )
 			{
 				numDetected++;
-				void *gcObj = gcMap.GetKey(gcMapCursor);
-				asCObjectType *type = gcMap.GetValue(gcMapCursor).type;
+				void *gcObj = gcMap[gcMapCursor].obj;
+				asCObjectType *type = gcMap[gcMapCursor].it.type;
+				type->gcStats.numDetected++;
 				if( type->flags & asOBJ_SCRIPT_OBJECT )
 				{
 					// For script objects we must call the class destructor before
@@ -904,7 +969,7 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 				}
 				engine->CallObjectMethod(gcObj, engine, type->beh.gcReleaseAllReferences);
 
-				gcMap.MoveNext(&gcMapCursor, gcMapCursor);
+				gcMapCursor = MoveNextInMap(gcMapCursor + 1);
 
 				detectState = breakCircles_haveGarbage;
 
@@ -935,35 +1000,221 @@ int asCGarbageCollector::IdentifyGarbageWithCyclicRefs()
 	UNREACHABLE_RETURN;
 }
 
-asCGarbageCollector::asSMapNode_t *asCGarbageCollector::GetNode(void *obj, asSIntTypePair it)
+void asCGarbageCollector::ReserveMap(asUINT numObjects)
 {
 	// This function will only be called within the critical section gcCollecting
 	asASSERT(isProcessing);
+	asASSERT(gcMapCount == 0);
 
-	asSMapNode_t *node;
-	if( freeNodes.GetLength() )
-		node = freeNodes.PopLast();
-	else
+	// Keep the load factor below 50% so the probe sequences stay short
+	asUINT capacity = 16;
+	while( capacity < numObjects*2 )
+		capacity <<= 1;
+
+	// Reuse the current memory unless it is much larger than needed
+	if( gcMap.GetLength() >= capacity && gcMap.GetLength() <= capacity*4 )
+		return;
+
+	gcMap.Allocate(capacity, false);
+	gcMap.SetLength(capacity);
+	for( asUINT n = 0; n < capacity; n++ )
+		gcMap[n].obj = 0;
+}
+
+asUINT asCGarbageCollector::HashInMap(void *obj) const
+{
+	// The lowest bits of the pointer are always the same due to alignment
+	// so they must be mixed with the higher bits to spread the objects
+	asPWORD h = (asPWORD)obj;
+	h ^= h >> 4;
+	h *= 2654435761u;
+	h ^= h >> 16;
+	return asUINT(h) & (gcMap.GetLength() - 1);
+}
+
+bool asCGarbageCollector::InsertInMap(void *obj, asSIntTypePair it)
+{
+	// This function will only be called within the critical section gcCollecting
+	asASSERT(isProcessing);
+
+	// Grow the table if it is more than 75% full. This can happen
+	// if objects were added to the GC after the map was reserved
+	if( (gcMapCount + 1)*4 > gcMap.GetLength()*3 )
 	{
-		node = asNEW(asSMapNode_t);
-		if( !node )
+		asUINT capacity = gcMap.GetLength() ? gcMap.GetLength()*2 : 16;
+		asCArray<asSMapEntry> tmp;
+		tmp.Allocate(capacity, false);
+		if( tmp.GetCapacity() < capacity )
 		{
 			// Out of memory
-			return 0;
+			return false;
 		}
+		tmp.SetLength(capacity);
+		for( asUINT n = 0; n < capacity; n++ )
+			tmp[n].obj = 0;
+
+		// Swap the arrays and reinsert the entries in the new one
+		gcMap.SwapWith(tmp);
+		gcMapCount = 0;
+		for( asUINT n = 0; n < tmp.GetLength(); n++ )
+			if( tmp[n].obj )
+				InsertInMap(tmp[n].obj, tmp[n].it);
 	}
-	
-	node->Init(obj, it);
-	return node;
+
+	asUINT mask = gcMap.GetLength() - 1;
+	asUINT idx = HashInMap(obj);
+	while( gcMap[idx].obj )
+	{
+		if( gcMap[idx].obj == obj )
+			return false;
+		idx = (idx + 1) & mask;
+	}
+
+	gcMap[idx].obj = obj;
+	gcMap[idx].it  = it;
+	gcMapCount++;
+
+	return true;
 }
 
-void asCGarbageCollector::ReturnNode(asSMapNode_t *node)
+asUINT asCGarbageCollector::FindInMap(void *obj) const
+{
+	if( gcMapCount == 0 )
+		return gcMap.GetLength();
+
+	asUINT mask = gcMap.GetLength() - 1;
+	asUINT idx = HashInMap(obj);
+	while( gcMap[idx].obj )
+	{
+		if( gcMap[idx].obj == obj )
+			return idx;
+		idx = (idx + 1) & mask;
+	}
+
+	return gcMap.GetLength();
+}
+
+void asCGarbageCollector::RemoveFromMapAtIdx(asUINT idx)
 {
 	// This function will only be called within the critical section gcCollecting
 	asASSERT(isProcessing);
+	asASSERT(idx < gcMap.GetLength() && gcMap[idx].obj);
 
-	if( node )
-		freeNodes.PushLast(node);
+	// Move the following entries in the probe sequence back to fill the hole, 
+	// so the table doesn't need markers for removed entries
+	asUINT mask = gcMap.GetLength() - 1;
+	asUINT next = idx;
+	for(;;)
+	{
+		next = (next + 1) & mask;
+		if( gcMap[next].obj == 0 )
+			break;
+
+		// The entry can only be moved if its home slot is not between the hole and its current position
+		asUINT home = HashInMap(gcMap[next].obj);
+		if( idx <= next ? (idx < home && home <= next) : (idx < home || home <= next) )
+			continue;
+
+		gcMap[idx] = gcMap[next];
+		idx = next;
+	}
+
+	gcMap[idx].obj = 0;
+	gcMapCount--;
+}
+
+void asCGarbageCollector::ClearMap()
+{
+	for( asUINT n = 0; n < gcMap.GetLength(); n++ )
+		gcMap[n].obj = 0;
+	gcMapCount = 0;
+}
+
+asUINT asCGarbageCollector::MoveNextInMap(asUINT idx) const
+{
+	while( idx < gcMap.GetLength() && gcMap[idx].obj == 0 )
+		idx++;
+	return idx;
+}
+
+bool asCGarbageCollector::CountReferencesInParallel()
+{
+	// Prepare one array for each worker to hold the references it finds
+	asUINT numTasks = engine->workerPoolSize;
+	while( workerRefs.GetLength() > numTasks )
+		asDELETE(workerRefs.PopLast(), asCArray<asUINT>);
+	while( workerRefs.GetLength() < numTasks )
+	{
+		asCArray<asUINT> *refs = asNEW(asCArray<asUINT>)();
+		if( refs == 0 )
+			break;
+		workerRefs.PushLast(refs);
+	}
+
+	// Out of memory, fall back to counting the references serially
+	if( workerRefs.GetLength() == 0 )
+		return false;
+
+	// The map isn't modified while the workers run, so they can search it
+	// without locks. The gcCollecting critical section is still held by
+	// this thread, so nothing else in the GC will run at the same time
+	detectState = countReferences_loop;
+	isCountingInParallel = true;
+	engine->workerPoolFunc(CountReferencesTask, this, workerRefs.GetLength(), engine->workerPoolParam);
+	isCountingInParallel = false;
+
+	// Merge the results from the workers
+	for( asUINT n = 0; n < workerRefs.GetLength(); n++ )
+	{
+		asCArray<asUINT> &refs = *workerRefs[n];
+		for( asUINT r = 0; r < refs.GetLength(); r++ )
+			gcMap[refs[r]].it.i--;
+		refs.SetLength(0);
+	}
+
+	// Objects of types that are not thread safe are handled by this thread
+	for( asUINT idx = MoveNextInMap(0); idx < gcMap.GetLength(); idx = MoveNextInMap(idx + 1) )
+	{
+		void *obj = gcMap[idx].obj;
+		asCObjectType *type = gcMap[idx].it.type;
+		if( type->flags & asOBJ_GC_THREADSAFE )
+			continue;
+
+		if( engine->CallObjectMethodRetBool(obj, type->beh.gcGetFlag) )
+			engine->CallObjectMethod(obj, engine, type->beh.gcEnumReferences);
+	}
+
+	return true;
+}
+
+void asCGarbageCollector::CountReferencesTask(asUINT task, void *param)
+{
+	asCGarbageCollector *gc = reinterpret_cast<asCGarbageCollector*>(param);
+	asCScriptEngine *engine = gc->engine;
+
+	// The GCEnumCallback will store the references in this array
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	tld->gcRefsFound = gc->workerRefs[task];
+
+	// Each task takes an equal share of the map
+	asQWORD length = gc->gcMap.GetLength();
+	asQWORD numTasks = gc->workerRefs.GetLength();
+	asUINT end = asUINT(length * (task + 1) / numTasks);
+	for( asUINT idx = asUINT(length * task / numTasks); idx < end; idx++ )
+	{
+		void *obj = gc->gcMap[idx].obj;
+		if( obj == 0 )
+			continue;
+
+		asCObjectType *type = gc->gcMap[idx].it.type;
+		if( !(type->flags & asOBJ_GC_THREADSAFE) )
+			continue;
+
+		if( engine->CallObjectMethodRetBool(obj, type->beh.gcGetFlag) )
+			engine->CallObjectMethod(obj, engine, type->beh.gcEnumReferences);
+	}
+
+	tld->gcRefsFound = 0;
 }
 
 void asCGarbageCollector::GCEnumCallback(void *reference)
@@ -974,18 +1225,29 @@ void asCGarbageCollector::GCEnumCallback(void *reference)
 	if( detectState == countReferences_loop )
 	{
 		// Find the reference in the map
-		asSMapNode<void*, asSIntTypePair> *cursor = 0;
-		if( gcMap.MoveTo(&cursor, reference) )
+		asUINT idx = FindInMap(reference);
+		if( idx < gcMap.GetLength() )
 		{
-			// Decrease the counter in the map for the reference
-			gcMap.GetValue(cursor).i--;
+			if( isCountingInParallel )
+			{
+				// The workers can't update the map, so the
+				// references are merged when they are done
+				asCArray<asUINT> *refs = asCThreadManager::GetLocalData()->gcRefsFound;
+				asASSERT( refs );
+				if( refs )
+					refs->PushLast(idx);
+			}
+			else
+			{
+				// Decrease the counter in the map for the reference
+				gcMap[idx].it.i--;
+			}
 		}
 	}
 	else if( detectState == detectGarbage_loop2 )
 	{
 		// Find the reference in the map
-		asSMapNode<void*, asSIntTypePair> *cursor = 0;
-		if( gcMap.MoveTo(&cursor, reference) )
+		if( FindInMap(reference) < gcMap.GetLength() )
 		{
 			// Add the object to the list of objects to mark as alive
 			liveObjects.PushLast(reference);
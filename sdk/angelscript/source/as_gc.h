@@ -42,7 +42,6 @@
 
 #include "as_config.h"
 #include "as_array.h"
-#include "as_map.h"
 #include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
@@ -58,6 +57,7 @@ public:
 
 	int    GarbageCollect(asDWORD flags, asUINT iterations);
 	void   GetStatistics(asUINT *currentSize, asUINT *totalDestroyed, asUINT *totalDetected, asUINT *newObjects, asUINT *totalNewDestroyed) const;
+	void   GetTypeStatistics(asCObjectType *type, asUINT *totalAdded, asUINT *totalNewDestroyed, asUINT *totalPromoted, asUINT *totalDetected) const;
 	void   GCEnumCallback(void *reference);
 	int    AddScriptObjectToGC(void *obj, asCObjectType *objType);
 	int    GetObjectInGC(asUINT idx, asUINT *seqNbr, void **obj, asITypeInfo **type);
@@ -73,7 +73,7 @@ public:
 protected:
 	struct asSObjTypePair {void *obj; asCObjectType *type; asUINT seqNbr;};
 	struct asSIntTypePair {int i; asCObjectType *type;};
-	typedef asSMapNode<void*, asSIntTypePair> asSMapNode_t;
+	struct asSMapEntry {void *obj; asSIntTypePair it;};
 
 	enum egcDestroyState
 	{
@@ -109,6 +109,8 @@ protected:
 	void           RemoveOldObjectAtIdx(int idx);
 	void           MoveObjectToOldList(int idx);
 	void           MoveAllObjectsToOldList();
+	bool           CountReferencesInParallel();
+	static void    CountReferencesTask(asUINT task, void *param);
 
 	// Holds all the objects known by the garbage collector
 	asCArray<asSObjTypePair>           gcNewObjects;
@@ -117,9 +119,16 @@ protected:
 	// This array temporarily holds references to objects known to be live objects
 	asCArray<void*>                    liveObjects;
 
+	// These arrays hold the map indices of the references found by each worker
+	// when counting references in parallel, until they are merged into the map
+	asCArray<asCArray<asUINT>*>        workerRefs;
+
 	// This map holds objects currently being searched for cyclic references, it also holds a 
-	// counter that gives the number of references to the object that the GC can't reach
-	asCMap<void*, asSIntTypePair>      gcMap;
+	// counter that gives the number of references to the object that the GC can't reach.
+	// It is an open addressing hash table keyed on the object pointer, where empty slots
+	// have a null pointer. The length of the array is always a power of 2
+	asCArray<asSMapEntry>              gcMap;
+	asUINT                             gcMapCount;
 
 	// State variables
 	egcDestroyState                    destroyNewState;
@@ -132,14 +141,20 @@ protected:
 	asUINT                             detectIdx;
 	asUINT                             numDetected;
 	asUINT                             numAdded;
-	asUINT                             seqAtSweepStart[3];
-	asSMapNode_t                      *gcMapCursor;
+	asCArray<asUINT>                   seqAtSweepStart;
+	asUINT                             gcMapCursor;
 	bool                               isProcessing;
-
-	// We'll keep a pool of nodes to avoid allocating memory all the time
-	asSMapNode_t            *GetNode(void *obj, asSIntTypePair it);
-	void                     ReturnNode(asSMapNode_t *node);
-	asCArray<asSMapNode_t*>  freeNodes;
+	bool                               isCountingInParallel;
+
+	// Operations on the gcMap. Insert returns false if the object is already in the map.
+	// Find and MoveNext return the length of the array when there is no match
+	void   ReserveMap(asUINT numObjects);
+	bool   InsertInMap(void *obj, asSIntTypePair it);
+	asUINT FindInMap(void *obj) const;
+	void   RemoveFromMapAtIdx(asUINT idx);
+	void   ClearMap();
+	asUINT MoveNextInMap(asUINT idx) const;
+	asUINT HashInMap(void *obj) const;
 
 	// Critical section for multithreaded access
 	DECLARECRITICALSECTION(gcCritical)   // Used for adding/removing objects
@@ -46,6 +46,7 @@
 #include "as_memory.h"
 #include "as_scriptnode.h"
 #include "as_bytecode.h"
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -181,108 +182,299 @@ void asFreeMem(void *mem)
 
 } // extern "C"
 
+// The number of stack blocks of each size that are kept for reuse
+const asUINT MAX_POOLED_STACK_BLOCKS_PER_SIZE = 4;
+
 asCMemoryMgr::asCMemoryMgr()
 {
+	stackBytesInUse  = 0;
+	stackBytesPooled = 0;
 }
 
 asCMemoryMgr::~asCMemoryMgr()
 {
 	FreeUnusedMemory();
+	FreeStackBlockPool();
 }
 
 void asCMemoryMgr::FreeUnusedMemory()
 {
-	// It's necessary to protect the scriptNodePool from multiple 
-	// simultaneous accesses, as the parser is used by several methods
-	// that can be executed simultaneously.
-	ENTERCRITICALSECTION(cs);
-
-	int n;
-	for( n = 0; n < (signed)scriptNodePool.GetLength(); n++ )
-		userFree(scriptNodePool[n]);
-	scriptNodePool.Allocate(0, false);
-
-	LEAVECRITICALSECTION(cs);
-
-	// The engine already protects against multiple threads 
-	// compiling scripts simultaneously so this pool doesn't have 
-	// to be protected again.
-	for( n = 0; n < (signed)byteInstructionPool.GetLength(); n++ )
-		userFree(byteInstructionPool[n]);
-	byteInstructionPool.Allocate(0, false);
+	// The arenas belong to the threads, so only the
+	// ones of the thread that completed the build can be freed
+	FreeThreadArenas();
 }
 
-void *asCMemoryMgr::AllocScriptNode()
+// The number of objects that each block in the arenas can hold
+const asUINT ARENA_OBJECTS_PER_BLOCK = 1024;
+
+asCObjectArena *asCMemoryMgr::GetScriptNodeArena()
 {
-	ENTERCRITICALSECTION(cs);
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	if( tld == 0 )
+		return 0;
 
-	if( scriptNodePool.GetLength() )
-	{
-		void *tRet = scriptNodePool.PopLast();
-		LEAVECRITICALSECTION(cs);
-		return tRet;
-	}
+	if( tld->scriptNodeArena == 0 )
+		tld->scriptNodeArena = asNEW(asCObjectArena)(sizeof(asCScriptNode), ARENA_OBJECTS_PER_BLOCK);
 
-	LEAVECRITICALSECTION(cs);
+	return tld->scriptNodeArena;
+}
 
-#if defined(AS_DEBUG) 
-	return ((asALLOCFUNCDEBUG_t)(userAlloc))(sizeof(asCScriptNode), __FILE__, __LINE__);
-#else
-	return userAlloc(sizeof(asCScriptNode));
+#ifndef AS_NO_COMPILER
+asCObjectArena *asCMemoryMgr::GetByteInstructionArena()
+{
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	if( tld == 0 )
+		return 0;
+
+	if( tld->byteInstructionArena == 0 )
+		tld->byteInstructionArena = asNEW(asCObjectArena)(sizeof(asCByteInstruction), ARENA_OBJECTS_PER_BLOCK);
+
+	return tld->byteInstructionArena;
+}
+#endif
+
+void asCMemoryMgr::FreeThreadArenas()
+{
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	if( tld == 0 )
+		return;
+
+	if( tld->scriptNodeArena )
+		tld->scriptNodeArena->FreeUnused();
+#ifndef AS_NO_COMPILER
+	if( tld->byteInstructionArena )
+		tld->byteInstructionArena->FreeUnused();
 #endif
 }
 
+void *asCMemoryMgr::AllocScriptNode()
+{
+	// This doesn't need a critical section as the arena is only used by one thread
+	asCObjectArena *arena = GetScriptNodeArena();
+	if( arena == 0 )
+		return 0;
+
+	return arena->Alloc();
+}
+
 void asCMemoryMgr::FreeScriptNode(void *ptr)
 {
-	ENTERCRITICALSECTION(cs);
+	// The node must be freed by the same thread that allocated it
+	GetScriptNodeArena()->Free(ptr);
+}
+
+//=========================================================================
+
+asCObjectArena::asCObjectArena(size_t size, asUINT perBlock)
+{
+	// Keep the objects aligned to pointer size or 8 bytes, whichever is bigger, and 
+	// make sure each object is large enough to hold the link in the free list
+	const size_t align = sizeof(void*) > 8 ? sizeof(void*) : 8;
+	if( size < sizeof(void*) )
+		size = sizeof(void*);
+	objectSize      = (size + align - 1) & ~(align - 1);
+	objectsPerBlock = perBlock;
+	currentBlock    = 0;
+	next            = 0;
+	end             = 0;
+	freeList        = 0;
+	numInUse        = 0;
+}
+
+asCObjectArena::~asCObjectArena()
+{
+	asASSERT( numInUse == 0 );
+	FreeBlocks();
+}
+
+void asCObjectArena::FreeBlocks()
+{
+	for( asUINT n = 0; n < blocks.GetLength(); n++ )
+		asDELETEARRAY(blocks[n]);
+	blocks.SetLength(0);
+
+	currentBlock = 0;
+	next         = 0;
+	end          = 0;
+	freeList     = 0;
+}
+
+void asCObjectArena::FreeUnused()
+{
+	if( numInUse == 0 )
+		FreeBlocks();
+}
+
+void *asCObjectArena::Alloc()
+{
+	void *ptr;
+	if( freeList )
+	{
+		// Reuse the most recently freed object
+		ptr = freeList;
+		freeList = *(void**)freeList;
+	}
+	else
+	{
+		if( next == end )
+		{
+			// Move on to the next block, allocating a new one if all have been used
+			asUINT blockIdx = next ? currentBlock + 1 : 0;
+			if( blockIdx == blocks.GetLength() )
+			{
+				asBYTE *block = asNEWARRAY(asBYTE, objectSize*objectsPerBlock);
+				if( block == 0 )
+				{
+					// Out of memory
+					return 0;
+				}
+				blocks.PushLast(block);
+				if( blocks.GetLength() != blockIdx + 1 )
+				{
+					// Out of memory
+					asDELETEARRAY(block);
+					return 0;
+				}
+			}
+
+			currentBlock = blockIdx;
+			next = blocks[blockIdx];
+			end  = next + objectSize*objectsPerBlock;
+		}
+
+		ptr = next;
+		next += objectSize;
+	}
 
-	// Pre allocate memory for the array to avoid slow growth
-	if( scriptNodePool.GetLength() == 0 )
-		scriptNodePool.Allocate(100, 0);
+	numInUse++;
+	return ptr;
+}
+
+void asCObjectArena::Free(void *ptr)
+{
+	asASSERT( numInUse > 0 );
 
-	scriptNodePool.PushLast(ptr);
-	
 #ifdef AS_DEBUG
 	// clear the memory to facilitate identification of use after free
-	memset(ptr, 0xCDCDCDCD, sizeof(asCScriptNode));
+	memset(ptr, 0xCDCDCDCD, objectSize);
 #endif
 
-	LEAVECRITICALSECTION(cs);
+	if( --numInUse == 0 )
+	{
+		// Nothing is in use anymore so the blocks can be filled from the 
+		// start again. This keeps the objects of the next build contiguous
+		freeList = 0;
+		next     = 0;
+		end      = 0;
+		return;
+	}
+
+	*(void**)ptr = freeList;
+	freeList = ptr;
 }
 
-#ifndef AS_NO_COMPILER
+asDWORD *asCMemoryMgr::AllocStackBlock(asUINT size)
+{
+	// The context's stack blocks can be allocated from multiple threads
+	// at the same time, so the pool must be protected
+	ENTERCRITICALSECTION(stackCs);
+
+	// Reuse a block of the same size if one is available
+	for( asUINT n = stackBlockPool.GetLength(); n-- > 0; )
+	{
+		if( stackBlockPoolSizes[n] == size )
+		{
+			asDWORD *block = stackBlockPool[n];
+			stackBlockPool.RemoveIndexUnordered(n);
+			stackBlockPoolSizes.RemoveIndexUnordered(n);
+			stackBytesPooled -= size*4;
+			stackBytesInUse  += size*4;
+
+			LEAVECRITICALSECTION(stackCs);
+			return block;
+		}
+	}
+
+	LEAVECRITICALSECTION(stackCs);
+
+#ifndef WIP_16BYTE_ALIGN
+	asDWORD *block = asNEWARRAY(asDWORD, size);
+#else
+	asDWORD *block = asNEWARRAYALIGNED(asDWORD, size, MAX_TYPE_ALIGNMENT);
+#endif
+
+	if( block )
+	{
+		ENTERCRITICALSECTION(stackCs);
+		stackBytesInUse += size*4;
+		LEAVECRITICALSECTION(stackCs);
+	}
 
-void *asCMemoryMgr::AllocByteInstruction()
+	return block;
+}
+
+void asCMemoryMgr::FreeStackBlock(asDWORD *ptr, asUINT size)
 {
-	// This doesn't need a critical section because, only one compilation is allowed at a time
-	
-	if( byteInstructionPool.GetLength() )
-		return byteInstructionPool.PopLast();
+	ENTERCRITICALSECTION(stackCs);
+
+	stackBytesInUse -= size*4;
+
+	// Only keep a limited number of blocks of each size, so a
+	// single deep call doesn't keep a lot of memory allocated
+	asUINT count = 0;
+	for( asUINT n = 0; n < stackBlockPoolSizes.GetLength(); n++ )
+		if( stackBlockPoolSizes[n] == size )
+			count++;
+
+	if( count < MAX_POOLED_STACK_BLOCKS_PER_SIZE )
+	{
+		stackBlockPool.PushLast(ptr);
+		stackBlockPoolSizes.PushLast(size);
+		stackBytesPooled += size*4;
+		ptr = 0;
+	}
+
+	LEAVECRITICALSECTION(stackCs);
 
-#if defined(AS_DEBUG) 
-	return ((asALLOCFUNCDEBUG_t)(userAlloc))(sizeof(asCByteInstruction), __FILE__, __LINE__);
+	if( ptr )
+	{
+#ifndef WIP_16BYTE_ALIGN
+		asDELETEARRAY(ptr);
 #else
-	return userAlloc(sizeof(asCByteInstruction));
+		asDELETEARRAYALIGNED(ptr);
 #endif
+	}
 }
 
-void asCMemoryMgr::FreeByteInstruction(void *ptr)
+void asCMemoryMgr::FreeStackBlockPool()
 {
-	// Pre allocate memory for the array to avoid slow growth
-	if( byteInstructionPool.GetLength() == 0 )
-		byteInstructionPool.Allocate(100, 0);
+	ENTERCRITICALSECTION(stackCs);
 
-	byteInstructionPool.PushLast(ptr);
-	
-#ifdef AS_DEBUG
-	// clear the memory to facilitate identification of use after free
-	memset(ptr, 0xCDCDCDCD, sizeof(asCByteInstruction));
+	for( asUINT n = 0; n < stackBlockPool.GetLength(); n++ )
+	{
+#ifndef WIP_16BYTE_ALIGN
+		asDELETEARRAY(stackBlockPool[n]);
+#else
+		asDELETEARRAYALIGNED(stackBlockPool[n]);
 #endif
+	}
+	stackBlockPool.Allocate(0, false);
+	stackBlockPoolSizes.Allocate(0, false);
+	stackBytesPooled = 0;
+
+	LEAVECRITICALSECTION(stackCs);
 }
 
-#endif // AS_NO_COMPILER
+void asCMemoryMgr::GetStackStatistics(asUINT *bytesInUse, asUINT *bytesPooled, asUINT *blocksPooled) const
+{
+	ENTERCRITICALSECTION(stackCs);
 
-END_AS_NAMESPACE
+	if( bytesInUse )   *bytesInUse   = stackBytesInUse;
+	if( bytesPooled )  *bytesPooled  = stackBytesPooled;
+	if( blocksPooled ) *blocksPooled = stackBlockPool.GetLength();
 
+	LEAVECRITICALSECTION(stackCs);
+}
 
+END_AS_NAMESPACE
 
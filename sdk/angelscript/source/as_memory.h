@@ -108,6 +108,37 @@ END_AS_NAMESPACE
 
 BEGIN_AS_NAMESPACE
 
+// Hands out objects of a fixed size from big blocks of memory. The objects are 
+// laid out in the blocks in the order they are allocated, so objects that are 
+// used together are also close in memory. Freed objects are reused, and once 
+// all of them have been freed the arena starts over from the first block. The 
+// blocks are only returned to the system by FreeUnused, or when the arena is 
+// destroyed. An arena is not thread safe, so each thread has its own
+class asCObjectArena
+{
+public:
+	asCObjectArena(size_t objectSize, asUINT objectsPerBlock);
+	~asCObjectArena();
+
+	void *Alloc();
+	void  Free(void *ptr);
+
+	// Releases the blocks if none of the objects are in use
+	void  FreeUnused();
+
+protected:
+	void  FreeBlocks();
+
+	size_t             objectSize;
+	asUINT             objectsPerBlock;
+	asCArray<asBYTE *> blocks;
+	asUINT             currentBlock;
+	asBYTE            *next;
+	asBYTE            *end;
+	void              *freeList;
+	asUINT             numInUse;
+};
+
 class asCMemoryMgr
 {
 public:
@@ -116,18 +147,30 @@ public:
 
 	void FreeUnusedMemory();
 
+	// The script nodes and byte instructions are only used while building, and
+	// by the thread that allocated them, so they come from that thread's arenas
 	void *AllocScriptNode();
 	void FreeScriptNode(void *ptr);
-
+	static asCObjectArena *GetScriptNodeArena();
 #ifndef AS_NO_COMPILER
-	void *AllocByteInstruction();
-	void FreeByteInstruction(void *ptr);
+	static asCObjectArena *GetByteInstructionArena();
 #endif
 
+	// Releases the arenas of the calling thread if they are not in use
+	static void FreeThreadArenas();
+
+	// The stack blocks are shared by all contexts. The size is given in dwords
+	asDWORD *AllocStackBlock(asUINT size);
+	void     FreeStackBlock(asDWORD *ptr, asUINT size);
+	void     FreeStackBlockPool();
+	void     GetStackStatistics(asUINT *bytesInUse, asUINT *bytesPooled, asUINT *blocksPooled) const;
+
 protected:
-	DECLARECRITICALSECTION(cs)
-	asCArray<void *> scriptNodePool;
-	asCArray<void *> byteInstructionPool;
+	DECLARECRITICALSECTION(mutable stackCs)
+	asCArray<asDWORD *> stackBlockPool;
+	asCArray<asUINT>    stackBlockPoolSizes;
+	asUINT              stackBytesInUse;
+	asUINT              stackBytesPooled;
 };
 
 END_AS_NAMESPACE
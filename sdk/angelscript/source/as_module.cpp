@@ -54,6 +54,8 @@ asCModule::asCModule(const char *name, asCScriptEngine *engine)
 	m_engine   = engine;
 
 	m_builder = 0;
+	m_isBuilding = false;
+	m_discardWhenUpdated = false;
 	m_isGlobalVarInitialized = false;
 
 	m_accessMask = 1;
@@ -96,9 +98,49 @@ asCModule::~asCModule()
 	}
 }
 
+// internal
+int asCModule::BeginUpdate()
+{
+	ACQUIREEXCLUSIVE(m_engine->engineRWLock);
+	if( m_isBuilding )
+	{
+		RELEASEEXCLUSIVE(m_engine->engineRWLock);
+		return asBUILD_IN_PROGRESS;
+	}
+	m_isBuilding = true;
+	RELEASEEXCLUSIVE(m_engine->engineRWLock);
+
+	return 0;
+}
+
+// internal
+void asCModule::EndUpdate()
+{
+	ACQUIREEXCLUSIVE(m_engine->engineRWLock);
+	m_isBuilding = false;
+	bool discard = m_discardWhenUpdated;
+	m_discardWhenUpdated = false;
+	RELEASEEXCLUSIVE(m_engine->engineRWLock);
+
+	// Complete a discard that was requested while the module was being updated
+	if( discard )
+		Discard();
+}
+
 // interface
 void asCModule::Discard()
 {
+	// If the module is being built or loaded it cannot be discarded yet, 
+	// instead it will be discarded by the thread updating it when done
+	ACQUIREEXCLUSIVE(m_engine->engineRWLock);
+	if( m_isBuilding )
+	{
+		m_discardWhenUpdated = true;
+		RELEASEEXCLUSIVE(m_engine->engineRWLock);
+		return;
+	}
+	RELEASEEXCLUSIVE(m_engine->engineRWLock);
+
 	// Reset the global variables already so that no object in the global variables keep the module alive forever.
 	// If any live object tries to access the global variables during clean up they will fail with a script exception,
 	// so the application must keep that in mind before discarding a module.
@@ -264,20 +306,68 @@ int asCModule::Build()
 #else
 	TimeIt("asCModule::Build");
 
+	// Different modules can be built by several threads, but not the same module.
+	// Only the parsing runs in parallel, the rest of the build is serialized
+	int r = BeginUpdate();
+	if( r < 0 )
+		return r;
+
+	bool isIncremental = false;
+	r = InternalBuild(&isIncremental);
+
+	// Declarations looked up before the build may now resolve to other entities
+	m_engine->InvalidateDeclCache();
+
+	// Initialize global variables. An incremental build keeps the current values
+	if( r >= 0 && m_engine->ep.initGlobalVarsAfterBuild && !(isIncremental && m_isGlobalVarInitialized) )
+		r = ResetGlobalVars(0);
+
+	EndUpdate();
+
+	return r;
+#endif
+}
+
+#ifndef AS_NO_COMPILER
+// internal
+int asCModule::InternalBuild(bool *isIncremental)
+{
+	// If the sections from the previous build were kept, the module may be updated by
+	// compiling only the changed functions. The builder parses the sections it needs
+	bool tryIncremental = m_builder && m_engine->ep.incrementalBuild && m_builtSections.GetLength();
+
+	// The script sections are parsed before the build lock is taken, as
+	// the parser doesn't touch the engine. This way other threads can
+	// parse their modules while this thread waits for the lock
+	if( m_builder && !tryIncremental )
+		m_builder->ParseScripts();
+
+	// Only one thread at a time may update the engine with the built entities
+	int r = m_engine->RequestBuild();
+	if( r < 0 )
+		return r;
+
+	// The incremental build replaces the bytecode of the existing functions, so it
+	// cannot be done while a context may still return to the previous bytecode
+	bool mustParse = false;
+	if( tryIncremental && IsCodeBeingExecuted() )
+	{
+		tryIncremental = false;
+		mustParse = true;
+	}
+
 	// Don't allow the module to be rebuilt if there are still
 	// external references that will need the previous code
 	// TODO: interface: The asIScriptModule must have a method for querying if the module is used
-	if( HasExternalReferences(false) )
+	if( HasExternalReferences(false, tryIncremental) )
 	{
 		m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_MODULE_IS_IN_USE);
+		m_engine->BuildCompleted();
 		return asMODULE_IS_IN_USE;
 	}
 
-	// Only one thread may build at one time
-	// TODO: It should be possible to have multiple threads perform compilations
-	int r = m_engine->RequestBuild();
-	if( r < 0 )
-		return r;
+	if( mustParse )
+		m_builder->ParseScripts();
 
 	m_engine->PrepareEngine();
 	if( m_engine->configFailed )
@@ -287,6 +377,40 @@ int asCModule::Build()
 		return asINVALID_CONFIGURATION;
 	}
 
+	if( tryIncremental )
+	{
+		{
+			asCBuilder builder(m_engine, this);
+			r = builder.BuildIncrementally(m_builder->scripts);
+		}
+		if( r != asNOT_SUPPORTED )
+		{
+			if( r >= 0 )
+				KeepBuiltSections(m_builder, m_builtSections.GetLength());
+			asDELETE(m_builder,asCBuilder);
+			m_builder = 0;
+
+			// The module must not be left with partially compiled functions
+			if( r < 0 )
+				InternalReset();
+			else
+				m_engine->PrepareEngine();
+
+			*isIncremental = r >= 0;
+			m_engine->BuildCompleted();
+			return r;
+		}
+
+		// Other changes than to the function bodies requires a full build
+		if( HasExternalReferences(false) )
+		{
+			m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_MODULE_IS_IN_USE);
+			m_engine->BuildCompleted();
+			return asMODULE_IS_IN_USE;
+		}
+		m_builder->ParseScripts();
+	}
+
 	InternalReset();
 
 	if( !m_builder )
@@ -296,7 +420,10 @@ int asCModule::Build()
 	}
 
 	// Compile the script
+	asUINT numSections = m_builder->scripts.GetLength();
 	r = m_builder->Build();
+	if( r >= 0 && m_engine->ep.incrementalBuild )
+		KeepBuiltSections(m_builder, numSections);
 	asDELETE(m_builder,asCBuilder);
 	m_builder = 0;
 
@@ -325,14 +452,57 @@ int asCModule::Build()
 
 	m_engine->BuildCompleted();
 
-	// Initialize global variables
-	if( r >= 0 && m_engine->ep.initGlobalVarsAfterBuild )
-		r = ResetGlobalVars(0);
-
 	return r;
-#endif
 }
 
+// internal
+void asCModule::KeepBuiltSections(asCBuilder *builder, asUINT numSections)
+{
+	// The constant values are kept, as they are only changed by a full build
+	for( asUINT n = 0; n < m_builtSections.GetLength(); n++ )
+		asDELETE(m_builtSections[n], asCScriptCode);
+	m_builtSections.SetLength(0);
+
+	// The sections added by the application come first, then those the builder added itself
+	for( asUINT n = 0; n < numSections; n++ )
+	{
+		asCScriptCode *script = builder->scripts[n];
+		if( script->sharedCode )
+		{
+			// The application's memory may not be valid after the build
+			asCScriptCode *copy = asNEW(asCScriptCode);
+			if( copy == 0 || copy->SetCode(script->name.AddressOf(), script->code, script->codeLength, true) < 0 )
+			{
+				if( copy )
+					asDELETE(copy, asCScriptCode);
+				DiscardBuiltSections();
+				return;
+			}
+			copy->lineOffset = script->lineOffset;
+			copy->idx = script->idx;
+			m_builtSections.PushLast(copy);
+		}
+		else
+		{
+			// Take over the builder's copy
+			m_builtSections.PushLast(script);
+			builder->scripts[n] = 0;
+		}
+	}
+}
+
+// internal
+void asCModule::DiscardBuiltSections()
+{
+	for( asUINT n = 0; n < m_builtSections.GetLength(); n++ )
+		asDELETE(m_builtSections[n], asCScriptCode);
+	m_builtSections.SetLength(0);
+	m_constantValues.EraseAll();
+	m_namespaceVisibility.EraseAll();
+	m_inlinedCalls.SetLength(0);
+}
+#endif
+
 // interface
 int asCModule::ResetGlobalVars(asIScriptContext *ctx)
 {
@@ -530,7 +700,33 @@ void asCModule::CallExit()
 }
 
 // internal
-bool asCModule::HasExternalReferences(bool shuttingDown)
+bool asCModule::IsCodeBeingExecuted() const
+{
+	// Contexts that are executing, suspended, or stopped by an exception
+	// still refer to the bytecode of the functions on their call stacks
+	bool found = false;
+	ACQUIRESHARED(m_engine->engineRWLock);
+	for( asUINT n = 0; n < m_engine->contexts.GetLength() && !found; n++ )
+	{
+		asCContext *ctx = m_engine->contexts[n];
+		asEContextState state = ctx->GetState();
+		if( state != asEXECUTION_ACTIVE && state != asEXECUTION_SUSPENDED && state != asEXECUTION_EXCEPTION )
+			continue;
+
+		for( asUINT s = 0; s < ctx->GetCallstackSize() && !found; s++ )
+		{
+			asCScriptFunction *func = static_cast<asCScriptFunction*>(ctx->GetFunction(s));
+			if( func && func->module == this )
+				found = true;
+		}
+	}
+	RELEASESHARED(m_engine->engineRWLock);
+
+	return found;
+}
+
+// internal
+bool asCModule::HasExternalReferences(bool shuttingDown, bool ignoreTypes)
 {
 	// Check all entities in the module for any external references.
 	// If there are any external references the module cannot be deleted yet.
@@ -581,6 +777,10 @@ bool asCModule::HasExternalReferences(bool shuttingDown)
 		}
 	}
 
+	// The live objects only keep the types, which are not replaced by an incremental build
+	if (ignoreTypes)
+		return false;
+
 	for (asUINT n = 0; n < m_classTypes.GetLength(); n++)
 	{
 		asCObjectType *obj = m_classTypes[n];
@@ -658,8 +858,15 @@ void asCModule::InternalReset()
 {
 	CallExit();
 
+	m_engine->InvalidateDeclCache();
+
 	asUINT n;
 
+#ifndef AS_NO_COMPILER
+	// The next build must compile everything
+	DiscardBuiltSections();
+#endif
+
 	// Remove all global functions
 	m_globalFunctions.Clear();
 
@@ -839,15 +1046,16 @@ void asCModule::InternalReset()
 // interface
 asIScriptFunction *asCModule::GetFunctionByName(const char *in_name) const
 {
-	asCString name;
+	const char *name = 0;
 	asSNameSpace *ns = 0;
 	if( m_engine->DetermineNameAndNamespace(in_name, m_defaultNamespace, name, ns) < 0 )
 		return 0;
+	size_t length = strlen(name);
 	
 	// Search recursively in the given namespace, moving up to parent namespace until the function is found
 	while( ns )
 	{
-		const asCArray<unsigned int> &idxs = m_globalFunctions.GetIndexes(ns, name);
+		const asCArray<unsigned int> &idxs = m_globalFunctions.GetIndexes(ns, name, length);
 		if( idxs.GetLength() != 1 )
 			return 0;
 
@@ -922,6 +1130,17 @@ asUINT asCModule::GetFunctionCount() const
 // interface
 asIScriptFunction *asCModule::GetFunctionByDecl(const char *decl) const
 {
+	if( decl == 0 )
+		return 0;
+
+	asCScriptFunction *f = 0;
+	if( m_declCache.GetFunction(m_engine, m_defaultNamespace, decl, &f) )
+		return f;
+
+	// Read the version before parsing so the result isn't stored 
+	// if the module is changed while the declaration is parsed
+	asDWORD version = m_engine->declCacheVersion.get();
+
 	asCBuilder bld(m_engine, const_cast<asCModule*>(this));
 
 	// Don't write parser errors to the message callback
@@ -936,26 +1155,47 @@ asIScriptFunction *asCModule::GetFunctionByDecl(const char *decl) const
 		return 0;
 	}
 
+	f = FindGlobalFunction(&func);
+	if( f )
+		m_declCache.PutFunction(m_engine, version, m_defaultNamespace, decl, f);
+
+	return f;
+}
+
+// interface
+asIScriptFunction *asCModule::GetFunctionBySignature(const asIFunctionSignature *signature) const
+{
+	if( signature == 0 || signature->GetEngine() != m_engine )
+		return 0;
+
+	// This cast is OK, the signature only updates its cached parse of the declaration
+	asCFunctionSignature *sig = const_cast<asCFunctionSignature*>(static_cast<const asCFunctionSignature*>(signature));
+	return sig->FindFunction(const_cast<asCModule*>(this));
+}
+
+// internal
+asCScriptFunction *asCModule::FindGlobalFunction(const asCScriptFunction *sig) const
+{
 	// Use the defaultNamespace implicitly unless an explicit namespace has been provided
-	asSNameSpace *ns = func.nameSpace == m_engine->nameSpaces[0] ? m_defaultNamespace : func.nameSpace;
+	asSNameSpace *ns = sig->nameSpace == m_engine->nameSpaces[0] ? m_defaultNamespace : sig->nameSpace;
 
 	// Search script functions for matching interface
 	while( ns )
 	{
-		asIScriptFunction *f = 0;
-		const asCArray<unsigned int> &idxs = m_globalFunctions.GetIndexes(ns, func.name);
+		asCScriptFunction *f = 0;
+		const asCArray<unsigned int> &idxs = m_globalFunctions.GetIndexes(ns, sig->name);
 		for( unsigned int n = 0; n < idxs.GetLength(); n++ )
 		{
 			const asCScriptFunction *funcPtr = m_globalFunctions.Get(idxs[n]);
 			if( funcPtr->objectType == 0 &&
-				func.returnType                 == funcPtr->returnType &&
-				func.parameterTypes.GetLength() == funcPtr->parameterTypes.GetLength()
+				sig->returnType                 == funcPtr->returnType &&
+				sig->parameterTypes.GetLength() == funcPtr->parameterTypes.GetLength()
 				)
 			{
 				bool match = true;
-				for( asUINT p = 0; p < func.parameterTypes.GetLength(); ++p )
+				for( asUINT p = 0; p < sig->parameterTypes.GetLength(); ++p )
 				{
-					if( func.parameterTypes[p] != funcPtr->parameterTypes[p] )
+					if( sig->parameterTypes[p] != funcPtr->parameterTypes[p] )
 					{
 						match = false;
 						break;
@@ -994,15 +1234,16 @@ asUINT asCModule::GetGlobalVarCount() const
 // interface
 int asCModule::GetGlobalVarIndexByName(const char *in_name) const
 {
-	asCString name;
+	const char *name = 0;
 	asSNameSpace *ns = 0;
 	if( m_engine->DetermineNameAndNamespace(in_name, m_defaultNamespace, name, ns) < 0 )
 		return asINVALID_ARG;
+	size_t length = strlen(name);
 	
 	// Find the global var id
 	while( ns )
 	{
-		int id = m_scriptGlobals.GetFirstIndex(ns, name);
+		int id = m_scriptGlobals.GetFirstIndex(ns, name, length);
 		if( id >= 0 ) return id;
 
 		// Recursively search parent namespaces
@@ -1036,6 +1277,11 @@ int asCModule::RemoveGlobalVar(asUINT index)
 	m_scriptGlobals.Erase(index);
 	prop->Release();
 
+#ifndef AS_NO_COMPILER
+	// The module no longer matches the script sections it was built from
+	DiscardBuiltSections();
+#endif
+
 	return 0;
 }
 
@@ -1159,14 +1405,7 @@ asITypeInfo *asCModule::GetTypeInfoByName(const char *in_name) const
 int asCModule::GetTypeIdByDecl(const char *decl) const
 {
 	asCDataType dt;
-
-	// This const cast is safe since we know the engine won't be modified
-	asCBuilder bld(m_engine, const_cast<asCModule*>(this));
-
-	// Don't write parser errors to the message callback
-	bld.silent = true;
-
-	int r = bld.ParseDataType(decl, &dt, m_defaultNamespace);
+	int r = GetDataTypeByDecl(decl, &dt);
 	if( r < 0 )
 		return asINVALID_TYPE;
 
@@ -1177,6 +1416,25 @@ int asCModule::GetTypeIdByDecl(const char *decl) const
 asITypeInfo *asCModule::GetTypeInfoByDecl(const char *decl) const
 {
 	asCDataType dt;
+	int r = GetDataTypeByDecl(decl, &dt);
+	if (r < 0)
+		return 0;
+
+	return dt.GetTypeInfo();
+}
+
+// internal
+int asCModule::GetDataTypeByDecl(const char *decl, asCDataType *dt) const
+{
+	if( decl == 0 )
+		return asINVALID_ARG;
+
+	if( m_declCache.GetDataType(m_engine, m_defaultNamespace, decl, dt) )
+		return asSUCCESS;
+
+	// Read the version before parsing so the result isn't stored 
+	// if the module is changed while the declaration is parsed
+	asDWORD version = m_engine->declCacheVersion.get();
 
 	// This const cast is safe since we know the engine won't be modified
 	asCBuilder bld(m_engine, const_cast<asCModule*>(this));
@@ -1184,11 +1442,13 @@ asITypeInfo *asCModule::GetTypeInfoByDecl(const char *decl) const
 	// Don't write parser errors to the message callback
 	bld.silent = true;
 
-	int r = bld.ParseDataType(decl, &dt, m_defaultNamespace);
-	if (r < 0)
-		return 0;
+	int r = bld.ParseDataType(decl, dt, m_defaultNamespace);
+	if( r < 0 )
+		return r;
 
-	return dt.GetTypeInfo();
+	m_declCache.PutDataType(m_engine, version, m_defaultNamespace, decl, *dt);
+
+	return asSUCCESS;
 }
 
 // interface
@@ -1534,6 +1794,7 @@ void asCModule::AddTypeDef(asCTypedefType* type)
 // internal
 void asCModule::AddFuncDef(asCFuncdefType* type)
 {
+	asASSERT( asCBuilder::GetCompileTask() == 0 );
 	m_funcDefs.PushLast(type);
 	m_typeLookup.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
 }
@@ -1634,11 +1895,60 @@ int asCModule::SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const
 #endif
 }
 
+// interface
+int asCModule::SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo) const
+{
+#ifdef AS_NO_COMPILER
+	UNUSED_VAR(out);
+	UNUSED_VAR(stripDebugInfo);
+	return asNOT_SUPPORTED;
+#else
+	if( out == 0 ) return asINVALID_ARG;
+
+	// Make sure there is actually something to save
+	if( IsEmpty() )
+		return asERROR;
+
+	asCWriter write(const_cast<asCModule*>(this), out, m_engine, stripDebugInfo);
+	return write.WriteImage();
+#endif
+}
+
 // interface
 int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 {
 	if( in == 0 ) return asINVALID_ARG;
 
+	int r = BeginUpdate();
+	if( r < 0 )
+		return r;
+
+	asCReader read(this, in, m_engine);
+	r = InternalLoadByteCode(read, wasDebugInfoStripped);
+
+	EndUpdate();
+	return r;
+}
+
+// interface
+int asCModule::LoadByteCode(const void *data, asUINT size, bool *wasDebugInfoStripped)
+{
+	if( data == 0 ) return asINVALID_ARG;
+
+	int r = BeginUpdate();
+	if( r < 0 )
+		return r;
+
+	asCReader read(this, data, size, m_engine);
+	r = InternalLoadByteCode(read, wasDebugInfoStripped);
+
+	EndUpdate();
+	return r;
+}
+
+// internal
+int asCModule::InternalLoadByteCode(asCReader &read, bool *wasDebugInfoStripped)
+{
 	// Don't allow the module to be rebuilt if there are still
 	// external references that will need the previous code
 	if( HasExternalReferences(false) )
@@ -1647,14 +1957,13 @@ int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 		return asMODULE_IS_IN_USE;
 	}
 
-	// Only permit loading bytecode if no other thread is currently compiling
-	// TODO: It should be possible to have multiple threads perform compilations
+	// Only one thread at a time may update the engine with the loaded entities
 	int r = m_engine->RequestBuild();
 	if( r < 0 )
 		return r;
 
-	asCReader read(this, in, m_engine);
 	r = read.Read(wasDebugInfoStripped);
+	m_engine->InvalidateDeclCache();
 	if (r < 0)
 	{
 		m_engine->BuildCompleted();
@@ -1691,18 +2000,26 @@ int asCModule::CompileGlobalVar(const char *sectionName, const char *code, int l
 	if( code == 0 )
 		return asINVALID_ARG;
 
-	// Only one thread may build at one time
-	// TODO: It should be possible to have multiple threads perform compilations
-	int r = m_engine->RequestBuild();
+	// The module cannot be modified while it is being built
+	int r = BeginUpdate();
 	if( r < 0 )
 		return r;
 
+	// Only one thread at a time may update the engine with the compiled entities
+	r = m_engine->RequestBuild();
+	if( r < 0 )
+	{
+		EndUpdate();
+		return r;
+	}
+
 	// Prepare the engine
 	m_engine->PrepareEngine();
 	if( m_engine->configFailed )
 	{
 		m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_INVALID_CONFIGURATION);
 		m_engine->BuildCompleted();
+		EndUpdate();
 		return asINVALID_CONFIGURATION;
 	}
 
@@ -1711,6 +2028,10 @@ int asCModule::CompileGlobalVar(const char *sectionName, const char *code, int l
 	asCString str = code;
 	r = varBuilder.CompileGlobalVar(sectionName, str.AddressOf(), lineOffset);
 
+	// The module no longer matches the script sections it was built from
+	if( r >= 0 )
+		DiscardBuiltSections();
+
 	m_engine->BuildCompleted();
 
 	// Initialize the variable
@@ -1732,6 +2053,8 @@ int asCModule::CompileGlobalVar(const char *sectionName, const char *code, int l
 		}
 	}
 
+	EndUpdate();
+
 	return r;
 #endif
 }
@@ -1756,11 +2079,18 @@ int asCModule::CompileFunction(const char* sectionName, const char* code, int li
 		(compileFlags != 0 && compileFlags != asCOMP_ADD_TO_MODULE))
 		return asINVALID_ARG;
 
-	// Only one thread may build at one time
-	// TODO: It should be possible to have multiple threads perform compilations
-	int r = m_engine->RequestBuild();
+	// The module cannot be modified while it is being built
+	int r = BeginUpdate();
+	if (r < 0)
+		return r;
+
+	// Only one thread at a time may update the engine with the compiled entities
+	r = m_engine->RequestBuild();
 	if (r < 0)
+	{
+		EndUpdate();
 		return r;
+	}
 
 	// Prepare the engine
 	m_engine->PrepareEngine();
@@ -1768,6 +2098,7 @@ int asCModule::CompileFunction(const char* sectionName, const char* code, int li
 	{
 		m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_INVALID_CONFIGURATION);
 		m_engine->BuildCompleted();
+		EndUpdate();
 		return asINVALID_CONFIGURATION;
 	}
 
@@ -1782,6 +2113,13 @@ int asCModule::CompileFunction(const char* sectionName, const char* code, int li
 		// Invoke the JIT compiler if it has been set
 		if (m_engine->jitCompiler)
 			func->JITCompile();
+
+		// The module no longer matches the script sections it was built from
+		if (compileFlags & asCOMP_ADD_TO_MODULE)
+		{
+			DiscardBuiltSections();
+			m_engine->InvalidateDeclCache();
+		}
 	}
 
 	m_engine->BuildCompleted();
@@ -1797,6 +2135,8 @@ int asCModule::CompileFunction(const char* sectionName, const char* code, int li
 	if( func )
 		func->ReleaseInternal();
 
+	EndUpdate();
+
 	return r;
 #endif
 }
@@ -1812,6 +2152,12 @@ int asCModule::RemoveFunction(asIScriptFunction *func)
 		m_globalFunctions.Erase(idx);
 		m_scriptFunctions.RemoveValue(f);
 		f->ReleaseInternal();
+		m_engine->InvalidateDeclCache();
+
+#ifndef AS_NO_COMPILER
+		// The module no longer matches the script sections it was built from
+		DiscardBuiltSections();
+#endif
 		return 0;
 	}
 
@@ -1855,6 +2201,11 @@ asDWORD asCModule::SetAccessMask(asDWORD mask)
 {
 	asDWORD old = m_accessMask;
 	m_accessMask = mask;
+
+	// The access mask decides which registered entities the declarations may refer to
+	if( old != mask )
+		m_engine->InvalidateDeclCache();
+
 	return old;
 }
 
@@ -41,12 +41,14 @@
 
 #include "as_config.h"
 #include "as_symboltable.h"
+#include "as_declcache.h"
 #include "as_atomic.h"
 #include "as_string.h"
 #include "as_array.h"
 #include "as_datatype.h"
 #include "as_scriptfunction.h"
 #include "as_property.h"
+#include "as_scriptcode.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -60,6 +62,7 @@ class asCContext;
 class asCConfigGroup;
 class asCTypedefType;
 class asCFuncdefType;
+class asCReader;
 struct asSNameSpace;
 
 struct sBindInfo
@@ -86,12 +89,6 @@ struct sObjectTypePair
 //       With this separation it will be possible to compile the library without
 //       the compiler, thus giving a much smaller binary executable.
 
-// TODO: There should be a special compile option that will let the application
-//       recompile an already compiled script. The compiler should check if no
-//       destructive changes have been made (changing function signatures, etc)
-//       then it should simply replace the bytecode within the functions without
-//       changing the values of existing global properties, etc.
-
 class asCModule : public asIScriptModule
 {
 //-------------------------------------------
@@ -117,6 +114,7 @@ public:
 	virtual asIScriptFunction *GetFunctionByIndex(asUINT index) const;
 	virtual asIScriptFunction *GetFunctionByDecl(const char *decl) const;
 	virtual asIScriptFunction *GetFunctionByName(const char *name) const;
+	virtual asIScriptFunction *GetFunctionBySignature(const asIFunctionSignature *signature) const;
 	virtual int                RemoveFunction(asIScriptFunction *func);
 
 	// Script global variables
@@ -157,7 +155,9 @@ public:
 
 	// Bytecode Saving/Loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const;
+	virtual int SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo) const;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped);
+	virtual int LoadByteCode(const void *data, asUINT size, bool *wasDebugInfoStripped);
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type);
@@ -178,15 +178,23 @@ public:
 
 	void InternalReset();
 	bool IsEmpty() const;
-	bool HasExternalReferences(bool shuttingDown);
+	bool HasExternalReferences(bool shuttingDown, bool ignoreTypes = false);
+	bool IsCodeBeingExecuted() const;
 
 	int  CallInit(asIScriptContext *ctx);
 	void CallExit();
 	int  InitGlobalProp(asCGlobalProperty *prop, asIScriptContext *ctx);
 
+	int  BeginUpdate();
+	void EndUpdate();
+
 	void JITCompile();
+	int  InternalLoadByteCode(asCReader &reader, bool *wasDebugInfoStripped);
 
 #ifndef AS_NO_COMPILER
+	int  InternalBuild(bool *isIncremental);
+	void KeepBuiltSections(asCBuilder *builder, asUINT numSections);
+	void DiscardBuiltSections();
 	int  AddScriptFunction(int sectionIdx, int declaredAt, int id, const asCString &name, const asCDataType &returnType, const asCArray<asCDataType> &params, const asCArray<asCString> &paramNames, const asCArray<asETypeModifiers> &inOutFlags, const asCArray<asCString *> &defaultArgs, bool isInterface, asCObjectType *objType = 0, bool isGlobalFunction = false, asSFunctionTraits funcTraits = asSFunctionTraits(), asSNameSpace *ns = 0);
 	int  AddScriptFunction(asCScriptFunction *func);
 	int  AddImportedFunction(int id, const asCString &name, const asCDataType &returnType, const asCArray<asCDataType> &params, const asCArray<asETypeModifiers> &inOutFlags, const asCArray<asCString *> &defaultArgs, asSFunctionTraits funcTraits, asSNameSpace *ns, const asCString &moduleName);
@@ -197,6 +205,8 @@ public:
 	asCScriptFunction *GetImportedFunction(int funcId) const;
 	asCTypeInfo       *GetType(const asCString &type, asSNameSpace *ns) const;
 	asCObjectType     *GetObjectType(const char *type, asSNameSpace *ns) const;
+	asCScriptFunction *FindGlobalFunction(const asCScriptFunction *sig) const;
+	int                GetDataTypeByDecl(const char *decl, asCDataType *dt) const;
 	asCGlobalProperty *AllocateGlobalProperty(const char *name, const asCDataType &dt, asSNameSpace *ns);
 	void               UninitializeGlobalProp(asCGlobalProperty *prop);
 	
@@ -214,10 +224,15 @@ public:
 	asCString         m_name;
 	asCScriptEngine  *m_engine;
 	asCBuilder       *m_builder;
+	bool              m_isBuilding; // Synchronized with engineRWLock
+	bool              m_discardWhenUpdated; // Synchronized with engineRWLock
 	asCArray<asPWORD> m_userData;
 	asDWORD           m_accessMask;
 	asSNameSpace     *m_defaultNamespace;
 
+	// Results of GetFunctionByDecl, GetTypeIdByDecl, and GetTypeInfoByDecl
+	mutable asCDeclCache m_declCache; // Synchronized with engine's declCacheCs
+
 	// This array holds all functions, class members, factories, etc that were compiled with the module.
 	// These references hold an internal reference to the function object.
 	asCArray<asCScriptFunction *>     m_scriptFunctions; // increases ref count
@@ -250,6 +265,16 @@ public:
 	asCArray<asCTypeInfo*>       m_externalTypes; // doesn't increase ref count
 	// This array holds functions that have been explicitly declared with 'external'
 	asCArray<asCScriptFunction*> m_externalFunctions; // doesn't increase ref count
+
+#ifndef AS_NO_COMPILER
+	// When asEP_INCREMENTAL_BUILD is set the script sections and the values of the constants
+	// are kept after the build, so the next build only has to compile the changed functions
+	asCArray<asCScriptCode*>                        m_builtSections;       // owned
+	asCMap<asCGlobalProperty*, asQWORD>             m_constantValues;      // doesn't increase ref count
+	asCMap<asSNameSpace*, asCArray<asSNameSpace*> > m_namespaceVisibility;
+	// Pairs of caller and callee for each function that was inlined, so the callers can be recompiled too
+	asCArray<asCScriptFunction*>                    m_inlinedCalls;        // doesn't increase ref count
+#endif
 };
 
 END_AS_NAMESPACE
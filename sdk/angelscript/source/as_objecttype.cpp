@@ -229,6 +229,32 @@ bool asCObjectType::IsInterface() const
 	return false;
 }
 
+// internal
+// Must be called when the interfaces and their virtual function table offsets have been
+// determined, so asCContext::CallInterfaceMethod can find the interface with a binary search
+void asCObjectType::SortInterfaces()
+{
+	asASSERT( interfaces.GetLength() == interfaceVFTOffsets.GetLength() );
+
+	sortedInterfaces = interfaces;
+	sortedInterfaceVFTOffsets = interfaceVFTOffsets;
+
+	// Insertion sort, as the number of interfaces is usually small
+	for( asUINT n = 1; n < sortedInterfaces.GetLength(); n++ )
+	{
+		asCObjectType *intf = sortedInterfaces[n];
+		asUINT offset = sortedInterfaceVFTOffsets[n];
+		asUINT m = n;
+		for( ; m > 0 && sortedInterfaces[m-1] > intf; m-- )
+		{
+			sortedInterfaces[m] = sortedInterfaces[m-1];
+			sortedInterfaceVFTOffsets[m] = sortedInterfaceVFTOffsets[m-1];
+		}
+		sortedInterfaces[m] = intf;
+		sortedInterfaceVFTOffsets[m] = offset;
+	}
+}
+
 // interface
 asUINT asCObjectType::GetFactoryCount() const
 {
@@ -306,7 +332,7 @@ asIScriptFunction *asCObjectType::GetMethodByName(const char *in_name, bool in_g
 // interface
 asIScriptFunction *asCObjectType::GetMethodByDecl(const char *decl, bool getVirtual) const
 {
-	if( methods.GetLength() == 0 )
+	if( methods.GetLength() == 0 || decl == 0 )
 		return 0;
 
 	// Get the module from one of the methods, but it will only be
@@ -316,18 +342,40 @@ asIScriptFunction *asCObjectType::GetMethodByDecl(const char *decl, bool getVirt
 	// find the methods, but any type not known by the object will result in
 	// an invalid declaration.
 	asCModule *mod = engine->scriptFunctions[methods[0]]->module;
-	int id = engine->GetMethodIdByDecl(this, decl, mod);
-	if( id <= 0 )
-		return 0;
+
+	asCScriptFunction *func = 0;
+	if( !methodDeclCache.GetFunction(engine, nameSpace, decl, &func) )
+	{
+		// Read the version before parsing so the result isn't stored 
+		// if the type is changed while the declaration is parsed
+		asDWORD version = engine->declCacheVersion.get();
+
+		int id = engine->GetMethodIdByDecl(this, decl, mod);
+		if( id <= 0 )
+			return 0;
+
+		func = engine->scriptFunctions[id];
+		methodDeclCache.PutFunction(engine, version, nameSpace, decl, func);
+	}
 
 	if( !getVirtual )
 	{
-		asCScriptFunction *func = engine->scriptFunctions[id];
 		if( func && func->funcType == asFUNC_VIRTUAL )
 			return virtualFunctionTable[func->vfTableIdx];
 	}
 
-	return engine->scriptFunctions[id];
+	return func;
+}
+
+// interface
+asIScriptFunction *asCObjectType::GetMethodBySignature(const asIFunctionSignature *signature, bool getVirtual) const
+{
+	if( signature == 0 || signature->GetEngine() != engine || methods.GetLength() == 0 )
+		return 0;
+
+	// This cast is OK, the signature only updates its cached parse of the declaration
+	asCFunctionSignature *sig = const_cast<asCFunctionSignature*>(static_cast<const asCFunctionSignature*>(signature));
+	return sig->FindMethod(this, getVirtual);
 }
 
 // interface
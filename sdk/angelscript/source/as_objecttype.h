@@ -45,9 +45,27 @@
 #include "as_array.h"
 #include "as_scriptfunction.h"
 #include "as_typeinfo.h"
+#include "as_declcache.h"
 
 BEGIN_AS_NAMESPACE
 
+// Counters gathered by the garbage collector for each type
+struct asSGCTypeStatistics
+{
+	asSGCTypeStatistics()
+	{
+		numAdded        = 0;
+		numNewDestroyed = 0;
+		numPromoted     = 0;
+		numDetected     = 0;
+	}
+
+	asUINT numAdded;
+	asUINT numNewDestroyed;
+	asUINT numPromoted;
+	asUINT numDetected;
+};
+
 struct asSTypeBehaviour
 {
 	asSTypeBehaviour() 
@@ -116,6 +134,7 @@ public:
 	asIScriptFunction *GetMethodByIndex(asUINT index, bool getVirtual) const;
 	asIScriptFunction *GetMethodByName(const char *name, bool getVirtual) const;
 	asIScriptFunction *GetMethodByDecl(const char *decl, bool getVirtual) const;
+	asIScriptFunction *GetMethodBySignature(const asIFunctionSignature *sig, bool getVirtual) const;
 	asUINT             GetPropertyCount() const;
 	int                GetProperty(asUINT index, const char **name, int *typeId, bool *isPrivate, bool *isProtected, int *offset, bool *isReference, asDWORD *accessMask, int *compositeOffset, bool *isCompositeIndirect, bool *isConst) const;
 	const char        *GetPropertyDeclaration(asUINT index, bool includeNamespace = false) const;
@@ -132,6 +151,7 @@ public:
 	void ReleaseAllFunctions();
 
 	bool IsInterface() const;
+	void SortInterfaces();
 
 	asCObjectProperty *AddPropertyToClass(const asCString &name, const asCDataType &dt, bool isPrivate, bool isProtected, bool isInherited);
 	void ReleaseAllProperties();
@@ -145,15 +165,24 @@ public:
 	// TODO: These are not used by template types. Should perhaps create a derived class to save memory on ordinary object types
 	asCArray<asCObjectType*>     interfaces;
 	asCArray<asUINT>             interfaceVFTOffsets;
+	// The same interfaces ordered by address, for fast lookup when calling interface methods
+	asCArray<asCObjectType*>     sortedInterfaces;
+	asCArray<asUINT>             sortedInterfaceVFTOffsets;
 	asCObjectType *              derivedFrom;
 	asCArray<asCScriptFunction*> virtualFunctionTable;
 
+	// Results of GetMethodByDecl. Synchronized with engine's declCacheCs
+	mutable asCDeclCache         methodDeclCache;
+
 	// Used for funcdefs declared as members of class.
 	// TODO: child funcdef: Should be possible to enumerate these from application
 	asCArray<asCFuncdefType*> childFuncDefs;
 
 	asSTypeBehaviour beh;
 
+	// Updated by the garbage collector for the objects of this type
+	asSGCTypeStatistics gcStats;
+
 	// Used for template types
 	asCArray<asCDataType> templateSubTypes;   // increases refCount for typeinfo held in datatype
 	bool                  acceptValueSubType;
@@ -48,22 +48,283 @@ BEGIN_AS_NAMESPACE
 #define SAVE_TO_BIT(dst, val, bit) ((dst) |= ((val) << (bit)))
 #define LOAD_FROM_BIT(dst, val, bit) ((dst) = ((val) >> (bit)) & 1)
 
+// The bytecode image is a container for the bytecode, with a table of contents that 
+// locates each section. All sections start at aligned offsets, so the image can be 
+// loaded directly from a memory mapped file. The header and the table of contents 
+// are stored as little endian dwords.
+//
+// The bytecode in the image refers to the application functions by their id, followed 
+// by the signature that is used to find the function if the application interface isn't 
+// the same as when the image was saved. The signature is written without references to 
+// the strings and types written before it, so it can be skipped when it isn't needed.
+//
+// The image starts with the magic. It can't be confused with the first byte of the plain 
+// bytecode, as that is the flag for the stripped debug info, i.e. either 0 or 1.
+static const asBYTE  BYTECODE_IMAGE_MAGIC[4]    = {'A','S','B','I'};
+static const asDWORD BYTECODE_IMAGE_VERSION     = 1;
+static const asUINT  BYTECODE_IMAGE_ALIGNMENT   = 8;
+static const asUINT  BYTECODE_IMAGE_HEADER_SIZE = 24; // magic, version, interface hash (2 dwords), number of sections, reserved
+static const asUINT  BYTECODE_IMAGE_TOC_ENTRY   = 12; // id, offset, size
+
+enum eImageSection
+{
+	asIMAGE_BYTECODE = 1 // The bytecode. This is always the last section
+};
+
+static asDWORD DecodeImageDWord(const asBYTE *data)
+{
+	return asDWORD(data[0]) | (asDWORD(data[1]) << 8) | (asDWORD(data[2]) << 16) | (asDWORD(data[3]) << 24);
+}
+
+// 64bit FNV-1a
+static void HashBytes(asQWORD &hash, const void *data, asUINT size)
+{
+	for( asUINT n = 0; n < size; n++ )
+	{
+		hash ^= ((const asBYTE*)data)[n];
+		hash *= asQWORD(0x100000001B3ull);
+	}
+}
+
+static void HashDWord(asQWORD &hash, asDWORD value)
+{
+	asBYTE b[4] = {asBYTE(value), asBYTE(value >> 8), asBYTE(value >> 16), asBYTE(value >> 24)};
+	HashBytes(hash, b, 4);
+}
+
+static void HashString(asQWORD &hash, const asCString &str)
+{
+	HashDWord(hash, (asDWORD)str.GetLength());
+	HashBytes(hash, str.AddressOf(), (asUINT)str.GetLength());
+}
+
+static void HashName(asQWORD &hash, const asCString &name, asSNameSpace *ns)
+{
+	HashString(hash, name);
+	HashString(hash, ns ? ns->name : asCString());
+}
+
+static void HashDataType(asQWORD &hash, const asCDataType &dt)
+{
+	HashDWord(hash, dt.GetTokenType());
+	asCTypeInfo *ti = dt.GetTypeInfo();
+	if( ti )
+		HashName(hash, ti->name, ti->nameSpace);
+	HashDWord(hash, (dt.IsObjectHandle() ? 1 : 0) | (dt.IsHandleToConst() ? 2 : 0) | (dt.IsReference() ? 4 : 0) | (dt.IsReadOnly() ? 8 : 0));
+}
+
+// Returns true for the functions registered by the application that can be referred to by their id in 
+// the image. The template instances are not included, as they are created on demand in each engine
+static bool IsPreResolvable(asCScriptFunction *func)
+{
+	return func &&
+		   func->module == 0 &&
+		   func->funcType == asFUNC_SYSTEM &&
+		   func->templateSubTypes.GetLength() == 0 &&
+		   (func->objectType == 0 || !(func->objectType->flags & asOBJ_TEMPLATE));
+}
+
+// Computes a hash of the interface registered by the application. The function ids stored 
+// in the image are only valid when loading it in an engine that gives the same hash
+static asQWORD ComputeInterfaceHash(asCScriptEngine *engine)
+{
+	TimeIt("ComputeInterfaceHash");
+
+	asQWORD hash = asQWORD(0xCBF29CE484222325ull);
+	HashDWord(hash, ANGELSCRIPT_VERSION);
+
+	asUINT n;
+	for( n = 0; n < engine->registeredObjTypes.GetLength(); n++ )
+	{
+		asCObjectType *ot = engine->registeredObjTypes[n];
+		HashName(hash, ot->name, ot->nameSpace);
+		HashDWord(hash, asDWORD(ot->flags));
+		HashDWord(hash, asDWORD(ot->flags >> 32));
+		HashDWord(hash, ot->size);
+	}
+	for( n = 0; n < engine->registeredTemplateTypes.GetLength(); n++ )
+		HashName(hash, engine->registeredTemplateTypes[n]->name, engine->registeredTemplateTypes[n]->nameSpace);
+	for( n = 0; n < engine->registeredEnums.GetLength(); n++ )
+		HashName(hash, engine->registeredEnums[n]->name, engine->registeredEnums[n]->nameSpace);
+	for( n = 0; n < engine->registeredTypeDefs.GetLength(); n++ )
+		HashName(hash, engine->registeredTypeDefs[n]->name, engine->registeredTypeDefs[n]->nameSpace);
+	for( n = 0; n < engine->registeredFuncDefs.GetLength(); n++ )
+		HashName(hash, engine->registeredFuncDefs[n]->name, engine->registeredFuncDefs[n]->nameSpace);
+
+	asCSymbolTable<asCGlobalProperty>::iterator it = engine->registeredGlobalProps.List();
+	for( ; it; it++ )
+	{
+		HashName(hash, (*it)->name, (*it)->nameSpace);
+		HashDataType(hash, (*it)->type);
+	}
+
+	for( n = 0; n < engine->scriptFunctions.GetLength(); n++ )
+	{
+		asCScriptFunction *func = engine->scriptFunctions[n];
+		if( !IsPreResolvable(func) )
+			continue;
+
+		HashDWord(hash, func->id);
+		HashName(hash, func->name, func->nameSpace);
+		if( func->objectType )
+			HashName(hash, func->objectType->name, func->objectType->nameSpace);
+		HashDWord(hash, func->IsReadOnly() ? 1 : 0);
+		HashDataType(hash, func->returnType);
+		HashDWord(hash, func->parameterTypes.GetLength());
+		for( asUINT p = 0; p < func->parameterTypes.GetLength(); p++ )
+		{
+			HashDataType(hash, func->parameterTypes[p]);
+			HashDWord(hash, func->inOutFlags[p]);
+		}
+	}
+
+	return hash;
+}
+
 asCReader::asCReader(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine)
-	: module(_module), stream(_stream), engine(_engine), error(false), bytesRead(0), lastCompositeProp(0)
+	: module(_module), stream(_stream), engine(_engine), error(false), bytesRead(0), memory(0), memorySize(0), memoryPos(0), useFunctionIds(false), lastCompositeProp(0)
+{
+}
+
+asCReader::asCReader(asCModule* _module, const void *_data, asUINT _size, asCScriptEngine* _engine)
+	: module(_module), stream(0), engine(_engine), error(false), bytesRead(0), memory((const asBYTE*)_data), memorySize(_size), memoryPos(0), useFunctionIds(false), lastCompositeProp(0)
+{
+}
+
+// Reads the bytes as they are stored, either from the memory buffer or with a single call to the stream
+int asCReader::ReadBytes(void *data, asUINT size)
 {
+	if( memory )
+	{
+		if( size > memorySize - memoryPos )
+			return -1;
+		memcpy(data, memory + memoryPos, size);
+		memoryPos += size;
+		return 0;
+	}
+
+	return stream->Read(data, size);
+}
+
+// Skips the given number of bytes. When reading from a stream the bytes are read and discarded
+int asCReader::SkipBytes(asUINT size)
+{
+	bytesRead += size;
+	if( memory )
+	{
+		if( size > memorySize - memoryPos )
+			return -1;
+		memoryPos += size;
+		return 0;
+	}
+
+	asBYTE buf[64];
+	while( size )
+	{
+		asUINT count = size < sizeof(buf) ? size : sizeof(buf);
+		if( stream->Read(buf, count) < 0 )
+			return -1;
+		size -= count;
+	}
+	return 0;
+}
+
+// Reads the header of a bytecode image, after the first byte of the magic, and skips the
+// sections in front of the bytecode. When done the next byte read is the first byte of the bytecode
+int asCReader::ReadImage()
+{
+	TimeIt("asCReader::ReadImage");
+
+	asBYTE header[BYTECODE_IMAGE_HEADER_SIZE];
+	header[0] = BYTECODE_IMAGE_MAGIC[0];
+	if( ReadBytes(header+1, BYTECODE_IMAGE_HEADER_SIZE-1) < 0 )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+	bytesRead += BYTECODE_IMAGE_HEADER_SIZE-1;
+
+	if( memcmp(header, BYTECODE_IMAGE_MAGIC, 4) != 0 ||
+		DecodeImageDWord(header+4) != BYTECODE_IMAGE_VERSION )
+		return Error(TXT_INVALID_BYTECODE_d);
+
+	asQWORD hash = asQWORD(DecodeImageDWord(header+8)) | (asQWORD(DecodeImageDWord(header+12)) << 32);
+	asUINT numSections = SanityCheck(DecodeImageDWord(header+16), 100);
+
+	asCArray<asBYTE> toc;
+	if( !toc.SetLengthNoConstruct(numSections*BYTECODE_IMAGE_TOC_ENTRY) )
+		return Error(TXT_INVALID_BYTECODE_d);
+	if( numSections && ReadBytes(toc.AddressOf(), toc.GetLength()) < 0 )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+	bytesRead += toc.GetLength();
+
+	// The function ids can only be used if the application has registered the exact same 
+	// interface as when the image was saved. If it hasn't, the functions are looked up by 
+	// their signature, just as when loading the plain bytecode
+	useFunctionIds = hash == ComputeInterfaceHash(engine);
+
+	asUINT pos = BYTECODE_IMAGE_HEADER_SIZE + toc.GetLength();
+	for( asUINT n = 0; n < numSections && !error; n++ )
+	{
+		asDWORD id     = DecodeImageDWord(&toc[n*BYTECODE_IMAGE_TOC_ENTRY]);
+		asDWORD offset = DecodeImageDWord(&toc[n*BYTECODE_IMAGE_TOC_ENTRY+4]);
+		asDWORD size   = DecodeImageDWord(&toc[n*BYTECODE_IMAGE_TOC_ENTRY+8]);
+
+		// The sections are stored in the order of the table of contents
+		if( offset < pos || SkipBytes(offset - pos) < 0 )
+			return Error(TXT_INVALID_BYTECODE_d);
+		pos = offset;
+
+		if( id == asIMAGE_BYTECODE )
+		{
+			if( n != numSections-1 )
+				return Error(TXT_INVALID_BYTECODE_d);
+
+			// Don't let the reader go beyond the bytecode section
+			if( memory )
+			{
+				if( size > memorySize - memoryPos )
+					return Error(TXT_INVALID_BYTECODE_d);
+				memorySize = memoryPos + size;
+			}
+			return 0;
+		}
+
+		// Sections that are not known are skipped
+		if( SkipBytes(size) < 0 )
+			return Error(TXT_UNEXPECTED_END_OF_FILE);
+		pos += size;
+	}
+
+	// The image must have the bytecode
+	return Error(TXT_INVALID_BYTECODE_d);
 }
 
 int asCReader::ReadData(void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
-	int ret = 0;
+	int ret;
+	if( size == 1 )
+		ret = ReadBytes(data, 1);
+	else
+	{
+		// The value is stored in big endian order. The buffer starts with the current 
+		// value, so any bytes not updated by a faulty stream are left as they were
+		asBYTE buf[8];
 #if defined(AS_BIG_ENDIAN)
-	for( asUINT n = 0; ret >= 0 && n < size; n++ )
-		ret = stream->Read(((asBYTE*)data)+n, 1);
+		memcpy(buf, data, size);
 #else
-	for( int n = size-1; ret >= 0 && n >= 0; n-- )
-		ret = stream->Read(((asBYTE*)data)+n, 1);
+		for( asUINT n = 0; n < size; n++ )
+			buf[n] = ((asBYTE*)data)[size-1-n];
 #endif
+		ret = ReadBytes(buf, size);
+		if( ret >= 0 )
+		{
+#if defined(AS_BIG_ENDIAN)
+			memcpy(data, buf, size);
+#else
+			for( asUINT n = 0; n < size; n++ )
+				((asBYTE*)data)[n] = buf[size-1-n];
+#endif
+		}
+	}
 	if (ret < 0)
 		Error(TXT_UNEXPECTED_END_OF_FILE);
 	bytesRead += size;
@@ -149,8 +410,21 @@ int asCReader::ReadInner()
 	unsigned long i, count;
 	asCScriptFunction* func;
 
-	// Read the flag as 1 byte even on platforms with 4byte booleans
-	noDebugInfo = ReadEncodedUInt() ? VALUE_OF_BOOLEAN_TRUE : 0;
+	// The first byte is either the start of a bytecode image, or the 
+	// flag for the stripped debug info, which is encoded as 1 byte
+	asBYTE b = 0xFF; // set to 0xFF to better catch if the stream doesn't update the value
+	ReadData(&b, 1);
+	if( b == BYTECODE_IMAGE_MAGIC[0] && !error )
+	{
+		if( ReadImage() < 0 )
+			return asERROR;
+		b = 0xFF;
+		ReadData(&b, 1);
+	}
+	asQWORD flag = ReadEncodedUInt64(b);
+	if( (flag>>32) != 0 && (flag>>32) != 0xFFFFFFFF )
+		Error(TXT_INVALID_BYTECODE_d);
+	noDebugInfo = asUINT(flag) ? VALUE_OF_BOOLEAN_TRUE : 0;
 
 	// Read enums
 	count = SanityCheck(ReadEncodedUInt(), 1000000);
@@ -698,6 +972,34 @@ void asCReader::ReadUsedFunctions()
 		// Is the function from the module or the application?
 		ReadData(&c, 1);
 
+		// Application function with the id stored in a bytecode image
+		bool isSelfContained = false;
+		if( c == 'i' )
+		{
+			asUINT id = ReadEncodedUInt();
+			asUINT length = ReadEncodedUInt();
+			if( useFunctionIds )
+			{
+				// The application interface is the same as when the image was saved, so the signature isn't needed
+				asCScriptFunction *f = id < engine->scriptFunctions.GetLength() ? engine->scriptFunctions[id] : 0;
+				if( !IsPreResolvable(f) || SkipBytes(length) < 0 )
+				{
+					Error(TXT_INVALID_BYTECODE_d);
+					return;
+				}
+
+				usedFunctions[n] = f;
+				continue;
+			}
+
+			// Look up the function by the signature. It was written 
+			// without references to the previously written strings and types
+			c = 'a';
+			isSelfContained = true;
+			savedStrings.SwapWith(selfContainedStrings);
+			savedDataTypes.SwapWith(selfContainedDataTypes);
+		}
+
 		if( c == 'n' )
 		{
 			// Null function pointer
@@ -708,6 +1010,13 @@ void asCReader::ReadUsedFunctions()
 			asCScriptFunction func(engine, c == 'm' ? module : 0, asFUNC_DUMMY);
 			asCObjectType *parentClass = 0;
 			ReadFunctionSignature(&func, &parentClass);
+			if( isSelfContained )
+			{
+				savedStrings.SwapWith(selfContainedStrings);
+				savedDataTypes.SwapWith(selfContainedDataTypes);
+				selfContainedStrings.SetLength(0);
+				selfContainedDataTypes.SetLength(0);
+			}
 			if( error )
 			{
 				func.funcType = asFUNC_DUMMY;
@@ -1774,6 +2083,9 @@ void asCReader::ReadTypeDeclaration(asCTypeInfo *type, int phase, bool *isExtern
 						ot->interfaceVFTOffsets.PushLast(offset);
 					}
 				}
+
+				if( !ot->IsInterface() )
+					ot->SortInterfaces();
 			}
 
 			// behaviours
@@ -1960,8 +2272,8 @@ void asCReader::ReadTypeDeclaration(asCTypeInfo *type, int phase, bool *isExtern
 						if( isNew )
 						{
 							// Destroy the function without releasing any references
-							if( func->id == func->signatureId )
-								engine->signatureIds.RemoveValue(func);
+							if( func->signatureId )
+								engine->RemoveSignatureId(func);
 							func->id = 0;
 							if( func->scriptData )
 								func->scriptData->byteCode.SetLength(0);
@@ -2091,72 +2403,75 @@ int asCReader::ReadEncodedInt()
 
 asQWORD asCReader::ReadEncodedUInt64()
 {
-	asQWORD i = 0;
 	asBYTE b = 0xFF; // set to 0xFF to better catch if the stream doesn't update the value
 	ReadData(&b, 1);
+	return ReadEncodedUInt64(b);
+}
+
+// Decodes the value when the first byte has already been read
+asQWORD asCReader::ReadEncodedUInt64(asBYTE b)
+{
+	asQWORD i = 0;
 	bool isNegative = ( b & 0x80 ) ? true : false;
 	b &= 0x7F;
 
+	// The leading bits of the first byte tell how many bytes follow,
+	// and the remaining bits are the most significant bits of the value
+	asUINT count;
 	if( (b & 0x7F) == 0x7F )
-	{
-		ReadData(&b, 1); i = asQWORD(b) << 56;
-		ReadData(&b, 1); i += asQWORD(b) << 48;
-		ReadData(&b, 1); i += asQWORD(b) << 40;
-		ReadData(&b, 1); i += asQWORD(b) << 32;
-		ReadData(&b, 1); i += asUINT(b) << 24;
-		ReadData(&b, 1); i += asUINT(b) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
-	}
+		count = 8;
 	else if( (b & 0x7E) == 0x7E )
 	{
-		i = asQWORD(b & 0x01) << 48;
-		ReadData(&b, 1); i += asQWORD(b) << 40;
-		ReadData(&b, 1); i += asQWORD(b) << 32;
-		ReadData(&b, 1); i += asUINT(b) << 24;
-		ReadData(&b, 1); i += asUINT(b) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
+		count = 6;
+		i = b & 0x01;
 	}
 	else if( (b & 0x7C) == 0x7C )
 	{
-		i = asQWORD(b & 0x03) << 40;
-		ReadData(&b, 1); i += asQWORD(b) << 32;
-		ReadData(&b, 1); i += asUINT(b) << 24;
-		ReadData(&b, 1); i += asUINT(b) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
+		count = 5;
+		i = b & 0x03;
 	}
 	else if( (b & 0x78) == 0x78 )
 	{
-		i = asQWORD(b & 0x07) << 32;
-		ReadData(&b, 1); i += asUINT(b) << 24;
-		ReadData(&b, 1); i += asUINT(b) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
+		count = 4;
+		i = b & 0x07;
 	}
 	else if( (b & 0x70) == 0x70 )
 	{
-		i = asUINT(b & 0x0F) << 24;
-		ReadData(&b, 1); i += asUINT(b) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
+		count = 3;
+		i = b & 0x0F;
 	}
 	else if( (b & 0x60) == 0x60 )
 	{
-		i = asUINT(b & 0x1F) << 16;
-		ReadData(&b, 1); i += asUINT(b) << 8;
-		ReadData(&b, 1); i += b;
+		count = 2;
+		i = b & 0x1F;
 	}
 	else if( (b & 0x40) == 0x40 )
 	{
-		i = asUINT(b & 0x3F) << 8;
-		ReadData(&b, 1); i += b;
+		count = 1;
+		i = b & 0x3F;
 	}
 	else
 	{
+		count = 0;
 		i = b;
 	}
+
+	if( count )
+	{
+		// Read the following bytes with a single call. Any bytes not
+		// updated by a faulty stream get the value of the first byte
+		asBYTE buf[8];
+		memset(buf, b, count);
+		if( ReadBytes(buf, count) < 0 )
+			Error(TXT_UNEXPECTED_END_OF_FILE);
+		else
+		{
+			for( asUINT n = 0; n < count; n++ )
+				i = (i << 8) + buf[n];
+		}
+		bytesRead += count;
+	}
+
 	if( isNegative )
 		i = (asQWORD)(-asINT64(i));
 
@@ -2204,7 +2519,7 @@ void asCReader::ReadString(asCString* str)
 	{
 		len /= 2;
 		str->SetLength(len);
-		int r = stream->Read(str->AddressOf(), len);
+		int r = ReadBytes(str->AddressOf(), len);
 		if (r < 0)
 			Error(TXT_UNEXPECTED_END_OF_FILE);
 
@@ -2936,6 +3251,15 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 			// Translate the prop index into the property offset
 			*(((short*)&bc[n])+1) = FindObjectPropOffset(*(((short*)&bc[n])+1));
 		}
+		else if( c == asBC_PshVPtrOfs )
+		{
+			// Translate the index to the type id
+			int *tid = (int*)&bc[n+2];
+			*tid = FindTypeId(*tid);
+
+			// Translate the prop index into the property offset
+			*(((short*)&bc[n])+2) = FindObjectPropOffset(*(((short*)&bc[n])+2));
+		}
 		else if( c == asBC_LoadRObjR ||
 			     c == asBC_LoadVObjR )
 		{
@@ -3120,6 +3444,26 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 			// The size is dword offset
 			bc[n+1] = size;
 		}
+		else if( c == asBC_JEqIi ||
+			     c == asBC_JNeIi ||
+			     c == asBC_JLtIi ||
+			     c == asBC_JGeIi ||
+			     c == asBC_JGtIi ||
+			     c == asBC_JLeIi )
+		{
+			// The offset is stored after the constant that is compared against
+			int offset = int(bc[n+2]);
+
+			int size = 0;
+			if( offset >= 0 )
+				for( asUINT num = bcNum+1; offset-- > 0; num++ )
+					size += bcSizes[num];
+			else
+				for( asUINT num = bcNum; offset++ < 0; num-- )
+					size -= bcSizes[num];
+
+			bc[n+2] = size;
+		}
 		else if( c == asBC_AllocMem )
 		{
 			// The size of the allocated memory is only known after all the elements has been seen.
@@ -3593,6 +3937,33 @@ void asCReader::CalculateStackNeeded(asCScriptFunction *func)
 
 			continue;
 		}
+		else if( bc == asBC_JEqIi || bc == asBC_JNeIi ||
+				 bc == asBC_JLtIi || bc == asBC_JGeIi ||
+				 bc == asBC_JGtIi || bc == asBC_JLeIi )
+		{
+			// Same as above, except the instruction is one dword larger
+			int offset = *(int*)&func->scriptData->byteCode[pos+2];
+
+			pos += 3;
+			if( stackSize[pos] == -1 )
+			{
+				stackSize[pos] = currStackSize;
+				paths.PushLast(pos);
+			}
+			else
+				asASSERT(stackSize[pos] == currStackSize);
+
+			pos += offset;
+			if( stackSize[pos] == -1 )
+			{
+				stackSize[pos] = currStackSize;
+				paths.PushLast(pos);
+			}
+			else
+				asASSERT(stackSize[pos] == currStackSize);
+
+			continue;
+		}
 		else if( bc == asBC_JMPP )
 		{
 			pos++;
@@ -3890,7 +4261,7 @@ asCTypeInfo *asCReader::FindType(int idx)
 #ifndef AS_NO_COMPILER
 
 asCWriter::asCWriter(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine, bool _stripDebug)
-	: module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug), error(false), bytesWritten(0), lastWasComposite(false)
+	: module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug), error(false), bytesWritten(0), isImage(false), lastWasComposite(false)
 {
 }
 
@@ -3908,6 +4279,80 @@ int asCWriter::Error(const char *msg)
 	return asERROR;
 }
 
+// Keeps the written bytecode in memory, so it can be placed after the header of the bytecode image
+class asCByteCodeBuffer : public asIBinaryStream
+{
+public:
+	int Read(void *, asUINT) { return asNOT_SUPPORTED; }
+	int Write(const void *ptr, asUINT size)
+	{
+		// The bytecode is written a few bytes at a time, so the buffer must grow exponentially
+		asUINT pos = data.GetLength();
+		if( pos + size > data.maxLength )
+			data.AllocateNoConstruct(2*(pos + size), true);
+		if( !data.SetLengthNoConstruct(pos + size) )
+			return asOUT_OF_MEMORY;
+		memcpy(data.AddressOf() + pos, ptr, size);
+		return 0;
+	}
+
+	asCArray<asBYTE> data;
+};
+
+static void EncodeImageDWord(asCArray<asBYTE> &data, asDWORD value)
+{
+	data.PushLast(asBYTE(value));
+	data.PushLast(asBYTE(value >> 8));
+	data.PushLast(asBYTE(value >> 16));
+	data.PushLast(asBYTE(value >> 24));
+}
+
+static asUINT AlignImageOffset(asUINT offset)
+{
+	return (offset + BYTECODE_IMAGE_ALIGNMENT - 1) & ~(BYTECODE_IMAGE_ALIGNMENT - 1);
+}
+
+int asCWriter::WriteImage()
+{
+	TimeIt("asCWriter::WriteImage");
+
+	// The bytecode is written to memory first, as its size must be known for the table of contents
+	asCByteCodeBuffer code;
+	asIBinaryStream *out = stream;
+	stream = &code;
+	isImage = true;
+	int r = Write();
+	isImage = false;
+	stream = out;
+	if( r < 0 )
+		return r;
+
+	const asUINT numSections = 1;
+	asUINT codeOffset = AlignImageOffset(BYTECODE_IMAGE_HEADER_SIZE + numSections*BYTECODE_IMAGE_TOC_ENTRY);
+
+	asQWORD hash = ComputeInterfaceHash(engine);
+
+	asCArray<asBYTE> header;
+	for( asUINT n = 0; n < 4; n++ )
+		header.PushLast(BYTECODE_IMAGE_MAGIC[n]);
+	EncodeImageDWord(header, BYTECODE_IMAGE_VERSION);
+	EncodeImageDWord(header, asDWORD(hash));
+	EncodeImageDWord(header, asDWORD(hash >> 32));
+	EncodeImageDWord(header, numSections);
+	EncodeImageDWord(header, 0);
+	EncodeImageDWord(header, asIMAGE_BYTECODE);
+	EncodeImageDWord(header, codeOffset);
+	EncodeImageDWord(header, code.data.GetLength());
+	while( header.GetLength() < codeOffset )
+		header.PushLast(0);
+
+	if( stream->Write(header.AddressOf(), header.GetLength()) < 0 ||
+		(code.data.GetLength() && stream->Write(code.data.AddressOf(), code.data.GetLength()) < 0) )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+
+	return asSUCCESS;
+}
+
 int asCWriter::WriteData(const void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
@@ -4146,7 +4591,34 @@ void asCWriter::WriteUsedFunctions()
 
 		// Write enough data to be able to uniquely identify the function upon load
 		asCScriptFunction *func = usedFunctions[n];
-		if(func)
+		if( func && isImage && IsPreResolvable(func) )
+		{
+			// In the image the application functions are stored by their id, followed by
+			// the signature that is used if the application interface has been changed.
+			// The signature is written on its own, so the loader can skip it
+			asCByteCodeBuffer signature;
+			asIBinaryStream *out = stream;
+			stream = &signature;
+			savedStrings.SwapWith(selfContainedStrings);
+			stringToIdMap.SwapWith(selfContainedStringToIdMap);
+			savedDataTypes.SwapWith(selfContainedDataTypes);
+			WriteFunctionSignature(func);
+			savedStrings.SwapWith(selfContainedStrings);
+			stringToIdMap.SwapWith(selfContainedStringToIdMap);
+			savedDataTypes.SwapWith(selfContainedDataTypes);
+			selfContainedStrings.SetLength(0);
+			selfContainedStringToIdMap.EraseAll();
+			selfContainedDataTypes.SetLength(0);
+			stream = out;
+
+			c = 'i';
+			WriteData(&c, 1);
+			WriteEncodedInt64(func->id);
+			WriteEncodedInt64(signature.data.GetLength());
+			if( signature.data.GetLength() && stream->Write(signature.data.AddressOf(), signature.data.GetLength()) < 0 )
+				Error(TXT_UNEXPECTED_END_OF_FILE);
+		}
+		else if(func)
 		{
 			// Is the function from the module or the application?
 			c = func->module ? 'm' : 'a';
@@ -5150,6 +5622,14 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			// Translate type ids into indices
 			*(int*)(tmpBC+1) = FindTypeIdIdx(*(int*)(tmpBC+1));
 		}
+		else if( c == asBC_PshVPtrOfs )  // rW_W_DW_ARG
+		{
+			// Translate property offsets into indices
+			*(((short*)tmpBC)+2) = (short)FindObjectPropIndex(*(((short*)tmpBC)+2), *(int*)(tmpBC+2), bc);
+
+			// Translate type ids into indices
+			*(int*)(tmpBC+2) = FindTypeIdIdx(*(int*)(tmpBC+2));
+		}
 		else if( c == asBC_LoadRObjR ||    // rW_W_DW_ARG
 			     c == asBC_LoadVObjR )     // rW_W_DW_ARG
 		{
@@ -5256,6 +5736,22 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 			// Set the offset in number of instructions
 			*(int*)(tmpBC+1) = targetBcSeqNum - bcSeqNum;
 		}
+		else if( c == asBC_JEqIi ||     // rW_DW_DW_ARG
+			     c == asBC_JNeIi ||
+			     c == asBC_JLtIi ||
+			     c == asBC_JGeIi ||
+			     c == asBC_JGtIi ||
+			     c == asBC_JLeIi )
+		{
+			// The offset is stored after the constant that is compared against
+			int offset = *(int*)(tmpBC+2);
+
+			int bcSeqNum = bytecodeNbrByPos[asUINT(bc - startBC)] + 1;
+			asDWORD *targetBC = bc + 3 + offset;
+			int targetBcSeqNum = bytecodeNbrByPos[asUINT(targetBC - startBC)];
+
+			*(int*)(tmpBC+2) = targetBcSeqNum - bcSeqNum;
+		}
 		else if( c == asBC_GETOBJ ||    // W_ARG
 			     c == asBC_GETOBJREF ||
 			     c == asBC_GETREF ||
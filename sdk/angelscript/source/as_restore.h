@@ -49,6 +49,7 @@ class asCReader
 {
 public:
 	asCReader(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine);
+	asCReader(asCModule *module, const void *data, asUINT size, asCScriptEngine *engine);
 
 	int Read(bool *wasDebugInfoStripped);
 
@@ -60,10 +61,18 @@ protected:
 	bool             error;
 	asUINT           bytesRead;
 
+	// When loading from memory the data is decoded directly from the buffer instead of the stream
+	const asBYTE    *memory;
+	asUINT           memorySize;
+	asUINT           memoryPos;
+
 	int                Error(const char *msg);
 
 	int                ReadInner();
 
+	int                ReadImage();
+	int                ReadBytes(void *data, asUINT size);
+	int                SkipBytes(asUINT size);
 	int                ReadData(void *data, asUINT size);
 	void               ReadString(asCString *str);
 	asCScriptFunction *ReadFunction(bool &isNew, bool addToModule = true, bool addToEngine = true, bool addToGC = true, bool *isExternal = 0);
@@ -78,6 +87,7 @@ protected:
 	asUINT             ReadEncodedUInt();
 	int                ReadEncodedInt();
 	asQWORD            ReadEncodedUInt64();
+	asQWORD            ReadEncodedUInt64(asBYTE firstByte);
 	asUINT             SanityCheck(asUINT val, asUINT max);
 	int                SanityCheck(int val, asUINT max);
 
@@ -106,6 +116,13 @@ protected:
 	asCArray<void*>              usedGlobalProperties;
 	asCArray<void*>              usedStringConstants;
 
+	// Set when loading an image that was saved with the same application interface
+	bool                         useFunctionIds;
+
+	// Used while reading a signature that was written on its own in a bytecode image
+	asCArray<asCString>          selfContainedStrings;
+	asCArray<asCDataType>        selfContainedDataTypes;
+
 	asCArray<asCScriptFunction*>  savedFunctions;
 	asCArray<asCDataType>         savedDataTypes;
 	asCArray<asCString>           savedStrings;
@@ -164,6 +181,7 @@ public:
 	asCWriter(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine, bool stripDebugInfo);
 
 	int Write();
+	int WriteImage();
 
 protected:
 	asCModule       *module;
@@ -220,6 +238,12 @@ protected:
 	asCArray<asCDataType>         savedDataTypes;
 	asCArray<asCString>           savedStrings;
 	asCMap<asCString, int>        stringToIdMap;
+
+	// Used while writing a signature on its own in a bytecode image
+	bool                          isImage;
+	asCArray<asCDataType>         selfContainedDataTypes;
+	asCArray<asCString>           selfContainedStrings;
+	asCMap<asCString, int>        selfContainedStringToIdMap;
 	asCArray<int>                 adjustStackByPos;
 	asCArray<int>                 adjustNegativeStackByPos;
 	asCArray<int>                 bytecodeNbrByPos;
@@ -121,6 +121,12 @@ AS_API const char * asGetLibraryOptions()
 #ifdef AS_BIG_ENDIAN
 		"AS_BIG_ENDIAN "
 #endif
+#ifdef AS_PROFILE
+		"AS_PROFILE "
+#endif
+#ifdef AS_BYTECODE_STATS
+		"AS_BYTECODE_STATS "
+#endif
 
 	// Target system
 #ifdef AS_WIN
@@ -230,6 +236,52 @@ AS_API const char * asGetLibraryOptions()
 	return string;
 }
 
+AS_API int asResetProfiler()
+{
+#ifdef AS_PROFILE
+	g_profiler.Reset();
+	return asSUCCESS;
+#else
+	return asNOT_SUPPORTED;
+#endif
+}
+
+AS_API asUINT asGetProfilerScopeCount()
+{
+#ifdef AS_PROFILE
+	return g_profiler.GetScopeCount();
+#else
+	return 0;
+#endif
+}
+
+AS_API int asGetProfilerScope(asUINT index, const char **scope, asUINT *count, double *totalTime, double *minTime, double *maxTime)
+{
+#ifdef AS_PROFILE
+	return g_profiler.GetScope(index, scope, count, totalTime, minTime, maxTime);
+#else
+	UNUSED_VAR(index);
+	UNUSED_VAR(scope);
+	UNUSED_VAR(count);
+	UNUSED_VAR(totalTime);
+	UNUSED_VAR(minTime);
+	UNUSED_VAR(maxTime);
+	return asNOT_SUPPORTED;
+#endif
+}
+
+AS_API int asWriteProfilerTrace(const char *filename)
+{
+#ifdef AS_PROFILE
+	if( filename == 0 )
+		return asINVALID_ARG;
+	return g_profiler.WriteTrace(filename);
+#else
+	UNUSED_VAR(filename);
+	return asNOT_SUPPORTED;
+#endif
+}
+
 AS_API asIScriptEngine *asCreateScriptEngine(asDWORD version)
 {
 	// Verify the version that the application expects
@@ -278,6 +330,8 @@ AS_API asIScriptEngine *asCreateScriptEngine(asDWORD version)
 // interface
 int asCScriptEngine::SetEngineProperty(asEEngineProp property, asPWORD value)
 {
+	InvalidateDeclCache();
+
 	switch( property )
 	{
 	case asEP_ALLOW_UNSAFE_REFERENCES:
@@ -498,6 +552,40 @@ int asCScriptEngine::SetEngineProperty(asEEngineProp property, asPWORD value)
 		tok.InitJumpTable();
 		break;
 
+	case asEP_STACK_HIGH_WATER_MARK:
+		// The size is given in bytes
+		ep.stackHighWaterMark = (asUINT)value;
+		break;
+
+	case asEP_GC_PROMOTION_SWEEPS:
+		// An object must be inspected at least once before it can be promoted
+		if( value < 1 || value > 255 )
+			return asINVALID_ARG;
+		ep.gcPromotionSweeps = (asUINT)value;
+		break;
+
+	case asEP_GC_PARALLEL_MIN_OBJECTS:
+		ep.gcParallelMinObjects = (asUINT)value;
+		break;
+
+	case asEP_COMPILE_PARALLEL_MIN_FUNCTIONS:
+		ep.compileParallelMinFunctions = (asUINT)value;
+		break;
+
+	case asEP_OPTIMIZE_BYTECODE_LEVEL:
+		if( value < 1 || value > 2 )
+			return asINVALID_ARG;
+		ep.optimizeByteCodeLevel = (asUINT)value;
+		break;
+
+	case asEP_MAX_INLINE_FUNCTION_SIZE:
+		ep.maxInlineFunctionSize = (asUINT)value;
+		break;
+
+	case asEP_INCREMENTAL_BUILD:
+		ep.incrementalBuild = value ? true : false;
+		break;
+
 	default:
 		return asINVALID_ARG;
 	}
@@ -630,6 +718,27 @@ asPWORD asCScriptEngine::GetEngineProperty(asEEngineProp property) const
 	case asEP_FOREACH_SUPPORT:
 		return ep.foreachSupport;
 
+	case asEP_STACK_HIGH_WATER_MARK:
+		return ep.stackHighWaterMark;
+
+	case asEP_GC_PROMOTION_SWEEPS:
+		return ep.gcPromotionSweeps;
+
+	case asEP_GC_PARALLEL_MIN_OBJECTS:
+		return ep.gcParallelMinObjects;
+
+	case asEP_COMPILE_PARALLEL_MIN_FUNCTIONS:
+		return ep.compileParallelMinFunctions;
+
+	case asEP_OPTIMIZE_BYTECODE_LEVEL:
+		return ep.optimizeByteCodeLevel;
+
+	case asEP_MAX_INLINE_FUNCTION_SIZE:
+		return ep.maxInlineFunctionSize;
+
+	case asEP_INCREMENTAL_BUILD:
+		return ep.incrementalBuild;
+
 	default:
 		return 0;
 	}
@@ -708,6 +817,13 @@ asCScriptEngine::asCScriptEngine()
 		ep.memberInitMode                = 1;         // 0 = pre 2.38.0, members with init expr in declaration are initialized after super(), 1 = all members initialized in beginning, except if explicitly initialized in body
 		ep.boolConversionMode            = 0;         // 0 = only do use opImplConv for registered value type, 1 = use also opConv in contextual conversion even for reference types
 		ep.foreachSupport                = true;
+		ep.stackHighWaterMark            = 0;         // 0 = contexts keep their stack memory until they are destroyed
+		ep.gcPromotionSweeps             = 3;         // number of sweeps a new object must survive before it is moved to the old generation
+		ep.gcParallelMinObjects          = 0;         // 0 = the garbage collector never uses the worker pool
+		ep.compileParallelMinFunctions   = 0;         // 0 = the builder never uses the worker pool
+		ep.optimizeByteCodeLevel         = 1;         // 1 = peephole optimizations, 2 = also data flow optimizations
+		ep.maxInlineFunctionSize         = 0;         // 0 = script functions are never inlined
+		ep.incrementalBuild              = false;     // false = each build compiles all the script sections
 	}
 
 	gc.engine = this;
@@ -717,7 +833,6 @@ asCScriptEngine::asCScriptEngine()
 	stringFactory = 0;
 	configFailed = false;
 	isPrepared = false;
-	isBuilding = false;
 	deferValidationOfTemplateTypes = false;
 	lastModule = 0;
 
@@ -736,6 +851,10 @@ asCScriptEngine::asCScriptEngine()
 	returnCtxFunc    = 0;
 	ctxCallbackParam = 0;
 
+	workerPoolFunc   = 0;
+	workerPoolParam  = 0;
+	workerPoolSize   = 0;
+
 	// We must set the namespace in the built-in types explicitly as
 	// this wasn't done by the default constructor. If we do not do
 	// this we will get null pointer access in other parts of the code
@@ -989,6 +1108,33 @@ int asCScriptEngine::SetContextCallbacks(asREQUESTCONTEXTFUNC_t requestCtx, asRE
 	return 0;
 }
 
+// interface
+int asCScriptEngine::SetWorkerPool(asWORKERPOOLFUNC_t callback, void *param, asUINT numWorkers)
+{
+#ifdef AS_NO_THREADS
+	UNUSED_VAR(callback);
+	UNUSED_VAR(param);
+	UNUSED_VAR(numWorkers);
+	return asNOT_SUPPORTED;
+#else
+	// A pool without workers can't run anything
+	if( callback && numWorkers == 0 )
+		return asINVALID_ARG;
+
+	workerPoolFunc  = callback;
+	workerPoolParam = param;
+	workerPoolSize  = callback ? numWorkers : 0;
+
+	return 0;
+#endif
+}
+
+// interface
+void asCScriptEngine::GetStackStatistics(asUINT *bytesInContexts, asUINT *bytesPooled, asUINT *blocksPooled) const
+{
+	memoryMgr.GetStackStatistics(bytesInContexts, bytesPooled, blocksPooled);
+}
+
 // interface
 asIScriptContext *asCScriptEngine::RequestContext()
 {
@@ -1539,11 +1685,20 @@ int asCScriptEngine::GetMethodIdByDecl(const asCObjectType *ot, const char *decl
 	if( r < 0 )
 		return asINVALID_DECLARATION;
 
-	// Search script functions for matching interface
+	return GetMethodIdBySignature(ot, &func);
+}
+
+// internal
+int asCScriptEngine::GetMethodIdBySignature(const asCObjectType *ot, const asCScriptFunction *sig) const
+{
+	// Search script functions for matching interface. The signature may have been 
+	// parsed without the object type, so the methods' own object type is used
 	int id = -1;
 	for( asUINT n = 0; n < ot->methods.GetLength(); ++n )
 	{
-		if( func.IsSignatureEqual(scriptFunctions[ot->methods[n]]) )
+		asCScriptFunction *f = scriptFunctions[ot->methods[n]];
+		if( f->name == sig->name && 
+			f->IsSignatureExceptNameEqual(sig->returnType, sig->parameterTypes, sig->inOutFlags, f->objectType, sig->IsReadOnly()) )
 		{
 			if( id == -1 )
 				id = ot->methods[n];
@@ -1590,9 +1745,17 @@ asIScriptContext *asCScriptEngine::CreateContext()
 // internal
 int asCScriptEngine::CreateContext(asIScriptContext **context, bool isInternal)
 {
-	*context = asNEW(asCContext)(this, !isInternal);
-	if( *context == 0 )
+	asCContext *ctx = asNEW(asCContext)(this, !isInternal);
+	if( ctx == 0 )
+	{
+		*context = 0;
 		return asOUT_OF_MEMORY;
+	}
+	*context = ctx;
+
+	ACQUIREEXCLUSIVE(engineRWLock);
+	contexts.PushLast(ctx);
+	RELEASEEXCLUSIVE(engineRWLock);
 
 	// We need to make sure the engine has been
 	// prepared before any context is executed
@@ -1604,6 +1767,8 @@ int asCScriptEngine::CreateContext(asIScriptContext **context, bool isInternal)
 // interface
 int asCScriptEngine::RegisterObjectProperty(const char *obj, const char *declaration, int byteOffset, int compositeOffset, bool isCompositeIndirect)
 {
+	InvalidateDeclCache();
+
 	int r;
 	asCDataType dt;
 	asCBuilder bld(this, 0);
@@ -1675,6 +1840,8 @@ int asCScriptEngine::RegisterObjectProperty(const char *obj, const char *declara
 // interface
 int asCScriptEngine::RegisterInterface(const char *name)
 {
+	InvalidateDeclCache();
+
 	if( name == 0 ) return ConfigError(asINVALID_NAME, "RegisterInterface", 0, 0);
 
 	// Verify if the name has been registered as a type already
@@ -1737,6 +1904,8 @@ int asCScriptEngine::RegisterInterface(const char *name)
 // interface
 int asCScriptEngine::RegisterInterfaceMethod(const char *intf, const char *declaration)
 {
+	InvalidateDeclCache();
+
 	// Verify that the correct config group is set.
 	if( currentGroup->FindType(intf) == 0 )
 		return ConfigError(asWRONG_CONFIG_GROUP, "RegisterInterfaceMethod", intf, declaration);
@@ -1816,6 +1985,8 @@ asCTypeInfo* asCScriptEngine::GetTemplateSubTypeByName(const asCString &name)
 
 int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asQWORD flags)
 {
+	InvalidateDeclCache();
+
 	int r;
 
 	isPrepared = false; // TODO: Only set this after the validations have been completed, to avoid unnecessary Prepare in case no change was made
@@ -1825,7 +1996,7 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asQWORD
 	if( flags & asOBJ_REF )
 	{
 		// Can optionally have the asOBJ_GC, asOBJ_NOHANDLE, asOBJ_SCOPED, or asOBJ_TEMPLATE flag set, but nothing else
-		if( flags & ~(asOBJ_REF | asOBJ_GC | asOBJ_NOHANDLE | asOBJ_SCOPED | asOBJ_TEMPLATE | asOBJ_NOCOUNT | asOBJ_IMPLICIT_HANDLE) )
+		if( flags & ~(asOBJ_REF | asOBJ_GC | asOBJ_GC_THREADSAFE | asOBJ_NOHANDLE | asOBJ_SCOPED | asOBJ_TEMPLATE | asOBJ_NOCOUNT | asOBJ_IMPLICIT_HANDLE) )
 			return ConfigError(asINVALID_ARG, "RegisterObjectType", name, 0);
 
 		// flags are exclusive
@@ -1899,6 +2070,10 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asQWORD
 	else
 		return ConfigError(asINVALID_ARG, "RegisterObjectType", name, 0);
 
+	// Thread safe enumeration of references only makes sense for garbage collected types
+	if( (flags & asOBJ_GC_THREADSAFE) && !(flags & asOBJ_GC) )
+		return ConfigError(asINVALID_ARG, "RegisterObjectType", name, 0);
+
 	// Don't allow anything else than the defined flags
 #ifndef WIP_16BYTE_ALIGN
 	if( flags - (flags & asOBJ_MASK_VALID_FLAGS) )
@@ -2100,6 +2275,8 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asQWORD
 // interface
 int asCScriptEngine::RegisterObjectBehaviour(const char *datatype, asEBehaviours behaviour, const char *decl, const asSFuncPtr &funcPointer, asDWORD callConv, void *auxiliary, int compositeOffset, bool isCompositeIndirect)
 {
+	InvalidateDeclCache();
+
 	if( datatype == 0 ) return ConfigError(asINVALID_ARG, "RegisterObjectBehaviour", datatype, decl);
 
 	// Determine the object type
@@ -2718,6 +2895,8 @@ int asCScriptEngine::AddBehaviourFunction(asCScriptFunction &func, asSSystemFunc
 // interface
 int asCScriptEngine::RegisterGlobalProperty(const char *declaration, void *pointer)
 {
+	InvalidateDeclCache();
+
 	// Don't accept a null pointer
 	if( pointer == 0 )
 		return ConfigError(asINVALID_ARG, "RegisterGlobalProperty", declaration, 0);
@@ -2832,15 +3011,16 @@ int asCScriptEngine::GetGlobalPropertyByIndex(asUINT index, const char **name, c
 // interface
 int asCScriptEngine::GetGlobalPropertyIndexByName(const char *in_name) const
 {
-	asCString name;
+	const char *name = 0;
 	asSNameSpace *ns = 0;
 	if( DetermineNameAndNamespace(in_name, defaultNamespace, name, ns) < 0 )
 		return asINVALID_ARG;
+	size_t length = strlen(name);
 			
 	// Find the global var id
 	while( ns )
 	{
-		int id = registeredGlobalProps.GetFirstIndex(ns, name);
+		int id = registeredGlobalProps.GetFirstIndex(ns, name, length);
 		if( id >= 0 )
 			return id;
 
@@ -2883,6 +3063,8 @@ int asCScriptEngine::GetGlobalPropertyIndexByDecl(const char *decl) const
 // interface
 int asCScriptEngine::RegisterObjectMethod(const char *obj, const char *declaration, const asSFuncPtr &funcPointer, asDWORD callConv, void *auxiliary, int compositeOffset, bool isCompositeIndirect)
 {
+	InvalidateDeclCache();
+
 	if( obj == 0 )
 		return ConfigError(asINVALID_ARG, "RegisterObjectMethod", obj, declaration);
 
@@ -3078,6 +3260,8 @@ int asCScriptEngine::RegisterMethodToObjectType(asCObjectType *objectType, const
 // interface
 int asCScriptEngine::RegisterGlobalFunction(const char *declaration, const asSFuncPtr &funcPointer, asDWORD callConv, void *auxiliary)
 {
+	InvalidateDeclCache();
+
 #ifdef AS_MAX_PORTABILITY
 	if( callConv != asCALL_GENERIC )
 		return ConfigError(asNOT_SUPPORTED, "RegisterGlobalFunction", declaration, 0);
@@ -3201,6 +3385,11 @@ int asCScriptEngine::GetTemplateFunctionInstance(asCScriptFunction* baseFunc, co
 			return func->id;
 	}
 
+#ifndef AS_NO_COMPILER
+	if( !asCBuilder::CanModifySharedState() )
+		return asERROR;
+#endif
+
 	// Generate the new template function instance
 	asCScriptFunction* newFunc = asNEW(asCScriptFunction)(this, 0, baseFunc->funcType);
 	if (newFunc == 0)
@@ -3465,6 +3654,8 @@ int asCScriptEngine::ConfigError(int err, const char *funcName, const char *arg1
 // interface
 int asCScriptEngine::RegisterDefaultArrayType(const char *type)
 {
+	InvalidateDeclCache();
+
 	asCBuilder bld(this, 0);
 	asCDataType dt;
 	int r = bld.ParseDataType(type, &dt, defaultNamespace);
@@ -3555,14 +3746,15 @@ asCModule *asCScriptEngine::GetModule(const char *name, bool create)
 
 	asCModule *retModule = 0;
 
+	// A module that is waiting to be discarded after an ongoing build is skipped
 	ACQUIRESHARED(engineRWLock);
-	if( lastModule && lastModule->m_name == name )
+	if( lastModule && lastModule->m_name == name && !lastModule->m_discardWhenUpdated )
 		retModule = lastModule;
 	else
 	{
 		// TODO: optimize: Improve linear search
 		for( asUINT n = 0; n < scriptModules.GetLength(); ++n )
-			if( scriptModules[n] && scriptModules[n]->m_name == name )
+			if( scriptModules[n] && scriptModules[n]->m_name == name && !scriptModules[n]->m_discardWhenUpdated )
 			{
 				retModule = scriptModules[n];
 				break;
@@ -3609,14 +3801,17 @@ asCModule *asCScriptEngine::GetModuleFromFuncId(int id)
 // internal
 int asCScriptEngine::RequestBuild()
 {
-	ACQUIREEXCLUSIVE(engineRWLock);
-	if( isBuilding )
-	{
-		RELEASEEXCLUSIVE(engineRWLock);
+	// A new build on this engine cannot be started from within a build in the
+	// same thread, e.g. from the message callback, as it would deadlock
+	asCThreadLocalData *tld = asCThreadManager::GetLocalData();
+	if( tld == 0 )
+		return asERROR;
+	if( tld->buildingEngines.IndexOf(this) >= 0 )
 		return asBUILD_IN_PROGRESS;
-	}
-	isBuilding = true;
-	RELEASEEXCLUSIVE(engineRWLock);
+
+	// Builds in other threads will wait until this one is completed
+	ENTERCRITICALSECTION(buildCs);
+	tld->buildingEngines.PushLast(this);
 
 	return 0;
 }
@@ -3627,11 +3822,14 @@ void asCScriptEngine::BuildCompleted()
 	// Always free up pooled memory after a completed build
 	memoryMgr.FreeUnusedMemory();
 
-	isBuilding = false;
+	asCThreadManager::GetLocalData()->buildingEngines.RemoveValue(this);
+	LEAVECRITICALSECTION(buildCs);
 }
 
 void asCScriptEngine::RemoveTemplateInstanceType(asCObjectType *t)
 {
+	InvalidateDeclCache();
+
 	// If there is a module that still owns the generated type, then don't remove it
 	if( t->module )
 		return;
@@ -3670,8 +3868,15 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 			// If the template instance is generated, then the module should hold a reference
 			// to it so the config group can determine see that the template type is in use.
 			// Template specializations will be treated as normal types
-			if( requestingModule && generatedTemplateTypes.Exists(type) )
+			if( requestingModule && generatedTemplateTypes.Exists(type) &&
+				(type->module == 0 || !requestingModule->m_templateInstances.Exists(type)) )
 			{
+#ifndef AS_NO_COMPILER
+				if( !asCBuilder::CanModifySharedState() )
+					return templateInstanceTypes[n];
+#endif
+
+				asASSERT( asCBuilder::GetCompileTask() == 0 );
 				if( type->module == 0 )
 				{
 					// Set the ownership of this template type
@@ -3690,6 +3895,10 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 	}
 
 	// No previous template instance exists
+#ifndef AS_NO_COMPILER
+	if( !asCBuilder::CanModifySharedState() )
+		return 0;
+#endif
 
 	// Make sure this template supports the subtype
 	for( n = 0; n < subTypes.GetLength(); n++ )
@@ -3800,6 +4009,7 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 	// to include the new template instance type in the list of known types, otherwise it is possible that we get
 	// a infinite recursive loop as the template instance type is requested again during the generation of the
 	// template functions.
+	asASSERT( asCBuilder::GetCompileTask() == 0 );
 	templateInstanceTypes.PushLast(ot);
 
 	// Store the template instance types that have been created automatically by the engine from a template type
@@ -5031,6 +5241,17 @@ void asCScriptEngine::GetGCStatistics(asUINT *currentSize, asUINT *totalDestroye
 	gc.GetStatistics(currentSize, totalDestroyed, totalDetected, newObjects, totalNewDestroyed);
 }
 
+// interface
+int asCScriptEngine::GetGCTypeStatistics(asITypeInfo *type, asUINT *totalAdded, asUINT *totalNewDestroyed, asUINT *totalPromoted, asUINT *totalDetected) const
+{
+	asCObjectType *ot = type ? CastToObjectType(reinterpret_cast<asCTypeInfo*>(type)) : 0;
+	if( ot == 0 )
+		return asINVALID_ARG;
+
+	gc.GetTypeStatistics(ot, totalAdded, totalNewDestroyed, totalPromoted, totalDetected);
+	return asSUCCESS;
+}
+
 // interface
 void asCScriptEngine::GCEnumCallback(void *reference)
 {
@@ -5147,6 +5368,12 @@ int asCScriptEngine::GetTypeIdFromDataType(const asCDataType &dtIn) const
 
 	if( typeId == -1 )
 	{
+#ifndef AS_NO_COMPILER
+		// The builder gives the types their ids before compiling in parallel, so this shouldn't happen
+		if( !asCBuilder::CanModifySharedState() )
+			return -1;
+#endif
+
 		ACQUIREEXCLUSIVE(engineRWLock);
 		// Make sure another thread didn't determine the typeId while we were waiting for the lock
 		if( ot->typeId == -1 )
@@ -5159,6 +5386,7 @@ int asCScriptEngine::GetTypeIdFromDataType(const asCDataType &dtIn) const
 
 			ot->typeId = typeId;
 
+			asASSERT( asCBuilder::GetCompileTask() == 0 );
 			mapTypeIdToTypeInfo.Insert(typeId, ot);
 		}
 		RELEASEEXCLUSIVE(engineRWLock);
@@ -5221,6 +5449,8 @@ asCObjectType *asCScriptEngine::GetObjectTypeFromTypeId(int typeId) const
 
 void asCScriptEngine::RemoveFromTypeIdMap(asCTypeInfo *type)
 {
+	InvalidateDeclCache();
+
 	ACQUIREEXCLUSIVE(engineRWLock);
 	asSMapNode<int,asCTypeInfo*> *cursor = 0;
 	mapTypeIdToTypeInfo.MoveFirst(&cursor);
@@ -5236,17 +5466,39 @@ void asCScriptEngine::RemoveFromTypeIdMap(asCTypeInfo *type)
 	RELEASEEXCLUSIVE(engineRWLock);
 }
 
-// interface
-asITypeInfo *asCScriptEngine::GetTypeInfoByDecl(const char *decl) const
+// internal
+int asCScriptEngine::GetDataTypeByDecl(const char *decl, asCDataType *dt) const
 {
-	asCDataType dt;
+	if( decl == 0 )
+		return asINVALID_ARG;
+
+	if( declCache.GetDataType(this, defaultNamespace, decl, dt) )
+		return asSUCCESS;
+
+	// Read the version before parsing so the result isn't stored 
+	// if the configuration is changed while the declaration is parsed
+	asDWORD version = declCacheVersion.get();
+
 	// This cast is ok, because we are not changing anything in the engine
 	asCBuilder bld(const_cast<asCScriptEngine*>(this), 0);
 
 	// Don't write parser errors to the message callback
 	bld.silent = true;
 
-	int r = bld.ParseDataType(decl, &dt, defaultNamespace);
+	int r = bld.ParseDataType(decl, dt, defaultNamespace);
+	if( r < 0 )
+		return r;
+
+	declCache.PutDataType(this, version, defaultNamespace, decl, *dt);
+
+	return asSUCCESS;
+}
+
+// interface
+asITypeInfo *asCScriptEngine::GetTypeInfoByDecl(const char *decl) const
+{
+	asCDataType dt;
+	int r = GetDataTypeByDecl(decl, &dt);
 	if (r < 0)
 		return 0;
 
@@ -5257,13 +5509,7 @@ asITypeInfo *asCScriptEngine::GetTypeInfoByDecl(const char *decl) const
 int asCScriptEngine::GetTypeIdByDecl(const char *decl) const
 {
 	asCDataType dt;
-	// This cast is ok, because we are not changing anything in the engine
-	asCBuilder bld(const_cast<asCScriptEngine*>(this), 0);
-
-	// Don't write parser errors to the message callback
-	bld.silent = true;
-
-	int r = bld.ParseDataType(decl, &dt, defaultNamespace);
+	int r = GetDataTypeByDecl(decl, &dt);
 	if( r < 0 )
 		return asINVALID_TYPE;
 
@@ -5867,6 +6113,8 @@ int asCScriptEngine::EndConfigGroup()
 // interface
 int asCScriptEngine::RemoveConfigGroup(const char *groupName)
 {
+	InvalidateDeclCache();
+
 	// It is not allowed to remove a group that is still in use.
 
 	// It would be possible to change the code in such a way that
@@ -5989,6 +6237,9 @@ int asCScriptEngine::GetNextScriptFunctionId()
 
 void asCScriptEngine::AddScriptFunction(asCScriptFunction *func)
 {
+	// The functions compiled in parallel must not change the engine
+	asASSERT( asCBuilder::GetCompileTask() == 0 );
+
 	// Update the internal arrays with the function id that is now used
 	if( freeScriptFunctionIds.GetLength() && freeScriptFunctionIds[freeScriptFunctionIds.GetLength()-1] == func->id )
 		freeScriptFunctionIds.PopLast();
@@ -6003,9 +6254,19 @@ void asCScriptEngine::AddScriptFunction(asCScriptFunction *func)
 	}
 }
 
+void asCScriptEngine::InvalidateDeclCache()
+{
+	declCacheVersion.atomicInc();
+}
+
 void asCScriptEngine::RemoveScriptFunction(asCScriptFunction *func)
 {
 	if( func == 0 || func->id < 0 ) return;
+
+	// Delegates are created and destroyed at runtime and are never returned by a declaration lookup
+	if( func->funcType != asFUNC_DELEGATE )
+		InvalidateDeclCache();
+
 	int id = func->id & ~FUNC_IMPORTED;
 	if( func->funcType == asFUNC_IMPORTED )
 	{
@@ -6043,30 +6304,47 @@ void asCScriptEngine::RemoveScriptFunction(asCScriptFunction *func)
 				freeScriptFunctionIds.PushLast(id);
 			}
 
-			// Is the function used as signature id?
-			if( func->signatureId == id )
-			{
-				// Remove the signature id
-				signatureIds.RemoveValue(func);
+			if( func->signatureId )
+				RemoveSignatureId(func);
+		}
+	}
+}
 
-				// Update all functions using the signature id
-				int newSigId = 0;
-				for( asUINT n = 0; n < scriptFunctions.GetLength(); n++ )
-				{
-					if( scriptFunctions[n] && scriptFunctions[n]->signatureId == id )
-					{
-						if( newSigId == 0 )
-						{
-							newSigId = scriptFunctions[n]->id;
-							signatureIds.PushLast(scriptFunctions[n]);
-						}
+// internal
+void asCScriptEngine::RemoveSignatureId(asCScriptFunction *func)
+{
+	// The signature may already have been cleared when the function is
+	// destroyed, so the bucket is found with the hash stored in the function
+	asSMapNode<asUINT, asCArray<asCScriptFunction*> > *cursor = 0;
+	if( !signatureIds.MoveTo(&cursor, func->signatureHash) )
+		return;
 
-						scriptFunctions[n]->signatureId = newSigId;
-					}
-				}
+	asCArray<asCScriptFunction*> &bucket = signatureIds.GetValue(cursor);
+	int idx = bucket.IndexOf(func);
+	if( idx < 0 )
+		return;
+	bucket.RemoveIndex(idx);
+
+	// Is the function used as signature id?
+	if( func->signatureId == func->id )
+	{
+		// Update all functions using the signature id. They all
+		// have the same signature, so they are in the same bucket
+		int newSigId = 0;
+		for( asUINT n = 0; n < bucket.GetLength(); n++ )
+		{
+			if( bucket[n]->signatureId == func->id )
+			{
+				if( newSigId == 0 )
+					newSigId = bucket[n]->id;
+
+				bucket[n]->signatureId = newSigId;
 			}
 		}
 	}
+
+	if( bucket.GetLength() == 0 )
+		signatureIds.Erase(cursor);
 }
 
 // internal
@@ -6078,6 +6356,8 @@ void asCScriptEngine::RemoveFuncdef(asCFuncdefType *funcdef)
 // interface
 int asCScriptEngine::RegisterFuncdef(const char *decl)
 {
+	InvalidateDeclCache();
+
 	if( decl == 0 ) return ConfigError(asINVALID_ARG, "RegisterFuncdef", decl, 0);
 
 	// Parse the function declaration
@@ -6169,6 +6449,11 @@ asCFuncdefType *asCScriptEngine::FindMatchingFuncdef(asCScriptFunction *func, as
 		}
 	}
 
+#ifndef AS_NO_COMPILER
+	if( funcDef == 0 && !asCBuilder::CanModifySharedState() )
+		return 0;
+#endif
+
 	if (funcDef == 0)
 	{
 		// Create a matching funcdef
@@ -6182,6 +6467,7 @@ asCFuncdefType *asCScriptEngine::FindMatchingFuncdef(asCScriptFunction *func, as
 		fd->inOutFlags = func->inOutFlags;
 
 		funcDef = asNEW(asCFuncdefType)(this, fd);
+		asASSERT( asCBuilder::GetCompileTask() == 0 );
 		funcDefs.PushLast(funcDef); // doesn't increase the refCount
 
 		fd->id = GetNextScriptFunctionId();
@@ -6206,6 +6492,10 @@ asCFuncdefType *asCScriptEngine::FindMatchingFuncdef(asCScriptFunction *func, as
 		// be stored as part of the module for saving/loading bytecode
 		if (!module->m_funcDefs.Exists(funcDef))
 		{
+#ifndef AS_NO_COMPILER
+			if( !asCBuilder::CanModifySharedState() )
+				return funcDef;
+#endif
 			module->AddFuncDef(funcDef);
 			funcDef->AddRefInternal();
 		}
@@ -6222,6 +6512,8 @@ asCFuncdefType *asCScriptEngine::FindMatchingFuncdef(asCScriptFunction *func, as
 // TODO: typedef: Accept complex types for the typedefs
 int asCScriptEngine::RegisterTypedef(const char *type, const char *decl)
 {
+	InvalidateDeclCache();
+
 	if( type == 0 ) return ConfigError(asINVALID_NAME, "RegisterTypedef", type, decl);
 
 	// Verify if the name has been registered as a type already
@@ -6312,6 +6604,8 @@ asITypeInfo *asCScriptEngine::GetTypedefByIndex(asUINT index) const
 // interface
 int asCScriptEngine::RegisterEnum(const char *typeName, const char *underlyingType)
 {
+	InvalidateDeclCache();
+
 	//	Check the name
 	if( NULL == typeName )
 		return ConfigError(asINVALID_NAME, "RegisterEnum", typeName, 0);
@@ -6388,6 +6682,8 @@ int asCScriptEngine::RegisterEnum(const char *typeName, const char *underlyingTy
 // interface
 int asCScriptEngine::RegisterEnumValue(const char *typeName, const char *valueName, asINT64 value)
 {
+	InvalidateDeclCache();
+
 	// Verify that the correct config group is used
 	if( currentGroup->FindType(typeName) == 0 )
 		return ConfigError(asWRONG_CONFIG_GROUP, "RegisterEnumValue", typeName, valueName);
@@ -6512,20 +6808,35 @@ asITypeInfo *asCScriptEngine::GetTypeInfoByName(const char *in_name) const
 
 // internal
 int asCScriptEngine::DetermineNameAndNamespace(const char *in_name, asSNameSpace *implicitNs, asCString &out_name, asSNameSpace *&out_ns) const
+{
+	const char *name = 0;
+	int r = DetermineNameAndNamespace(in_name, implicitNs, name, out_ns);
+	if( r >= 0 )
+		out_name = name;
+
+	return r;
+}
+
+// internal
+// The returned name points into in_name, so symbols can be looked up without copying the name
+int asCScriptEngine::DetermineNameAndNamespace(const char *in_name, asSNameSpace *implicitNs, const char *&out_name, asSNameSpace *&out_ns) const
 {
 	if( in_name == 0 )
 		return asINVALID_ARG;
 	
-	asCString name = in_name;
-	asCString scope;
+	// The name is what follows the last '::'
+	const char *name = in_name;
+	for( const char *p = in_name; *p; p++ )
+		if( p[0] == ':' && p[1] == ':' )
+			name = p + 2;
+
 	asSNameSpace *ns = implicitNs;
 	
 	// Check if the given name contains a scope
-	int pos = name.FindLast("::");
-	if( pos >= 0 )
+	if( name != in_name )
 	{
-		scope = name.SubString(0, pos);
-		name = name.SubString(pos+2);
+		size_t pos = size_t(name - in_name) - 2;
+		asCString scope(in_name, pos);
 		if( pos == 0 )
 		{
 			// The scope is '::' so the search must start in the global namespace
@@ -6816,10 +7127,16 @@ asCObjectType *asCScriptEngine::GetListPatternType(int listPatternFuncId)
 			return listPatternTypes[n];
 	}
 
+#ifndef AS_NO_COMPILER
+	if( !asCBuilder::CanModifySharedState() )
+		return 0;
+#endif
+
 	// Create a new list pattern type for the given object type
 	asCObjectType *lpt = asNEW(asCObjectType)(this);
 	lpt->templateSubTypes.PushLast(asCDataType::CreateType(ot, false));
 	lpt->flags = asOBJ_LIST_PATTERN;
+	asASSERT( asCBuilder::GetCompileTask() == 0 );
 	listPatternTypes.PushLast(lpt);
 
 	return lpt;
@@ -7016,5 +7333,16 @@ asSNameSpace *asCScriptEngine::GetParentNameSpace(asSNameSpace *ns) const
 	return nameSpaces[0];
 }
 
+// interface
+asIFunctionSignature *asCScriptEngine::CreateFunctionSignature(const char *decl)
+{
+	if( decl == 0 )
+		return 0;
+
+	// The declaration is parsed when it is first matched, as it 
+	// may refer to script types that are not yet known
+	return asNEW(asCFunctionSignature)(this, decl);
+}
+
 END_AS_NAMESPACE
 
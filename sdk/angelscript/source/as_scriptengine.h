@@ -92,6 +92,7 @@ public:
 	virtual asUINT             GetGlobalFunctionCount() const;
 	virtual asIScriptFunction *GetGlobalFunctionByIndex(asUINT index) const;
 	virtual asIScriptFunction *GetGlobalFunctionByDecl(const char *declaration) const;
+	virtual asIFunctionSignature *CreateFunctionSignature(const char *declaration);
 
 	// Global properties
 	virtual int    RegisterGlobalProperty(const char *declaration, void *pointer);
@@ -181,6 +182,10 @@ public:
 	virtual asIScriptContext *RequestContext();
 	virtual void              ReturnContext(asIScriptContext *ctx);
 	virtual int               SetContextCallbacks(asREQUESTCONTEXTFUNC_t requestCtx, asRETURNCONTEXTFUNC_t returnCtx, void *param = 0);
+	virtual void              GetStackStatistics(asUINT *bytesInContexts, asUINT *bytesPooled = 0, asUINT *blocksPooled = 0) const;
+
+	// Worker pool
+	virtual int               SetWorkerPool(asWORKERPOOLFUNC_t callback, void *param = 0, asUINT numWorkers = 0);
 
 	// String interpretation
 	virtual asETokenClass ParseToken(const char *string, size_t stringLength = 0, asUINT *tokenLength = 0) const;
@@ -188,6 +193,7 @@ public:
 	// Garbage collection
 	virtual int  GarbageCollect(asDWORD flags = asGC_FULL_CYCLE, asUINT numIterations = 1);
 	virtual void GetGCStatistics(asUINT *currentSize, asUINT *totalDestroyed, asUINT *totalDetected, asUINT *newObjects, asUINT *totalNewDestroyed) const;
+	virtual int  GetGCTypeStatistics(asITypeInfo *type, asUINT *totalAdded, asUINT *totalNewDestroyed, asUINT *totalPromoted, asUINT *totalDetected) const;
 	virtual int  NotifyGarbageCollectorOfNewObject(void *obj, asITypeInfo *type);
 	virtual int  GetObjectInGC(asUINT idx, asUINT *seqNbr, void **obj = 0, asITypeInfo **type = 0);
 	virtual void GCEnumCallback(void *reference);
@@ -288,11 +294,17 @@ public:
 	asCModule *GetModuleFromFuncId(int funcId);
 
 	int  GetMethodIdByDecl(const asCObjectType *ot, const char *decl, asCModule *mod);
+	int  GetMethodIdBySignature(const asCObjectType *ot, const asCScriptFunction *sig) const;
+	int  GetDataTypeByDecl(const char *decl, asCDataType *dt) const;
 	int  GetFactoryIdByDecl(const asCObjectType *ot, const char *decl);
 
 	int  GetNextScriptFunctionId();
 	void AddScriptFunction(asCScriptFunction *func);
 	void RemoveScriptFunction(asCScriptFunction *func);
+
+	// Called whenever something changes that could alter the result of a declaration lookup
+	void InvalidateDeclCache();
+	void RemoveSignatureId(asCScriptFunction *func);
 	void RemoveFuncdef(asCFuncdefType *func);
 
 	int ConfigError(int err, const char *funcName, const char *arg1, const char *arg2);
@@ -318,6 +330,7 @@ public:
 	asCFuncdefType    *FindMatchingFuncdef(asCScriptFunction *func, asCModule *mod);
 
 	int                DetermineNameAndNamespace(const char *in_name, asSNameSpace *implicitNs, asCString &out_name, asSNameSpace *&out_ns) const;
+	int                DetermineNameAndNamespace(const char *in_name, asSNameSpace *implicitNs, const char *&out_name, asSNameSpace *&out_ns) const;
 	asCTypeInfo       *GetTemplateSubTypeByName(const asCString &name);
 	
 	// Global property management
@@ -383,7 +396,8 @@ public:
 	// Stores all functions, i.e. registered functions, script functions, class methods, behaviours, etc.
 	asCArray<asCScriptFunction *> scriptFunctions;       // doesn't increase ref count
 	asCArray<int>                 freeScriptFunctionIds;
-	asCArray<asCScriptFunction *> signatureIds;
+	// All functions with a signature id, grouped by asCScriptFunction::GetSignatureHash
+	asCMap<asUINT, asCArray<asCScriptFunction *> > signatureIds;
 
 	// An array with all module imported functions
 	asCArray<sBindInfo *>  importedFunctions; // doesn't increase ref count
@@ -399,13 +413,12 @@ public:
 	// improvement, since it is common that the same module is accessed many times in a row
 	asCModule             *lastModule;
 	// Synchronized with engineRWLock
-	// This flag is true if a script is currently being compiled. It is used to prevent multiple
-	// threads from requesting builds at the same time (without blocking)
-	bool                   isBuilding;
-	// Synchronized with engineRWLock
 	// This array holds modules that have been discard (thus are no longer visible to the application)
 	// but cannot yet be deleted due to having external references to some of the entities in them
 	asCArray<asCModule *>  discardedModules;
+	// Synchronized with engineRWLock
+	// This array holds all contexts, so a build can tell if the code it will replace is still being executed
+	asCArray<asCContext *> contexts; // doesn't increase ref count
 	// This flag is set to true during compilations of scripts (or loading pre-compiled scripts)
 	// to delay the validation of template types until the subtypes have been fully declared
 	bool                   deferValidationOfTemplateTypes;
@@ -471,6 +484,11 @@ public:
 	asRETURNCONTEXTFUNC_t   returnCtxFunc;
 	void                   *ctxCallbackParam;
 
+	// Callback for running work in parallel
+	asWORKERPOOLFUNC_t      workerPoolFunc;
+	void                   *workerPoolParam;
+	asUINT                  workerPoolSize;
+
 	// User data
 	asCArray<asPWORD>       userData;
 
@@ -489,6 +507,19 @@ public:
 
 	// Synchronization for threads
 	DECLAREREADWRITELOCK(mutable engineRWLock)
+	// Held while a module registers its declarations and compiles, as this updates
+	// the engine's shared state. Only the parsing is done before taking this lock, 
+	// so several modules can be parsed in parallel while another is compiled
+	DECLARECRITICALSECTION(buildCs)
+	// Protects the declaration caches of the engine, modules, and object types
+	DECLARECRITICALSECTION(mutable declCacheCs)
+
+	// Synchronized
+	// Incremented when a cached declaration lookup may no longer be valid
+	asCAtomic              declCacheVersion;
+	// Synchronized with declCacheCs
+	// Results of GetTypeIdByDecl and GetTypeInfoByDecl
+	mutable asCDeclCache   declCache;
 
 	// Engine properties
 	struct
@@ -535,6 +566,13 @@ public:
 		asUINT memberInitMode;
 		asUINT boolConversionMode;
 		bool   foreachSupport;
+		asUINT stackHighWaterMark;
+		asUINT gcPromotionSweeps;
+		asUINT gcParallelMinObjects;
+		asUINT compileParallelMinFunctions;
+		asUINT optimizeByteCodeLevel;
+		asUINT maxInlineFunctionSize;
+		bool   incrementalBuild;
 	} ep;
 
 	// Callbacks
@@ -365,6 +365,7 @@ asCScriptFunction::asCScriptFunction(asCScriptEngine *engine, asCModule *mod, as
 	name                   = "";
 	sysFuncIntf            = 0;
 	signatureId            = 0;
+	signatureHash          = 0;
 	dontCleanUpOnException = false;
 	vfTableIdx             = -1;
 	gcFlag                 = false;
@@ -1081,19 +1082,60 @@ void asCScriptFunction::ComputeSignatureId()
 	// function name, return type, and parameter types. The object
 	// type for methods is not used, so that class methods and
 	// interface methods match each other.
-	for( asUINT n = 0; n < engine->signatureIds.GetLength(); n++ )
+	//
+	// Only the functions with the same signature hash need to be compared
+	if( signatureId )
+		engine->RemoveSignatureId(this);
+
+	signatureHash = GetSignatureHash();
+	asSMapNode<asUINT, asCArray<asCScriptFunction*> > *cursor = 0;
+	if( !engine->signatureIds.MoveTo(&cursor, signatureHash) )
 	{
-		if( !IsSignatureEqual(engine->signatureIds[n]) ) continue;
+		engine->signatureIds.Insert(signatureHash, asCArray<asCScriptFunction*>());
+		engine->signatureIds.MoveTo(&cursor, signatureHash);
+	}
+	asCArray<asCScriptFunction*> &bucket = engine->signatureIds.GetValue(cursor);
+
+	signatureId = id;
+	for( asUINT n = 0; n < bucket.GetLength(); n++ )
+	{
+		if( !IsSignatureEqual(bucket[n]) ) continue;
 
 		// We don't need to increment the reference counter here, because
-		// asCScriptEngine::FreeScriptFunctionId will maintain the signature
+		// asCScriptEngine::RemoveSignatureId will maintain the signature
 		// id as the function is freed.
-		signatureId = engine->signatureIds[n]->signatureId;
-		return;
+		signatureId = bucket[n]->signatureId;
+		break;
 	}
 
-	signatureId = id;
-	engine->signatureIds.PushLast(this);
+	// All functions with a signature id are kept in the bucket so the
+	// id can be handed over without searching all functions when the
+	// function that gave its id to the signature is freed
+	bucket.PushLast(this);
+}
+
+// internal
+asUINT asCScriptFunction::GetSignatureHash() const
+{
+	// The hash must only be based on properties that are compared
+	// by IsSignatureEqual, so that equal signatures give equal hashes
+	asUINT hash = 2166136261u;
+	for( asUINT n = 0; n < name.GetLength(); n++ )
+		hash = (hash ^ asBYTE(name[n])) * 16777619u;
+
+	hash = (hash ^ (IsReadOnly() ? 1 : 0) ^ (objectType ? 2 : 0)) * 16777619u;
+
+	for( asUINT n = 0; n <= parameterTypes.GetLength(); n++ )
+	{
+		const asCDataType &dt = n < parameterTypes.GetLength() ? parameterTypes[n] : returnType;
+		hash = (hash ^ asUINT(dt.GetTokenType())) * 16777619u;
+		hash = (hash ^ asUINT(asPWORD(dt.GetTypeInfo()) >> 3)) * 16777619u;
+		hash = (hash ^ (dt.IsReference() ? 1 : 0) ^ (dt.IsObjectHandle() ? 2 : 0)) * 16777619u;
+		if( n < inOutFlags.GetLength() )
+			hash = (hash ^ asUINT(inOutFlags[n])) * 16777619u;
+	}
+
+	return hash;
 }
 
 // internal
@@ -2021,5 +2063,157 @@ asITypeInfo* asCScriptFunction::GetSubType(asUINT subtypeIndex) const
 	return templateSubTypes[subtypeIndex].GetTypeInfo();
 }
 
+//==================================================================================
+
+asCFunctionSignature::asCFunctionSignature(asCScriptEngine *in_engine, const char *decl)
+{
+	refCount.set(1);
+	engine        = in_engine;
+	declaration   = decl;
+	parsed        = 0;
+	parsedModule  = 0;
+	parsedVersion = 0;
+	isGlobal      = false;
+	isValid       = false;
+
+	engine->AddRef();
+}
+
+asCFunctionSignature::~asCFunctionSignature()
+{
+	// The parsed function is a dummy, so it is not deleted by ReleaseInternal
+	if( parsed )
+		asDELETE(parsed, asCScriptFunction);
+	parsed = 0;
+
+	engine->Release();
+}
+
+// interface
+asIScriptEngine *asCFunctionSignature::GetEngine() const
+{
+	return engine;
+}
+
+// interface
+int asCFunctionSignature::AddRef() const
+{
+	return refCount.atomicInc();
+}
+
+// interface
+int asCFunctionSignature::Release() const
+{
+	int r = refCount.atomicDec();
+
+	if( r == 0 )
+	{
+		asDELETE(const_cast<asCFunctionSignature*>(this),asCFunctionSignature);
+		return 0;
+	}
+
+	return r;
+}
+
+// interface
+const char *asCFunctionSignature::GetDeclaration() const
+{
+	return declaration.AddressOf();
+}
+
+// internal
+// Must be called with the lock held. Returns null if the declaration isn't valid for the module
+const asCScriptFunction *asCFunctionSignature::Parse(asCModule *mod)
+{
+	asDWORD version = engine->declCacheVersion.get();
+	if( parsed == 0 || parsedVersion != version )
+	{
+		// If the declaration only refers to registered types it can be 
+		// parsed without a module, and then be used with any module
+		isGlobal      = ParseInto(0);
+		isValid       = isGlobal;
+		parsedModule  = 0;
+		parsedVersion = version;
+	}
+
+	if( isGlobal )
+		return parsed;
+
+	if( mod == 0 )
+		return 0;
+
+	// The declaration refers to script types, so it must be parsed for each module
+	if( parsedModule != mod )
+	{
+		isValid      = ParseInto(mod);
+		parsedModule = mod;
+	}
+
+	return isValid ? parsed : 0;
+}
+
+// internal
+bool asCFunctionSignature::ParseInto(asCModule *mod)
+{
+	if( parsed )
+		asDELETE(parsed, asCScriptFunction);
+
+	parsed = asNEW(asCScriptFunction)(engine, mod, asFUNC_DUMMY);
+	if( parsed == 0 )
+		return false;
+
+	asCBuilder bld(engine, mod);
+
+	// Don't write parser errors to the message callback
+	bld.silent = true;
+
+	// The script object type is given so the declaration may be for a read-only method.
+	// The types are resolved from the global namespace, as the signature is not tied to any
+	// module or type and so has no default namespace
+	int r = bld.ParseFunctionDeclaration(&engine->scriptTypeBehaviours, declaration.AddressOf(), parsed, false, 0, 0, engine->nameSpaces[0]);
+	return r >= 0;
+}
+
+// internal
+asCScriptFunction *asCFunctionSignature::FindFunction(asCModule *mod)
+{
+	asCScriptFunction *func = 0;
+
+	ENTERCRITICALSECTION(lock);
+	const asCScriptFunction *sig = Parse(mod);
+
+	// Global functions cannot be read-only
+	if( sig && !sig->IsReadOnly() )
+		func = mod->FindGlobalFunction(sig);
+	LEAVECRITICALSECTION(lock);
+
+	return func;
+}
+
+// internal
+asCScriptFunction *asCFunctionSignature::FindMethod(const asCObjectType *ot, bool getVirtual)
+{
+	// Script types in the declaration are resolved from the 
+	// module of the methods, the same way as GetMethodByDecl does
+	asCModule *mod = engine->scriptFunctions[ot->methods[0]]->module;
+
+	int id = asNO_FUNCTION;
+
+	ENTERCRITICALSECTION(lock);
+	const asCScriptFunction *sig = Parse(mod);
+	if( sig )
+		id = engine->GetMethodIdBySignature(ot, sig);
+	LEAVECRITICALSECTION(lock);
+
+	if( id <= 0 )
+		return 0;
+
+	asCScriptFunction *func = engine->scriptFunctions[id];
+	if( !getVirtual && func->funcType == asFUNC_VIRTUAL )
+		return ot->virtualFunctionTable[func->vfTableIdx];
+
+	return func;
+}
+
 END_AS_NAMESPACE
 
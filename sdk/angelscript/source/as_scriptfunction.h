@@ -45,6 +45,7 @@
 #include "as_array.h"
 #include "as_datatype.h"
 #include "as_atomic.h"
+#include "as_criticalsection.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -266,6 +267,7 @@ public:
 	asCString GetDeclarationStr(bool includeObjectName = true, bool includeNamespace = false, bool includeParamNames = false) const;
 	int       GetLineNumber(int programPosition, int *sectionIdx);
 	void      ComputeSignatureId();
+	asUINT    GetSignatureHash() const;
 	bool      IsSignatureEqual(const asCScriptFunction *func) const;
 	bool      IsSignatureExceptNameEqual(const asCScriptFunction *func) const;
 	bool      IsSignatureExceptNameEqual(const asCDataType &retType, const asCArray<asCDataType> &paramTypes, const asCArray<asETypeModifiers> &inOutFlags, const asCObjectType *type, bool isReadOnly) const;
@@ -328,6 +330,7 @@ public:
 	asSFunctionTraits            traits;
 	asCObjectType               *objectType;
 	int                          signatureId;
+	asUINT                       signatureHash; // The hash of the signature when the signatureId was computed
 
 	int                          id;
 
@@ -394,6 +397,41 @@ public:
 	asSSystemFunctionInterface  *sysFuncIntf;
 };
 
+// A declaration that is parsed once and then matched against the functions of many modules and types
+class asCFunctionSignature : public asIFunctionSignature
+{
+public:
+	asCFunctionSignature(asCScriptEngine *engine, const char *decl);
+
+	asIScriptEngine *GetEngine() const;
+	int              AddRef() const;
+	int              Release() const;
+	const char      *GetDeclaration() const;
+
+	asCScriptFunction *FindFunction(asCModule *mod);
+	asCScriptFunction *FindMethod(const asCObjectType *ot, bool getVirtual);
+
+protected:
+	virtual ~asCFunctionSignature();
+
+	const asCScriptFunction *Parse(asCModule *mod);
+	bool                     ParseInto(asCModule *mod);
+
+	asCScriptEngine   *engine;
+	asCString          declaration;
+	mutable asCAtomic  refCount;
+
+	DECLARECRITICALSECTION(lock)
+
+	// The declaration is only parsed again when the engine configuration has changed or if
+	// it refers to script types and is matched against a different module. Synchronized with lock
+	asCScriptFunction *parsed;
+	asCModule         *parsedModule;
+	asDWORD            parsedVersion;
+	bool               isGlobal;
+	bool               isValid;
+};
+
 const char * const DELEGATE_FACTORY = "$dlgte";
 asCScriptFunction *CreateDelegate(asCScriptFunction *func, void *obj);
 
@@ -98,9 +98,21 @@ private:
 
 
 
+// Slot in the lookup table of the symbol table. All symbols with
+// the same namespace and name share the slot, and the hash of the
+// name is computed only once when the slot is created
+struct asSSymbolTableSlot
+{
+	const asSNameSpace *ns;
+	asCString           name;
+	asUINT              hash;
+	asCArray<asUINT>    indexes;
+};
+
 // Symbol table mapping namespace + name to symbols
 // The structure keeps the entries indexed in an array so the indices will not change
-// There is also a map for a quick lookup. The map supports multiple entries with the same name
+// There is also a hash table for a quick lookup. The hash table supports multiple entries with the same name
+// A second hash table maps the entries back to their index
 template<class T>
 class asCSymbolTable
 {
@@ -109,9 +121,12 @@ public:
 	typedef asCSymbolTableIterator<T, const T> const_iterator;
 
 	asCSymbolTable(asUINT initialCapacity = 0);
+	~asCSymbolTable();
 
 	int      GetFirstIndex(const asSNameSpace *ns, const asCString &name, const asIFilter &comparator) const;
+	int      GetFirstIndex(const asSNameSpace *ns, const char *name, size_t length, const asIFilter &comparator) const;
 	int      GetFirstIndex(const asSNameSpace *ns, const asCString &name) const;
+	int      GetFirstIndex(const asSNameSpace *ns, const char *name, size_t length) const;
 	int      GetLastIndex() const;
 
 	int      GetIndex(const T*) const;
@@ -125,6 +140,7 @@ public:
 	const T* GetLast() const;
 
 	const asCArray<asUINT> &GetIndexes(const asSNameSpace *ns, const asCString &name) const;
+	const asCArray<asUINT> &GetIndexes(const asSNameSpace *ns, const char *name, size_t length) const;
 
 	asUINT   Put(T* entry);
 
@@ -140,18 +156,34 @@ public:
 	const_iterator List() const;
 
 private:
-	// Don't allow assignment
+	// Don't allow copy or assignment
+	asCSymbolTable(const asCSymbolTable<T> &) {}
 	asCSymbolTable<T>& operator=(const asCSymbolTable<T> &other) { return *this; }
 
 	friend class asCSymbolTableIterator<T, T>;
 	friend class asCSymbolTableIterator<T, const T>;
 
-	void GetKey(const T *entry, asSNameSpaceNamePair &key) const;
+	void GetKey(const T *entry, const asSNameSpace *&ns, const asCString *&name) const;
 	bool CheckIdx(asUINT idx) const;
 
-	asCMap<asSNameSpaceNamePair, asCArray<asUINT> > m_map;
-	asCArray<T*>                                    m_entries;
-	unsigned int                                    m_size;
+	static asUINT HashName(const asSNameSpace *ns, const char *name, size_t length);
+	static asUINT HashEntry(const T *entry);
+	int  FindSlot(const asSNameSpace *ns, const char *name, size_t length, asUINT hash) const;
+	void InsertSlot(asSSymbolTableSlot *slot);
+	void RemoveSlot(asUINT pos);
+	int  FindEntrySlot(const T *entry) const;
+	void InsertEntrySlot(asUINT idx);
+	void RemoveEntrySlot(asUINT pos);
+	void Rehash(asUINT slotCapacity, asUINT entrySlotCapacity);
+	void ClearLookup();
+
+	// Both hash tables use open addressing with linear probing, and are
+	// kept at most half full. The capacity is always a power of 2
+	asCArray<asSSymbolTableSlot*> m_slots;
+	asUINT                        m_slotCount;
+	asCArray<asUINT>              m_entrySlots; // index + 1 of the entry, or 0 for a free slot
+	asCArray<T*>                  m_entries;
+	unsigned int                  m_size;
 };
 
 
@@ -160,12 +192,17 @@ private:
 template<class T>
 void asCSymbolTable<T>::SwapWith(asCSymbolTable<T> &other)
 {
-	m_map.SwapWith(other.m_map);
+	m_slots.SwapWith(other.m_slots);
+	m_entrySlots.SwapWith(other.m_entrySlots);
 	m_entries.SwapWith(other.m_entries);
 
 	asUINT tmp = m_size;
 	m_size = other.m_size;
 	other.m_size = tmp;
+
+	tmp = m_slotCount;
+	m_slotCount = other.m_slotCount;
+	other.m_slotCount = tmp;
 }
 
 
@@ -176,29 +213,47 @@ void asCSymbolTable<T>::SwapWith(asCSymbolTable<T> &other)
 template<class T>
 asCSymbolTable<T>::asCSymbolTable(asUINT initialCapacity) : m_entries(initialCapacity)
 {
+	m_slotCount = 0;
 	m_size = 0;
 }
 
 
 
+
+template<class T>
+asCSymbolTable<T>::~asCSymbolTable()
+{
+	ClearLookup();
+}
+
+
+
+
 template<class T>
 int asCSymbolTable<T>::GetFirstIndex(
         const asSNameSpace *ns,
         const asCString &name,
         const asIFilter &filter) const
 {
-	asSNameSpaceNamePair key(ns, name);
+	return GetFirstIndex(ns, name.AddressOf(), name.GetLength(), filter);
+}
+
+
+
 
-	asSMapNode<asSNameSpaceNamePair, asCArray<asUINT> > *cursor;
-	if( m_map.MoveTo(&cursor, key) )
+template<class T>
+int asCSymbolTable<T>::GetFirstIndex(
+        const asSNameSpace *ns,
+        const char *name,
+        size_t length,
+        const asIFilter &filter) const
+{
+	const asCArray<asUINT> &arr = GetIndexes(ns, name, length);
+	for( asUINT n = 0; n < arr.GetLength(); n++ )
 	{
-		const asCArray<asUINT> &arr = m_map.GetValue(cursor);
-		for( asUINT n = 0; n < arr.GetLength(); n++ )
-		{
-			T *entry = m_entries[arr[n]];
-			if( entry && filter(entry) )
-				return arr[n];
-		}
+		T *entry = m_entries[arr[n]];
+		if( entry && filter(entry) )
+			return arr[n];
 	}
 
 	return -1;
@@ -206,14 +261,22 @@ int asCSymbolTable<T>::GetFirstIndex(
 
 
 
+
 template<class T>
 const asCArray<asUINT> &asCSymbolTable<T>::GetIndexes(const asSNameSpace *ns, const asCString &name) const
 {
-	asSNameSpaceNamePair key(ns, name);
+	return GetIndexes(ns, name.AddressOf(), name.GetLength());
+}
 
-	asSMapNode<asSNameSpaceNamePair, asCArray<asUINT> > *cursor;
-	if( m_map.MoveTo(&cursor, key) )
-		return m_map.GetValue(cursor);
+
+
+
+template<class T>
+const asCArray<asUINT> &asCSymbolTable<T>::GetIndexes(const asSNameSpace *ns, const char *name, size_t length) const
+{
+	int pos = FindSlot(ns, name, length, HashName(ns, name, length));
+	if( pos >= 0 )
+		return m_slots[pos]->indexes;
 
 	static asCArray<asUINT> dummy;
 	return dummy;
@@ -236,11 +299,18 @@ T* asCSymbolTable<T>::GetFirst(const asSNameSpace *ns, const asCString &name, co
 template<class T>
 int asCSymbolTable<T>::GetFirstIndex(const asSNameSpace *ns, const asCString &name) const
 {
-	asSNameSpaceNamePair key(ns, name);
+	return GetFirstIndex(ns, name.AddressOf(), name.GetLength());
+}
+
+
 
-	asSMapNode<asSNameSpaceNamePair, asCArray<asUINT> > *cursor;
-	if( m_map.MoveTo(&cursor, key) )
-		return m_map.GetValue(cursor)[0];
+
+template<class T>
+int asCSymbolTable<T>::GetFirstIndex(const asSNameSpace *ns, const char *name, size_t length) const
+{
+	int pos = FindSlot(ns, name, length, HashName(ns, name, length));
+	if( pos >= 0 )
+		return m_slots[pos]->indexes[0];
 
 	return -1;
 }
@@ -249,13 +319,12 @@ int asCSymbolTable<T>::GetFirstIndex(const asSNameSpace *ns, const asCString &na
 
 
 // Find the index of a certain symbol
-// ATTENTION: this function has linear runtime complexity O(n)!!
 template<class T>
 int asCSymbolTable<T>::GetIndex(const T* entry) const
 {
-	for( asUINT n = 0; n < m_entries.GetLength(); n++ )
-		if( m_entries[n] == entry )
-			return n;
+	int pos = FindEntrySlot(entry);
+	if( pos >= 0 )
+		return int(m_entrySlots[pos]) - 1;
 
 	return -1;
 }
@@ -263,8 +332,6 @@ int asCSymbolTable<T>::GetIndex(const T* entry) const
 
 
 
-
-
 template<class T>
 T* asCSymbolTable<T>::Get(asUINT idx)
 {
@@ -274,6 +341,9 @@ T* asCSymbolTable<T>::Get(asUINT idx)
 	return m_entries[idx];
 }
 
+
+
+
 template<class T>
 const T* asCSymbolTable<T>::Get(asUINT idx) const
 {
@@ -283,7 +353,6 @@ const T* asCSymbolTable<T>::Get(asUINT idx) const
 
 
 
-
 template<class T>
 T* asCSymbolTable<T>::GetFirst(const asSNameSpace *ns, const asCString &name)
 {
@@ -291,6 +360,9 @@ T* asCSymbolTable<T>::GetFirst(const asSNameSpace *ns, const asCString &name)
 	return Get(idx);
 }
 
+
+
+
 template<class T>
 const T* asCSymbolTable<T>::GetFirst(const asSNameSpace *ns, const asCString &name) const
 {
@@ -300,13 +372,15 @@ const T* asCSymbolTable<T>::GetFirst(const asSNameSpace *ns, const asCString &na
 
 
 
-
 template<class T>
 T* asCSymbolTable<T>::GetLast()
 {
 	return Get(GetLastIndex());
 }
 
+
+
+
 template<class T>
 const T* asCSymbolTable<T>::GetLast() const
 {
@@ -316,14 +390,13 @@ const T* asCSymbolTable<T>::GetLast() const
 
 
 
-
 // Clear the symbol table
 // ATTENTION: The contained symbols are not rleased. This is up to the client
 template<class T>
 void asCSymbolTable<T>::Clear()
 {
 	m_entries.SetLength(0);
-	m_map.EraseAll();
+	ClearLookup();
 	m_size = 0;
 }
 
@@ -337,11 +410,12 @@ void asCSymbolTable<T>::Allocate(asUINT elemCnt, bool keepData)
 	asASSERT( elemCnt >= m_entries.GetLength() );
 	m_entries.Allocate(elemCnt, keepData);
 	if( !keepData )
-		m_map.EraseAll();
+		ClearLookup();
 }
 
 
 
+
 template<class T>
 bool asCSymbolTable<T>::Erase(asUINT idx)
 {
@@ -356,21 +430,31 @@ bool asCSymbolTable<T>::Erase(asUINT idx)
 	if( !entry )
 		return false;
 
-	// Remove the symbol from the lookup map
-	asSNameSpaceNamePair key;
-	GetKey(entry, key);
-
-	asSMapNode<asSNameSpaceNamePair, asCArray<asUINT> > *cursor;
-	if( m_map.MoveTo(&cursor, key) )
+	// Remove the symbol from the lookup table
+	const asSNameSpace *ns;
+	const asCString *name;
+	GetKey(entry, ns, name);
+	int pos = FindSlot(ns, name->AddressOf(), name->GetLength(), HashName(ns, name->AddressOf(), name->GetLength()));
+	if( pos >= 0 )
 	{
-		asCArray<asUINT> &arr = m_map.GetValue(cursor);
+		asCArray<asUINT> &arr = m_slots[pos]->indexes;
 		arr.RemoveValue(idx);
 		if( arr.GetLength() == 0 )
-			m_map.Erase(cursor);
+		{
+			asDELETE(m_slots[pos], asSSymbolTableSlot);
+			RemoveSlot(pos);
+			m_slotCount--;
+		}
 	}
 	else
 		asASSERT(false);
 
+	// Remove the symbol from the reverse lookup
+	pos = FindEntrySlot(entry);
+	asASSERT( pos >= 0 );
+	if( pos >= 0 )
+		RemoveEntrySlot(pos);
+
 	// Remove the symbol from the indexed array
 	if( idx == m_entries.GetLength() - 1 )
 		m_entries.PopLast();
@@ -378,14 +462,22 @@ bool asCSymbolTable<T>::Erase(asUINT idx)
 	{
 		// Must keep the array packed
 		int prevIdx = int(m_entries.GetLength()-1);
+
+		// Update the index in the reverse lookup while the entry is still in its old position
+		pos = FindEntrySlot(m_entries[prevIdx]);
+		asASSERT( pos >= 0 );
+		if( pos >= 0 )
+			m_entrySlots[pos] = idx + 1;
+
 		m_entries[idx] = m_entries.PopLast();
-		
-		// Update the index in the lookup map
+
+		// Update the index in the lookup table
 		entry = m_entries[idx];
-		GetKey(entry, key);
-		if( m_map.MoveTo(&cursor, key) )
+		GetKey(entry, ns, name);
+		pos = FindSlot(ns, name->AddressOf(), name->GetLength(), HashName(ns, name->AddressOf(), name->GetLength()));
+		if( pos >= 0 )
 		{
-			asCArray<asUINT> &arr = m_map.GetValue(cursor);
+			asCArray<asUINT> &arr = m_slots[pos]->indexes;
 			arr[arr.IndexOf(prevIdx)] = idx;
 		}
 		else
@@ -403,21 +495,44 @@ template<class T>
 asUINT asCSymbolTable<T>::Put(T *entry)
 {
 	asUINT idx = m_entries.GetLength();
-	asSNameSpaceNamePair key;
-	GetKey(entry, key);
 
-	asSMapNode<asSNameSpaceNamePair, asCArray<asUINT> > *cursor;
-	if( m_map.MoveTo(&cursor, key) )
-		m_map.GetValue(cursor).PushLast(idx);
+	// The reverse lookup can only hold one index for each entry
+	asASSERT( GetIndex(entry) < 0 );
+
+	// Make sure both hash tables stay at most half full
+	if( (m_slotCount + 1) * 2 > m_slots.GetLength() || (idx + 1) * 2 > m_entrySlots.GetLength() )
+	{
+		asUINT slotCapacity = m_slots.GetLength() ? m_slots.GetLength() : 16;
+		while( (m_slotCount + 1) * 2 > slotCapacity )
+			slotCapacity *= 2;
+		asUINT entrySlotCapacity = m_entrySlots.GetLength() ? m_entrySlots.GetLength() : 16;
+		while( (idx + 1) * 2 > entrySlotCapacity )
+			entrySlotCapacity *= 2;
+		Rehash(slotCapacity, entrySlotCapacity);
+	}
+
+	const asSNameSpace *ns;
+	const asCString *name;
+	GetKey(entry, ns, name);
+	asUINT hash = HashName(ns, name->AddressOf(), name->GetLength());
+	int pos = FindSlot(ns, name->AddressOf(), name->GetLength(), hash);
+	if( pos >= 0 )
+		m_slots[pos]->indexes.PushLast(idx);
 	else
 	{
-		asCArray<asUINT> arr(1);
-		arr.PushLast(idx);
-		m_map.Insert(key, arr);
+		asSSymbolTableSlot *slot = asNEW(asSSymbolTableSlot);
+		slot->ns   = ns;
+		slot->name = *name;
+		slot->hash = hash;
+		slot->indexes.PushLast(idx);
+		InsertSlot(slot);
+		m_slotCount++;
 	}
 
 	m_entries.PushLast(entry);
+	InsertEntrySlot(idx);
 	m_size++;
+
 	return idx;
 }
 
@@ -426,9 +541,184 @@ asUINT asCSymbolTable<T>::Put(T *entry)
 
 // Return key for specified symbol (namespace and name are used to generate the key)
 template<class T>
-void asCSymbolTable<T>::GetKey(const T *entry, asSNameSpaceNamePair &key) const
+void asCSymbolTable<T>::GetKey(const T *entry, const asSNameSpace *&ns, const asCString *&name) const
+{
+	ns   = entry->nameSpace;
+	name = &entry->name;
+}
+
+
+
+
+template<class T>
+asUINT asCSymbolTable<T>::HashName(const asSNameSpace *ns, const char *name, size_t length)
+{
+	asUINT hash = 2166136261u;
+	for( size_t n = 0; n < length; n++ )
+		hash = (hash ^ asBYTE(name[n])) * 16777619u;
+
+	// Mix in the namespace pointer. The lowest bits are always the same due to alignment
+	hash ^= asUINT(asPWORD(ns) >> 4);
+	hash *= 2654435761u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+
+
+
+template<class T>
+asUINT asCSymbolTable<T>::HashEntry(const T *entry)
+{
+	// The lowest bits of the pointer are always the same due to alignment
+	// so they must be mixed with the higher bits to spread the entries
+	asPWORD h = (asPWORD)entry;
+	h ^= h >> 4;
+	h *= 2654435761u;
+	h ^= h >> 16;
+	return asUINT(h);
+}
+
+
+
+
+template<class T>
+int asCSymbolTable<T>::FindSlot(const asSNameSpace *ns, const char *name, size_t length, asUINT hash) const
+{
+	if( m_slots.GetLength() == 0 )
+		return -1;
+
+	asUINT mask = m_slots.GetLength() - 1;
+	for( asUINT pos = hash & mask; m_slots[pos]; pos = (pos + 1) & mask )
+	{
+		const asSSymbolTableSlot *slot = m_slots[pos];
+		if( slot->hash == hash && slot->ns == ns && slot->name.Compare(name, length) == 0 )
+			return int(pos);
+	}
+
+	return -1;
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::InsertSlot(asSSymbolTableSlot *slot)
+{
+	asUINT mask = m_slots.GetLength() - 1;
+	asUINT pos = slot->hash & mask;
+	while( m_slots[pos] )
+		pos = (pos + 1) & mask;
+	m_slots[pos] = slot;
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::RemoveSlot(asUINT pos)
 {
-	key = asSNameSpaceNamePair(entry->nameSpace, entry->name);
+	// Move the following slots back so the free slot doesn't break the probe sequence
+	// of any of them. A slot can only be moved if the free slot is not before its home
+	asUINT mask = m_slots.GetLength() - 1;
+	for( asUINT next = (pos + 1) & mask; m_slots[next]; next = (next + 1) & mask )
+	{
+		asUINT home = m_slots[next]->hash & mask;
+		if( ((next - home) & mask) >= ((next - pos) & mask) )
+		{
+			m_slots[pos] = m_slots[next];
+			pos = next;
+		}
+	}
+	m_slots[pos] = 0;
+}
+
+
+
+
+template<class T>
+int asCSymbolTable<T>::FindEntrySlot(const T *entry) const
+{
+	if( m_entrySlots.GetLength() == 0 )
+		return -1;
+
+	asUINT mask = m_entrySlots.GetLength() - 1;
+	for( asUINT pos = HashEntry(entry) & mask; m_entrySlots[pos]; pos = (pos + 1) & mask )
+	{
+		if( m_entries[m_entrySlots[pos] - 1] == entry )
+			return int(pos);
+	}
+
+	return -1;
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::InsertEntrySlot(asUINT idx)
+{
+	asUINT mask = m_entrySlots.GetLength() - 1;
+	asUINT pos = HashEntry(m_entries[idx]) & mask;
+	while( m_entrySlots[pos] )
+		pos = (pos + 1) & mask;
+	m_entrySlots[pos] = idx + 1;
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::RemoveEntrySlot(asUINT pos)
+{
+	// Same as RemoveSlot, but the home of the slot is given by the entry
+	asUINT mask = m_entrySlots.GetLength() - 1;
+	for( asUINT next = (pos + 1) & mask; m_entrySlots[next]; next = (next + 1) & mask )
+	{
+		asUINT home = HashEntry(m_entries[m_entrySlots[next] - 1]) & mask;
+		if( ((next - home) & mask) >= ((next - pos) & mask) )
+		{
+			m_entrySlots[pos] = m_entrySlots[next];
+			pos = next;
+		}
+	}
+	m_entrySlots[pos] = 0;
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::Rehash(asUINT slotCapacity, asUINT entrySlotCapacity)
+{
+	asCArray<asSSymbolTableSlot*> oldSlots;
+	oldSlots.SwapWith(m_slots);
+	m_slots.SetLength(slotCapacity);
+	for( asUINT n = 0; n < slotCapacity; n++ )
+		m_slots[n] = 0;
+	for( asUINT n = 0; n < oldSlots.GetLength(); n++ )
+		if( oldSlots[n] )
+			InsertSlot(oldSlots[n]);
+
+	m_entrySlots.SetLength(entrySlotCapacity);
+	for( asUINT n = 0; n < entrySlotCapacity; n++ )
+		m_entrySlots[n] = 0;
+	for( asUINT n = 0; n < m_entries.GetLength(); n++ )
+		InsertEntrySlot(n);
+}
+
+
+
+
+template<class T>
+void asCSymbolTable<T>::ClearLookup()
+{
+	for( asUINT n = 0; n < m_slots.GetLength(); n++ )
+		if( m_slots[n] )
+			asDELETE(m_slots[n], asSSymbolTableSlot);
+	m_slots.SetLength(0);
+	m_slotCount = 0;
+	m_entrySlots.SetLength(0);
 }
 
 
@@ -39,6 +39,16 @@
 #include "as_config.h"
 #include "as_thread.h"
 #include "as_atomic.h"
+#include "as_memory.h"
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
 
 BEGIN_AS_NAMESPACE
 
@@ -315,10 +325,27 @@ asCThreadLocalData *asCThreadManager::GetLocalData()
 
 asCThreadLocalData::asCThreadLocalData()
 {
+	gcRefsFound     = 0;
+	scriptNodeArena = 0;
+#ifndef AS_NO_COMPILER
+	byteInstructionArena = 0;
+	compileTask          = 0;
+#endif
+#ifdef AS_PROFILE
+	profilerScope      = -1;
+	profilerGeneration = 0;
+	profilerThreadId   = 0;
+#endif
 }
 
 asCThreadLocalData::~asCThreadLocalData()
 {
+	if( scriptNodeArena )
+		asDELETE(scriptNodeArena, asCObjectArena);
+#ifndef AS_NO_COMPILER
+	if( byteInstructionArena )
+		asDELETE(byteInstructionArena, asCObjectArena);
+#endif
 }
 
 //=========================================================================
@@ -464,5 +491,23 @@ void asCThreadReadWriteLock::ReleaseShared()
 
 //========================================================================
 
+asQWORD asGetTimeInMicroseconds()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return asQWORD(count.QuadPart / freq.QuadPart) * 1000000 + asQWORD(count.QuadPart % freq.QuadPart) * 1000000 / asQWORD(freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return asQWORD(ts.tv_sec) * 1000000 + asQWORD(ts.tv_nsec) / 1000;
+#else
+	return asQWORD(clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+//========================================================================
+
 END_AS_NAMESPACE
 
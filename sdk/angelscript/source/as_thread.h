@@ -49,6 +49,10 @@ BEGIN_AS_NAMESPACE
 
 class asCThreadLocalData;
 
+// Returns a monotonic time stamp in microseconds. Used by the garbage
+// collector's time budget and by the profiler
+asQWORD asGetTimeInMicroseconds();
+
 class asCThreadManager : public asIThreadManager
 {
 public:
@@ -89,6 +93,9 @@ protected:
 //======================================================================
 
 class asIScriptContext;
+class asIScriptEngine;
+class asCObjectArena;
+struct sCompileTask;
 
 class asCThreadLocalData
 {
@@ -96,6 +103,32 @@ public:
 	asCArray<asIScriptContext *> activeContexts;
 	asCString string;
 
+	// Set while the thread counts references for the garbage collector
+	asCArray<asUINT> *gcRefsFound;
+
+	// The engines whose build lock is held by the thread. There can be more than
+	// one if a build on another engine is started from within a build
+	asCArray<asIScriptEngine *> buildingEngines;
+
+	// The parser allocates the script nodes from this arena
+	asCObjectArena *scriptNodeArena;
+
+#ifndef AS_NO_COMPILER
+	// The compiler allocates the byte instructions from this arena
+	asCObjectArena *byteInstructionArena;
+
+	// Set while the thread compiles a function in parallel with other threads
+	sCompileTask *compileTask;
+#endif
+
+#ifdef AS_PROFILE
+	// The scope the profiler is timing in this thread, the profiler's generation when
+	// the scope was entered, and the thread's id in the trace
+	int    profilerScope;
+	asUINT profilerGeneration;
+	asUINT profilerThreadId;
+#endif
+
 protected:
 	friend class asCThreadManager;
 
@@ -102,6 +102,7 @@ public:
 	asIScriptFunction *GetMethodByIndex(asUINT index, bool getVirtual) const { UNUSED_VAR(index); UNUSED_VAR(getVirtual); return 0; }
 	asIScriptFunction *GetMethodByName(const char *in_name, bool getVirtual) const { UNUSED_VAR(in_name); UNUSED_VAR(getVirtual); return 0; }
 	asIScriptFunction *GetMethodByDecl(const char *decl, bool getVirtual) const { UNUSED_VAR(decl); UNUSED_VAR(getVirtual); return 0; }
+	asIScriptFunction *GetMethodBySignature(const asIFunctionSignature *sig, bool getVirtual) const { UNUSED_VAR(sig); UNUSED_VAR(getVirtual); return 0; }
 
 	// Properties
 	asUINT      GetPropertyCount() const { return 0; }
@@ -81,6 +81,7 @@ class asIJITCompilerAbstract;
 class asIThreadManager;
 class asILockableSharedBool;
 class asIStringFactory;
+class asIFunctionSignature;
 
 //! \typedef asINT8
 //! \brief 8 bit signed integer
@@ -299,6 +300,20 @@ enum asEEngineProp
 	asEP_BOOL_CONVERSION_MODE               = 39,
 	//! \todo document this
 	asEP_FOREACH_SUPPORT                    = 40,
+	//! Contexts that hold more stack memory than this number of bytes after an execution return the unused blocks to the engine. Default: 0 (never)
+	asEP_STACK_HIGH_WATER_MARK              = 41,
+	//! The number of sweeps a new object must survive in the garbage collector before it is moved to the old generation. Default: 3
+	asEP_GC_PROMOTION_SWEEPS                = 42,
+	//! The minimum number of objects in the cycle for the garbage collector to count the references with the \ref asIScriptEngine::SetWorkerPool "worker pool". Default: 0 (never)
+	asEP_GC_PARALLEL_MIN_OBJECTS            = 43,
+	//! The minimum number of functions in the module for the builder to compile the function bodies with the \ref asIScriptEngine::SetWorkerPool "worker pool". Default: 0 (never)
+	asEP_COMPILE_PARALLEL_MIN_FUNCTIONS     = 44,
+	//! Select 2 to also run the data flow optimizations, i.e. constant and copy propagation, dead store elimination, and removal of unreachable blocks. Only used when \ref asEP_OPTIMIZE_BYTECODE is true. Default: 1
+	asEP_OPTIMIZE_BYTECODE_LEVEL            = 45,
+	//! The largest size in dwords of the bytecode of a script function for the calls to it to be replaced with a copy of the bytecode. Only used when \ref asEP_OPTIMIZE_BYTECODE is true. Default: 0 (never)
+	asEP_MAX_INLINE_FUNCTION_SIZE           = 46,
+	//! When true the script sections are kept after a build, so the next build of the module only compiles the function bodies that changed. Default: false
+	asEP_INCREMENTAL_BUILD                  = 47,
 
 	asEP_LAST_PROPERTY
 };
@@ -407,8 +422,10 @@ enum asEObjTypeFlags : asQWORD
 	asOBJ_IMPLICIT_HANDLE             = (1<<20),
 	//! The C++ class contains unions. Only valid for value types.
 	asOBJ_APP_CLASS_UNION             = (asQWORD(1)<<32),
+	//! The GC behaviours can be called from multiple threads at the same time. Only valid together with asOBJ_GC.
+	asOBJ_GC_THREADSAFE               = (asQWORD(1)<<33),
 	//! This mask shows which flags are value for RegisterObjectType
-	asOBJ_MASK_VALID_FLAGS            = 0x1801FFFFFul,
+	asOBJ_MASK_VALID_FLAGS            = 0x3801FFFFFul,
 	// Internal flags
 	//! The object is a script class or an interface.
 	asOBJ_SCRIPT_OBJECT               = (1<<21),
@@ -524,7 +541,9 @@ enum asEGCFlags
 	//! Destroy known garbage
 	asGC_DESTROY_GARBAGE = 4,
 	//! Detect garbage with circular references
-	asGC_DETECT_GARBAGE  = 8
+	asGC_DETECT_GARBAGE  = 8,
+	//! Run until there is nothing more to do, or the time given in microseconds has passed
+	asGC_TIME_BUDGET     = 16
 };
 
 // Token classes
@@ -681,6 +700,10 @@ typedef asIScriptContext *(*asREQUESTCONTEXTFUNC_t)(asIScriptEngine *, void *);
 typedef void (*asRETURNCONTEXTFUNC_t)(asIScriptEngine *, asIScriptContext *, void *);
 //! The function signature for the callback used when detecting a circular reference in garbage
 typedef void (*asCIRCULARREFFUNC_t)(asITypeInfo *, const void *, void *);
+//! The function signature for a task given to the worker pool
+typedef void (*asWORKFUNC_t)(asUINT, void *);
+//! The function signature for the worker pool callback
+typedef void (*asWORKERPOOLFUNC_t)(asWORKFUNC_t, void *, asUINT, void *);
 
 struct asSVMRegisters;
 //! \brief The function signature of a JIT compiled function
@@ -884,6 +907,89 @@ extern "C"
 	//! functions and methods must be registered with the \ref asCALL_GENERIC calling convention.
 	AS_API const char      *asGetLibraryOptions();
 
+	// Build profiler
+	//! \ingroup api_auxiliary_functions
+	//! \brief Discards the timings collected by the profiler.
+	//! \return A negative value on error.
+	//! \retval asNOT_SUPPORTED The library was compiled without AS_PROFILE.
+	//!
+	//! Call this before a build or a load of bytecode to only get the timings for that. 
+	//! The scopes that are being timed in other threads while the profiler is reset are left out of the timings.
+	//!
+	//! \see \ref doc_finetuning_7
+	AS_API int               asResetProfiler();
+	//! \ingroup api_auxiliary_functions
+	//! \brief Returns the number of scopes timed by the profiler.
+	//! \return The number of scopes, or 0 if the library was compiled without AS_PROFILE.
+	//!
+	//! \see \ref doc_finetuning_7
+	AS_API asUINT            asGetProfilerScopeCount();
+	//! \ingroup api_auxiliary_functions
+	//! \brief Returns the timings of a scope.
+	//! \param[in] index The index of the scope.
+	//! \param[out] scope Receives the name of the scope, prefixed by the names of the outer scopes separated with '|'.
+	//! \param[out] count Receives the number of times the scope was executed.
+	//! \param[out] totalTime Receives the total time spent in the scope in seconds.
+	//! \param[out] minTime Receives the shortest time spent in the scope in seconds.
+	//! \param[out] maxTime Receives the longest time spent in the scope in seconds.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The index is out of range.
+	//! \retval asNOT_SUPPORTED The library was compiled without AS_PROFILE.
+	//!
+	//! The outer scopes always have a lower index than the scopes nested in them. The name
+	//! stays valid even after more scopes are timed or the profiler is reset.
+	//!
+	//! \see \ref doc_finetuning_7
+	AS_API int               asGetProfilerScope(asUINT index, const char **scope, asUINT *count = 0, double *totalTime = 0, double *minTime = 0, double *maxTime = 0);
+	//! \ingroup api_auxiliary_functions
+	//! \brief Writes the timings as a trace file.
+	//! \param[in] filename The name of the file.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The filename is null.
+	//! \retval asERROR The file couldn't be written.
+	//! \retval asNOT_SUPPORTED The library was compiled without AS_PROFILE.
+	//!
+	//! The file is written in the Chrome Trace Event Format, with one event for each time a scope
+	//! was executed, and can be viewed in chrome://tracing or in Perfetto. Executions shorter than 
+	//! 10 microseconds are left out, as are the executions after the first million.
+	//!
+	//! \see \ref doc_finetuning_7
+	AS_API int               asWriteProfilerTrace(const char *filename);
+
+	// Bytecode statistics
+	//! \ingroup api_auxiliary_functions
+	//! \brief Discards the instruction counts collected by the contexts.
+	//! \return A negative value on error.
+	//! \retval asNOT_SUPPORTED The library was compiled without AS_BYTECODE_STATS.
+	//!
+	//! \see \ref doc_finetuning_8
+	AS_API int               asResetByteCodeStats();
+	//! \ingroup api_auxiliary_functions
+	//! \brief Returns the number of different instruction sequences that have been executed.
+	//! \param[in] length The number of instructions in the sequences, from 1 to 3.
+	//! \return The number of sequences, or 0 if the library was compiled without AS_BYTECODE_STATS.
+	//!
+	//! \see \ref doc_finetuning_8
+	AS_API asUINT            asGetByteCodeStatsCount(asUINT length);
+	//! \ingroup api_auxiliary_functions
+	//! \brief Returns an executed instruction sequence and how many times it was executed.
+	//! \param[in] length The number of instructions in the sequence, from 1 to 3.
+	//! \param[in] index The index of the sequence.
+	//! \param[out] opcodes Receives the \ref asEBCInstr "opcodes" of the sequence. Must have room for \a length bytes.
+	//! \param[out] count Receives the number of times the sequence was executed.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The length or the index is out of range.
+	//! \retval asNOT_SUPPORTED The library was compiled without AS_BYTECODE_STATS.
+	//!
+	//! The sequences are ordered with the most executed first. A sequence is made of 
+	//! instructions that were executed one after the other by the same context, so a
+	//! taken jump or a call to a script function also forms a sequence with the 
+	//! instruction executed after it. Instructions executed by a JIT compiled function
+	//! aren't counted.
+	//!
+	//! \see \ref doc_finetuning_8
+	AS_API int               asGetByteCodeStats(asUINT length, asUINT index, asBYTE *opcodes, asQWORD *count = 0);
+
 	// Context
 	//! \ingroup api_principal_functions
 	//! \brief Returns the currently active context.
@@ -1289,6 +1395,22 @@ public:
 	//! \param[in] declaration The signature of the function.
 	//! \return The function object, or null on error.
 	virtual asIScriptFunction *GetGlobalFunctionByDecl(const char *declaration) const = 0;
+	//! \brief Creates a function signature that can be matched against many modules and types.
+	//! \param[in] declaration The signature of the function.
+	//! \return The function signature, or null on error.
+	//!
+	//! The returned object can be given to \ref asIScriptModule::GetFunctionBySignature and
+	//! \ref asITypeInfo::GetMethodBySignature to avoid parsing the same declaration again
+	//! each time a function is looked up. The types in the declaration are resolved from the 
+	//! global namespace, so they must be fully qualified if declared in a namespace.
+	//!
+	//! The declaration is parsed when first used. If it only refers to registered types
+	//! it is parsed once for all modules, otherwise once per module it is used with.
+	//!
+	//! The application must release the object when it is no longer needed.
+	//!
+	//! \see \ref doc_call_script_func_sig
+	virtual asIFunctionSignature *CreateFunctionSignature(const char *declaration) = 0;
 	//! \}
 
 	// Global properties
@@ -1978,6 +2100,40 @@ public:
 	//! when building modules, or to detect script exceptions that may occur in 
 	//! script class destructors when called from the garbage collector.
 	virtual int                    SetContextCallbacks(asREQUESTCONTEXTFUNC_t requestCtx, asRETURNCONTEXTFUNC_t returnCtx, void *param = 0) = 0;
+	//! \brief Obtain statistics on the memory used for the context stacks.
+	//! \param[out] bytesInContexts The number of bytes currently held by the contexts' stacks.
+	//! \param[out] bytesPooled The number of bytes kept by the engine for reuse by the contexts.
+	//! \param[out] blocksPooled The number of stack blocks kept by the engine for reuse.
+	//!
+	//! The contexts borrow their stack blocks from the engine and return them when the context 
+	//! is destroyed or trimmed, so the pooled memory can be reused without new allocations.
+	//!
+	//! \see \ref asIScriptContext::TrimStack, \ref asEP_STACK_HIGH_WATER_MARK
+	virtual void                   GetStackStatistics(asUINT *bytesInContexts, asUINT *bytesPooled = 0, asUINT *blocksPooled = 0) const = 0;
+	//! \}
+
+	// Worker pool
+	//! \name Worker pool
+	//! \{
+
+	//! \brief Register a worker pool that the engine can use to run work in parallel.
+	//! \param[in] callback The worker pool callback, or null to remove the pool.
+	//! \param[in] param An additional parameter that will be passed to the callback.
+	//! \param[in] numWorkers The number of tasks the work should be divided into.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The number of workers is 0.
+	//! \retval asNOT_SUPPORTED The library was compiled without support for multiple threads.
+	//!
+	//! The callback will be given a work function, a parameter for it, and the number of tasks. It must 
+	//! call the work function once for each task, from 0 to the number of tasks minus 1, passing the task 
+	//! index and the parameter, and return only when all tasks have been completed. The tasks are 
+	//! independent of each other and can be executed by different threads at the same time.
+	//!
+	//! The threads that execute the tasks will access the thread local data of the engine, so they
+	//! should call \ref asThreadCleanup before they exit.
+	//!
+	//! \see \ref asEP_GC_PARALLEL_MIN_OBJECTS, \ref asEP_COMPILE_PARALLEL_MIN_FUNCTIONS
+	virtual int                    SetWorkerPool(asWORKERPOOLFUNC_t callback, void *param = 0, asUINT numWorkers = 0) = 0;
 	//! \}
 
 	// String interpretation
@@ -2002,7 +2158,7 @@ public:
 
 	//! \brief Perform garbage collection.
 	//! \param[in] flags Set to a combination of the \ref asEGCFlags.
-	//! \param[in] numIterations The number of iterations to perform when not doing a full cycle
+	//! \param[in] numIterations The number of iterations to perform when not doing a full cycle, or the number of microseconds with \ref asGC_TIME_BUDGET
 	//! \return 1 if the cycle wasn't completed, 0 if it was.
 	//!
 	//! This method will free script objects that can no longer be reached. When the engine 
@@ -2016,6 +2172,10 @@ public:
 	//! out the garbage collection time over a large period, thus not impacting the responsiveness 
 	//! of the application.
 	//!
+	//! With \ref asGC_TIME_BUDGET the garbage collector keeps running steps until there is 
+	//! nothing more to do or the given number of microseconds has passed, which is an easier 
+	//! way to fit the garbage collection in a frame than guessing the number of iterations.
+	//!
 	//! \see \ref doc_gc
 	virtual int  GarbageCollect(asDWORD flags = asGC_FULL_CYCLE, asUINT numIterations = 1) = 0;
 	//! \brief Obtain statistics from the garbage collector.
@@ -2031,6 +2191,20 @@ public:
 	//!
 	//! \see \ref doc_gc
 	virtual void GetGCStatistics(asUINT *currentSize, asUINT *totalDestroyed = 0, asUINT *totalDetected = 0, asUINT *newObjects = 0, asUINT *totalNewDestroyed = 0) const = 0;
+	//! \brief Obtain statistics from the garbage collector for a single type.
+	//! \param[in] type The object type.
+	//! \param[out] totalAdded The total number of objects of this type added to the garbage collector.
+	//! \param[out] totalNewDestroyed The total number of objects of this type destroyed while still in the new generation.
+	//! \param[out] totalPromoted The total number of objects of this type moved to the old generation.
+	//! \param[out] totalDetected The total number of objects of this type detected as garbage with circular references.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The type is null or not an object type.
+	//!
+	//! Use this to find which types are responsible for most of the work in the garbage collector,
+	//! e.g. types that are often promoted to the old generation or that often form circular references.
+	//!
+	//! \see \ref doc_gc, \ref asEP_GC_PROMOTION_SWEEPS
+	virtual int  GetGCTypeStatistics(asITypeInfo *type, asUINT *totalAdded, asUINT *totalNewDestroyed = 0, asUINT *totalPromoted = 0, asUINT *totalDetected = 0) const = 0;
 	//! \brief Notify the garbage collector of a new object that needs to be managed.
 	//! \param[in] obj A pointer to the newly created object.
 	//! \param[in] type The type of the object.
@@ -2301,6 +2475,10 @@ public:
 	//! compiled bytecode it has. After calling this method
 	//! the module pointer is no longer valid and shouldn't
 	//! be used by the application.
+	//!
+	//! If the module is being built, e.g. when called from the
+	//! message callback, the module will be discarded as soon 
+	//! as the build is completed.
 	virtual void             Discard() = 0;
 	//! \}
 
@@ -2334,7 +2512,7 @@ public:
 	//! \return A negative value on error
 	//! \retval asINVALID_CONFIGURATION The engine configuration is invalid.
 	//! \retval asERROR The script failed to build.
-	//! \retval asBUILD_IN_PROGRESS Another thread is currently building. 
+	//! \retval asBUILD_IN_PROGRESS The module is already being built by another thread, or a build is in progress in this thread.
 	//! \retval asINIT_GLOBAL_VARS_FAILED It was not possible to initialize at least one of the global variables.
 	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
 	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and and cannot be removed. 
@@ -2349,6 +2527,10 @@ public:
 	//! Compiler messages are sent to the message callback function set with \ref asIScriptEngine::SetMessageCallback. 
 	//! If there are no errors or warnings, no messages will be sent to the callback function.
 	//!
+	//! Different modules can be built by multiple threads at the same time, but only the parsing of the
+	//! script sections runs in parallel. The registration of the script entities and the compilation of
+	//! the functions are done by one module at a time, while the other threads wait.
+	//!
 	//! Any global variables found in the script will be initialized by the
 	//! compiler if the engine property \ref asEP_INIT_GLOBAL_VARS_AFTER_BUILD is set. If you get the error
 	//! \ref asINIT_GLOBAL_VARS_FAILED, then it is probable that one of the global variables during the initialization 
@@ -2365,7 +2547,7 @@ public:
 	//! \return A negative value on error
 	//! \retval asINVALID_ARG One or more arguments have invalid values.
 	//! \retval asINVALID_CONFIGURATION The engine configuration is invalid.
-	//! \retval asBUILD_IN_PROGRESS Another build is in progress.
+	//! \retval asBUILD_IN_PROGRESS Another build is in progress in this thread, or the module is being built.
 	//! \retval asERROR The compilation failed.
 	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
 	//!
@@ -2387,7 +2569,7 @@ public:
 	//! \return A negative value on error
 	//! \retval asINVALID_ARG One or more arguments have invalid values.
 	//! \retval asINVALID_CONFIGURATION The engine configuration is invalid.
-	//! \retval asBUILD_IN_PROGRESS Another build is in progress.
+	//! \retval asBUILD_IN_PROGRESS Another build is in progress in this thread, or the module is being built.
 	//! \retval asERROR The compilation failed.
 	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
 	//!
@@ -2443,6 +2625,9 @@ public:
 	//! \brief Returns the function by its declaration
 	//! \param[in] decl The function declaration.
 	//! \return The function or null in case of error.
+	//!
+	//! The result is cached by the module, so repeating the same lookup doesn't parse the
+	//! declaration again until the module or the engine configuration is changed.
 	virtual asIScriptFunction *GetFunctionByDecl(const char *decl) const = 0;
 	//! \brief Returns the function by its name
 	//! \param[in] name The function name
@@ -2453,6 +2638,14 @@ public:
 	//! the scoping operator ::. If the scope starts with :: it will be used as the 
 	//! absolute scope, otherwise it will be relative to the default namespace.
 	virtual asIScriptFunction *GetFunctionByName(const char *name) const = 0;
+	//! \brief Returns the function matching a pre-parsed signature
+	//! \param[in] signature The signature created with \ref asIScriptEngine::CreateFunctionSignature.
+	//! \return The function or null if not found.
+	//!
+	//! The function is searched for in the default namespace as given by \ref SetDefaultNamespace.
+	//!
+	//! \see \ref doc_call_script_func_sig
+	virtual asIScriptFunction *GetFunctionBySignature(const asIFunctionSignature *signature) const = 0;
 	//! \brief Remove a single function from the scope of the module
 	//! \param[in] func The pointer to the function that should be removed.
 	//! \return A negative value on error.
@@ -2711,13 +2904,31 @@ public:
 	//!
 	//! \see \ref doc_adv_precompile
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
+	//! \brief Save compiled byte code as an image that can be loaded faster.
+	//! \param[in] out The output stream.
+	//! \param[in] stripDebugInfo Set to true to skip saving the debug information.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The stream object wasn't specified.
+	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
+	//! \retval asERROR Nothing has been compiled in the module.
+	//!
+	//! The image holds the same byte code as \ref SaveByteCode, together with the ids of the application functions 
+	//! that the scripts call and a hash of the interface registered by the application. When the image is loaded 
+	//! in an engine that has registered the exact same interface, the functions are found directly by their id 
+	//! instead of by comparing their signatures. If the interface is different the image is loaded just like the 
+	//! plain byte code. The image is loaded with \ref LoadByteCode, which detects the format automatically.
+	//!
+	//! All sections of the image start at aligned offsets, so it is suitable for loading from a memory mapped file.
+	//!
+	//! \see \ref doc_adv_precompile
+	virtual int SaveByteCodeImage(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
 	//! \brief Load pre-compiled byte code from a binary stream.
 	//!
 	//! \param[in] in The input stream.
 	//! \param[out] wasDebugInfoStripped Set to true if the byte code was saved without debug information.
 	//! \return A negative value on error.
 	//! \retval asINVALID_ARG The stream object wasn't specified.
-	//! \retval asBUILD_IN_PROGRESS Another thread is currently building.
+	//! \retval asBUILD_IN_PROGRESS Another build is in progress in this thread, or the module is being built.
 	//! \retval asOUT_OF_MEMORY The engine ran out of memory while loading the byte code.
 	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and and cannot be removed. 
 	//! \retval asERROR It was not possible to load the byte code.
@@ -2737,6 +2948,25 @@ public:
 	//!
 	//! \see \ref doc_adv_precompile
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped = 0) = 0;
+	//! \brief Load pre-compiled byte code from a memory buffer.
+	//!
+	//! \param[in] data A pointer to the byte code.
+	//! \param[in] size The size of the byte code in bytes.
+	//! \param[out] wasDebugInfoStripped Set to true if the byte code was saved without debug information.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The buffer wasn't specified.
+	//! \retval asBUILD_IN_PROGRESS Another build is in progress in this thread, or the module is being built.
+	//! \retval asOUT_OF_MEMORY The engine ran out of memory while loading the byte code.
+	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and and cannot be removed. 
+	//! \retval asERROR It was not possible to load the byte code.
+	//!
+	//! This method works like the one that takes a \ref asIBinaryStream, except that the byte code is decoded directly 
+	//! from the buffer instead of being read from the stream a few bytes at a time. This makes the loading considerably 
+	//! faster, as no virtual calls are made. The buffer can for example be a memory mapped file. The engine doesn't 
+	//! keep any reference to the buffer after the method returns.
+	//!
+	//! \see \ref doc_adv_precompile
+	virtual int LoadByteCode(const void *data, asUINT size, bool *wasDebugInfoStripped = 0) = 0;
 	//! \}
 
 	// User data
@@ -2911,6 +3141,29 @@ public:
 	virtual bool            IsNested(asUINT *nestCount = 0) const = 0;
 	//! \}
 
+	// Stack memory
+	//! \name Stack memory
+	//! \{
+
+	//! \brief Returns the unused stack memory to the engine.
+	//! \return A negative value on error.
+	//! \retval asCONTEXT_ACTIVE The context is being deserialized.
+	//!
+	//! The stack grows in blocks, each twice the size of the previous, and the blocks are 
+	//! normally kept by the context until it is destroyed. This method gives the blocks that 
+	//! are not currently in use back to the engine, so a context that once executed a deep 
+	//! call doesn't keep the memory allocated. When the context is not executing, this 
+	//! brings the stack back to the initial block.
+	//!
+	//! \see \ref asEP_STACK_HIGH_WATER_MARK
+	virtual int             TrimStack() = 0;
+	//! \brief Obtain statistics on the memory used for the stack.
+	//! \param[out] allocatedBytes The number of bytes allocated for the stack.
+	//! \param[out] blockCount The number of stack blocks held by the context.
+	//! \return A negative value on error.
+	virtual int             GetStackStatistics(asUINT *allocatedBytes, asUINT *blockCount = 0) const = 0;
+	//! \}
+
 	// Object pointer for calling class methods
 	//! \name Object pointer for calling class methods
 	//! \{
@@ -3189,6 +3442,39 @@ public:
 	//!
 	//! Removes a previously registered callback.
 	virtual void               ClearLineCallback() = 0;
+	//! \brief Sets a sample callback function. The function will be called when a sample has been requested.
+	//! \param[in] callback The callback function/method that should be called to take the sample.
+	//! \param[in] obj The object pointer on which the callback is called.
+	//! \param[in] callConv The calling convention of the callback function/method.
+	//! \return A negative value on error.
+	//! \retval asNOT_SUPPORTED Calling convention must not be asCALL_GENERIC, or the routine's calling convention is not supported.
+	//! \retval asINVALID_ARG   \a obj must not be null for class methods.
+	//! \retval asWRONG_CALLING_CONV \a callConv isn't compatible with the routines' calling convention.
+	//!
+	//! The sample callback is meant for sampling profilers. Unlike the line callback it is only
+	//! invoked after \ref RequestSample has been called, so the script runs at full speed in between
+	//! the samples. The callback can inspect the call stack of the context in the same way as the
+	//! line callback.
+	//!
+	//! The signature of the callback is the same as for \ref SetLineCallback.
+	//!
+	//! \see The add-on \ref doc_addon_profiler
+	virtual int                SetSampleCallback(const asSFuncPtr &callback, void *obj, int callConv) = 0;
+	//! \brief Removes the registered callback.
+	//!
+	//! Removes a previously registered callback.
+	virtual void               ClearSampleCallback() = 0;
+	//! \brief Requests that the sample callback is invoked at the next safe point.
+	//! \return A negative value on error.
+	//! \retval asERROR Invalid context object.
+	//! \retval asNO_FUNCTION No sample callback has been set.
+	//!
+	//! The sample is taken at the next statement, script function entry, or return from an application
+	//! registered function. Like \ref Suspend this method can be called from another thread while the
+	//! context is executing, which is how a timer thread drives the sampling.
+	//!
+	//! If the context is not executing, the sample will be taken when the execution is resumed.
+	virtual int                RequestSample() = 0;
 	//! \brief Returns the size of the callstack, i.e. the number of functions that have yet to complete.
 	//! \return The number of functions on the call stack, including the current function.
 	//!
@@ -3939,7 +4225,17 @@ public:
 	//! that you wish to execute. The method is then sent to the context's \ref asIScriptContext::Prepare "Prepare" method.
 	//!
 	//! The method will find the script method with the exact same declaration.
+	//!
+	//! The result is cached by the type, so repeating the same lookup doesn't parse the
+	//! declaration again until the module or the engine configuration is changed.
 	virtual asIScriptFunction *GetMethodByDecl(const char *decl, bool getVirtual = true) const = 0;
+	//! \brief Returns the method matching a pre-parsed signature.
+	//! \param[in] signature The signature created with \ref asIScriptEngine::CreateFunctionSignature.
+	//! \param[in] getVirtual Set to true if the virtual method or the real method should be retrieved.
+	//! \return The method or null if not found.
+	//!
+	//! \see \ref doc_call_script_func_sig
+	virtual asIScriptFunction *GetMethodBySignature(const asIFunctionSignature *signature, bool getVirtual = true) const = 0;
 	//! \}
 
 	// Properties
@@ -4324,6 +4620,41 @@ protected:
 	virtual ~asIScriptFunction() {};
 };
 
+//! \ingroup api_auxiliary_interfaces
+//! \brief A pre-parsed function declaration.
+//!
+//! This interface is returned by \ref asIScriptEngine::CreateFunctionSignature and is used
+//! to look up functions and methods without parsing the declaration each time.
+//!
+//! \see \ref doc_call_script_func_sig
+class asIFunctionSignature
+{
+public:
+	//! \brief Returns a pointer to the engine.
+	//! \return A pointer to the engine.
+	virtual asIScriptEngine *GetEngine() const = 0;
+
+	// Memory management
+	//! \name Memory management
+	//! \{
+
+	//! \brief Increases the reference counter.
+	//! \return The number of references to this object.
+	virtual int AddRef() const = 0;
+	//! \brief Decrements the reference counter.
+	//! \return The number of references to this object.
+	virtual int Release() const = 0;
+	//! \}
+
+	// Declaration
+	//! \brief Returns the declaration the signature was created from.
+	//! \return A null terminated string with the declaration.
+	virtual const char *GetDeclaration() const = 0;
+
+protected:
+	virtual ~asIFunctionSignature() {}
+};
+
 //! \ingroup api_auxiliary_interfaces
 //! \brief A binary stream interface.
 //!
@@ -5071,8 +5402,22 @@ enum asEBCInstr
 	asBC_POWu64			= 199,
 	//! \brief Call registered function with single 32bit integer argument. Suspend further execution if requested.
 	asBC_Thiscall1		= 200,
-
-	asBC_MAXBYTECODE	= 201,
+	//! \brief Compare int variable with constant and jump if equal. Replaces CMPIi + JZ.
+	asBC_JEqIi			= 201,
+	//! \brief Compare int variable with constant and jump if not equal. Replaces CMPIi + JNZ.
+	asBC_JNeIi			= 202,
+	//! \brief Compare int variable with constant and jump if less. Replaces CMPIi + JS.
+	asBC_JLtIi			= 203,
+	//! \brief Compare int variable with constant and jump if greater or equal. Replaces CMPIi + JNS.
+	asBC_JGeIi			= 204,
+	//! \brief Compare int variable with constant and jump if greater. Replaces CMPIi + JP.
+	asBC_JGtIi			= 205,
+	//! \brief Compare int variable with constant and jump if less or equal. Replaces CMPIi + JNP.
+	asBC_JLeIi			= 206,
+	//! \brief Push the pointer in the variable with an added offset onto the stack. Replaces PshVPtr + ADDSi.
+	asBC_PshVPtrOfs		= 207,
+
+	asBC_MAXBYTECODE	= 208,
 
 	// Temporary tokens. Can't be output to the final program
 	asBC_TryBlock		= 250,
@@ -5404,14 +5749,14 @@ const asSBCInfo asBCInfo[256] =
 	asBCINFO(POWi64,	wW_rW_rW_ARG,	0),
 	asBCINFO(POWu64,	wW_rW_rW_ARG,	0),
 	asBCINFO(Thiscall1, DW_ARG,			-AS_PTR_SIZE-1),
+	asBCINFO(JEqIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JNeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLtIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JGtIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(JLeIi,		rW_DW_DW_ARG,	0),
+	asBCINFO(PshVPtrOfs, rW_W_DW_ARG,	AS_PTR_SIZE),
 
-	asBCINFO_DUMMY(201),
-	asBCINFO_DUMMY(202),
-	asBCINFO_DUMMY(203),
-	asBCINFO_DUMMY(204),
-	asBCINFO_DUMMY(205),
-	asBCINFO_DUMMY(206),
-	asBCINFO_DUMMY(207),
 	asBCINFO_DUMMY(208),
 	asBCINFO_DUMMY(209),
 	asBCINFO_DUMMY(210),
@@ -12,6 +12,7 @@ This page gives a brief description of the add-ons that you'll find in the /sdk/
  - \subpage doc_addon_build
  - \subpage doc_addon_ctxmgr
  - \subpage doc_addon_debugger
+ - \subpage doc_addon_profiler
  - \subpage doc_addon_serializer
  - \subpage doc_addon_helpers
  - \subpage doc_addon_autowrap
@@ -357,6 +358,98 @@ int ExecuteWithDebug(asIScriptContext *ctx)
 
 
 
+\page doc_addon_profiler Profiler
+
+<b>Path:</b> /sdk/add_on/scriptprofiler/
+
+The <code>CScriptProfiler</code> is a sampling profiler for scripts. A timer thread periodically 
+requests a sample from the contexts attached to the profiler with \ref asIScriptContext::RequestSample "RequestSample", 
+and the contexts record their call stack at the next statement, function entry, or return from an 
+application function. The samples are aggregated in a call tree with the number of samples in each 
+function and on each line.
+
+As the sample callback is only invoked when a sample has been requested, the overhead is much lower 
+than for profiling with the line callback, and the script runs at full speed in between the samples.
+
+The result can be retrieved as collapsed stacks, which is the input format for flame graph tools, 
+as a call tree in JSON format, or as a table of the functions where most of the time was spent.
+
+The profiler holds references to the functions in the call tree, so it must be reset or destroyed
+before the engine is shut down.
+
+\see The sample \ref doc_samples_asrun for a complete example of how to use the profiler
+
+\section doc_addon_profiler_1 Public C++ interface
+
+\code
+class CScriptProfiler
+{
+public:
+  CScriptProfiler();
+  virtual ~CScriptProfiler();
+
+  // The time between the samples in microseconds. Default is 1000
+  void        SetInterval(asUINT microseconds);
+  asUINT      GetInterval() const;
+
+  // Set or remove the sample callback on the context. A context can
+  // only be attached to one profiler at a time
+  int         AttachContext(asIScriptContext *ctx);
+  void        DetachContext(asIScriptContext *ctx);
+
+  // Start and stop the timer thread that requests the samples
+  int         Start();
+  void        Stop();
+
+  // Discard all samples and release the functions held by the call tree
+  void        Reset();
+
+  asUINT      GetSampleCount() const;
+
+  // Returns one line per call stack with the number of samples taken in it, e.g.
+  // "void main();void update() 42". This is the input expected by flamegraph.pl
+  std::string GetCollapsedStacks() const;
+
+  // Returns the call tree with inclusive and exclusive samples per function,
+  // and the samples per line, in JSON format
+  std::string GetJSON() const;
+
+  // Returns a table of the functions with the most exclusive samples
+  std::string GetReport(asUINT maxFunctions = 20) const;
+
+  // Sample callback invoked by the context
+  void        SampleCallback(asIScriptContext *ctx);
+};
+\endcode
+
+\section doc_addon_profiler_2 Example usage
+
+\code
+CScriptProfiler profiler;
+int ExecuteWithProfiler(asIScriptContext *ctx)
+{
+  // Take a sample every 500 microseconds
+  profiler.SetInterval(500);
+  profiler.AttachContext(ctx);
+  profiler.Start();
+
+  int r = ctx->Execute();
+
+  profiler.Stop();
+  profiler.DetachContext(ctx);
+
+  // Show where the time was spent
+  printf("%s", profiler.GetReport().c_str());
+
+  return r;
+}
+\endcode
+
+
+
+
+
+
 \page doc_addon_ctxmgr Context manager
 
 <b>Path:</b> /sdk/add_on/contextmgr/
@@ -187,7 +187,47 @@ By default the engine will accept 100 nested calls.
 
 Normally this option is only used for testing the library, but should you find that the compilation time takes too long, then
 it may be of interest to turn off the bytecode optimization pass by setting this option to false. 
+
+\ref asEP_OPTIMIZE_BYTECODE_LEVEL
+
+By setting this option to 2 the compiler will also analyse the flow of values through each function. Variables that are known to 
+hold a constant or a copy of another variable are replaced by the constant or the original variable, values that are never read 
+are not stored, and branches that are never taken are removed together with the code that can no longer be reached. This gives 
+less instructions to execute, at the cost of a slightly longer compilation. Functions with try/catch blocks are not analysed.
+
+As with optimizing compilers for other languages, a debugger may see stale values in the local variables that were optimized 
+away, and a value changed by the debugger may not be seen by the script. The default is 1, which only performs the local optimizations.
+
+\ref asEP_MAX_INLINE_FUNCTION_SIZE
+
+When set to a value above 0 the builder will replace the calls to small script functions, e.g. property accessors, with a copy of 
+the bytecode of the called function, if the function is not larger than the given number of dwords. Only functions that take and 
+return primitive values and that don't call other functions are inlined, and only when the exact function is known at compile time, 
+i.e. global functions, and methods called on a local variable of the class type. This saves the cost of setting up a new call 
+frame for each call. The inlined code reports the line numbers of the called function, but a debugger will see it as part of the 
+calling function's call frame. The default is 0, i.e. no functions are inlined. The option is ignored if \ref asEP_OPTIMIZE_BYTECODE 
+is turned off.
  
+\ref asEP_COMPILE_PARALLEL_MIN_FUNCTIONS
+
+When a worker pool has been registered with \ref asIScriptEngine::SetWorkerPool "SetWorkerPool", the builder will compile the 
+function bodies with the workers when the module has at least this number of functions. A function that needs to add something 
+to the engine, e.g. a new template instance or a lambda, is compiled again by the thread that builds the module, so the result is 
+the same as when compiling the functions one by one. The default is 0, which means the worker pool is never used by the builder.
+
+\see \ref doc_adv_multithread
+
+\ref asEP_INCREMENTAL_BUILD
+
+When turned on the module keeps a copy of the script sections after a successful build. When the module is built again with 
+the same sections, and the only differences are inside the statement blocks of the functions, then only the changed functions 
+are compiled again. The functions that had the changed functions inlined in them are also compiled again. The global variables 
+keep their values, and the existing objects of the script classes stay valid, as the declarations are not changed. Any other 
+change, e.g. a new function, a changed declaration, or a change in a mixin or shared entity, gives a normal full build. 
+The incremental build is not done while a context is executing, is suspended in, or has stopped with an exception in any of 
+the module's functions, as it would still refer to the replaced code. The build is then a normal full build.
+The default is false.
+
 \ref asEP_COPY_SCRIPT_SECTIONS
  
 If you want to spare some dynamic memory and the script sections passed to the engine is already stored somewhere in memory then you
@@ -208,6 +248,13 @@ maximum size by setting the asEP_MAX_CALL_STACK_SIZE. This limit is set in numbe
 In some cases it may be useful to set the initial stack size too, e.g. if you know beforehand that a large stack is needed, or 
 if you wish to avoid any runtime memory allocations during an execution. In this case you can use the asEP_INIT_STACK_SIZE for the 
 data stack, and asEP_INIT_CALL_STACK_SIZE for the call stack.
+
+\ref asEP_STACK_HIGH_WATER_MARK
+
+The blocks of the data stack are borrowed from a pool in the engine and normally stay with the context until it is destroyed. With this option
+the context will give back the blocks it isn't using after an execution if the memory it holds is larger than the given number of bytes. This
+is useful when keeping a pool of contexts, so a single deep call doesn't keep the memory allocated for the life time of the context. The 
+application can also trim the stack explicitly with \ref asIScriptContext::TrimStack "TrimStack".
  
 \ref asEP_BUILD_WITHOUT_LINE_CUES
  
@@ -243,6 +290,22 @@ CPU can be spared.
 
 \see \ref doc_gc
 
+\ref asEP_GC_PARALLEL_MIN_OBJECTS
+
+When a worker pool has been registered with \ref asIScriptEngine::SetWorkerPool "SetWorkerPool", the garbage collector will share the 
+counting of references between the workers when there are at least this number of objects in the cycle. The default is 0, which means
+the worker pool is never used by the garbage collector.
+
+\see \ref doc_gc_threads
+
+\ref asEP_GC_PROMOTION_SWEEPS
+
+Sets the number of sweeps a new object must survive in the garbage collector before it is moved to the old generation, where the 
+circular references are detected. The default is 3. Applications where most garbage objects have circular references may benefit 
+from a lower value.
+
+\see \ref doc_gc
+
 \ref asEP_DISABLE_SCRIPT_CLASS_GC
 
 By default the script compiler will detect script classes that can potentially form circular references and will flag them for
@@ -456,6 +456,16 @@ Make a jump to a relative position depending on the value in the value register
  - \ref asBC_JLowZ
  - \ref asBC_JLowNZ
 
+Compare an int variable with a constant and make a jump to a relative position depending on the result.
+The value register is not updated. These replace a \ref asBC_CMPIi followed by a conditional jump.
+
+ - \ref asBC_JEqIi
+ - \ref asBC_JNeIi
+ - \ref asBC_JLtIi
+ - \ref asBC_JGeIi
+ - \ref asBC_JGtIi
+ - \ref asBC_JLeIi
+
 Call an application registered function
 
  - \ref asBC_CALLSYS
@@ -502,6 +512,10 @@ Push the value of a variable on the stack.
  - \ref asBC_PshV8
  - \ref asBC_PshVPtr
 
+Push the pointer in a variable with an added offset on the stack. Raises exception if the pointer is null.
+
+ - \ref asBC_PshVPtrOfs
+
 Initialize the value of a variable with a constant.
  
  - \ref asBC_SetV1
@@ -29,8 +29,16 @@ Even if you don't want or can't use multithreading, you can still write applicat
    same module, but if the module has global variables you need to make sure the scripts perform proper
    access control so that they do not get corrupted, if multiple threads try to update them simultaneously.
 
- - The engine will only allow one thread to build scripts at any one time, since this is something that 
-   changes the internal state of the engine and cannot safely be done in multiple threads simultaneously.
+ - Multiple threads may build different modules at the same time, but only the parsing of the script sections 
+   runs in parallel. The registration of the script entities and the compilation change the internal state of 
+   the engine, so the engine lets only one thread at a time do this part while the others wait. The same module cannot 
+   be built by two threads simultaneously. The message callback is never invoked by two threads at the same 
+   time during the builds.
+
+ - The function bodies of a large module can be compiled by the application's \ref asIScriptEngine::SetWorkerPool "worker pool"
+   by setting the engine property \ref asEP_COMPILE_PARALLEL_MIN_FUNCTIONS. The messages are still given to the message callback
+   by the thread that builds the module, in the same order as when the functions are compiled one by one. The worker threads 
+   must call \ref asThreadCleanup before they exit.
    
  - Reference counters for objects that will be referred to by scripts in different threads must be thread safe
    in order to avoid race conditions as multiple threads attempt to update the same reference counter.
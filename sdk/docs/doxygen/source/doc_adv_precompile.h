@@ -41,6 +41,23 @@ protected:
 };
 \endcode
 
+If the whole bytecode is already in memory, e.g. because it was read in one go or because the file has been 
+memory mapped, it is faster to pass the buffer directly to the \ref asIScriptModule::LoadByteCode "LoadByteCode" 
+overload that takes a pointer and a size. The bytecode is then decoded straight from the buffer without calling 
+the stream for each value.
+
+\code
+// The buffer holds the bytecode saved with SaveByteCode
+int r = mod->LoadByteCode(buffer, bufferSize);
+\endcode
+
+For the fastest possible load the bytecode can be saved with \ref asIScriptModule::SaveByteCodeImage "SaveByteCodeImage" 
+instead. The image holds the same bytecode, but also the ids of the application functions that the scripts call, and a 
+hash of the interface registered by the application. When the image is loaded in an application that registers the exact 
+same interface, the functions are found directly by their ids instead of by comparing their signatures. If the interface 
+has changed, the image is loaded just like the plain bytecode. \ref asIScriptModule::LoadByteCode "LoadByteCode" detects 
+the image automatically, and the sections in it are aligned so the image can be loaded from a memory mapped file.
+
 
 \see \ref doc_samples_asbuild
 
@@ -53,6 +53,26 @@ Note that the return value retrieved with GetReturnValue() is only valid
 if the script function returned successfully, i.e. if Execute() returned 
 asEXECUTION_FINISHED.
 
+\subsection doc_call_script_func_sig Looking up functions repeatedly
+
+The result of \ref asIScriptModule::GetFunctionByDecl "GetFunctionByDecl" is cached by the module, 
+so looking up the same declaration again is cheap as long as the module isn't changed. 
+If the same declaration is looked up in many modules, or for many script classes with 
+\ref asITypeInfo::GetMethodByDecl "GetMethodByDecl", then the declaration can be parsed once 
+with \ref asIScriptEngine::CreateFunctionSignature "CreateFunctionSignature" and the returned 
+object passed to \ref asIScriptModule::GetFunctionBySignature "GetFunctionBySignature" or 
+\ref asITypeInfo::GetMethodBySignature "GetMethodBySignature" instead.
+
+\code
+asIFunctionSignature *sig = engine->CreateFunctionSignature("void onUpdate(float)");
+for( asUINT n = 0; n < engine->GetModuleCount(); n++ )
+{
+  asIScriptFunction *func = engine->GetModuleByIndex(n)->GetFunctionBySignature(sig);
+  ...
+}
+sig->Release();
+\endcode
+
 \section doc_call_script_2 Passing and returning primitives
 
 When calling script functions that take arguments, the values of these 
@@ -164,6 +164,80 @@ on the function signature and the platforms ABI complexity.
 
 
 
+\section doc_finetuning_7 Measure the time to build scripts and load bytecode
+
+If the scripts take too long to build or load, the library can be compiled with the AS_PROFILE flag to 
+measure where the time goes. The profiler times the main steps of the builder, the compiler, and the 
+bytecode loader, in all the threads that use the engine, and keeps the timings until they are reset.
+
+\code
+asResetProfiler();
+mod->Build();
+
+// Print the time spent in each step
+for( asUINT n = 0; n < asGetProfilerScopeCount(); n++ )
+{
+  const char *scope;
+  asUINT count;
+  double time;
+  asGetProfilerScope(n, &scope, &count, &time);
+  printf("%s: %u calls, %f secs\n", scope, count, time);
+}
+
+// Write a trace that can be viewed in chrome://tracing or Perfetto
+asWriteProfilerTrace("build_trace.json");
+\endcode
+
+The profiler adds some overhead to every step it measures, so the library shouldn't be compiled with 
+AS_PROFILE in released applications.
+
+
+
+
+\section doc_finetuning_8 Count the executed bytecode instructions
+
+To see which instructions and which sequences of instructions a script spends its time on, the library 
+can be compiled with the AS_BYTECODE_STATS flag. Each context then counts the instructions it executes, 
+together with the pairs and triples of instructions executed one after the other. The counts are 
+shared by all engines and are kept until they are reset.
+
+\code
+asResetByteCodeStats();
+ctx->Execute();
+
+// Print the 20 most executed pairs of instructions
+asBYTE op[2];
+asQWORD count;
+for( asUINT n = 0; n < 20 && asGetByteCodeStats(2, n, op, &count) >= 0; n++ )
+  printf("%s %s: %llu\n", asBCInfo[op[0]].name, asBCInfo[op[1]].name, count);
+\endcode
+
+The \ref doc_samples_asrun "asrun" sample prints the most executed sequences when given the 
+--bytecode-stats option. Counting the instructions makes the execution several times slower, 
+so the library shouldn't be compiled with AS_BYTECODE_STATS in released applications.
+
+
+
+
+\section doc_finetuning_9 Inline small script functions
+
+Each call to a script function, even one as small as a property accessor, requires the VM to set up a new 
+stack frame and to restore the previous frame when returning. By setting the engine property \ref asEP_MAX_INLINE_FUNCTION_SIZE 
+the builder will instead copy the bytecode of small functions into the functions that call them.
+
+\code
+// Inline functions with at most 32 dwords of bytecode
+engine->SetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE, 32);
+\endcode
+
+Only functions that take and return primitives and that don't call other functions are inlined. Methods are 
+inlined when the object is a local variable of the class type, as then the true type of the object is known. 
+An exception in the inlined code reports the line in the called function, but the callstack will not show the 
+called function as a separate entry.
+
+
+
+
 
 
 */
\ No newline at end of file
@@ -30,6 +30,16 @@ Finally, if the application goes into a state where responsiveness is not so cri
 cycle on the garbage collector, thus cleaning up all garbage at once. To do this, call \ref 
 asIScriptEngine::GarbageCollect "GarbageCollect"(\ref asGC_FULL_CYCLE).
 
+When the application has a fixed amount of time to spend on garbage collection, e.g. the remaining time of a frame, it can call 
+\ref asIScriptEngine::GarbageCollect "GarbageCollect"(\ref asGC_TIME_BUDGET, microseconds). The garbage collector will then run 
+as many steps as fits in the given time, and return 0 if it finished all the work before the time ran out.
+
+The objects are first kept in a new generation, where they are checked with the cheap local test. Objects that survive a number 
+of sweeps, set with \ref asEP_GC_PROMOTION_SWEEPS, are moved to the old generation where the more expensive detection of circular 
+references is done. A lower number lets the circular references be found sooner, while a higher number avoids the detection for 
+short lived objects. The statistics per type, obtained with \ref asIScriptEngine::GetGCTypeStatistics "GetGCTypeStatistics", 
+can help decide which value is best for the application.
+
 Should the automatic garbage collections not be desired, e.g. in critical inner loops where maximum performance is
 needed, it can easily be turned off with a call to \ref asIScriptEngine::SetEngineProperty "SetEngineProperty"(\ref asEP_AUTO_GARBAGE_COLLECT, false).
 
@@ -53,6 +63,13 @@ The garbage collector itself is thread safe, but in order to be able to safely u
 environment the application must make sure all the objects that may be in the garbage collector has thread safe implementations
 of \ref doc_gc_object "the GC behaviours". 
 
+On large heaps the counting of references in the detection of circular references can be shared between multiple threads. To do 
+this the application registers a worker pool with \ref asIScriptEngine::SetWorkerPool "SetWorkerPool" and sets the minimum number 
+of objects for which this is worth it with \ref asEP_GC_PARALLEL_MIN_OBJECTS. Only the objects of types flagged with 
+\ref asOBJ_GC_THREADSAFE are handed to the workers, the others are still handled by the thread that invoked the garbage collector. 
+Script classes get this flag automatically, unless they hold value types that don't have it. Observe that this part of the cycle is 
+then completed in a single step, even when the garbage collector is invoked with \ref asGC_ONE_STEP.
+
 \see \ref doc_reg_gcref_4
 
 
@@ -195,6 +195,9 @@ static container, i.e. the memory layout of the contents cannot change, then ENU
 change, e.g. dynamic arrays or hash maps, then the iteration over the content in ENUMREFS must be protected so that it doesn't break
 in case the memory happen to change in the middle of the iteration.
 
+Types that have thread-safe GC behaviours can be registered with the \ref asOBJ_GC_THREADSAFE flag. This allows the garbage collector to
+call the GETGCFLAG and ENUMREFS behaviours for these objects from the threads of the application's worker pool.
+
 \see \ref doc_gc_threads
 
 
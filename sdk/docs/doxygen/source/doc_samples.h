@@ -163,6 +163,7 @@ breakpoints, stepping through the code, examining variables, etc.
 
  - \ref doc_debug
  - \ref doc_addon_debugger
+ - \ref doc_addon_profiler
  - \ref doc_addon_std_string
  - \ref doc_addon_array
  - \ref doc_addon_dict
@@ -198,10 +199,14 @@ can be added as the first line on the script to make the script files executable
 \section doc_samples_asrun_usage Usage
 
 <pre>
-asrun [-d] \<script file> [\<args>]
- -d             inform if the script should be runned with debug
- \<script file>  is the script file that should be runned
- \<args>         zero or more args for the script
+asrun [-d] [--profile] [--bytecode-stats] \<script file> [\<args>]
+ -d               inform if the script should be runned with debug
+ --profile        sample the execution and write the profile to
+                  \<script file>.folded and \<script file>.json
+ --bytecode-stats print the most executed bytecode sequences. The
+                  library must be compiled with AS_BYTECODE_STATS
+ \<script file>    is the script file that should be runned
+ \<args>           zero or more args for the script
 </pre>
 
 These usage instructions are also presented if the tool is executed without any arguments.
@@ -296,7 +296,9 @@ A class can be marked as 'final' to prevent the inheritance of it. This is an op
 mostly used in larger projects where there are many classes and it may be difficult to manually 
 control the correct use of all classes. It is also possible to mark individual class methods of a 
 class as 'final', in which case it is still possible to inherit from the class, but the finalled
-method cannot be overridden.
+method cannot be overridden. As a side benefit, when the compiler knows that a method cannot be overridden,
+either because the method or the class is final, it will call the method directly instead of looking it
+up in the virtual function table, which is slightly faster.
 
 Another keyword that can be used to mark a class is 'abstract'. Abstract classes cannot be 
 instantiated, but they can be derived from. Abstract classes are most frequently used when you
@@ -496,7 +496,13 @@ The second variant finds the first character that doesn't match any of those in
 
 \note These functions work on the individual bytes in the strings. They do not attempt to understand encoded characters, e.g. UTF-8 encoded characters that can take up to 4 bytes.
 
-\todo Add info on regexFind (also doesn't handle utf-8)
+<b>int regexFind(const string &in regex, uint start = 0, uint &out lengthOfMatch = void) const</b><br>
+
+Searches the string for the first match of the regular expression, starting at \a start. Returns the position of the match, or a negative
+value if there is no match. The length of the match is returned in \a lengthOfMatch. The compiled expressions are cached, so
+calling the function repeatedly with the same expression doesn't compile it again. If the expression is invalid, a script exception is raised.
+
+\note The regular expression works on the individual bytes in the string, so it doesn't understand UTF-8 encoded characters.
 
 <b>array<string>@ split(const string &in delimiter) const</b><br>
 
@@ -549,6 +555,33 @@ Examples:
   string num = formatFloat(number, '0', 8, 2);
 </pre>
 
+\subsection doc_datatypes_strings_addon_regex Regular expressions
+
+The <code>regex</code> type holds a compiled regular expression in ECMAScript syntax, so it can be used many times without compiling the
+expression again. If the expression is invalid, the constructor raises a script exception.
+
+<pre>
+  regex rex('[0-9]+');
+  uint length;
+  int pos = rex.find('abc123', 0, length);  // pos = 3, length = 3
+</pre>
+
+<b>int find(const string &in str, uint start = 0, uint &out lengthOfMatch = void) const</b><br>
+
+Returns the position of the first match in \a str at or after \a start, or a negative value if there is no match.
+
+<b>bool match(const string &in str) const</b><br>
+
+Returns true if the whole string matches the expression.
+
+<b>string replace(const string &in str, const string &in fmt) const</b><br>
+
+Returns a copy of \a str where each match is replaced with \a fmt. The format can refer to the sub-expressions with $1, $2, etc.
+
+<b>array<string>@ split(const string &in str) const</b><br>
+
+Splits the string where the expression matches, in the same way as the split method on the string.
+
 
 
 
@@ -4,6 +4,8 @@
 #include <vector>
 #include <stdlib.h>  // system()
 #include <stdio.h>
+#include <fstream>   // ofstream
+#include <iomanip>   // setw()
 
 #if defined(_MSC_VER) && !defined(_WIN32_WCE) && !defined(__S3E__)
 #include <direct.h>  // _chdir()
@@ -26,6 +28,7 @@
 #include "../../../add_on/contextmgr/contextmgr.h"
 #include "../../../add_on/datetime/datetime.h"
 #include "../../../add_on/scriptsocket/scriptsocket.h"
+#include "../../../add_on/scriptprofiler/scriptprofiler.h"
 
 #ifdef _WIN32
 #include <Windows.h> // WriteConsoleW
@@ -76,6 +79,8 @@ CScriptArray     *GetCommandLineArgs();
 void              SetWorkDir(const string &file);
 void              WaitForUser();
 int               PragmaCallback(const string &pragmaText, CScriptBuilder &builder, void *userParam);
+void              WriteProfile(const char *scriptFile);
+void              WriteByteCodeStats();
 
 // The command line arguments
 CScriptArray *g_commandLineArgs = 0;
@@ -89,6 +94,13 @@ CContextMgr *g_ctxMgr = 0;
 bool       g_doDebug = false;
 CDebugger *g_dbg = 0;
 
+// The profiler samples the execution of the script
+bool             g_doProfile = false;
+CScriptProfiler *g_profiler = 0;
+
+// The library counts the executed instructions if compiled with AS_BYTECODE_STATS
+bool g_doByteCodeStats = false;
+
 // Context pool
 vector<asIScriptContext*> g_ctxPool;
 
@@ -113,21 +125,35 @@ int main(int argc, char **argv)
 
 	int r;
 
-	// Validate the command line arguments
+	// Validate the command line arguments. The options come before the script file
 	bool argsValid = true;
-	if( argc < 2 ) 
-		argsValid = false;
-	else if( argc == 2 && strcmp(argv[1], "-d") == 0 )
+	int scriptArg = 1;
+	for( ; argsValid && scriptArg < argc && argv[scriptArg][0] == '-'; scriptArg++ )
+	{
+		if( strcmp(argv[scriptArg], "-d") == 0 )
+			g_doDebug = true;
+		else if( strcmp(argv[scriptArg], "--profile") == 0 )
+			g_doProfile = true;
+		else if( strcmp(argv[scriptArg], "--bytecode-stats") == 0 )
+			g_doByteCodeStats = true;
+		else
+			argsValid = false;
+	}
+	if( scriptArg >= argc )
 		argsValid = false;
 
 	if( !argsValid )
 	{
 		cout << "AngelScript command line runner. Version " << ANGELSCRIPT_VERSION_STRING << endl << endl;
 		cout << "Usage: " << endl;
-		cout << "asrun [-d] <script file> [<args>]" << endl;
-		cout << " -d             inform if the script should be runned with debug" << endl;
-		cout << " <script file>  is the script file that should be runned" << endl;
-		cout << " <args>         zero or more args for the script" << endl;
+		cout << "asrun [-d] [--profile] [--bytecode-stats] <script file> [<args>]" << endl;
+		cout << " -d               inform if the script should be runned with debug" << endl;
+		cout << " --profile        sample the execution and write the profile to" << endl;
+		cout << "                  <script file>.folded and <script file>.json" << endl;
+		cout << " --bytecode-stats print the most executed bytecode sequences. The" << endl;
+		cout << "                  library must be compiled with AS_BYTECODE_STATS" << endl;
+		cout << " <script file>    is the script file that should be runned" << endl;
+		cout << " <args>           zero or more args for the script" << endl;
 
 		WaitForUser();
 		return -1;
@@ -146,12 +172,7 @@ int main(int argc, char **argv)
 	r = ConfigureEngine(engine);
 	if( r < 0 ) return -1;
 	
-	// Check if the script is to be debugged
-	if( strcmp(argv[1], "-d") == 0 )
-		g_doDebug = true;
-
 	// Store the command line arguments for the script
-	int scriptArg = g_doDebug ? 2 : 1;
 	g_argc = argc - (scriptArg + 1);
 	g_argv = argv + (scriptArg + 1);
 
@@ -397,6 +418,21 @@ int ExecuteScript(asIScriptEngine *engine, const char *scriptFile)
 	if(g_doDebug)
 		InitializeDebugger(engine);
 
+	// The contexts are attached to the profiler as they are taken from the pool,
+	// so the initialization of the global variables and the co-routines are included
+	if( g_doProfile )
+	{
+		g_profiler = new CScriptProfiler();
+		g_profiler->Start();
+	}
+
+	// Only the instructions executed by the script are counted, not those of the build
+	if( g_doByteCodeStats && asResetByteCodeStats() < 0 )
+	{
+		engine->WriteMessage(scriptFile, 0, 0, asMSGTYPE_WARNING, "The library was compiled without AS_BYTECODE_STATS");
+		g_doByteCodeStats = false;
+	}
+
 	// Once we have the main function, we first need to initialize the global variables
 	// Since we've set up the request context callback we will be able to debug the 
 	// initialization without passing in a pre-created context
@@ -417,6 +453,12 @@ int ExecuteScript(asIScriptEngine *engine, const char *scriptFile)
 	// be managed by the context manager
 	while( g_ctxMgr->ExecuteScripts() );
 
+	if( g_profiler )
+		g_profiler->Stop();
+
+	if( g_doByteCodeStats )
+		WriteByteCodeStats();
+
 	// Check if the main script finished normally
 	r = ctx->GetState();
 	if( r != asEXECUTION_FINISHED )
@@ -483,9 +525,57 @@ int ExecuteScript(asIScriptEngine *engine, const char *scriptFile)
 		g_dbg = 0;
 	}
 
+	// The profiler holds references to the script functions, 
+	// so it must be destroyed before the engine is shut down
+	if( g_profiler )
+	{
+		WriteProfile(scriptFile);
+		delete g_profiler;
+		g_profiler = 0;
+	}
+
 	return r;
 }
 
+// Print a summary of the profile and write the full results to files next to the script
+void WriteProfile(const char *scriptFile)
+{
+	cout << g_profiler->GetReport();
+
+	// The collapsed stacks can be turned into a flame graph with flamegraph.pl
+	string folded = string(scriptFile) + ".folded";
+	ofstream(folded.c_str()) << g_profiler->GetCollapsedStacks();
+
+	string json = string(scriptFile) + ".json";
+	ofstream(json.c_str()) << g_profiler->GetJSON();
+
+	cout << "Profile written to " << folded << " and " << json << endl;
+}
+
+// Print the instructions, and the sequences of two and three instructions, that were executed the most
+void WriteByteCodeStats()
+{
+	const char *titles[] = { "Instructions", "Pairs", "Triples" };
+	for( asUINT length = 1; length <= 3; length++ )
+	{
+		cout << titles[length-1] << " (" << asGetByteCodeStatsCount(length) << " different)" << endl;
+
+		asBYTE opcodes[3];
+		asQWORD count;
+		for( asUINT n = 0; n < 20 && asGetByteCodeStats(length, n, opcodes, &count) >= 0; n++ )
+		{
+			string seq;
+			for( asUINT i = 0; i < length; i++ )
+			{
+				if( i ) seq += " ";
+				seq += asBCInfo[opcodes[i]].name;
+			}
+			cout << "  " << setw(40) << left << seq << right << count << endl;
+		}
+		cout << endl;
+	}
+}
+
 // This little function allows the script to print a string to the screen
 void PrintString(const string &str)
 {
@@ -690,6 +780,10 @@ asIScriptContext *RequestContextCallback(asIScriptEngine *engine, void * /*param
 		ctx->SetLineCallback(asMETHOD(CDebugger, LineCallback), g_dbg, asCALL_THISCALL);
 	}
 
+	// Attach the profiler if needed
+	if( ctx && g_profiler )
+		g_profiler->AttachContext(ctx);
+
 	return ctx;
 }
 
@@ -703,6 +797,9 @@ void ReturnContextCallback(asIScriptEngine *engine, asIScriptContext *ctx, void
 	// up may trigger other script executions, e.g. if a destructor needs to call a function.
 	ctx->Unprepare();
 
+	if( g_profiler )
+		g_profiler->DetachContext(ctx);
+
 	// Place the context into the pool for when it will be needed again
 	g_ctxPool.push_back(ctx);
 }
@@ -1,17 +1,25 @@
 #include <stdio.h>
+#if defined(WIN32)
 #include <conio.h>
+#endif
 #if defined(_MSC_VER)
 #include <crtdbg.h>
 #endif
 #include "angelscript.h"
+#include "utils.h"
 
 namespace TestBasic { void Test(); }
 namespace TestBigArrays { void Test(); }
+namespace TestBigFunction { void Test(); }
 namespace TestManySymbols { void Test(); }
 namespace TestManyFuncs { void Test(); }
 namespace TestComplex { void Test(); }
 namespace TestRebuild { void Test(); }
 namespace TestHugeAPI { void Test(); }
+namespace TestConcurrentLoad { void Test(); }
+namespace TestConcurrentBuild { void Test(); }
+namespace TestParallelCompile { void Test(); }
+namespace TestLoadBytecode { void Test(); }
 
 void DetectMemoryLeaks()
 {
@@ -35,14 +43,23 @@ int main(int argc, char **argv)
 
 	TestBasic::Test();
 	TestBigArrays::Test();
+	TestBigFunction::Test();
 	TestManySymbols::Test();
 	TestManyFuncs::Test();
 	TestComplex::Test();
 	TestRebuild::Test();
 	TestHugeAPI::Test();
+	TestConcurrentLoad::Test();
+	TestConcurrentBuild::Test();
+	TestParallelCompile::Test();
+	TestLoadBytecode::Test();
+
+	PrintProfile("buildperf_trace.json");
 	
 	printf("--------------------------------------------\n");
 	printf("Press any key to quit.\n");
+#if defined(WIN32)
 	while(!getch());
+#endif
 	return 0;
 }
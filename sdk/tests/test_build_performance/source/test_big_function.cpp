@@ -0,0 +1,94 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include "memory_stream.h"
+
+#include <string>
+#include <sstream>
+using std::string;
+using std::stringstream;
+
+namespace TestBigFunction
+{
+
+#define TESTNAME "TestBigFunction"
+
+void Test()
+{
+	printf("---------------------------------------------\n");
+	printf("%s\n\n", TESTNAME);
+
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	////////////////////////////////////////////
+	printf("\nGenerating...\n");
+
+	// Functions with many branches, like generated state machines or lookup
+	// functions. Each return and break jumps to the end of the function
+#ifdef _DEBUG
+	const int numBranches = 100;
+#else
+	const int numBranches = 10000;
+#endif
+
+	std::stringstream script_buffer;
+	script_buffer << "int lookup(int a, int b) {\n";
+	for( int n = 0; n < numBranches; n++ )
+		script_buffer << "  if( a == " << n << " ) { b += " << n << "; if( b > " << n*3 << " ) return b * 2; }\n";
+	script_buffer << "  return b;\n}\n";
+
+	script_buffer << "int select(int a) {\n  int s = 0;\n  switch( a ) {\n";
+	for( int n = 0; n < numBranches; n++ )
+		script_buffer << "  case " << n << ": s += " << n << " * a; break;\n";
+	script_buffer << "  }\n  return s;\n}\n";
+	string script = script_buffer.str();
+
+	////////////////////////////////////////////
+	printf("\nBuilding...\n");
+
+	double time = GetSystemTimer();
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script.c_str(), script.size(), 0);
+	int r = mod->Build();
+
+	time = GetSystemTimer() - time;
+
+	if( r != 0 )
+		printf("Build failed\n");
+	else
+		printf("Time = %f secs\n", time);
+
+	////////////////////////////////////////////
+	printf("\nSaving...\n");
+
+	time = GetSystemTimer();
+
+	CBytecodeStream stream("");
+	mod->SaveByteCode(&stream);
+
+	time = GetSystemTimer() - time;
+	printf("Time = %f secs\n", time);
+	printf("Size = %d\n", int(stream.buffer.size()));
+
+	////////////////////////////////////////////
+	printf("\nLoading...\n");
+
+	time = GetSystemTimer();
+
+	asIScriptModule *mod2 = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod2->LoadByteCode(&stream);
+
+	time = GetSystemTimer() - time;
+	printf("Time = %f secs\n", time);
+
+	engine->Release();
+}
+
+} // namespace
+
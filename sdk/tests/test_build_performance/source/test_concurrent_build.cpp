@@ -0,0 +1,145 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+using std::string;
+using std::vector;
+
+namespace TestConcurrentBuild
+{
+
+#define TESTNAME "TestConcurrentBuild"
+
+// Each module is independent of the others, like mods loaded by a game server
+static const char *scriptModule =
+"class Item%d                                                \n"
+"{                                                           \n"
+"   string name;                                             \n"
+"   int    value;                                            \n"
+"   array<int> stats;                                        \n"
+"   Item%d(const string &in n, int v) { name = n; value = v; }\n"
+"   int Score() const                                        \n"
+"   {                                                        \n"
+"      int s = value;                                        \n"
+"      for( uint n = 0; n < stats.length(); n++ )            \n"
+"         s += stats[n] * int(n + 1);                        \n"
+"      return s;                                             \n"
+"   }                                                        \n"
+"}                                                           \n"
+"int Evaluate(int count)                                     \n"
+"{                                                           \n"
+"   array<Item%d@> items;                                    \n"
+"   for( int n = 0; n < count; n++ )                         \n"
+"   {                                                        \n"
+"      Item%d item('item' + n, n * %d);                      \n"
+"      item.stats.insertLast(n);                             \n"
+"      items.insertLast(item);                               \n"
+"   }                                                        \n"
+"   int total = 0;                                           \n"
+"   for( uint n = 0; n < items.length(); n++ )               \n"
+"   {                                                        \n"
+"      if( items[n].Score() > 10 )                           \n"
+"         total += items[n].Score();                         \n"
+"      else                                                  \n"
+"         total -= items[n].value;                           \n"
+"   }                                                        \n"
+"   return total;                                            \n"
+"}                                                           \n";
+
+static void BuildThread(asIScriptEngine *engine, const vector<string> *scripts, std::atomic<int> *next, std::atomic<int> *failures)
+{
+	// Take the next module that hasn't been built yet
+	for( int n = (*next)++; n < (int)scripts->size(); n = (*next)++ )
+	{
+		char name[20];
+		sprintf(name, "mod%d", n);
+
+		asIScriptModule *mod = engine->GetModule(name, asGM_ALWAYS_CREATE);
+		mod->AddScriptSection(name, (*scripts)[n].c_str(), (*scripts)[n].size(), 0);
+		if( mod->Build() < 0 )
+			(*failures)++;
+	}
+
+	asThreadCleanup();
+}
+
+// Builds all the modules on the same engine with the given number of threads. Only the
+// parsing runs in parallel, so the speed up is limited by the time spent compiling
+static double BuildInThreads(int numThreads, const vector<string> &scripts, COutStream &out)
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	RegisterScriptArray(engine, true);
+	RegisterStdString(engine);
+
+	std::atomic<int> next(0);
+	std::atomic<int> failures(0);
+
+	double time = GetSystemTimer();
+
+	vector<std::thread> threads;
+	for( int n = 0; n < numThreads; n++ )
+		threads.push_back(std::thread(BuildThread, engine, &scripts, &next, &failures));
+	for( int n = 0; n < numThreads; n++ )
+		threads[n].join();
+
+	time = GetSystemTimer() - time;
+
+	if( failures > 0 || engine->GetModuleCount() != scripts.size() )
+		printf("Build failed\n");
+
+	engine->ShutDownAndRelease();
+
+	return time;
+}
+
+void Test()
+{
+	printf("---------------------------------------------\n");
+	printf("%s\n\n", TESTNAME);
+
+	asPrepareMultithread();
+
+	COutStream out;
+
+	////////////////////////////////////////////
+	printf("\nGenerating...\n");
+
+#ifdef _DEBUG
+	const int numModules = 16;
+#else
+	const int numModules = 300;
+#endif
+
+	vector<string> scripts;
+	for( int n = 0; n < numModules; n++ )
+	{
+		char buf[5000];
+		sprintf(buf, scriptModule, n, n, n, n, n);
+		scripts.push_back(buf);
+	}
+
+	////////////////////////////////////////////
+	double time1 = 0;
+	for( int numThreads = 1; numThreads <= 16; numThreads *= 2 )
+	{
+		printf("\nBuilding in %d thread%s...\n", numThreads, numThreads > 1 ? "s" : "");
+
+		double time = BuildInThreads(numThreads, scripts, out);
+		if( numThreads == 1 )
+			time1 = time;
+
+		printf("Time = %f secs, %.1f modules/sec, %.2fx\n", time, numModules / time, time1 / time);
+	}
+}
+
+} // namespace
+
+
+
@@ -0,0 +1,133 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include "memory_stream.h"
+#include <string>
+#include <vector>
+#include <thread>
+using std::string;
+using std::vector;
+
+namespace TestConcurrentLoad
+{
+
+#define TESTNAME "TestConcurrentLoad"
+
+// Each line has its own string constant, and also one that is shared by all lines
+static const char *scriptMiddle =
+"   s = 'string constant %d'; s += 'shared';                 \n";
+
+static asIScriptEngine *CreateEngine(COutStream &out)
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	RegisterScriptArray(engine, true);
+	RegisterStdString(engine);
+
+	return engine;
+}
+
+static void LoadThread(asIScriptEngine *engine, const vector<asBYTE> *bytecode, int iterations)
+{
+	for( int n = 0; n < iterations; n++ )
+	{
+		CBytecodeStream stream("");
+		stream.buffer = *bytecode;
+
+		asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		if( mod->LoadByteCode(&stream) < 0 )
+			printf("Load failed\n");
+		mod->Discard();
+	}
+
+	asThreadCleanup();
+}
+
+// Loads the bytecode in the given number of threads, each with its own engine.
+// The engines all share the string factory, so this measures the contention on it.
+static double LoadInThreads(int numThreads, const vector<asBYTE> &bytecode, int iterations, COutStream &out)
+{
+	vector<asIScriptEngine*> engines;
+	for( int n = 0; n < numThreads; n++ )
+		engines.push_back(CreateEngine(out));
+
+	double time = GetSystemTimer();
+
+	vector<std::thread> threads;
+	for( int n = 0; n < numThreads; n++ )
+		threads.push_back(std::thread(LoadThread, engines[n], &bytecode, iterations));
+	for( int n = 0; n < numThreads; n++ )
+		threads[n].join();
+
+	time = GetSystemTimer() - time;
+
+	for( int n = 0; n < numThreads; n++ )
+		engines[n]->ShutDownAndRelease();
+
+	return time;
+}
+
+void Test()
+{
+	printf("---------------------------------------------\n");
+	printf("%s\n\n", TESTNAME);
+
+	asPrepareMultithread();
+
+	COutStream out;
+	asIScriptEngine *engine = CreateEngine(out);
+
+	////////////////////////////////////////////
+	printf("\nGenerating...\n");
+
+#ifdef _DEBUG
+	const int numLines = 50;
+	const int iterations = 2;
+#else
+	const int numLines = 5000;
+	const int iterations = 20;
+#endif
+
+	string script = "void main()\n{\n   string s;\n";
+	for( int n = 0; n < numLines; n++ )
+	{
+		char buf[500];
+		sprintf(buf, scriptMiddle, n);
+		script += buf;
+	}
+	script += "}\n";
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script.c_str(), script.size(), 0);
+	int r = mod->Build();
+	if( r != 0 )
+	{
+		printf("Build failed\n");
+		engine->ShutDownAndRelease();
+		return;
+	}
+
+	CBytecodeStream stream("");
+	mod->SaveByteCode(&stream);
+	engine->ShutDownAndRelease();
+
+	////////////////////////////////////////////
+	printf("\nLoading in 1 thread...\n");
+
+	double time1 = LoadInThreads(1, stream.buffer, iterations, out);
+	printf("Time = %f secs, %.1f loads/sec\n", time1, iterations / time1);
+
+	////////////////////////////////////////////
+	printf("\nLoading in 8 threads...\n");
+
+	double time8 = LoadInThreads(8, stream.buffer, iterations, out);
+	printf("Time = %f secs, %.1f loads/sec\n", time8, 8 * iterations / time8);
+}
+
+} // namespace
+
+
+
@@ -71,6 +71,10 @@ void Test()
 		sprintf(buf, "  obj%d o; o.val = o.func(3.12, 3.12);\n", i);
 		script += buf;
 		script += "}\n";
+
+		// Each script class method gets a signature id
+		sprintf(buf, "class cls%d { int method%d(float a) { return glob%d; } }\n", i, i, i);
+		script += buf;
 	}
 
 	////////////////////////////////////////////
@@ -112,6 +116,30 @@ void Test()
 	time = GetSystemTimer() - time;
 	printf("Time = %f secs\n", time);
 
+	////////////////////////////////////////////
+	printf("\nSaving image...\n");
+
+	time = GetSystemTimer();
+
+	CBytecodeStream image("");
+	mod2->SaveByteCodeImage(&image);
+
+	time = GetSystemTimer() - time;
+	printf("Time = %f secs\n", time);
+	printf("Size = %d\n", int(image.buffer.size()));
+
+	////////////////////////////////////////////
+	printf("\nLoading image from memory...\n");
+
+	time = GetSystemTimer();
+
+	asIScriptModule *mod3 = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	if( mod3->LoadByteCode(&image.buffer[0], asUINT(image.buffer.size())) < 0 )
+		printf("Load failed\n");
+
+	time = GetSystemTimer() - time;
+	printf("Time = %f secs\n", time);
+
 	engine->Release();
 }
 
@@ -0,0 +1,115 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include "memory_stream.h"
+#include <string>
+using std::string;
+
+namespace TestLoadBytecode
+{
+
+#define TESTNAME "TestLoadBytecode"
+
+// Each function has a bit of everything so the loader decodes 
+// both the declarations and a good amount of bytecode
+static const char *scriptFunc =
+"int Func%d(int a, const string &in s, array<int> @arr)      \n"
+"{                                                           \n"
+"   int sum = a;                                             \n"
+"   for( uint n = 0; n < arr.length(); n++ )                 \n"
+"      sum += arr[n] * %d;                                   \n"
+"   if( s == 'string constant %d' )                          \n"
+"      sum += int(s.length());                               \n"
+"   return sum + %d;                                         \n"
+"}                                                           \n";
+
+void Test()
+{
+	printf("---------------------------------------------\n");
+	printf("%s\n\n", TESTNAME);
+
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	RegisterScriptArray(engine, true);
+	RegisterStdString(engine);
+
+	////////////////////////////////////////////
+	printf("\nGenerating...\n");
+
+#ifdef _DEBUG
+	const int numFuncs = 20;
+	const int iterations = 2;
+#else
+	const int numFuncs = 5000;
+	const int iterations = 20;
+#endif
+
+	string script;
+	for( int n = 0; n < numFuncs; n++ )
+	{
+		char buf[1000];
+		sprintf(buf, scriptFunc, n, n, n, n);
+		script += buf;
+	}
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script.c_str(), script.size(), 0);
+	int r = mod->Build();
+	if( r != 0 )
+	{
+		printf("Build failed\n");
+		engine->ShutDownAndRelease();
+		return;
+	}
+
+	CBytecodeStream stream("");
+	mod->SaveByteCode(&stream);
+	printf("Bytecode size = %d bytes\n", (int)stream.buffer.size());
+
+	////////////////////////////////////////////
+	printf("\nLoading from stream...\n");
+
+	double time = GetSystemTimer();
+
+	for( int n = 0; r >= 0 && n < iterations; n++ )
+	{
+		stream.Restart();
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+	}
+
+	time = GetSystemTimer() - time;
+
+	if( r < 0 )
+		printf("Load failed\n");
+	else
+		printf("Time = %f secs, %.1f MB/sec\n", time, iterations * stream.buffer.size() / time / 1000000);
+
+	////////////////////////////////////////////
+	printf("\nLoading from memory...\n");
+
+	time = GetSystemTimer();
+
+	for( int n = 0; r >= 0 && n < iterations; n++ )
+	{
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream.buffer[0], (asUINT)stream.buffer.size());
+	}
+
+	time = GetSystemTimer() - time;
+
+	if( r < 0 )
+		printf("Load failed\n");
+	else
+		printf("Time = %f secs, %.1f MB/sec\n", time, iterations * stream.buffer.size() / time / 1000000);
+
+	engine->ShutDownAndRelease();
+}
+
+} // namespace
+
@@ -0,0 +1,122 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include <string>
+#include <vector>
+#include <thread>
+using std::string;
+using std::vector;
+
+namespace TestParallelCompile
+{
+
+#define TESTNAME "TestParallelCompile"
+
+// A single large module with many functions, like the game logic of a big project
+static const char *scriptFunc =
+"int Func%d(int a, const string &in s)                       \n"
+"{                                                           \n"
+"   array<int> arr(a);                                       \n"
+"   int sum = 0;                                             \n"
+"   for( uint n = 0; n < arr.length(); n++ )                 \n"
+"   {                                                        \n"
+"      arr[n] = n * %d + a;                                  \n"
+"      if( arr[n] %% 3 == 0 )                                \n"
+"         sum += arr[n] / 3;                                 \n"
+"      else if( arr[n] %% 5 == 1 )                           \n"
+"         sum -= arr[n] * 2;                                 \n"
+"      else                                                  \n"
+"         sum += int(s.length());                            \n"
+"   }                                                        \n"
+"   string str = 'value: ' + sum;                            \n"
+"   while( str.length() < 20 )                               \n"
+"      str += '.';                                           \n"
+"   return sum + int(str.length());                          \n"
+"}                                                           \n";
+
+// Starts one thread for each task and waits for all of them
+static void ThreadPool(asWORKFUNC_t work, void *workParam, asUINT numTasks, void *)
+{
+	vector<std::thread> threads;
+	for( asUINT n = 0; n < numTasks; n++ )
+		threads.push_back(std::thread(work, n, workParam));
+	for( asUINT n = 0; n < numTasks; n++ )
+		threads[n].join();
+}
+
+static double Build(asUINT numWorkers, const string &script, COutStream &out)
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	RegisterScriptArray(engine, true);
+	RegisterStdString(engine);
+
+	if( numWorkers > 1 )
+	{
+		engine->SetWorkerPool(ThreadPool, 0, numWorkers);
+		engine->SetEngineProperty(asEP_COMPILE_PARALLEL_MIN_FUNCTIONS, 100);
+	}
+
+	double time = GetSystemTimer();
+
+	asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("test", script.c_str(), script.size(), 0);
+	if( mod->Build() < 0 )
+		printf("Build failed\n");
+
+	time = GetSystemTimer() - time;
+
+	engine->ShutDownAndRelease();
+
+	return time;
+}
+
+void Test()
+{
+	printf("---------------------------------------------\n");
+	printf("%s\n\n", TESTNAME);
+
+	asPrepareMultithread();
+
+	COutStream out;
+
+	////////////////////////////////////////////
+	printf("\nGenerating...\n");
+
+#ifdef _DEBUG
+	const int numFuncs = 100;
+#else
+	const int numFuncs = 2000;
+#endif
+
+	string script;
+	for( int n = 0; n < numFuncs; n++ )
+	{
+		char buf[2000];
+		sprintf(buf, scriptFunc, n, n);
+		script += buf;
+	}
+
+	////////////////////////////////////////////
+	double time1 = 0;
+	for( asUINT numWorkers = 1; numWorkers <= 8; numWorkers *= 2 )
+	{
+		printf("\nCompiling with %d worker%s...\n", numWorkers, numWorkers > 1 ? "s" : "");
+
+		double time = Build(numWorkers, script, out);
+		if( numWorkers == 1 )
+			time1 = time;
+
+		printf("Time = %f secs, %.2fx\n", time, time1 / time);
+	}
+
+	asThreadCleanup();
+}
+
+} // namespace
+
+
+
@@ -97,6 +97,57 @@ void Test()
 		printf("Time average = %f secs\n", time/iterations);
 	}
 
+	////////////////////////////////////////////
+	printf("\nBuilding incrementally...\n");
+
+	// Rebuild the same module with a change in a single function body, 
+	// so only that function needs to be compiled again
+	engine->SetEngineProperty(asEP_INCREMENTAL_BUILD, true);
+
+	string script = 
+		"Test t; \n"
+		"void globalFunc() { \n"
+		"  for( uint n = 0; n < 10; n++ ) \n"
+		"    t.children[n].doSomething(); \n"
+		"} \n"
+		"class Test { \n"
+		"  Test @next; \n"
+		"  array<Test@> children; \n"
+		"  void doSomething() { if( t is this ) doSomethingElse(); } \n"
+		"  void doSomethingElse() { globalFunc(); } \n"
+		"  Test() {} \n"
+		"  Test @opAssign() { return this; } \n"
+		"} \n"
+		"void main() { \n"
+		"  for( uint n = 0; n < 10; n++ ) \n"
+		"    t.children.insertLast(Test()); \n"
+		"} \n";
+	size_t changedPos = script.find("n < 10");
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script.c_str());
+	r = mod->Build();
+
+	time = GetSystemTimer();
+
+	for( int n = 0; r >= 0 && n < iterations; n++ )
+	{
+		// Alternate the loop limit in globalFunc between 10 and 11
+		script[changedPos+5] = (n & 1) ? '0' : '1';
+		mod->AddScriptSection(TESTNAME, script.c_str());
+		r = mod->Build();
+	}
+
+	time = GetSystemTimer() - time;
+
+	if( r < 0 )
+		printf("Build failed\n");
+	else
+	{
+		printf("Time = %f secs\n", time);
+		printf("Time average = %f secs\n", time/iterations);
+	}
+
 	engine->Release();
 }
 
@@ -1,4 +1,8 @@
 #include "utils.h"
+
+#if defined(WIN32)
+// Windows version
+
 #include <math.h>
 
 #include <windows.h>
@@ -50,3 +54,51 @@ double GetSystemTimer()
         return (double)timeGetTime()/1000.0;
 }
 
+#else
+// Linux version
+
+#include <time.h>
+
+double GetSystemTimer()
+{
+	// Use a monotonic clock so the measurements are not affected by changes to the system time
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return double(ts.tv_sec) + double(ts.tv_nsec)/1000000000.0;
+}
+
+#endif
+
+void PrintProfile(const char *traceFile)
+{
+	// The library only collects the timings when compiled with AS_PROFILE
+	if( asGetProfilerScopeCount() == 0 )
+		return;
+
+	printf("---------------------------------------------\n");
+	printf("Profile\n\n");
+	printf("%-70s %10s %12s %12s\n", "Scope", "Count", "Tot time", "Max time");
+	for( asUINT n = 0; n < asGetProfilerScopeCount(); n++ )
+	{
+		const char *scope;
+		asUINT count;
+		double time, minTime, maxTime;
+		asGetProfilerScope(n, &scope, &count, &time, &minTime, &maxTime);
+
+		// Indent the inner scopes instead of showing the full path
+		int depth = 0;
+		const char *name = scope;
+		for( const char *c = scope; *c; c++ )
+			if( *c == '|' )
+			{
+				depth++;
+				name = c + 1;
+			}
+
+		printf("%*s%-*s %10u %12.6f %12.6f\n", depth*2, "", 70 - depth*2, name, count, time, maxTime);
+	}
+
+	if( asWriteProfilerTrace(traceFile) >= 0 )
+		printf("\nTrace written to %s\n", traceFile);
+}
@@ -11,6 +11,9 @@
 
 double GetSystemTimer();
 
+// Prints the timings collected by the library's profiler, if it was compiled with AS_PROFILE
+void PrintProfile(const char *traceFile);
+
 class COutStream
 {
 public:
@@ -173,6 +173,8 @@ namespace Test_Addon_ScriptFile    { bool Test(); }
 namespace Test_Addon_DateTime      { bool Test(); }
 namespace Test_Addon_StdString     { bool Test(); }
 namespace Test_Addon_ScriptSocket  { bool Test(); }
+namespace Test_Addon_ScriptProfiler { bool Test(); }
+namespace Test_Addon_ScriptJIT    { bool Test(); }
 
 #include "utils.h"
 
@@ -245,6 +247,8 @@ int allTests()
 	if( Test_Addon_Dictionary::Test()    ) goto failed; else PRINTF("-- Test_Addon_Dictionary passed\n");
 	if( Test_Addon_DateTime::Test()      ) goto failed; else PRINTF("-- Test_Addon_DateTime passed\n");
 	if( Test_Addon_StdString::Test()     ) goto failed; else PRINTF("-- Test_Addon_StdString passed\n");
+	if( Test_Addon_ScriptProfiler::Test() ) goto failed; else PRINTF("-- Test_Addon_ScriptProfiler passed\n");
+	if( Test_Addon_ScriptJIT::Test()     ) goto failed; else PRINTF("-- Test_Addon_ScriptJIT passed\n");
 #ifndef _WIN32
 	PRINTF("Skipping test Addon_ScriptSocket as it only works on Windows\n");
 #else
@@ -0,0 +1,298 @@
+#include "utils.h"
+#include "../../../add_on/scriptjit/scriptjit.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace Test_Addon_ScriptJIT
+{
+
+static const char *script =
+"int g = 7; \n"
+"class Acc \n"
+"{ \n"
+"  int v = 0; \n"
+"  void add(int a) { v += a; } \n"
+"  int get() const { return v; } \n"
+"} \n"
+"int fib(int n) \n"
+"{ \n"
+"  if( n < 2 ) return n; \n"
+"  return fib(n-1) + fib(n-2); \n"
+"} \n"
+"int loop(int n) \n"
+"{ \n"
+"  int s = 0; \n"
+"  for( int i = 0; i < n; i++ ) \n"
+"  { \n"
+"    if( i % 3 == 0 ) s += i; \n"
+"    else s -= 1; \n"
+"  } \n"
+"  return s; \n"
+"} \n"
+"double real(int n) \n"
+"{ \n"
+"  double d = 0; \n"
+"  float f = 0.5f; \n"
+"  for( int i = 1; i <= n; i++ ) { d += 1.0/i; f *= 1.5f; } \n"
+"  return d + f; \n"
+"} \n"
+"int64 bits(int64 a) \n"
+"{ \n"
+"  return (a << 20) / 3 + (a & 0xFF) - (a >> 2); \n"
+"} \n"
+"int globals(int n) \n"
+"{ \n"
+"  for( int i = 0; i < n; i++ ) g += i; \n"
+"  return g; \n"
+"} \n"
+"int methods(int n) \n"
+"{ \n"
+"  Acc a; \n"
+"  for( int i = 0; i < n; i++ ) a.add(i); \n"
+"  return a.get(); \n"
+"} \n"
+"int sys(int n) \n"
+"{ \n"
+"  int s = 0; \n"
+"  for( int i = 0; i < n; i++ ) s += twice(i); \n"
+"  return s; \n"
+"} \n"
+"int div(int a, int b) \n"
+"{ \n"
+"  return a / b; \n"
+"} \n"
+"int nullCall() \n"
+"{ \n"
+"  Acc @a; \n"
+"  return a.get(); \n"
+"} \n"
+"int throws(int n) \n"
+"{ \n"
+"  int s = 0; \n"
+"  for( int i = 0; i < n; i++ ) \n"
+"  { \n"
+"    s += i; \n"
+"    if( i == 5 ) fail(); \n"
+"  } \n"
+"  return s; \n"
+"} \n";
+
+int Twice(int a)
+{
+	return a * 2;
+}
+
+void Fail()
+{
+	asGetActiveContext()->SetException("fail");
+}
+
+// Suspends the execution on every line
+void LineCallback(asIScriptContext *ctx, void *)
+{
+	ctx->Suspend();
+}
+
+static asIScriptEngine *CreateEngine(CScriptJIT *jit, COutStream &out)
+{
+	asIScriptEngine *engine = asCreateScriptEngine();
+	engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+	if( jit )
+	{
+		engine->SetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS, true);
+		engine->SetEngineProperty(asEP_JIT_INTERFACE_VERSION, 2);
+		engine->SetJITCompiler(jit);
+	}
+	engine->RegisterGlobalFunction("int twice(int)", asFUNCTION(Twice), asCALL_CDECL);
+	engine->RegisterGlobalFunction("void fail()", asFUNCTION(Fail), asCALL_CDECL);
+
+	asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("test", script);
+	if( mod->Build() < 0 )
+	{
+		engine->ShutDownAndRelease();
+		return 0;
+	}
+
+	return engine;
+}
+
+// Executes the function and returns the value it returned, or a string describing the exception
+static string Run(asIScriptEngine *engine, const char *decl, int arg1, int arg2 = 0)
+{
+	asIScriptFunction *func = engine->GetModule("test")->GetFunctionByDecl(decl);
+	if( func == 0 )
+		return "no function";
+
+	asIScriptContext *ctx = engine->CreateContext();
+	ctx->Prepare(func);
+	for( asUINT n = 0; n < func->GetParamCount(); n++ )
+	{
+		int typeId = 0;
+		func->GetParam(n, &typeId);
+		if( typeId == asTYPEID_INT64 )
+			ctx->SetArgQWord(n, asQWORD(n == 0 ? arg1 : arg2));
+		else
+			ctx->SetArgDWord(n, asDWORD(n == 0 ? arg1 : arg2));
+	}
+	int r = ctx->Execute();
+
+	stringstream s;
+	if( r == asEXECUTION_FINISHED )
+	{
+		int typeId = func->GetReturnTypeId();
+		if( typeId == asTYPEID_DOUBLE )
+			s << ctx->GetReturnDouble();
+		else if( typeId == asTYPEID_INT64 )
+			s << asINT64(ctx->GetReturnQWord());
+		else
+			s << int(ctx->GetReturnDWord());
+	}
+	else if( r == asEXECUTION_EXCEPTION )
+		s << "exception '" << ctx->GetExceptionString() << "' in " << ctx->GetExceptionFunction()->GetName() << " line " << ctx->GetExceptionLineNumber();
+	else
+		s << "state " << r;
+	ctx->Release();
+
+	return s.str();
+}
+
+bool Test()
+{
+	bool fail = false;
+	int r;
+	COutStream out;
+
+	const char *decls[] = { "int fib(int)", "int loop(int)", "double real(int)", "int64 bits(int64)", "int globals(int)",
+	                        "int methods(int)", "int sys(int)", "int div(int, int)", "int nullCall()", "int throws(int)" };
+	const asUINT numDecls = sizeof(decls)/sizeof(decls[0]);
+
+	// The functions compiled by the JIT must give the same results and
+	// raise the same exceptions as the interpreter
+	{
+		CScriptJIT jit;
+		asIScriptEngine *interp = CreateEngine(0, out);
+		asIScriptEngine *engine = CreateEngine(&jit, out);
+		if( interp == 0 || engine == 0 )
+			TEST_FAILED;
+		else
+		{
+			// The native code is only generated on the supported platforms
+			for( asUINT n = 0; n < numDecls; n++ )
+			{
+				asIScriptFunction *func = engine->GetModule("test")->GetFunctionByDecl(decls[n]);
+				if( func == 0 || (func->GetJITFunction() != 0) != CScriptJIT::IsSupported() )
+					TEST_FAILED;
+			}
+
+			for( asUINT n = 0; n < numDecls; n++ )
+			{
+				for( int arg = 0; arg < 20; arg += 7 )
+				{
+					string expected = Run(interp, decls[n], arg, 3);
+					string result = Run(engine, decls[n], arg, 3);
+					if( result != expected )
+					{
+						PRINTF("%s(%d): '%s' != '%s'\n", decls[n], arg, result.c_str(), expected.c_str());
+						TEST_FAILED;
+					}
+				}
+			}
+
+			// Verify some of the results, so a problem in both the JIT and the interpreter isn't hidden
+			if( Run(engine, "int fib(int)", 20) != "6765" ||
+				Run(engine, "int loop(int)", 10) != "12" ||
+				Run(engine, "int methods(int)", 10) != "45" ||
+				Run(engine, "int sys(int)", 10) != "90" ||
+				Run(engine, "int64 bits(int64)", 1000) != "349525315" )
+				TEST_FAILED;
+
+			// The exceptions are reported at the right place, both from the
+			// instructions in the native code and from the called functions
+			if( Run(engine, "int div(int, int)", 1, 0) != "exception 'Divide by zero' in div line 53" )
+				TEST_FAILED;
+			if( Run(engine, "int nullCall()", 0) != "exception 'Null pointer access' in nullCall line 58" )
+				TEST_FAILED;
+			if( Run(engine, "int throws(int)", 10) != "exception 'fail' in throws line 66" )
+				TEST_FAILED;
+
+			// The global variable is shared with the interpreter
+			int *g = (int*)engine->GetModule("test")->GetAddressOfGlobalVar(0);
+			if( g == 0 || *g != 7 + 21 + 91 )
+				TEST_FAILED;
+		}
+
+		if( interp ) interp->ShutDownAndRelease();
+		if( engine ) engine->ShutDownAndRelease();
+	}
+
+	// A context executing native code can be suspended and resumed
+	{
+		CScriptJIT jit;
+		asIScriptEngine *engine = CreateEngine(&jit, out);
+		if( engine == 0 )
+			TEST_FAILED;
+		else
+		{
+			asIScriptContext *ctx = engine->CreateContext();
+			ctx->SetLineCallback(asFUNCTION(LineCallback), 0, asCALL_CDECL);
+			ctx->Prepare(engine->GetModule("test")->GetFunctionByDecl("int methods(int)"));
+			ctx->SetArgDWord(0, 10);
+			int suspends = 0;
+			while( (r = ctx->Execute()) == asEXECUTION_SUSPENDED )
+				suspends++;
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 45 )
+				TEST_FAILED;
+			if( suspends == 0 )
+				TEST_FAILED;
+			ctx->Release();
+
+			engine->ShutDownAndRelease();
+		}
+	}
+
+	// The functions can be compiled one by one
+	{
+		CScriptJIT jit;
+		jit.SetEnabledByDefault(false);
+		if( jit.GetEnabledByDefault() )
+			TEST_FAILED;
+
+		asIScriptEngine *engine = CreateEngine(&jit, out);
+		if( engine == 0 )
+			TEST_FAILED;
+		else
+		{
+			asIScriptFunction *func = engine->GetModule("test")->GetFunctionByDecl("int fib(int)");
+			if( func->GetJITFunction() != 0 )
+				TEST_FAILED;
+
+			r = jit.EnableFunction(func, true);
+			if( r != (CScriptJIT::IsSupported() ? asSUCCESS : asNOT_SUPPORTED) )
+				TEST_FAILED;
+			if( (func->GetJITFunction() != 0) != CScriptJIT::IsSupported() )
+				TEST_FAILED;
+			if( Run(engine, "int fib(int)", 15) != "610" )
+				TEST_FAILED;
+
+			// Releasing the native code returns the function to the interpreter
+			r = jit.EnableFunction(func, false);
+			if( r < 0 || func->GetJITFunction() != 0 )
+				TEST_FAILED;
+			if( Run(engine, "int fib(int)", 15) != "610" )
+				TEST_FAILED;
+
+			if( jit.EnableFunction(0, true) != asINVALID_ARG )
+				TEST_FAILED;
+
+			engine->ShutDownAndRelease();
+		}
+	}
+
+	// Success
+	return fail;
+}
+
+} // namespace
@@ -0,0 +1,181 @@
+#include "utils.h"
+#include "../../../add_on/scriptprofiler/scriptprofiler.h"
+
+using namespace std;
+
+namespace Test_Addon_ScriptProfiler
+{
+
+// Takes a sample when the script returns from this function
+void Sample()
+{
+	asGetActiveContext()->RequestSample();
+}
+
+// Clearing the line callback must not drop the sample that was just requested
+void SampleAndClearLineCallback()
+{
+	asIScriptContext *ctx = asGetActiveContext();
+	ctx->RequestSample();
+	ctx->ClearLineCallback();
+}
+
+void LineCallback(asIScriptContext *)
+{
+}
+
+bool Test()
+{
+	bool fail = false;
+	int r;
+	COutStream out;
+
+	// Take the samples explicitly, so the result is deterministic
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void sample()", asFUNCTION(Sample), asCALL_CDECL);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"void main() \n"
+			"{ \n"
+			"  work(); \n"
+			"  sample(); \n"
+			"  work(); \n"
+			"} \n"
+			"void work() \n"
+			"{ \n"
+			"  sample(); \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptContext *ctx = engine->CreateContext();
+
+		// Without a sample callback there is nothing to request
+		if( ctx->RequestSample() != asNO_FUNCTION )
+			TEST_FAILED;
+
+		CScriptProfiler *profiler = new CScriptProfiler();
+		if( profiler->AttachContext(ctx) < 0 )
+			TEST_FAILED;
+
+		ctx->Prepare(mod->GetFunctionByName("main"));
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( profiler->GetSampleCount() != 3 )
+			TEST_FAILED;
+
+		string stacks = profiler->GetCollapsedStacks();
+		if( stacks != "void main() 1\n"
+		              "void main();void work() 2\n" )
+		{
+			PRINTF("%s", stacks.c_str());
+			TEST_FAILED;
+		}
+
+		string json = profiler->GetJSON();
+		if( json != "{\"interval\":1000,\"samples\":3,\"root\":{\"name\":\"<root>\",\"inclusive\":3,\"exclusive\":0,\"lines\":[],\"children\":["
+		            "{\"name\":\"void main()\",\"section\":\"test\",\"inclusive\":3,\"exclusive\":1,\"lines\":[[3,1],[4,1],[5,1]],\"children\":["
+		            "{\"name\":\"void work()\",\"section\":\"test\",\"inclusive\":2,\"exclusive\":2,\"lines\":[[9,2]],\"children\":[]}]}]}}\n" )
+		{
+			PRINTF("%s", json.c_str());
+			TEST_FAILED;
+		}
+
+		string report = profiler->GetReport();
+		if( report.find("void work()") == string::npos || report.find("void work()") > report.find("void main()") )
+		{
+			PRINTF("%s", report.c_str());
+			TEST_FAILED;
+		}
+
+		profiler->Reset();
+		if( profiler->GetSampleCount() != 0 || profiler->GetCollapsedStacks() != "" )
+			TEST_FAILED;
+
+		// The timer thread requests samples while the script is executing
+		mod = engine->GetModule("test2", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test2",
+			"int main() \n"
+			"{ \n"
+			"  int sum = 0; \n"
+			"  for( int n = 0; n < 10000000; n++ ) \n"
+			"    sum += n; \n"
+			"  return sum; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		profiler->SetInterval(100);
+		if( profiler->Start() < 0 )
+			TEST_FAILED;
+		if( profiler->Start() >= 0 )
+			TEST_FAILED;
+
+		ctx->Prepare(mod->GetFunctionByName("main"));
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		profiler->Stop();
+		profiler->DetachContext(ctx);
+
+		if( profiler->GetSampleCount() == 0 )
+			TEST_FAILED;
+		if( profiler->GetCollapsedStacks().find("int main() ") != 0 )
+			TEST_FAILED;
+
+		// The profiler holds references to the functions, so it must be destroyed before the engine
+		delete profiler;
+
+		ctx->Release();
+		engine->ShutDownAndRelease();
+	}
+
+	// A pending sample request is kept when the line callback is cleared
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void sampleAndClear()", asFUNCTION(SampleAndClearLineCallback), asCALL_CDECL);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"void main() \n"
+			"{ \n"
+			"  sampleAndClear(); \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptContext *ctx = engine->CreateContext();
+		CScriptProfiler *profiler = new CScriptProfiler();
+		if( profiler->AttachContext(ctx) < 0 )
+			TEST_FAILED;
+		ctx->SetLineCallback(asFUNCTION(LineCallback), 0, asCALL_CDECL);
+
+		ctx->Prepare(mod->GetFunctionByName("main"));
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( profiler->GetSampleCount() != 1 )
+			TEST_FAILED;
+
+		profiler->DetachContext(ctx);
+		delete profiler;
+
+		ctx->Release();
+		engine->ShutDownAndRelease();
+	}
+
+	return fail;
+}
+
+} // namespace
@@ -149,6 +149,61 @@ namespace Test_Addon_StdString
 			engine->ShutDownAndRelease();
 		}
 
+		// Test the regex type, and that regexFind reports invalid patterns
+		{
+			asIScriptEngine* engine = asCreateScriptEngine();
+			engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+			RegisterStdString(engine);
+			RegisterScriptArray(engine, false);
+			RegisterStdStringUtils(engine);
+			bout.buffer = "";
+
+			engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+			asIScriptContext* ctx = engine->CreateContext();
+			r = ExecuteString(engine,
+				"regex rex('[0-9]+');\n"
+				"uint length;\n"
+				"assert( rex.find('ab123c45', 0, length) == 2 && length == 3 );\n"
+				"assert( rex.find('ab123c45', 5, length) == 6 && length == 2 );\n"
+				"assert( rex.find('abc', 0, length) == -1 && length == 0 );\n"
+				"assert( rex.match('123') );\n"
+				"assert( !rex.match('123a') );\n"
+				"assert( rex.replace('a1b22c', '#') == 'a#b#c' );\n"
+				"assert( regex('([a-z])([0-9])').replace('a1b2', '$2$1') == '1a2b' );\n"
+				"array<string> @arr = regex(' *[,;] *').split('A, B;;D');\n"
+				"assert( arr.length() == 4 && arr[0] == 'A' && arr[1] == 'B' && arr[2] == '' && arr[3] == 'D' );\n"
+				"for( uint n = 0; n < 3; n++ )\n"
+				"  assert( 'x12'.regexFind('[0-9]+', 0, length) == 1 && length == 2 );\n"
+				"assert( 'x12y34'.regexFind('[0-9]+', 3, length) == 4 && length == 2 );\n", 0, ctx);
+			if (r != asEXECUTION_FINISHED)
+			{
+				TEST_FAILED;
+				if (r == asEXECUTION_EXCEPTION)
+				{
+					PRINTF("%s\n", GetExceptionInfo(ctx).c_str());
+				}
+			}
+
+			r = ExecuteString(engine, "regex rex('[0-9');\n", 0, ctx);
+			if (r != asEXECUTION_EXCEPTION || std::string(ctx->GetExceptionString()) != "Invalid regular expression")
+				TEST_FAILED;
+
+			r = ExecuteString(engine, "'abc'.regexFind('(a');\n", 0, ctx);
+			if (r != asEXECUTION_EXCEPTION || std::string(ctx->GetExceptionString()) != "Invalid regular expression")
+				TEST_FAILED;
+
+			ctx->Release();
+
+			if (bout.buffer != "")
+			{
+				PRINTF("%s", bout.buffer.c_str());
+				TEST_FAILED;
+			}
+
+			engine->ShutDownAndRelease();
+		}
+
 		// Test const string with int value assignment
 		// https://www.gamedev.net/forums/topic/715649-assertion-failure-const-string-asdf-10/5461912/
 		{
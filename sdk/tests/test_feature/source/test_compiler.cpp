@@ -2835,7 +2835,7 @@ bool Test()
 
 		asBYTE expect[] = 
 			{	
-				asBC_SUSPEND,asBC_CALL,asBC_STOREOBJ,asBC_ChkNullV,asBC_VAR,asBC_CALL,asBC_STOREOBJ,asBC_PshVPtr,asBC_GETOBJREF,asBC_CALLINTF,asBC_FREE,
+				asBC_SUSPEND,asBC_CALL,asBC_STOREOBJ,asBC_ChkNullV,asBC_VAR,asBC_CALL,asBC_STOREOBJ,asBC_PshVPtr,asBC_GETOBJREF,asBC_CALL,asBC_FREE,
 				asBC_SUSPEND,asBC_FREE,asBC_RET
 			};
 		asIScriptFunction *func = mod->GetFunctionByName("main");
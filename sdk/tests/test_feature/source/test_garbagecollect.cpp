@@ -71,12 +71,152 @@ void CircularRefDetected(asITypeInfo *type, const void *obj, void * /* user para
 	typeFound += type->GetName();
 }
 
+// Runs the tasks one after the other, in reverse order to make
+// sure the garbage collector doesn't depend on the order
+void SerialWorkerPool(asWORKFUNC_t work, void *workParam, asUINT numTasks, void *param)
+{
+	(*(int*)param)++;
+	for( asUINT n = numTasks; n-- > 0; )
+		work(n, workParam);
+}
+
 bool Test()
 {
 	bool fail = false;
 	COutStream out;
 	int r;
 
+	// Test the promotion setting, the time budget, and the statistics per type
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_AUTO_GARBAGE_COLLECT, false);
+
+		if (engine->SetEngineProperty(asEP_GC_PROMOTION_SWEEPS, 0) != asINVALID_ARG)
+			TEST_FAILED;
+		if (engine->GetEngineProperty(asEP_GC_PROMOTION_SWEEPS) != 3)
+			TEST_FAILED;
+
+		// Promote the objects as soon as they survive the first sweep
+		engine->SetEngineProperty(asEP_GC_PROMOTION_SWEEPS, 1);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class Node { Node @next; } \n"
+			"Node @keep; \n"
+			"void CreateTemp() { Node a; } \n"
+			"void CreateLive() { @keep = Node(); } \n"
+			"void CreateGarbage(int count) \n"
+			"{ \n"
+			"  for( int n = 0; n < count; n++ ) \n"
+			"  { \n"
+			"    Node a, b; \n"
+			"    @a.next = b; \n"
+			"    @b.next = a; \n"
+			"  } \n"
+			"} \n");
+		r = mod->Build();
+		if (r < 0)
+			TEST_FAILED;
+
+		asITypeInfo *type = mod->GetTypeInfoByName("Node");
+		if (engine->GetGCTypeStatistics(0, 0) != asINVALID_ARG)
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "CreateTemp(); CreateLive();", mod);
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+
+		// The temporary object is destroyed while still new, and the live object is promoted
+		engine->GarbageCollect(asGC_ONE_STEP | asGC_DESTROY_GARBAGE, 10);
+
+		asUINT added = 0, newDestroyed = 0, promoted = 0, detected = 0;
+		engine->GetGCTypeStatistics(type, &added, &newDestroyed, &promoted, &detected);
+		if (added != 2 || newDestroyed != 1 || promoted != 1 || detected != 0)
+			TEST_FAILED;
+
+		asUINT currentSize = 0, newObjects = 0;
+		engine->GetGCStatistics(&currentSize, 0, 0, &newObjects);
+		if (currentSize != 1 || newObjects != 0)
+			TEST_FAILED;
+
+		// With a generous time budget the GC returns 0 when there is nothing more to do
+		r = ExecuteString(engine, "CreateGarbage(10);", mod);
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+		r = engine->GarbageCollect(asGC_TIME_BUDGET, 1000000);
+		if (r != 0)
+			TEST_FAILED;
+
+		engine->GetGCStatistics(&currentSize);
+		if (currentSize != 1)
+			TEST_FAILED;
+
+		engine->GetGCTypeStatistics(type, &added, &newDestroyed, &promoted, &detected);
+		if (added != 22 || newDestroyed != 1 || promoted != 21 || detected != 20)
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Test counting the references with a worker pool
+	if( !strstr(asGetLibraryOptions(), "AS_NO_THREADS") )
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_AUTO_GARBAGE_COLLECT, false);
+		RegisterScriptArray(engine, false);
+
+		int numPoolCalls = 0;
+		if (engine->SetWorkerPool(SerialWorkerPool, &numPoolCalls, 0) != asINVALID_ARG)
+			TEST_FAILED;
+		if (engine->SetWorkerPool(SerialWorkerPool, &numPoolCalls, 4) != asSUCCESS)
+			TEST_FAILED;
+		engine->SetEngineProperty(asEP_GC_PARALLEL_MIN_OBJECTS, 1);
+
+		// The array is not thread safe, so it is handled by the GC's own thread
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class Node { Node @next; array<Node@> list; } \n"
+			"Node @keep; \n"
+			"void CreateGarbage(int count) \n"
+			"{ \n"
+			"  @keep = Node(); \n"
+			"  for( int n = 0; n < count; n++ ) \n"
+			"  { \n"
+			"    Node a, b; \n"
+			"    @a.next = b; \n"
+			"    b.list.insertLast(a); \n"
+			"    keep.list.insertLast(Node()); \n"
+			"  } \n"
+			"} \n");
+		r = mod->Build();
+		if (r < 0)
+			TEST_FAILED;
+
+		asITypeInfo *type = mod->GetTypeInfoByName("Node");
+		if (type == 0 || !(type->GetFlags() & asOBJ_GC_THREADSAFE))
+			TEST_FAILED;
+		if (mod->GetTypeInfoByDecl("array<Node@>")->GetFlags() & asOBJ_GC_THREADSAFE)
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "CreateGarbage(50);", mod);
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+
+		engine->GarbageCollect();
+		if (numPoolCalls == 0)
+			TEST_FAILED;
+
+		// The kept object and the objects it refers to must survive, each with its array
+		asUINT currentSize = 0, totalDetected = 0;
+		engine->GetGCStatistics(&currentSize, 0, &totalDetected);
+		if (currentSize != 102 || totalDetected != 200)
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
 	// It is possible to disable GC for script classes at compile time
 	{
 		asIScriptEngine* engine = asCreateScriptEngine();
@@ -6,6 +6,117 @@ using namespace std;
 namespace TestModule
 {
 
+// Attempts to build another module from within the message callback
+struct CNestedBuild
+{
+	CNestedBuild() : engine(0), result(0) {}
+	void Callback(asSMessageInfo *)
+	{
+		asIScriptModule *mod = engine->GetModule("nested", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("nested", "void f() {}");
+		result = mod->Build();
+	}
+	asIScriptEngine *engine;
+	int              result;
+};
+
+// Attempts to update the module that is being built, and builds a module in another engine, from within the message callback
+struct CUpdateDuringBuild
+{
+	CUpdateDuringBuild() : mod(0), otherEngine(0), compileResult(0), varResult(0), loadResult(0), otherResult(-1), discard(false) {}
+	void Callback(asSMessageInfo *)
+	{
+		asIScriptFunction *func = 0;
+		compileResult = mod->CompileFunction("f", "void f() {}", 0, 0, &func);
+		if( func )
+			func->Release();
+		varResult = mod->CompileGlobalVar("g", "int g;", 0);
+		CBytecodeStream stream("test");
+		loadResult = mod->LoadByteCode(&stream);
+
+		asIScriptModule *other = otherEngine->GetModule("other", asGM_ALWAYS_CREATE);
+		other->AddScriptSection("other", "void f() {}");
+		otherResult = other->Build();
+
+		if( discard )
+			mod->Discard();
+	}
+	asIScriptModule *mod;
+	asIScriptEngine *otherEngine;
+	int              compileResult;
+	int              varResult;
+	int              loadResult;
+	int              otherResult;
+	bool             discard;
+};
+
+// Suspends the context when it is executing a class method named f
+static void SuspendInMethod(asIScriptContext *ctx, void *)
+{
+	asIScriptFunction *func = ctx->GetFunction();
+	if( func && func->GetObjectType() && string(func->GetName()) == "f" )
+		ctx->Suspend();
+}
+
+// Runs the tasks one after the other, in reverse order to not simply repeat the serial build
+void ReverseWorkerPool(asWORKFUNC_t work, void *workParam, asUINT numTasks, void *param)
+{
+	(*(int*)param)++;
+	for( asUINT n = numTasks; n-- > 0; )
+		work(n, workParam);
+}
+
+// Builds the script and returns the messages and the saved bytecode
+static int BuildAndSave(const char *script, bool useWorkers, string &messages, vector<asBYTE> &bytecode, int &numPoolCalls)
+{
+	asIScriptEngine *engine = asCreateScriptEngine();
+	CBufferedOutStream bout;
+	engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+	RegisterScriptArray(engine, true);
+	RegisterStdString(engine);
+	if( useWorkers )
+	{
+		engine->SetWorkerPool(ReverseWorkerPool, &numPoolCalls, 3);
+		engine->SetEngineProperty(asEP_COMPILE_PARALLEL_MIN_FUNCTIONS, 2);
+	}
+
+	asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("test", script);
+	int r = mod->Build();
+	if( r >= 0 )
+	{
+		CBytecodeStream stream("test");
+		mod->SaveByteCode(&stream);
+		bytecode = stream.buffer;
+
+		// The functions must also work
+		asIScriptContext *ctx = engine->CreateContext();
+		ctx->Prepare(mod->GetFunctionByName("main"));
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 42 )
+			r = -1;
+		ctx->Release();
+	}
+
+	messages = bout.buffer;
+	engine->ShutDownAndRelease();
+	return r;
+}
+
+// Calls the function and returns the value it returned, or -1 if it failed
+static int CallInt(asIScriptEngine *engine, asIScriptModule *mod, const char *decl)
+{
+	asIScriptFunction *func = mod->GetFunctionByDecl(decl);
+	if( func == 0 )
+		return -1;
+	asIScriptContext *ctx = engine->CreateContext();
+	ctx->Prepare(func);
+	int r = ctx->Execute();
+	int ret = r == asEXECUTION_FINISHED ? int(ctx->GetReturnDWord()) : -1;
+	ctx->Release();
+	return ret;
+}
+
 bool Test()
 {
 	bool fail = false;
@@ -14,6 +125,133 @@ bool Test()
 	COutStream out;
 	asIScriptContext *ctx;
 
+	// A build cannot be started from within another build in the same thread.
+	// The messages from the parser are only written once the build lock is taken,
+	// so this must be reported with asBUILD_IN_PROGRESS instead of deadlocking
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		CNestedBuild nested;
+		nested.engine = engine;
+		engine->SetMessageCallback(asMETHOD(CNestedBuild, Callback), &nested, asCALL_THISCALL);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", "void main() { int a = ; }");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+		if( nested.result != asBUILD_IN_PROGRESS )
+			TEST_FAILED;
+
+		// The script sections are kept, so the other module can be built afterwards
+		engine->ClearMessageCallback();
+		mod = engine->GetModule("nested");
+		r = mod ? mod->Build() : -1;
+		if( r < 0 )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// The module that is being built cannot be updated from within the build, but
+	// modules in other engines can be built. A discard is done after the build
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		asIScriptEngine *otherEngine = asCreateScriptEngine();
+		CUpdateDuringBuild update;
+		update.otherEngine = otherEngine;
+		engine->SetMessageCallback(asMETHOD(CUpdateDuringBuild, Callback), &update, asCALL_THISCALL);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		update.mod = mod;
+		mod->AddScriptSection("test", "void main() { int a = ; }");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+		if( update.compileResult != asBUILD_IN_PROGRESS ||
+			update.varResult != asBUILD_IN_PROGRESS ||
+			update.loadResult != asBUILD_IN_PROGRESS )
+			TEST_FAILED;
+		if( update.otherResult < 0 )
+			TEST_FAILED;
+
+		// Once the build is completed the module can be updated again
+		engine->ClearMessageCallback();
+		mod->AddScriptSection("test", "int main() { return 42; }");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		if( CallInt(engine, mod, "int main()") != 42 )
+			TEST_FAILED;
+
+		// The module is discarded when the build is completed
+		engine->SetMessageCallback(asMETHOD(CUpdateDuringBuild, Callback), &update, asCALL_THISCALL);
+		update.discard = true;
+		mod->AddScriptSection("test", "void main() { int a = ; }");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+		if( engine->GetModule("test") != 0 )
+			TEST_FAILED;
+
+		otherEngine->ShutDownAndRelease();
+		engine->ShutDownAndRelease();
+	}
+
+	// Compiling the function bodies with the worker pool must give the same result as a serial build,
+	// even when functions have to be deferred because they create template instances or lambdas
+	{
+		const char *script =
+			"funcdef int CB(int); \n"
+			"int Apply(CB @f, int v) { return f(v); } \n"
+			"int Lambda() { return Apply(function(x) { return x + 1; }, 1); } \n"
+			"int List() { array<float> a = {1.5f, 2.5f}; return int(a[0] + a[1]); } \n"
+			"int Str() { string s = 'hello'; return s.length(); } \n"
+			"int Warn() { float f = 3.7f; int i = f; return i; } \n"
+			"int Nested() { array<array<int>> a = {{1, 2}, {3}}; return a[0][1] + a[1][0]; } \n"
+			"int main() { return Lambda() + List() + Str() + Warn() + Nested() + 23; } \n";
+
+		string msgSerial, msgParallel;
+		vector<asBYTE> bcSerial, bcParallel;
+		int numPoolCalls = 0;
+		r = BuildAndSave(script, false, msgSerial, bcSerial, numPoolCalls);
+		if( r < 0 )
+			TEST_FAILED;
+		r = BuildAndSave(script, true, msgParallel, bcParallel, numPoolCalls);
+		if( r < 0 )
+			TEST_FAILED;
+		if( numPoolCalls == 0 )
+			TEST_FAILED;
+		if( msgSerial != msgParallel || msgParallel == "" )
+		{
+			PRINTF("%s---\n%s", msgSerial.c_str(), msgParallel.c_str());
+			TEST_FAILED;
+		}
+		if( bcSerial != bcParallel )
+			TEST_FAILED;
+
+		// The errors must be reported in the same order
+		script =
+			"int A() { return b; } \n"
+			"int B() { array<double> d = {1, 2}; return d.length(); } \n"
+			"int C() { return A(1); } \n"
+			"int D() { int x = 1.5; return x; } \n"
+			"int main() { return 42; } \n";
+		numPoolCalls = 0;
+		r = BuildAndSave(script, false, msgSerial, bcSerial, numPoolCalls);
+		if( r >= 0 )
+			TEST_FAILED;
+		r = BuildAndSave(script, true, msgParallel, bcParallel, numPoolCalls);
+		if( r >= 0 )
+			TEST_FAILED;
+		if( numPoolCalls == 0 )
+			TEST_FAILED;
+		if( msgSerial != msgParallel || msgParallel == "" )
+		{
+			PRINTF("%s---\n%s", msgSerial.c_str(), msgParallel.c_str());
+			TEST_FAILED;
+		}
+	}
+
 	// Test CompileGlobalVar with an array
 	// Reported by gmp3
 	{
@@ -683,6 +921,346 @@ bool Test()
 			TEST_FAILED;
 	}
 
+	// With asEP_INCREMENTAL_BUILD the module only compiles the functions whose statement blocks
+	// have changed, and the functions that inlined them. Everything else is kept as is
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_INCREMENTAL_BUILD, true);
+		engine->SetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE, 32);
+		bout.buffer = "";
+
+		const char *changing =
+			"funcdef int CB(); \n"
+			"namespace N { int Three() { return 3; } } \n"
+			"using namespace N; \n"
+			"int g = Init(); \n"
+			"int Init() { return 5; } \n"
+			"int Value() { return 1; } \n"
+			"int Calls() { return Value() + Three(); } \n"
+			"class C \n"
+			"{ \n"
+			"  int m = 10, k; \n"
+			"  C() { k = 1; } \n"
+			"  int Get() { return m + k; } \n"
+			"} \n"
+			"C obj; \n"
+			"int Lambda() { CB @f = function() { return 7; }; return f(); } \n"
+			"int Switch(int v) { switch( v ) { case K: return 1; } return 0; } \n";
+		const char *unchanged =
+			"const int K = 4; \n"
+			"int Uses() { return Value() * 10; } \n";
+
+		asIScriptModule *mod = engine->GetModule("incr", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("changing", changing);
+		mod->AddScriptSection("unchanged", unchanged);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		if( CallInt(engine, mod, "int Calls()") != 4 ||
+			CallInt(engine, mod, "int Uses()") != 10 ||
+			CallInt(engine, mod, "int Lambda()") != 7 ||
+			CallInt(engine, mod, "int Switch(int)") != 0 )
+			TEST_FAILED;
+
+		int *g = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("g"));
+		if( g == 0 || *g != 5 )
+			TEST_FAILED;
+		if( g ) *g = 100;
+		asIScriptFunction *uses = mod->GetFunctionByDecl("int Uses()");
+		int ctorRow = 0;
+		mod->GetTypeInfoByName("C")->GetFactoryByIndex(0)->GetDeclaredAt(0, &ctorRow, 0);
+
+		// Only the statement blocks are changed. Calls() is two lines longer, so the class is moved
+		const char *changed =
+			"funcdef int CB(); \n"
+			"namespace N { int Three() { return 3; } } \n"
+			"using namespace N; \n"
+			"int g = Init(); \n"
+			"int Init() { return 5; } \n"
+			"int Value() { return 2; } \n"
+			"int Calls() { \n"
+			"  return Value() + Three(); \n"
+			"} \n"
+			"class C \n"
+			"{ \n"
+			"  int m = 10, k; \n"
+			"  C() { k = 2; } \n"
+			"  int Get() { return m + k; } \n"
+			"} \n"
+			"C obj; \n"
+			"int Lambda() { CB @f = function() { return 8; }; return f(); } \n"
+			"int Switch(int v) { switch( v ) { case K: return 2; } return 0; } \n";
+		mod->AddScriptSection("changing", changed);
+		mod->AddScriptSection("unchanged", unchanged);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The global variable keeps its value, and Uses() has been compiled again as it inlined Value()
+		g = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("g"));
+		if( g == 0 || *g != 100 )
+			TEST_FAILED;
+		if( mod->GetFunctionByDecl("int Uses()") != uses )
+			TEST_FAILED;
+		if( CallInt(engine, mod, "int Calls()") != 5 ||
+			CallInt(engine, mod, "int Uses()") != 20 ||
+			CallInt(engine, mod, "int Lambda()") != 8 )
+			TEST_FAILED;
+
+		// The new constructor still initializes the members, while the existing object is untouched
+		r = ExecuteString(engine, "C c; g = c.Get()*10000 + obj.Get()*100 + Switch(4);", mod);
+		if( r != asEXECUTION_FINISHED || *g != 121102 )
+			TEST_FAILED;
+
+		// The functions that were not compiled again are moved with the code
+		int row = 0, newCtorRow = 0;
+		mod->GetFunctionByDecl("int Lambda()")->GetDeclaredAt(0, &row, 0);
+		mod->GetTypeInfoByName("C")->GetFactoryByIndex(0)->GetDeclaredAt(0, &newCtorRow, 0);
+		if( row != 17 || newCtorRow != ctorRow + 2 )
+			TEST_FAILED;
+
+		// Errors in the changed code fails the build, and the module is discarded
+		bout.buffer = "";
+		mod->AddScriptSection("changing", changing);
+		mod->AddScriptSection("unchanged", "const int K = 4; \nint Uses() { return x; } \n");
+		r = mod->Build();
+		if( r >= 0 || mod->GetFunctionCount() != 0 )
+			TEST_FAILED;
+		if( bout.buffer != "unchanged (2, 1) : Info    : Compiling int Uses()\n"
+		                   "unchanged (2, 21) : Error   : No matching symbol 'x'\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// Changes to the declarations requires a full build, which initializes the global variables again.
+		// A full build is not allowed while there are live objects of the module's classes, but an
+		// incremental build is, as it doesn't replace the types
+		bout.buffer = "";
+		mod = engine->GetModule("decl", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("decl", "int g = 5; \nint F() { return 1; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		g = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("g"));
+		if( g ) *g = 100;
+		mod->AddScriptSection("decl", "int g = 5; \nint F() { return 1; } \nint More() { return 2; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		g = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("g"));
+		if( g == 0 || *g != 5 || CallInt(engine, mod, "int More()") != 2 )
+			TEST_FAILED;
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// An incremental build must not replace the bytecode of the functions while a context is still executing them
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_INCREMENTAL_BUILD, true);
+		bout.buffer = "";
+
+		const char *scriptA =
+			"shared interface I { int f(); } \n"
+			"class C : I \n"
+			"{ \n"
+			"  int f() \n"
+			"  { \n"
+			"    int s = 0; \n"
+			"    for( int n = 0; n < 10; n++ ) \n"
+			"      s += n; \n"
+			"    return s; \n"
+			"  } \n"
+			"} \n";
+		const char *changedA =
+			"shared interface I { int f(); } \n"
+			"class C : I \n"
+			"{ \n"
+			"  int f() \n"
+			"  { \n"
+			"    int s = 1000; \n"
+			"    for( int n = 0; n < 10; n++ ) \n"
+			"      s += n; \n"
+			"    return s; \n"
+			"  } \n"
+			"} \n";
+
+		asIScriptModule *modA = engine->GetModule("a", asGM_ALWAYS_CREATE);
+		modA->AddScriptSection("a", scriptA);
+		r = modA->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptModule *modB = engine->GetModule("b", asGM_ALWAYS_CREATE);
+		modB->AddScriptSection("b",
+			"shared interface I { int f(); } \n"
+			"int run(I @i) { return i.f(); } \n");
+		r = modB->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// Suspend the context inside C::f, which is called from the other module
+		asIScriptObject *obj = (asIScriptObject*)engine->CreateScriptObject(modA->GetTypeInfoByName("C"));
+		ctx = engine->CreateContext();
+		ctx->SetLineCallback(asFUNCTION(SuspendInMethod), 0, asCALL_CDECL);
+		ctx->Prepare(modB->GetFunctionByName("run"));
+		ctx->SetArgObject(0, obj);
+		r = ctx->Execute();
+		if( r != asEXECUTION_SUSPENDED )
+			TEST_FAILED;
+
+		modA->AddScriptSection("a", changedA);
+		r = modA->Build();
+		if( r != asMODULE_IS_IN_USE )
+			TEST_FAILED;
+		if( bout.buffer != " (0, 0) : Error   : The module is still in use and cannot be rebuilt. Discard it and request another module\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// The context continues with the original code
+		ctx->ClearLineCallback();
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 45 )
+			TEST_FAILED;
+
+		// When the code is no longer executed the incremental build can be done
+		bout.buffer = "";
+		r = modA->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		ctx->Prepare(modB->GetFunctionByName("run"));
+		ctx->SetArgObject(0, obj);
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 1045 )
+			TEST_FAILED;
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		ctx->Release();
+		obj->Release();
+		engine->ShutDownAndRelease();
+	}
+
+	// Test that declaration lookups are cached and that the cache is invalidated when the module or configuration changes
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"void f() {} \n"
+			"int g(float a) { return 1; } \n"
+			"class C { int m(float a) const { return 2; } void h(C @c) {} } \n"
+			"void h(C @c) {} \n"
+			"namespace N { void f() {} } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptFunction *f = mod->GetFunctionByDecl("void f()");
+		if( f == 0 || f != mod->GetFunctionByDecl("void f()") || string(f->GetNamespace()) != "" )
+			TEST_FAILED;
+
+		// The default namespace is part of the key for the cached results
+		mod->SetDefaultNamespace("N");
+		asIScriptFunction *nf = mod->GetFunctionByDecl("void f()");
+		if( nf == 0 || nf == f || string(nf->GetNamespace()) != "N" )
+			TEST_FAILED;
+		mod->SetDefaultNamespace("");
+		if( mod->GetFunctionByDecl("void f()") != f )
+			TEST_FAILED;
+
+		asITypeInfo *type = mod->GetTypeInfoByDecl("C");
+		if( type == 0 || type != mod->GetTypeInfoByDecl("C") || mod->GetTypeIdByDecl("C") != type->GetTypeId() )
+			TEST_FAILED;
+
+		asIScriptFunction *m = type->GetMethodByDecl("int m(float) const");
+		if( m == 0 || m != type->GetMethodByDecl("int m(float) const") || type->GetMethodByDecl("int m(float)") != 0 )
+			TEST_FAILED;
+
+		// Pre-parsed signatures give the same result as the declarations
+		asIFunctionSignature *sigG = engine->CreateFunctionSignature("int g(float)");
+		asIFunctionSignature *sigH = engine->CreateFunctionSignature("void h(C@)");
+		asIFunctionSignature *sigM = engine->CreateFunctionSignature("int m(float) const");
+		if( sigG == 0 || sigH == 0 || sigM == 0 || string(sigG->GetDeclaration()) != "int g(float)" )
+			TEST_FAILED;
+		else
+		{
+			if( mod->GetFunctionBySignature(sigG) == 0 || mod->GetFunctionBySignature(sigG) != mod->GetFunctionByDecl("int g(float)") )
+				TEST_FAILED;
+			if( mod->GetFunctionBySignature(sigH) == 0 || mod->GetFunctionBySignature(sigH) != mod->GetFunctionByDecl("void h(C@)") )
+				TEST_FAILED;
+			if( type->GetMethodBySignature(sigM) != m || type->GetMethodBySignature(sigH) != type->GetMethodByDecl("void h(C@)") )
+				TEST_FAILED;
+
+			// Read-only signatures only match methods
+			if( mod->GetFunctionBySignature(sigM) != 0 )
+				TEST_FAILED;
+		}
+
+		// Rebuilding the module must not return the functions from the previous build
+		mod->AddScriptSection("test",
+			"int g(float a) { return 3; } \n"
+			"class C { int m(float a) const { return 4; } } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		if( mod->GetFunctionByDecl("void f()") != 0 )
+			TEST_FAILED;
+		asIScriptFunction *g = mod->GetFunctionByDecl("int g(float)");
+		if( g == 0 || g->GetModule() != mod || g != mod->GetFunctionBySignature(sigG) )
+			TEST_FAILED;
+		type = mod->GetTypeInfoByDecl("C");
+		if( type == 0 || type->GetMethodByDecl("int m(float) const") == 0 || type->GetMethodByDecl("int m(float) const") != type->GetMethodBySignature(sigM) )
+			TEST_FAILED;
+		if( mod->GetFunctionBySignature(sigH) != 0 )
+			TEST_FAILED;
+
+		// The same signature can be used with other modules, even after the first is discarded
+		mod->Discard();
+		mod = engine->GetModule("other", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("other", "int g(float a) { return 5; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		g = mod->GetFunctionByDecl("int g(float)");
+		if( g == 0 || g->GetModule() != mod || g != mod->GetFunctionBySignature(sigG) )
+			TEST_FAILED;
+
+		if( sigG ) sigG->Release();
+		if( sigH ) sigH->Release();
+		if( sigM ) sigM->Release();
+		mod->Discard();
+
+		// Removing a config group invalidates the engine's cached lookups
+		engine->BeginConfigGroup("grp");
+		r = engine->RegisterObjectType("T", 0, asOBJ_REF | asOBJ_NOCOUNT); assert( r >= 0 );
+		engine->EndConfigGroup();
+		int typeId = engine->GetTypeIdByDecl("T");
+		if( typeId < 0 || engine->GetTypeIdByDecl("T") != typeId || engine->GetTypeInfoByDecl("T") == 0 )
+			TEST_FAILED;
+		r = engine->RemoveConfigGroup("grp");
+		if( r < 0 )
+			TEST_FAILED;
+		if( engine->GetTypeIdByDecl("T") >= 0 || engine->GetTypeInfoByDecl("T") != 0 )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Success
 	return fail;
 }
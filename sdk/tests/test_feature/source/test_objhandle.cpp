@@ -277,8 +277,8 @@ bool Test()
 		asIScriptFunction *func = mod->GetTypeInfoByName("TestClass")->GetMethodByName("TestAccessToMemberOfMember", false);
 		asBYTE expect[] =
 		{
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
 			asBC_SUSPEND,asBC_RET
 		};
 		if (!ValidateByteCode(func, expect))
@@ -288,8 +288,8 @@ bool Test()
 		asBYTE expect2[] =
 		{
 			asBC_SUSPEND,asBC_CALL,asBC_STOREOBJ,
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
 			asBC_SUSPEND,asBC_FREE,asBC_RET
 		};
 		if (!ValidateByteCode(func, expect2))
@@ -298,8 +298,8 @@ bool Test()
 		func = mod->GetFunctionByName("TestHandleAccessToMemberOfMember");
 		asBYTE expect3[] =
 		{
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,asBC_FREE,
-			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtr,asBC_ADDSi,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_CpyVtoV4,asBC_FREE,
+			asBC_SUSPEND,asBC_PshC4,asBC_PshVPtrOfs,asBC_RDSPtr,asBC_RefCpyV,asBC_Thiscall1,asBC_RDR4,asBC_ADDi,asBC_FREE,
 			asBC_SUSPEND,asBC_FREE,asBC_RET
 		};
 		if (!ValidateByteCode(func, expect3))
@@ -404,6 +404,36 @@ static double g_d[6];
 static asUINT g_b[6];
 static asQWORD g_b64[6];
 
+// Returns the number of times the instruction is found in the function
+static asUINT CountInstructions(asIScriptFunction *func, asEBCInstr instr)
+{
+	asUINT len, count = 0;
+	asDWORD *bc = func->GetByteCode(&len);
+	for( asUINT n = 0; n < len; n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		if( *(asBYTE*)&bc[n] == instr )
+			count++;
+	}
+	return count;
+}
+
+// Returns true if the function has a call to a function with the given name
+static bool CallsFunction(asIScriptFunction *func, const char *name)
+{
+	asUINT len;
+	asDWORD *bc = func->GetByteCode(&len);
+	for( asUINT n = 0; n < len; n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		asBYTE c = *(asBYTE*)&bc[n];
+		if( c != asBC_CALL && c != asBC_CALLINTF )
+			continue;
+		asIScriptFunction *called = func->GetEngine()->GetFunctionById(asBC_INTARG(&bc[n]));
+		if( called && string(called->GetName()) == name )
+			return true;
+	}
+	return false;
+}
+
 bool TestOptimize()
 {
 	bool fail = false;
@@ -946,13 +976,13 @@ bool TestOptimize()
 		asBYTE expect[] = 
 			{	
 				asBC_SUSPEND,asBC_SetV4,asBC_JMP,asBC_SUSPEND,
-				asBC_SUSPEND,asBC_CMPIi,asBC_JP,asBC_CMPIi,asBC_JZ,asBC_CMPIi,asBC_JZ,asBC_JMP,
+				asBC_SUSPEND,asBC_JGtIi,asBC_JEqIi,asBC_JEqIi,asBC_JMP,
 				asBC_SUSPEND,asBC_PshC4,asBC_CALL,
 				asBC_SUSPEND,asBC_JMP,
 				asBC_SUSPEND,asBC_PshC4,asBC_CALL,
 				asBC_SUSPEND,asBC_JMP,
 				asBC_SUSPEND,asBC_PshC4,asBC_CALL,
-				asBC_SUSPEND,asBC_SUSPEND,asBC_IncVi,asBC_SUSPEND,asBC_CMPIi,asBC_JS,
+				asBC_SUSPEND,asBC_SUSPEND,asBC_IncVi,asBC_SUSPEND,asBC_JLtIi,
 				asBC_SUSPEND,asBC_RET
 			};
 		if( !ValidateByteCode(func, expect) )
@@ -1248,6 +1278,285 @@ bool TestOptimize()
 		engine->ShutDownAndRelease();
 	}
 
+	// The data flow optimizations propagate constants and copies, remove values that
+	// are never read, and remove the branches that are never taken
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		r = engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE_LEVEL, 3);
+		if( r != asINVALID_ARG )
+			TEST_FAILED;
+		r = engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE_LEVEL, 2);
+		if( r < 0 )
+			TEST_FAILED;
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int calc(int a) \n"
+			"{ \n"
+			"  int k = 10; \n"
+			"  int m = k * 3; \n"
+			"  int c = a; \n"
+			"  int d = c + m; \n"
+			"  if( k == 10 ) \n"
+			"    d += 1; \n"
+			"  else \n"
+			"    d -= 1; \n"
+			"  return d; \n"
+			"} \n"
+			"int loop(int n) \n"
+			"{ \n"
+			"  int s = 0, t = 5; \n"
+			"  for( int i = 0; i < n; i++ ) \n"
+			"  { \n"
+			"    int u = t; \n"
+			"    s += u + i; \n"
+			"  } \n"
+			"  return s; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptFunction *func = mod->GetFunctionByName("calc");
+		asBYTE expect[] =
+		{
+			asBC_SUSPEND,asBC_ADDIi,
+			asBC_SUSPEND,asBC_ADDIi,
+			asBC_SUSPEND,asBC_CpyVtoR4,asBC_RET
+		};
+		if( !ValidateByteCode(func, expect) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( calc(4) == 35 ); assert( loop(4) == 26 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Small script functions can be inlined at the call sites
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+
+		r = engine->SetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE, 32);
+		if( r < 0 || engine->GetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE) != 32 )
+			TEST_FAILED;
+
+		const char *script =
+			"class V \n"
+			"{ \n"
+			"  float x; \n"
+			"  float get_X() const property { return x; } \n"
+			"  void set_X(float v) property { x = v; } \n"
+			"  float len2() const { return x*x; } \n"
+			"} \n"
+			"int add(int a, int b) { return a + b; } \n"
+			"int div(int a, int b) \n"
+			"{ \n"
+			"  return a / b; \n"
+			"} \n"
+			"int calc(int n) \n"
+			"{ \n"
+			"  V v; \n"
+			"  v.X = 3; \n"
+			"  int s = 0; \n"
+			"  for( int i = 0; i < n; i++ ) \n"
+			"    s = add(s, i) + int(v.len2()) + int(v.X); \n"
+			"  return s; \n"
+			"} \n"
+			"int test(int b) \n"
+			"{ \n"
+			"  int r = div(10, b); \n"
+			"  return r; \n"
+			"} \n";
+
+		CBytecodeStream stream(__FILE__);
+		for( int pass = 0; pass < 2; pass++ )
+		{
+			mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+			if( pass == 0 )
+			{
+				mod->AddScriptSection("test", script);
+				r = mod->Build();
+				if( r < 0 )
+					TEST_FAILED;
+				mod->SaveByteCode(&stream);
+			}
+			else
+			{
+				// The inlined code must survive a save/load round trip
+				r = mod->LoadByteCode(&stream);
+				if( r < 0 )
+					TEST_FAILED;
+			}
+
+			asIScriptFunction *calc = mod->GetFunctionByName("calc");
+			if( calc == 0 || CallsFunction(calc, "add") || CallsFunction(calc, "len2") ||
+				CallsFunction(calc, "get_X") || CallsFunction(calc, "set_X") )
+				TEST_FAILED;
+
+			asIScriptContext *ctx = engine->CreateContext();
+			ctx->Prepare(calc);
+			ctx->SetArgDWord(0, 4);
+			r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 54 )
+				TEST_FAILED;
+
+			// An exception in the inlined code reports the line in the inlined function
+			ctx->Prepare(mod->GetFunctionByName("test"));
+			ctx->SetArgDWord(0, 0);
+			r = ctx->Execute();
+			if( r != asEXECUTION_EXCEPTION || ctx->GetExceptionLineNumber() != 11 ||
+				string(ctx->GetExceptionFunction()->GetName()) != "test" )
+				TEST_FAILED;
+
+			ctx->Prepare(mod->GetFunctionByName("test"));
+			ctx->SetArgDWord(0, 2);
+			r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 5 )
+				TEST_FAILED;
+			ctx->Release();
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// A method that is inlined must still raise an exception when called on a null handle
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE, 32);
+
+		const char *script =
+			"final class A { int f(int a) { return a + 1; } } \n"
+			"class B { int f(int a) final { return a + 2; } } \n"
+			"int t1(A @a) { return a.f(1); } \n"
+			"int t2(B @b) { return b.f(1); } \n"
+			"int t3() { A a; return a.f(1); } \n";
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", script);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		const char *funcs[] = {"t1", "t2", "t3"};
+		for( asUINT n = 0; n < 3; n++ )
+		{
+			asIScriptFunction *func = mod->GetFunctionByName(funcs[n]);
+			if( func == 0 || CallsFunction(func, "f") )
+				TEST_FAILED;
+
+			// A local object can never be null so it isn't checked
+			if( CountInstructions(func, asBC_ChkNullV) != (n < 2 ? 1 : 0) )
+				TEST_FAILED;
+		}
+
+		asIScriptContext *ctx = engine->CreateContext();
+		for( asUINT n = 0; n < 2; n++ )
+		{
+			ctx->Prepare(mod->GetFunctionByName(funcs[n]));
+			ctx->SetArgObject(0, 0);
+			r = ctx->Execute();
+			if( r != asEXECUTION_EXCEPTION || string(ctx->GetExceptionString()) != "Null pointer access" )
+				TEST_FAILED;
+		}
+		ctx->Release();
+
+		r = ExecuteString(engine, "A a; B b; assert( t1(a) == 2 ); assert( t2(b) == 3 ); assert( t3() == 2 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Calls to methods that cannot be overridden are made directly instead of through the virtual function table
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		const char *script =
+			"class Base \n"
+			"{ \n"
+			"  int v = 1; \n"
+			"  int get() { return v; } \n"
+			"  int fixed() final { return v * 10; } \n"
+			"} \n"
+			"final class Leaf : Base \n"
+			"{ \n"
+			"  int get() override { return v + 1; } \n"
+			"} \n"
+			"int test(Base @b, Leaf @l) \n"
+			"{ \n"
+			"  return b.get() + b.fixed() + l.get(); \n"
+			"} \n";
+
+		CBytecodeStream stream(__FILE__);
+		for( int pass = 0; pass < 2; pass++ )
+		{
+			mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+			if( pass == 0 )
+			{
+				mod->AddScriptSection("test", script);
+				r = mod->Build();
+				if( r < 0 )
+					TEST_FAILED;
+				mod->SaveByteCode(&stream);
+			}
+			else
+			{
+				// The direct calls must survive a save/load round trip
+				r = mod->LoadByteCode(&stream);
+				if( r < 0 )
+					TEST_FAILED;
+			}
+
+			// Only the call to Base::get must be virtual
+			asIScriptFunction *func = mod->GetFunctionByName("test");
+			if( func == 0 || CountInstructions(func, asBC_CALLINTF) != 1 || CountInstructions(func, asBC_CALL) != 2 )
+				TEST_FAILED;
+
+			r = ExecuteString(engine, "Leaf l; assert( test(l, l) == 14 ); assert( test(Base(), l) == 13 );", mod);
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+
+			// A null handle must still raise an exception
+			r = ExecuteString(engine, "Leaf @l; test(Base(), l);", mod);
+			if( r != asEXECUTION_EXCEPTION )
+				TEST_FAILED;
+		}
+
+		// The direct calls can also be inlined, but a null handle must still raise an exception
+		engine->SetEngineProperty(asEP_MAX_INLINE_FUNCTION_SIZE, 32);
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", script);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptFunction *func = mod->GetFunctionByName("test");
+		if( func == 0 || CountInstructions(func, asBC_CALLINTF) != 1 || CountInstructions(func, asBC_CALL) != 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "Leaf l; assert( test(l, l) == 14 ); assert( test(Base(), l) == 13 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		asIScriptContext *ctx = engine->CreateContext();
+		r = ExecuteString(engine, "Leaf @l; test(Base(), l);", mod, ctx);
+		if( r != asEXECUTION_EXCEPTION || string(ctx->GetExceptionString()) != "Null pointer access" )
+			TEST_FAILED;
+		ctx->Release();
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Success
 	return fail;
 }
@@ -337,6 +337,11 @@ void DummyRelease(asIScriptGeneric *gen)
 		delete object;
 }
 
+static void MulGeneric(asIScriptGeneric *gen)
+{
+	gen->SetReturnDWord(gen->GetArgDWord(0) * gen->GetArgDWord(1));
+}
+
 void Dummy(asIScriptGeneric *)
 {
 }
@@ -397,6 +402,188 @@ bool Test()
 	asIScriptEngine* engine;
 	asIScriptModule* mod;
 
+	// Test loading bytecode directly from a memory buffer
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		bout.buffer = "";
+
+		RegisterStdString(engine);
+		RegisterScriptArray(engine, true);
+
+		CBytecodeStream stream(__FILE__);
+
+		const char *script =
+			"class C { int64 big = -1234567890123; double d = 3.5; } \n"
+			"string s = 'hello'; \n"
+			"int result; \n"
+			"void main() { \n"
+			"  C c; \n"
+			"  array<int> a = {1, -2, 300000}; \n"
+			"  result = int(c.big % 1000) + int(c.d*2) + a[0] + a[1] + a[2] + int(s.length()); \n"
+			"} \n";
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("main", script);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream.buffer[0], asUINT(stream.buffer.size()));
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "main()", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+		int *result = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("result"));
+		if( result == 0 || *result != -123 + 7 + 1 - 2 + 300000 + 5 )
+			TEST_FAILED;
+
+		// The module must be the same as the one loaded from the stream
+		CBytecodeStream stream2(__FILE__);
+		r = mod->SaveByteCode(&stream2);
+		if( r < 0 )
+			TEST_FAILED;
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		CBytecodeStream stream3(__FILE__);
+		r = mod->SaveByteCode(&stream3);
+		if( r < 0 || stream2.buffer != stream3.buffer )
+			TEST_FAILED;
+
+		// A truncated buffer must fail without reading beyond the end
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream.buffer[0], asUINT(stream.buffer.size()/2));
+		if( r >= 0 )
+			TEST_FAILED;
+		if( bout.buffer.find("Unexpected end of file") == std::string::npos )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		r = mod->LoadByteCode((const void*)0, 0);
+		if( r != asINVALID_ARG )
+			TEST_FAILED;
+
+		bout.buffer = "";
+		engine->ShutDownAndRelease();
+	}
+
+	// Test saving and loading a bytecode image
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		bout.buffer = "";
+
+		RegisterStdString(engine);
+		engine->RegisterGlobalFunction("int Mul(int, int)", asFUNCTION(MulGeneric), asCALL_GENERIC);
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("main",
+			"int result; \n"
+			"void main() { string s = 'abc'; result = Mul(s.length(), 7); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		CBytecodeStream image(__FILE__);
+		r = mod->SaveByteCodeImage(&image);
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The image can be loaded both from a stream and from memory
+		for( int n = 0; n < 2; n++ )
+		{
+			mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+			image.Restart();
+			r = n == 0 ? mod->LoadByteCode(&image) : mod->LoadByteCode(&image.buffer[0], asUINT(image.buffer.size()));
+			if( r < 0 )
+				TEST_FAILED;
+			r = ExecuteString(engine, "main()", mod);
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+			int *result = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("result"));
+			if( result == 0 || *result != 21 )
+				TEST_FAILED;
+		}
+
+		// The image refers to Mul by its id, so the signature stored for it isn't needed in an engine with the same interface
+		std::vector<asBYTE> corrupted = image.buffer;
+		for( size_t n = 0; n + 3 < corrupted.size(); n++ )
+			if( corrupted[n] == 6 && corrupted[n+1] == 'M' && corrupted[n+2] == 'u' && corrupted[n+3] == 'l' )
+				corrupted[n+3] = 'x';
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&corrupted[0], asUINT(corrupted.size()));
+		if( r < 0 )
+			TEST_FAILED;
+		r = ExecuteString(engine, "main()", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+
+		// An engine with a different interface looks up the functions by their signature instead
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+
+		engine->RegisterGlobalFunction("int Other(int, int)", asFUNCTION(MulGeneric), asCALL_GENERIC);
+		RegisterStdString(engine);
+		engine->RegisterGlobalFunction("int Mul(int, int)", asFUNCTION(MulGeneric), asCALL_GENERIC);
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&image.buffer[0], asUINT(image.buffer.size()));
+		if( r < 0 )
+			TEST_FAILED;
+		r = ExecuteString(engine, "main()", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+		int *result = (int*)mod->GetAddressOfGlobalVar(mod->GetGlobalVarIndexByName("result"));
+		if( result == 0 || *result != 21 )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// Here the corrupted signature is used, so the function isn't found
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&corrupted[0], asUINT(corrupted.size()));
+		if( r >= 0 )
+			TEST_FAILED;
+		if( bout.buffer.find("The bytecode is invalid") == std::string::npos )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+		bout.buffer = "";
+
+		// A truncated image must fail
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&image.buffer[0], 30);
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer != " (0, 0) : Error   : Unexpected end of file\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+		bout.buffer = "";
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Test saving / loading bytecode with class that cannot generate copy constructor containing other class that cannot generate copy constructor
 	// Problem reported by Sam Tupy
 	{
@@ -425,7 +612,7 @@ bool Test()
 		mod->Discard();
 
 		asDWORD crc32 = ComputeCRC32(&stream.buffer[0], asUINT(stream.buffer.size()));
-		if (crc32 != 0x6B5CC4DF)
+		if (crc32 != 0xB2942D85)
 		{
 			PRINTF("The saved byte code has different checksum than the expected. Got 0x%X\n", crc32);
 			TEST_FAILED;
@@ -476,7 +663,7 @@ bool Test()
 		mod->Discard();
 
 		asDWORD crc32 = ComputeCRC32(&stream.buffer[0], asUINT(stream.buffer.size()));
-		if (crc32 != 0x200443CA)
+		if (crc32 != 0xCFF1135F)
 		{
 			PRINTF("The saved byte code has different checksum than the expected. Got 0x%X\n", crc32);
 			TEST_FAILED;
@@ -599,7 +786,7 @@ bool Test()
 		mod->Discard();
 
 		asDWORD crc32 = ComputeCRC32(&stream.buffer[0], asUINT(stream.buffer.size()));
-		if (crc32 != 0xBAA90FEE)
+		if (crc32 != 0x4A887115)
 		{
 			PRINTF("The saved byte code has different checksum than the expected. Got 0x%X\n", crc32);
 			TEST_FAILED;
@@ -1746,7 +1933,7 @@ bool Test()
 
 		engine->ShutDownAndRelease();
 
-		if( bout.buffer != "config (65, 0) : Warning : Cannot register template callback without the actual implementation\n" )
+		if( bout.buffer != "config (72, 0) : Warning : Cannot register template callback without the actual implementation\n" )
 		{
 			PRINTF("%s", bout.buffer.c_str());
 			TEST_FAILED;
@@ -1820,6 +2007,13 @@ bool Test()
 					"ep 38 1\n"
 					"ep 39 0\n"
 					"ep 40 1\n"
+					"ep 41 0\n"
+					"ep 42 3\n"
+					"ep 43 0\n"
+					"ep 44 0\n"
+					"ep 45 1\n"
+					"ep 46 0\n"
+					"ep 47 0\n"
 					"\n"
 					"// Enums\n"
 					"\n"
@@ -2420,7 +2614,7 @@ bool Test()
 		mod->SaveByteCode(&stream2, true);
 
 #ifndef STREAM_TO_FILE
-		if (stream.buffer.size() != 2433)
+		if (stream.buffer.size() != 2425)
 			PRINTF("The saved byte code is not of the expected size. It is %d bytes\n", (int)stream.buffer.size());
 		asUINT zeroes = stream.CountZeroes();
 		if (zeroes != 611)
@@ -2429,14 +2623,14 @@ bool Test()
 			// Mac OS X PPC has more zeroes, probably due to the bool type being 4 bytes
 		}
 		asDWORD crc32 = ComputeCRC32(&stream.buffer[0], asUINT(stream.buffer.size()));
-		if( crc32 != 0xE4913FF2)
+		if( crc32 != 0xC0ABE2CD)
 		{
 			PRINTF("The saved byte code has different checksum than the expected. Got 0x%X\n", crc32);
 			TEST_FAILED;
 		}
 
 		// Without debug info
-		if (stream2.buffer.size() != 2022)
+		if (stream2.buffer.size() != 2014)
 			PRINTF("The saved byte code without debug info is not of the expected size. It is %d bytes\n", (int)stream2.buffer.size());
 		zeroes = stream2.CountZeroes();
 		if (zeroes != 441)
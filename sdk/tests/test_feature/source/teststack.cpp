@@ -84,5 +84,98 @@ bool TestStack()
 		engine->Release();
 	}
 
+	// Test trimming the stack and reusing the stack blocks between contexts
+	{
+		asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_INIT_STACK_SIZE, 256);
+
+		asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		mod->AddScriptSection(TESTNAME,
+			"void recursive(int n) \n"
+			"{                     \n"
+			"  if( n > 0 )         \n"
+			"    recursive(n - 1); \n"
+			"}                     \n");
+		int r = mod->Build();
+		if (r < 0)
+			TEST_FAILED;
+
+		asIScriptFunction *func = mod->GetFunctionByDecl("void recursive(int)");
+		asIScriptContext *ctx = engine->CreateContext();
+		ctx->Prepare(func);
+		ctx->SetArgDWord(0, 1000);
+		r = ctx->Execute();
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+
+		asUINT allocated = 0, blocks = 0;
+		ctx->GetStackStatistics(&allocated, &blocks);
+		if (blocks < 2 || allocated <= 256)
+			TEST_FAILED;
+		asUINT deepBlocks = blocks;
+
+		asUINT inUse = 0, pooled = 0, pooledBlocks = 0;
+		engine->GetStackStatistics(&inUse, &pooled, &pooledBlocks);
+		if (inUse != allocated || pooled != 0 || pooledBlocks != 0)
+			TEST_FAILED;
+
+		// Trimming returns all but the initial block to the engine
+		r = ctx->TrimStack();
+		if (r != asSUCCESS)
+			TEST_FAILED;
+		ctx->GetStackStatistics(&allocated, &blocks);
+		if (blocks != 1 || allocated != 256)
+			TEST_FAILED;
+		engine->GetStackStatistics(&inUse, &pooled, &pooledBlocks);
+		if (inUse != 256 || pooled == 0 || pooledBlocks != deepBlocks - 1)
+			TEST_FAILED;
+
+		// Another context will borrow the pooled blocks rather than allocating new ones
+		asIScriptContext *ctx2 = engine->CreateContext();
+		ctx2->Prepare(func);
+		ctx2->SetArgDWord(0, 1000);
+		r = ctx2->Execute();
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+		asUINT pooledAfter = 0;
+		engine->GetStackStatistics(0, &pooledAfter);
+		if (pooledAfter != 0)
+			TEST_FAILED;
+		ctx2->Release();
+
+		// With the high water mark the context trims the stack automatically after the execution
+		engine->SetEngineProperty(asEP_STACK_HIGH_WATER_MARK, 1024);
+		if (engine->GetEngineProperty(asEP_STACK_HIGH_WATER_MARK) != 1024)
+			TEST_FAILED;
+		ctx->Prepare(func);
+		ctx->SetArgDWord(0, 1000);
+		r = ctx->Execute();
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+		ctx->GetStackStatistics(&allocated, &blocks);
+		if (blocks != 1)
+			TEST_FAILED;
+
+		// A shallow call stays within the limit, so nothing is released
+		ctx->Prepare(func);
+		ctx->SetArgDWord(0, 1);
+		r = ctx->Execute();
+		if (r != asEXECUTION_FINISHED)
+			TEST_FAILED;
+		ctx->GetStackStatistics(&allocated, &blocks);
+		if (blocks != 1)
+			TEST_FAILED;
+
+		ctx->Release();
+
+		// When the context is destroyed all its blocks are returned to the engine
+		engine->GetStackStatistics(&inUse);
+		if (inUse != 0)
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
 	return fail;
 }
@@ -6,14 +6,16 @@
 #include <crtdbg.h>
 #endif
 #include "angelscript.h"
+#include "../../../add_on/scriptjit/scriptjit.h"
+#include "utils.h"
 
-namespace TestBasic        { void Test(double *time); }
+namespace TestBasic        { void Test(double *time, asIJITCompilerAbstract *jit = 0); }
 namespace TestBasic2       { void Test(double *time); }
-namespace TestCall         { void Test(double *time); }
+namespace TestCall         { void Test(double *time, asIJITCompilerAbstract *jit = 0); }
 namespace TestCall2        { void Test(double *time); }
-namespace TestFib          { void Test(double *time); }
-namespace TestInt          { void Test(double *time); }
-namespace TestIntf         { void Test(double *time); }
+namespace TestFib          { void Test(double *time, asIJITCompilerAbstract *jit = 0); }
+namespace TestInt          { void Test(double *time, asIJITCompilerAbstract *jit = 0); }
+namespace TestIntf         { void Test(double *time); void TestMany(double *time); }
 namespace TestMthd         { void Test(double *time); }
 namespace TestString       { void Test(double *time); }
 namespace TestStringPooled { void Test(double *time); }
@@ -22,11 +24,14 @@ namespace TestThisProp     { void Test(double *time); }
 namespace TestVector3      { void Test(double *time); }
 namespace TestAssign       { void Test(double *times); }
 namespace TestArray        { void Test(double *times); }
+namespace TestArraySort    { void Test(double *times); }
+namespace TestGC           { void Test(double *times); }
 namespace TestGlobalVar    { void Test(double *time); }
 namespace TestClassProp    { void Test(double *time); }
 namespace TestRetObj       { void Test(double *times); }
+namespace TestOptLevel     { void Test(double *times); }
 
-const int NUM_TESTS = 25;
+const int NUM_TESTS = 33;
 
 // Times for 2.36.1 (64bit, Intel i7)
 double testTimesOrig[NUM_TESTS] = 
@@ -55,7 +60,15 @@ double testTimesOrig[NUM_TESTS] =
 0.217,  // ClassProp
 1.000,  // RetObj.1
 0.462,  // RetObj.2
-0.134   // RetObj.3
+0.134,  // RetObj.3
+0.000,  // Intf.2 (not measured for this version)
+0.000,  // Sort.1 (not measured for this version)
+0.000,  // Sort.2 (not measured for this version)
+0.000,  // GC.1 (not measured for this version)
+0.000,  // GC.2 (not measured for this version)
+0.000,  // GC.3 (not measured for this version)
+0.000,  // OptLevel.1 (not measured for this version)
+0.000   // OptLevel.2 (not measured for this version)
 };
 
 // Times for 2.36.2 WIP (64bit, Intel i7) (optimizations in context)
@@ -85,12 +98,27 @@ double testTimesOrig2[NUM_TESTS] =
 	0.213,  // ClassProp
 	0.927,  // RetObj.1
 	0.430,  // RetObj.2
-	0.118   // RetObj.3
+	0.118,  // RetObj.3
+	0.000,  // Intf.2 (not measured for this version)
+	0.000,  // Sort.1 (not measured for this version)
+	0.000,  // Sort.2 (not measured for this version)
+	0.000,  // GC.1 (not measured for this version)
+	0.000,  // GC.2 (not measured for this version)
+	0.000,  // GC.3 (not measured for this version)
+	0.000,  // OptLevel.1 (not measured for this version)
+	0.000   // OptLevel.2 (not measured for this version)
 };
 
 double testTimesBest[NUM_TESTS];
 double testTimes[NUM_TESTS];
 
+// The tests that are also executed with the JIT compiler
+const int NUM_JIT_TESTS = 4;
+const char *jitTestNames[NUM_JIT_TESTS] = { "Basic", "Call", "Fib", "Int" };
+const int jitTestInterpIdx[NUM_JIT_TESTS] = { 0, 2, 4, 5 };
+double jitTimesBest[NUM_JIT_TESTS];
+double jitTimes[NUM_JIT_TESTS];
+
 void DetectMemoryLeaks()
 {
 #if defined(_MSC_VER)
@@ -135,6 +163,10 @@ int main(int argc, char **argv)
 		TestGlobalVar::Test(&testTimes[20]); printf("."); fflush(stdout);
 		TestClassProp::Test(&testTimes[21]); printf("."); fflush(stdout);
 		TestRetObj::Test(&testTimes[22]); printf("."); fflush(stdout);
+		TestIntf::TestMany(&testTimes[25]); printf("."); fflush(stdout);
+		TestArraySort::Test(&testTimes[26]); printf("."); fflush(stdout);
+		TestGC::Test(&testTimes[28]); printf("."); fflush(stdout);
+		TestOptLevel::Test(&testTimes[31]); printf("."); fflush(stdout);
 
 		for( int t = 0; t < NUM_TESTS; t++ )
 		{
@@ -170,6 +202,48 @@ int main(int argc, char **argv)
 	printf("RetObj.1       %.3f    %.3f    %.3f%s\n", testTimesOrig[22], testTimesOrig2[22], testTimesBest[22], testTimesBest[22] < testTimesOrig2[22] ? " +" : " -");
 	printf("RetObj.2       %.3f    %.3f    %.3f%s\n", testTimesOrig[23], testTimesOrig2[23], testTimesBest[23], testTimesBest[23] < testTimesOrig2[23] ? " +" : " -");
 	printf("RetObj.3       %.3f    %.3f    %.3f%s\n", testTimesOrig[24], testTimesOrig2[24], testTimesBest[24], testTimesBest[24] < testTimesOrig2[24] ? " +" : " -");
+	printf("Intf.2         %.3f    %.3f    %.3f%s\n", testTimesOrig[25], testTimesOrig2[25], testTimesBest[25], testTimesBest[25] < testTimesOrig2[25] ? " +" : " -");
+	printf("Sort.1         %.3f    %.3f    %.3f%s\n", testTimesOrig[26], testTimesOrig2[26], testTimesBest[26], testTimesBest[26] < testTimesOrig2[26] ? " +" : " -");
+	printf("Sort.2         %.3f    %.3f    %.3f%s\n", testTimesOrig[27], testTimesOrig2[27], testTimesBest[27], testTimesBest[27] < testTimesOrig2[27] ? " +" : " -");
+	printf("GC.1           %.3f    %.3f    %.3f%s\n", testTimesOrig[28], testTimesOrig2[28], testTimesBest[28], testTimesBest[28] < testTimesOrig2[28] ? " +" : " -");
+	printf("GC.2           %.3f    %.3f    %.3f%s\n", testTimesOrig[29], testTimesOrig2[29], testTimesBest[29], testTimesBest[29] < testTimesOrig2[29] ? " +" : " -");
+	printf("GC.3           %.3f    %.3f    %.3f%s\n", testTimesOrig[30], testTimesOrig2[30], testTimesBest[30], testTimesBest[30] < testTimesOrig2[30] ? " +" : " -");
+	printf("OptLevel.1     %.3f    %.3f    %.3f%s\n", testTimesOrig[31], testTimesOrig2[31], testTimesBest[31], testTimesBest[31] < testTimesOrig2[31] ? " +" : " -");
+	printf("OptLevel.2     %.3f    %.3f    %.3f%s\n", testTimesOrig[32], testTimesOrig2[32], testTimesBest[32], testTimesBest[32] < testTimesOrig2[32] ? " +" : " -");
+
+	PrintByteCodeStats();
+
+	if( CScriptJIT::IsSupported() )
+	{
+		// Compare the interpreter with the JIT compiler
+		CScriptJIT jit;
+
+		for( n = 0; n < NUM_JIT_TESTS; n++ )
+			jitTimesBest[n] = 1000;
+
+		for( n = 0; n < 10; n++ )
+		{
+			TestBasic::Test(&jitTimes[0], &jit); printf("."); fflush(stdout);
+			TestCall::Test(&jitTimes[1], &jit); printf("."); fflush(stdout);
+			TestFib::Test(&jitTimes[2], &jit); printf("."); fflush(stdout);
+			TestInt::Test(&jitTimes[3], &jit); printf("."); fflush(stdout);
+
+			for( int t = 0; t < NUM_JIT_TESTS; t++ )
+			{
+				if( jitTimesBest[t] > jitTimes[t] )
+					jitTimesBest[t] = jitTimes[t];
+			}
+
+			printf("\n");
+		}
+
+		printf("JIT            interp   jit      speedup\n");
+		for( n = 0; n < NUM_JIT_TESTS; n++ )
+		{
+			double interp = testTimesBest[jitTestInterpIdx[n]];
+			printf("%-14s %.3f    %.3f    %.2fx\n", jitTestNames[n], interp, jitTimesBest[n], interp / jitTimesBest[n]);
+		}
+	}
 
 	printf("--------------------------------------------\n");
 	printf("Press any key to quit.\n");
@@ -0,0 +1,103 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+#include "../../../add_on/scriptarray/scriptarray.h"
+
+namespace TestArraySort
+{
+
+#define TESTNAME "TestArraySort"
+
+static const char *script =
+"void TestSortFloat()                                            \n"
+"{                                                               \n"
+"    array<float> a(100000);                                     \n"
+"    uint seed = 1;                                              \n"
+"    for( uint r = 0; r < 10; r++ )                              \n"
+"    {                                                           \n"
+"        for( uint n = 0; n < a.length(); n++ )                  \n"
+"        {                                                       \n"
+"            seed = seed * 1103515245 + 12345;                   \n"
+"            a[n] = float(seed >> 8) / 1000.0f;                  \n"
+"        }                                                       \n"
+"        a.sortAsc();                                            \n"
+"        a.sortDesc();                                           \n"
+"    }                                                           \n"
+"}                                                               \n"
+"                                                                \n"
+"void TestSortInt()                                              \n"
+"{                                                               \n"
+"    array<int> a(100000);                                       \n"
+"    uint seed = 1;                                              \n"
+"    for( uint r = 0; r < 10; r++ )                              \n"
+"    {                                                           \n"
+"        for( uint n = 0; n < a.length(); n++ )                  \n"
+"        {                                                       \n"
+"            seed = seed * 1103515245 + 12345;                   \n"
+"            a[n] = int(seed);                                   \n"
+"        }                                                       \n"
+"        a.sortAsc();                                            \n"
+"        a.sortDesc();                                           \n"
+"    }                                                           \n"
+"}                                                               \n";
+
+static double Run(asIScriptContext *ctx, asIScriptFunction *func)
+{
+	ctx->Prepare(func);
+
+	double time = GetSystemTimer();
+
+	int r = ctx->Execute();
+
+	time = GetSystemTimer() - time;
+
+	if( r != 0 )
+	{
+		printf("Execution didn't terminate with asEXECUTION_FINISHED\n");
+		if( r == asEXECUTION_EXCEPTION )
+		{
+			printf("Script exception\n");
+			asIScriptFunction *func = ctx->GetExceptionFunction();
+			printf("Func: %s\n", func->GetName());
+			printf("Line: %d\n", ctx->GetExceptionLineNumber());
+			printf("Desc: %s\n", ctx->GetExceptionString());
+		}
+		return 0;
+	}
+
+	return time;
+}
+
+void Test(double *testTimes)
+{
+ 	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+	RegisterScriptArray(engine, false);
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script, strlen(script), 0);
+	mod->Build();
+
+#ifndef _DEBUG
+	asIScriptContext *ctx = engine->CreateContext();
+
+	double time = Run(ctx, mod->GetFunctionByDecl("void TestSortFloat()"));
+	if( time > 0 )
+		testTimes[0] = time;
+
+	time = Run(ctx, mod->GetFunctionByDecl("void TestSortInt()"));
+	if( time > 0 )
+		testTimes[1] = time;
+
+	ctx->Release();
+#endif
+	engine->Release();
+}
+
+} // namespace
+
+
+
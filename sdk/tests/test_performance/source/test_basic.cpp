@@ -70,9 +70,10 @@ float Average(float a, float b)
 	return (a+b)/2;
 }
 
-void Test(double *testTime)
+void Test(double *testTime, asIJITCompilerAbstract *jit)
 {
  	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	ConfigureJIT(engine, jit);
 	COutStream out;
 	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
 	engine->RegisterGlobalFunction("float Average(float, float)", asFUNCTION(Average), asCALL_CDECL);
@@ -15,9 +15,10 @@ static const char *script =
 "}                                                               \n";
 
                                          
-void Test(double *testTime)
+void Test(double *testTime, asIJITCompilerAbstract *jit)
 {
  	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	ConfigureJIT(engine, jit);
 	COutStream out;
 	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
 
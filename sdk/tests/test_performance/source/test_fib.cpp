@@ -31,9 +31,10 @@ static const char *script =
 "    return cur;                      \n"
 "}                                    \n";
 
-void Test(double *testTime)
+void Test(double *testTime, asIJITCompilerAbstract *jit)
 {
  	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	ConfigureJIT(engine, jit);
 	engine->SetEngineProperty(asEP_BUILD_WITHOUT_LINE_CUES, true);
 
 	COutStream out;
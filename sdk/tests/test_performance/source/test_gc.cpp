@@ -0,0 +1,91 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+
+namespace TestGC
+{
+
+#define TESTNAME "TestGC"
+
+// Each pair of objects hold a reference to each other, so they can only
+// be destroyed by the garbage collector when it detects the circular references
+static const char *script =
+"class Node                                                      \n"
+"{                                                               \n"
+"    Node @next;                                                 \n"
+"}                                                               \n"
+"                                                                \n"
+"void CreateGarbage(uint count)                                  \n"
+"{                                                               \n"
+"    for( uint n = 0; n < count; n += 2 )                        \n"
+"    {                                                           \n"
+"        Node a, b;                                              \n"
+"        @a.next = b;                                            \n"
+"        @b.next = a;                                            \n"
+"    }                                                           \n"
+"}                                                               \n";
+
+// Returns the time for a full cycle to destroy the given number of objects
+static double Run(asIScriptEngine *engine, asIScriptContext *ctx, asIScriptFunction *func, asUINT count)
+{
+	ctx->Prepare(func);
+	ctx->SetArgDWord(0, count);
+	int r = ctx->Execute();
+	if( r != asEXECUTION_FINISHED )
+	{
+		printf("Execution didn't terminate with asEXECUTION_FINISHED\n");
+		return 0;
+	}
+
+	double time = GetSystemTimer();
+
+	engine->GarbageCollect(asGC_FULL_CYCLE);
+
+	time = GetSystemTimer() - time;
+
+	asUINT currentSize;
+	engine->GetGCStatistics(&currentSize);
+	if( currentSize != 0 )
+	{
+		printf("The garbage collector didn't destroy all objects\n");
+		return 0;
+	}
+
+	return time;
+}
+
+void Test(double *testTimes)
+{
+ 	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+	engine->SetEngineProperty(asEP_AUTO_GARBAGE_COLLECT, false);
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script, strlen(script), 0);
+	mod->Build();
+
+#ifndef _DEBUG
+	asIScriptContext *ctx = engine->CreateContext();
+	asIScriptFunction *func = mod->GetFunctionByDecl("void CreateGarbage(uint)");
+
+	const asUINT counts[3] = { 10000, 100000, 1000000 };
+	for( int n = 0; n < 3; n++ )
+	{
+		double time = Run(engine, ctx, func, counts[n]);
+		if( time > 0 )
+			testTimes[n] = time;
+	}
+
+	ctx->Release();
+#endif
+	engine->Release();
+}
+
+} // namespace
+
+
+
+
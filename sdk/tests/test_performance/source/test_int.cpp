@@ -71,9 +71,10 @@ int Average(int a, int b)
 }
 
                                          
-void Test(double *testTime)
+void Test(double *testTime, asIJITCompilerAbstract *jit)
 {
  	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	ConfigureJIT(engine, jit);
 	COutStream out;
 	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
 
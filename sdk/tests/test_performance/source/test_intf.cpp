@@ -57,6 +57,63 @@ static const char *script =
 "    }                                                           \n"
 "}                                                               \n";
 
+// The same call through handles to a class that implements many interfaces
+static const char *scriptMany =
+"interface intf0 { void func0(); }                               \n"
+"interface intf1 { void func1(); }                               \n"
+"interface intf2 { void func2(); }                               \n"
+"interface intf3 { void func3(); }                               \n"
+"interface intf4 { void func4(); }                               \n"
+"interface intf5 { void func5(); }                               \n"
+"interface intf6 { void func6(); }                               \n"
+"interface intf7 { void func7(); }                               \n"
+"interface intf8 { void func8(); }                               \n"
+"interface intf9 { void func9(); }                               \n"
+"interface intf10 { void func10(); }                             \n"
+"interface intf11 { void func11(); }                             \n"
+"interface intf12 { void func12(); }                             \n"
+"interface intf13 { void func13(); }                             \n"
+"interface intf14 { void func14(); }                             \n"
+"interface intf15 { void func15(); }                             \n"
+"class many : intf0, intf1, intf2, intf3, intf4, intf5,           \n"
+"             intf6, intf7, intf8, intf9, intf10, intf11,         \n"
+"             intf12, intf13, intf14, intf15                      \n"
+"{                                                               \n"
+"    void func0() {}                                             \n"
+"    void func1() {}                                             \n"
+"    void func2() {}                                             \n"
+"    void func3() {}                                             \n"
+"    void func4() {}                                             \n"
+"    void func5() {}                                             \n"
+"    void func6() {}                                             \n"
+"    void func7() {}                                             \n"
+"    void func8() {}                                             \n"
+"    void func9() {}                                             \n"
+"    void func10() {}                                            \n"
+"    void func11() {}                                            \n"
+"    void func12() {}                                            \n"
+"    void func13() {}                                            \n"
+"    void func14() {}                                            \n"
+"    void func15() {}                                            \n"
+"}                                                               \n"
+"                                                                \n"
+"void TestIntfMany()                                             \n"
+"{                                                               \n"
+"    many obj;                                                   \n"
+"    intf15 @i15 = obj;                                          \n"
+"    intf11 @i11 = obj;                                          \n"
+"    intf7 @i7 = obj;                                            \n"
+"    intf3 @i3 = obj;                                            \n"
+"                                                                \n"
+"    for( int n = 0; n < 2500000; n++ )                          \n"
+"    {                                                           \n"
+"        i15.func15();                                           \n"
+"        i11.func11();                                           \n"
+"        i7.func7();                                             \n"
+"        i3.func3();                                             \n"
+"    }                                                           \n"
+"}                                                               \n";
+
                                          
 void Test(double *testTime)
 {
@@ -99,6 +156,47 @@ void Test(double *testTime)
 	engine->Release();
 }
 
+void TestMany(double *testTime)
+{
+ 	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, scriptMany, strlen(scriptMany), 0);
+
+	mod->Build();
+
+#ifndef _DEBUG
+	asIScriptContext *ctx = engine->CreateContext();
+	ctx->Prepare(mod->GetFunctionByDecl("void TestIntfMany()"));
+
+	double time = GetSystemTimer();
+
+	int r = ctx->Execute();
+
+	time = GetSystemTimer() - time;
+
+	if( r != 0 )
+	{
+		printf("Execution didn't terminate with asEXECUTION_FINISHED\n");
+		if( r == asEXECUTION_EXCEPTION )
+		{
+			printf("Script exception\n");
+			asIScriptFunction *func = ctx->GetExceptionFunction();
+			printf("Func: %s\n", func->GetName());
+			printf("Line: %d\n", ctx->GetExceptionLineNumber());
+			printf("Desc: %s\n", ctx->GetExceptionString());
+		}
+	}
+	else
+		*testTime = time;
+
+	ctx->Release();
+#endif
+	engine->Release();
+}
+
 } // namespace
 
 
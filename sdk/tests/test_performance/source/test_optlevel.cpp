@@ -0,0 +1,89 @@
+//
+// Test author: Andreas Jonsson
+//
+
+#include "utils.h"
+
+namespace TestOptLevel
+{
+
+#define TESTNAME "TestOptLevel"
+
+// The loop has constants, copies, dead stores and a condition that is always
+// false, which the data flow optimization at level 2 is able to remove
+static const char *script =
+"int TestOptLevel()                        \n"
+"{                                         \n"
+"    int sum = 0;                          \n"
+"    for( int i = 0; i < 5000000; i++ )    \n"
+"    {                                     \n"
+"        int a = 3;                        \n"
+"        int b = a * 4;                    \n"
+"        int c = b;                        \n"
+"        int unused = i * 7;               \n"
+"        bool trace = false;               \n"
+"        if( trace )                       \n"
+"            sum -= c;                     \n"
+"        sum += c + i;                     \n"
+"        if( sum > 100000 )                \n"
+"            sum -= 100000;                \n"
+"    }                                     \n"
+"    return sum;                           \n"
+"}                                         \n";
+
+// Builds the script with the given optimization level and returns the time to execute it
+static double Run(int level)
+{
+ 	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	COutStream out;
+	engine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+	engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE_LEVEL, level);
+	engine->SetEngineProperty(asEP_BUILD_WITHOUT_LINE_CUES, true);
+
+	asIScriptModule *mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+	mod->AddScriptSection(TESTNAME, script, strlen(script), 0);
+	mod->Build();
+
+	double time = 0;
+
+#ifndef _DEBUG
+	asIScriptContext *ctx = engine->CreateContext();
+	ctx->Prepare(mod->GetFunctionByDecl("int TestOptLevel()"));
+
+	time = GetSystemTimer();
+
+	int r = ctx->Execute();
+
+	time = GetSystemTimer() - time;
+
+	if( r != asEXECUTION_FINISHED )
+	{
+		printf("Execution didn't terminate with asEXECUTION_FINISHED\n");
+		time = 0;
+	}
+	else if( ctx->GetReturnDWord() != 1508673696 )
+	{
+		printf("The script returned the wrong value at optimization level %d\n", level);
+		time = 0;
+	}
+
+	ctx->Release();
+#endif
+	engine->Release();
+
+	return time;
+}
+
+// Runs the same script with the peephole optimizations only (level 1) and with the data flow optimization (level 2)
+void Test(double *testTimes)
+{
+	for( int level = 1; level <= 2; level++ )
+	{
+		double time = Run(level);
+		if( time > 0 )
+			testTimes[level-1] = time;
+	}
+}
+
+} // namespace
+
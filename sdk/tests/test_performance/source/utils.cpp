@@ -98,3 +98,29 @@ double GetSystemTimer()
 
 #endif
 
+
+void PrintByteCodeStats()
+{
+	// The library only counts the instructions when compiled with AS_BYTECODE_STATS
+	if( asGetByteCodeStatsCount(1) == 0 )
+		return;
+
+	printf("--------------------------------------------\n");
+	printf("Most executed bytecode sequences\n");
+	for( asUINT length = 1; length <= 3; length++ )
+	{
+		printf("\n");
+		asBYTE op[3];
+		asQWORD count;
+		for( asUINT n = 0; n < 25 && asGetByteCodeStats(length, n, op, &count) >= 0; n++ )
+		{
+			char seq[64] = "";
+			for( asUINT i = 0; i < length; i++ )
+			{
+				if( i ) strcat(seq, " ");
+				strcat(seq, asBCInfo[op[i]].name);
+			}
+			printf("%-40s %12.0f\n", seq, double(count));
+		}
+	}
+}
@@ -9,6 +9,19 @@
 
 double GetSystemTimer();
 
+// Prints the most executed instructions when the library is compiled with AS_BYTECODE_STATS
+void PrintByteCodeStats();
+
+// Sets up the engine to execute the scripts with the JIT compiler. Does nothing if jit is null.
+inline void ConfigureJIT(asIScriptEngine *engine, asIJITCompilerAbstract *jit)
+{
+	if( jit == 0 )
+		return;
+	engine->SetEngineProperty(asEP_INCLUDE_JIT_INSTRUCTIONS, true);
+	engine->SetEngineProperty(asEP_JIT_INTERFACE_VERSION, 2);
+	engine->SetJITCompiler(jit);
+}
+
 class COutStream
 {
 public: